@@ -99,11 +99,14 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/unfair_mutex_impl.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/unfair_recursive_mutex.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/wfree_idle_count.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/atlas_allocator.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/byte_string.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/function_fifo.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/functional.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/lean_vector.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/lru_cache.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/container.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/fenwick_tree.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/polymorphic_optional.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/secure_vector.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/small_map.hpp
@@ -117,9 +120,12 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/wfree_fifo.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/wfree_unordered_map.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/awaitable.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/coroutine_frame_pool.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/generator.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/coroutine.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/lazy_task.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/task.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/when_all.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/crt/crt.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/crt/crt_utils.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/crt/crt_utils_intf.hpp
@@ -129,12 +135,15 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/dispatch.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/function_timer.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/loop_intf.hpp
+    $<$<PLATFORM_ID:Linux>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/loop_linux_impl.hpp>
     $<$<PLATFORM_ID:Windows>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/loop_win32_impl.hpp>
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/notifier.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/scoped_task.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/socket_event.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/socket_event_intf.hpp
+    $<$<PLATFORM_ID:Linux>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/socket_event_linux_impl.hpp>
     $<$<PLATFORM_ID:Windows>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/socket_event_win32_impl.hpp>
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/thread_pool.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/when_any.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/file/access_mode.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/file/file_intf.hpp
@@ -150,13 +159,16 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_book.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_char_map.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_coverage.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_family_id.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_index.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_metrics.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_variant.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_weight.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/glyph_atlas_info.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/glyph_id.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/glyph_metrics.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/glyph_sdf_tile.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/hikogui_icon.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_font.hpp
@@ -253,11 +265,15 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/gfx_pipeline_tone_mapper_vulkan_impl.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/gfx_pipeline_vulkan_intf.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/gfx_pipeline_vulkan_impl.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/gfx_software_renderer.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/render_doc.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/renderdoc_app.h
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_event.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_event_script.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_event_type.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_event_variant.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_window_base.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_window_headless.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_window_size.hpp
     $<$<PLATFORM_ID:Windows>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_window_win32.hpp>
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/hitbox.hpp
@@ -282,6 +298,7 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/axis.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/circle.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/corner_radii.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/damage_region.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/extent2.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/extent3.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/line_end_cap.hpp
@@ -301,6 +318,7 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/rotate3.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/scale2.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/scale3.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/spatial_grid.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/transform.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/translate2.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/translate3.hpp
@@ -309,6 +327,7 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/bezier.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/bezier_curve.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/bezier_point.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/coverage_rasterizer.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/graphic_path.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/graphic_path.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/i18n/iso_15924.hpp
@@ -326,6 +345,7 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/pixmap.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/pixmap_span.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/sdf_r8.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/sdf_rgba8.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/sfloat_rg32.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/sfloat_rgb32.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/sfloat_rgba16.hpp
@@ -440,6 +460,7 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/skeleton/skeleton_string_node.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/skeleton/skeleton_top_node.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/skeleton/skeleton_while_node.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/telemetry/allocation_counter.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/telemetry/counters.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/telemetry/delayed_format.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/telemetry/format_check.hpp
@@ -508,7 +529,8 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/endian.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/enum_metadata.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/exception_intf.hpp
-    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/exception_win32_impl.hpp
+    $<$<NOT:$<PLATFORM_ID:Windows>>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/exception_posix_impl.hpp>
+    $<$<PLATFORM_ID:Windows>:${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/exception_win32_impl.hpp>
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/exception.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/fixed_string.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/half.hpp
@@ -538,6 +560,8 @@ target_sources(hikogui INTERFACE FILE_SET hikogui_include_files TYPE HEADERS BAS
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/grid_widget.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/icon_widget.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/label_widget.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/list_delegate.hpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/list_widget.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/menu_button_widget.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/widgets.hpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/momentary_button_widget.hpp
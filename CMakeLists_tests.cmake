@@ -30,34 +30,54 @@ target_sources(hikogui_tests PRIVATE
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/callback_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/unfair_mutex_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/concurrency/rcu_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/atlas_allocator_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/fenwick_tree_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/lean_vector_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/lru_cache_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/polymorphic_optional_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/small_map_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/container/tree_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/coroutine_frame_pool_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/generator_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/lazy_task_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/coroutine/task_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/function_timer_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/loop_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/notifier_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/dispatch/thread_pool_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/file/file_view_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_char_map_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_coverage_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_index_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/font_weight_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/glyph_sdf_tile_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/font/true_type_font_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/formula/formula_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/damage_region_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/matrix3_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/point2_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/point3_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/scale2_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/scale3_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/spatial_grid_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/transform_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/translate2_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/translate3_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/vector2_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/geometry/vector3_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GFX/gfx_software_renderer_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/bezier_curve_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/coverage_rasterizer_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/graphic_path/graphic_path_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_event_script_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/GUI/gui_window_headless_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/i18n/iso_15924_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/i18n/iso_3166_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/i18n/iso_639_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/i18n/language_tag_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/pixmap_span_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/image/pixmap_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/layout/grid_layout_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/layout/spreadsheet_address_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/numeric/bigint_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/numeric/bound_integer_tests.cpp
@@ -104,7 +124,10 @@ target_sources(hikogui_tests PRIVATE
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/reflection_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/type_traits_tests.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/utility/units_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/grid_widget_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/list_widget_tests.cpp
     #${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/text_widget_tests.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/src/hikogui/widgets/widget_tests.cpp
 )
 
 show_build_target_properties(hikogui_tests)
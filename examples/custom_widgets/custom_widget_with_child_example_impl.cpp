@@ -27,7 +27,7 @@ public:
         _layout = {};
 
         // We need to recursively set the constraints of any child widget here as well
-        _label_constraints = _label_widget->update_constraints();
+        _label_constraints = _label_widget->update_constraints_retained();
 
         // We add the ability to resize the widget beyond the size of the label.
         auto r = hi::box_constraints{};
@@ -60,7 +60,7 @@ public:
 
         // The layout of any child widget must always be set, even if the layout didn't actually change.
         // This is because child widgets may need to re-layout for other reasons.
-        _label_widget->set_layout(context.transform(_label_shape));
+        _label_widget->set_layout_retained(context.transform(_label_shape));
     }
 
     // The `draw()` function is called when all or part of the window requires redrawing.
@@ -89,7 +89,7 @@ public:
             // Child widget only need to be drawn when the parent is visible, but the child may have
             // a visible area outside of the parent's visible area, therefor it should do its own
             // overlap check.
-            _label_widget->draw(context);
+            _label_widget->draw_retained(context);
         }
     }
 
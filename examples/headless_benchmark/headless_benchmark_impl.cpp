@@ -0,0 +1,111 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+// Count the allocations of each frame, this must be done in exactly one translation unit.
+#define HI_COUNT_ALLOCATIONS
+
+#include "hikogui/hikogui.hpp"
+#include "hikogui/crt.hpp"
+#include <string>
+#include <format>
+#include <iostream>
+#include <filesystem>
+
+using namespace hi;
+
+int usage()
+{
+    std::cerr << "Usage:\n";
+    std::cerr << "    headless_benchmark [--capture] <script filename>\n" << std::endl;
+    return 2;
+}
+
+[[nodiscard]] std::unique_ptr<window_widget> make_widgets(observer<int>& value)
+{
+    auto widget = std::make_unique<window_widget>(txt("Headless benchmark"));
+
+    widget->content().emplace<label_widget>("A1", txt("checkbox:"));
+    widget->content().emplace<checkbox_with_label_widget>("B1", value, 1, 2);
+
+    widget->content().emplace<label_widget>("A2", txt("toggle:"));
+    widget->content().emplace<toggle_with_label_widget>("B2", value, 1, 2);
+
+    widget->content().emplace<vertical_scroll_widget>("A3:B3").emplace<list_widget>(
+        10'000, [](widget_intf const& parent, size_t index) -> std::unique_ptr<widget> {
+            return std::make_unique<label_widget>(&parent, txt(std::format("row {}", index)));
+        });
+
+    return widget;
+}
+
+int hi_main(int argc, char *argv[])
+{
+    hi_axiom_not_null(argv);
+
+    set_application_name("Headless benchmark");
+    set_application_vendor("HikoGUI");
+    set_application_version({1, 0, 0});
+
+    auto capture = false;
+    auto script_filename = std::filesystem::path{};
+    for (auto i = 1; i != argc; ++i) {
+        hilet arg = std::string_view{argv[i]};
+        if (arg == "--capture") {
+            capture = true;
+        } else if (script_filename.empty()) {
+            script_filename = std::filesystem::path{arg};
+        } else {
+            return usage();
+        }
+    }
+    if (script_filename.empty()) {
+        return usage();
+    }
+
+    hilet script = gui_event_script::load(script_filename);
+
+    observer<int> value = 0;
+    auto window = gui_window_headless{make_widgets(value), script.size};
+    window.set_capture(capture);
+
+    std::cout << "frame,event_ns,constrain_ns,layout_ns,draw_ns,capture_ns,total_ns,event_allocs,constrain_allocs,layout_allocs,draw_allocs,capture_allocs,redraw_rectangles,quads\n";
+
+    auto display_time_point = std::chrono::utc_clock::now();
+    auto frame_nr = 0_uz;
+    for (hilet& frame : script.frames) {
+        for (auto i = 0_uz; i != frame.repeat; ++i) {
+            if (frame.resize) {
+                window.set_window_size(*frame.resize);
+            }
+            for (hilet& event : frame.events) {
+                window.process_event(event);
+            }
+
+            // Handle the callbacks which the widgets scheduled on the main loop.
+            loop::main().resume_once();
+
+            hilet s = window.render(display_time_point);
+            display_time_point += script.frame_duration;
+
+            std::cout << std::format(
+                "{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
+                frame_nr++,
+                s.event_duration.count(),
+                s.constrain_duration.count(),
+                s.layout_duration.count(),
+                s.draw_duration.count(),
+                s.capture_duration.count(),
+                s.duration().count(),
+                s.event_allocations,
+                s.constrain_allocations,
+                s.layout_allocations,
+                s.draw_allocations,
+                s.capture_allocations,
+                s.num_redraw_rectangles,
+                s.num_quads);
+        }
+    }
+
+    return 0;
+}
@@ -12,6 +12,7 @@ layout(push_constant) uniform push_constants {
 
 layout(constant_id = 0) const float sdf_max_distance = 1.0;
 layout(constant_id = 1) const float atlas_image_width = 1.0;
+layout(constant_id = 2) const bool sdf_multi_channel = false;
 
 layout(set = 0, binding = 0) uniform sampler in_sampler;
 layout(set = 0, binding = 1) uniform texture2D in_textures[128];
@@ -60,6 +61,20 @@ vec2 blue_coord(vec4 texture_stride, vec2 coord)
     return coord + tmp.xy + tmp.zw;
 }
 
+/** Get the distance to the nearest edge from the atlas.
+ *
+ * For a multi-channel signed distance field the distance is the median of the red, green and blue channels.
+ */
+float get_distance(int image_nr, vec2 coord)
+{
+    vec4 distances = texture(sampler2D(in_textures[image_nr], in_sampler), coord);
+    if (sdf_multi_channel) {
+        return max(min(distances.r, distances.g), min(max(distances.r, distances.g), distances.b));
+    } else {
+        return distances.r;
+    }
+}
+
 /** Get the distance from the sub-pixels to the nearest edge.
  *
  * @return Distances to the edge from the center of the red, green and blue sub-pixels.
@@ -70,12 +85,12 @@ vec3 get_subpixel_to_edge_distances()
     vec2 image_coord = in_texture_coord.xy;
     vec4 texture_stride = get_texture_stride();
 
-    float green_distance = texture(sampler2D(in_textures[image_nr], in_sampler), green_coord(texture_stride, image_coord)).r;
+    float green_distance = get_distance(image_nr, green_coord(texture_stride, image_coord));
 
     vec3 distances = vec3(green_distance, green_distance, green_distance);
     if (pushConstants.has_subpixels) {
-        distances.r = texture(sampler2D(in_textures[image_nr], in_sampler), red_coord(texture_stride, image_coord)).r;
-        distances.b = texture(sampler2D(in_textures[image_nr], in_sampler), blue_coord(texture_stride, image_coord)).r;
+        distances.r = get_distance(image_nr, red_coord(texture_stride, image_coord));
+        distances.b = get_distance(image_nr, blue_coord(texture_stride, image_coord));
     }
 
     float pixel_distance = length(texture_stride.xy);
@@ -25,6 +25,7 @@
 #include "gfx_pipeline_tone_mapper_vulkan_impl.hpp" // export
 #include "gfx_pipeline_vulkan_intf.hpp" // export
 #include "gfx_pipeline_vulkan_impl.hpp" // export
+#include "gfx_software_renderer.hpp" // export
 #include "render_doc.hpp" // export
 
 hi_export_module(hikogui.GFX);
@@ -22,10 +22,32 @@ hi_inline draw_context::draw_context(
     vector_span<gfx_pipeline_box::vertex>& box_vertices,
     vector_span<gfx_pipeline_image::vertex>& image_vertices,
     vector_span<gfx_pipeline_SDF::vertex>& sdf_vertices,
+    std::vector<glyph_allocation_id>& glyphs,
     vector_span<gfx_pipeline_override::vertex>& override_vertices) noexcept :
     device(std::addressof(device)),
     frame_buffer_index(std::numeric_limits<size_t>::max()),
-    scissor_rectangle(),
+    redraw_region(),
+    _box_vertices(&box_vertices),
+    _image_vertices(&image_vertices),
+    _sdf_vertices(&sdf_vertices),
+    _override_vertices(&override_vertices),
+    _glyphs(&glyphs)
+{
+    _box_vertices->clear();
+    _image_vertices->clear();
+    _sdf_vertices->clear();
+    _override_vertices->clear();
+    _glyphs->clear();
+}
+
+hi_inline draw_context::draw_context(
+    vector_span<gfx_pipeline_box::vertex>& box_vertices,
+    vector_span<gfx_pipeline_image::vertex>& image_vertices,
+    vector_span<gfx_pipeline_SDF::vertex>& sdf_vertices,
+    vector_span<gfx_pipeline_override::vertex>& override_vertices) noexcept :
+    device(nullptr),
+    frame_buffer_index(0),
+    redraw_region(),
     _box_vertices(&box_vertices),
     _image_vertices(&image_vertices),
     _sdf_vertices(&sdf_vertices),
@@ -88,7 +110,7 @@ draw_context::_draw_box(aarectangle const& clipping_rectangle, quad box, draw_at
 {
     hi_assert_not_null(_image_vertices);
 
-    if (image.state != gfx_pipeline_image::paged_image::state_type::uploaded) {
+    if (device == nullptr or image.state != gfx_pipeline_image::paged_image::state_type::uploaded) {
         return false;
     }
 
@@ -105,6 +127,11 @@ hi_inline void draw_context::_draw_glyph(
 {
     hi_assert_not_null(_sdf_vertices);
 
+    if (device == nullptr) {
+        ++global_counter<"draw_glyph::no_device">;
+        return;
+    }
+
     if (_sdf_vertices->full()) {
         auto box_attributes = attributes;
         box_attributes.fill_color = hi::color{1.0f, 0.0f, 1.0f}; // Magenta.
@@ -115,6 +142,7 @@ hi_inline void draw_context::_draw_glyph(
 
     hilet atlas_was_updated =
         device->SDF_pipeline->place_vertices(*_sdf_vertices, clipping_rectangle, box, font, glyph, attributes.fill_color);
+    _glyphs->push_back(font.atlas_info(glyph).allocation_id);
 
     if (atlas_was_updated) {
         device->SDF_pipeline->prepare_atlas_for_rendering();
@@ -129,6 +157,11 @@ hi_inline void draw_context::_draw_text(
 {
     hi_assert_not_null(_sdf_vertices);
 
+    if (device == nullptr) {
+        ++global_counter<"draw_glyph::no_device">;
+        return;
+    }
+
     auto atlas_was_updated = false;
     for (hilet& c : text) {
         hilet box = translate2{c.position} * c.metrics.bounding_rectangle;
@@ -147,6 +180,7 @@ hi_inline void draw_context::_draw_text(
 
         atlas_was_updated |= device->SDF_pipeline->place_vertices(
             *_sdf_vertices, clipping_rectangle, transform * box, *c.glyphs.font, c.glyphs.ids.front(), color);
+        _glyphs->push_back(c.glyphs.font->atlas_info(c.glyphs.ids.front()).allocation_id);
     }
 
     if (atlas_was_updated) {
@@ -325,4 +359,142 @@ hi_inline void draw_context::_draw_text_cursors(
     _draw_text_insertion_cursor(clipping_rectangle, transform, text, primary_cursor, draw_flags, attributes);
 }
 
+[[nodiscard]] hi_inline draw_context draw_context::start_recording(draw_recording& recording) const noexcept
+{
+    // This also releases the recordings of the children, so that they can be reused.
+    recording.clear();
+
+    auto r = *this;
+    r._recording = std::addressof(recording);
+    r._recording_start = mark();
+    return r;
+}
+
+hi_inline void draw_context::finish_recording() const noexcept
+{
+    hi_assert_not_null(_recording);
+    auto& recording = *_recording;
+
+    hilet append = [](auto& dst, auto const& src, std::size_t first, std::size_t last) {
+        for (auto i = first; i != last; ++i) {
+            dst.push_back(src[i]);
+        }
+    };
+
+    hilet append_own = [&](draw_mark const& first, draw_mark const& last) {
+        append(recording.box_vertices, *_box_vertices, first.box_vertices, last.box_vertices);
+        append(recording.image_vertices, *_image_vertices, first.image_vertices, last.image_vertices);
+        append(recording.sdf_vertices, *_sdf_vertices, first.sdf_vertices, last.sdf_vertices);
+        append(recording.override_vertices, *_override_vertices, first.override_vertices, last.override_vertices);
+        if (_glyphs) {
+            append(recording.glyphs, *_glyphs, first.glyphs, last.glyphs);
+        }
+    };
+
+    // The children were added with their position in the vertex buffers, skip over
+    // their vertices and convert the position to the position in the recording.
+    hilet end = mark();
+    auto position = _recording_start;
+    for (auto& child : recording.children) {
+        append_own(position, child.position);
+        position = child.position + child.recording->size;
+        child.position = recording.own_size();
+    }
+    append_own(position, end);
+
+    recording.size = end - _recording_start;
+    recording.generation = generation;
+    recording.atlas_eviction_count = device ? device->SDF_pipeline->atlas_eviction_count : 0;
+    recording.active = active;
+}
+
+hi_inline void
+draw_context::add_recording(std::shared_ptr<draw_recording const> recording, draw_mark const& start, vector2 offset) const noexcept
+{
+    if (_recording == nullptr) {
+        return;
+    }
+
+    _recording->children.push_back({start, offset, std::move(recording)});
+}
+
+[[nodiscard]] hi_inline bool draw_context::replay(draw_recording const& recording, vector2 offset) const noexcept
+{
+    hilet atlas_eviction_count = device ? device->SDF_pipeline->atlas_eviction_count : 0;
+    if (recording.generation != generation or recording.active != active or
+        recording.atlas_eviction_count != atlas_eviction_count) {
+        // The vertices may refer to an old theme, or to glyphs that are no longer in the atlas.
+        return false;
+    }
+
+    hilet fits = [](auto const& dst, std::size_t size) {
+        return dst.size() + size <= dst.capacity();
+    };
+
+    if (not fits(*_box_vertices, recording.size.box_vertices) or not fits(*_image_vertices, recording.size.image_vertices) or
+        not fits(*_sdf_vertices, recording.size.sdf_vertices) or
+        not fits(*_override_vertices, recording.size.override_vertices)) {
+        ++global_counter<"draw_context::replay:overflow">;
+        return false;
+    }
+
+    _replay(recording, offset);
+    return true;
+}
+
+hi_inline void draw_context::_replay(draw_recording const& recording, vector2 offset) const noexcept
+{
+    hilet position_offset = f32x4{offset.x(), offset.y(), 0.0f, 0.0f};
+    hilet clipping_offset = f32x4{offset.x(), offset.y(), offset.x(), offset.y()};
+
+    hilet copy = [&](auto& dst, auto const& src, std::size_t first, std::size_t last, auto clipping_rectangle) {
+        if (offset == vector2{}) {
+            for (auto i = first; i != last; ++i) {
+                dst.push_back(src[i]);
+            }
+        } else {
+            for (auto i = first; i != last; ++i) {
+                auto vertex = src[i];
+                vertex.position = static_cast<f32x4>(vertex.position) + position_offset;
+                vertex.*clipping_rectangle = static_cast<f32x4>(vertex.*clipping_rectangle) + clipping_offset;
+                dst.push_back(vertex);
+            }
+        }
+    };
+
+    hilet copy_own = [&](draw_mark const& first, draw_mark const& last) {
+        copy(*_box_vertices, recording.box_vertices, first.box_vertices, last.box_vertices, &gfx_pipeline_box::vertex::clipping_rectangle);
+        copy(
+            *_image_vertices,
+            recording.image_vertices,
+            first.image_vertices,
+            last.image_vertices,
+            &gfx_pipeline_image::vertex::clipping_rectangle);
+        copy(*_sdf_vertices, recording.sdf_vertices, first.sdf_vertices, last.sdf_vertices, &gfx_pipeline_SDF::vertex::clippingRectangle);
+        copy(
+            *_override_vertices,
+            recording.override_vertices,
+            first.override_vertices,
+            last.override_vertices,
+            &gfx_pipeline_override::vertex::clipping_rectangle);
+
+        if (first.glyphs != last.glyphs) {
+            hi_assert_not_null(device);
+            hilet glyphs = std::span{recording.glyphs}.subspan(first.glyphs, last.glyphs - first.glyphs);
+
+            // The glyphs must stay in the atlas while these vertices are in use.
+            device->SDF_pipeline->touch_glyphs(glyphs);
+            _glyphs->insert(_glyphs->end(), glyphs.begin(), glyphs.end());
+        }
+    };
+
+    auto position = draw_mark{};
+    for (hilet& child : recording.children) {
+        copy_own(position, child.position);
+        _replay(*child.recording, offset + child.offset);
+        position = child.position;
+    }
+    copy_own(position, recording.own_size());
+}
+
 }} // namespace hi::v1
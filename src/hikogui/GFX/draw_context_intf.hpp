@@ -16,6 +16,9 @@
 #include "../container/container.hpp"
 #include "../utility/utility.hpp"
 #include "../macros.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
 
 hi_export_module(hikogui.GFX : draw_context_intf);
 
@@ -204,19 +207,135 @@ template<typename Context>
 concept draw_quad_shape = std::same_as<Context, quad> or std::same_as<Context, rectangle> or std::same_as<Context, aarectangle> or
     std::same_as<Context, aarectangle>;
 
+using glyph_allocation_id = gfx_pipeline_SDF::device_shared::glyph_allocator_type::id_type;
+
+/** The position in each of the vertex buffers of a draw context.
+ */
+struct draw_mark {
+    std::size_t box_vertices = 0;
+    std::size_t image_vertices = 0;
+    std::size_t sdf_vertices = 0;
+    std::size_t override_vertices = 0;
+
+    /** The position in the list of glyph allocations, which runs parallel to the SDF vertices.
+     */
+    std::size_t glyphs = 0;
+
+    [[nodiscard]] constexpr friend draw_mark operator+(draw_mark const& lhs, draw_mark const& rhs) noexcept
+    {
+        return {
+            lhs.box_vertices + rhs.box_vertices,
+            lhs.image_vertices + rhs.image_vertices,
+            lhs.sdf_vertices + rhs.sdf_vertices,
+            lhs.override_vertices + rhs.override_vertices,
+            lhs.glyphs + rhs.glyphs};
+    }
+
+    [[nodiscard]] constexpr friend draw_mark operator-(draw_mark const& lhs, draw_mark const& rhs) noexcept
+    {
+        return {
+            lhs.box_vertices - rhs.box_vertices,
+            lhs.image_vertices - rhs.image_vertices,
+            lhs.sdf_vertices - rhs.sdf_vertices,
+            lhs.override_vertices - rhs.override_vertices,
+            lhs.glyphs - rhs.glyphs};
+    }
+
+    [[nodiscard]] constexpr friend bool operator==(draw_mark const&, draw_mark const&) noexcept = default;
+};
+
+/** Vertices retained from a previous frame.
+ *
+ * The vertices drawn by a widget are recorded, so that they can be replayed
+ * into the draw context of a following frame without drawing the shapes again.
+ *
+ * The vertices drawn by a child widget are not copied into the recording of
+ * its parent; instead the parent refers to the recording of the child.
+ */
+struct draw_recording {
+    /** A reference to the recording of a child widget.
+     */
+    struct child_type {
+        /** The position in the vertices of this recording where the child's vertices are inserted.
+         */
+        draw_mark position;
+
+        /** The translation of the child's vertices.
+         */
+        vector2 offset;
+
+        std::shared_ptr<draw_recording const> recording;
+    };
+
+    std::vector<gfx_pipeline_box::vertex> box_vertices;
+    std::vector<gfx_pipeline_image::vertex> image_vertices;
+    std::vector<gfx_pipeline_SDF::vertex> sdf_vertices;
+    std::vector<gfx_pipeline_override::vertex> override_vertices;
+
+    /** The glyphs in the atlas used by `sdf_vertices`.
+     */
+    std::vector<glyph_allocation_id> glyphs;
+
+    /** The recordings of the children, ordered by position.
+     */
+    std::vector<child_type> children;
+
+    /** The number of vertices including those of the children.
+     */
+    draw_mark size;
+
+    /** The generation of the draw context during recording.
+     */
+    std::size_t generation = 0;
+
+    /** The number of glyph evictions from the atlas during recording.
+     */
+    uint64_t atlas_eviction_count = 0;
+
+    /** If the window was active during recording.
+     */
+    bool active = false;
+
+    /** The number of vertices of this recording, excluding those of the children.
+     */
+    [[nodiscard]] draw_mark own_size() const noexcept
+    {
+        return {box_vertices.size(), image_vertices.size(), sdf_vertices.size(), override_vertices.size(), glyphs.size()};
+    }
+
+    void clear() noexcept
+    {
+        box_vertices.clear();
+        image_vertices.clear();
+        sdf_vertices.clear();
+        override_vertices.clear();
+        glyphs.clear();
+        children.clear();
+        size = {};
+    }
+};
+
 /** Draw context for drawing using the HikoGUI shaders.
  */
 class draw_context {
 public:
+    /** The device used for drawing images and glyphs.
+     *
+     * When there is no device, for example in a headless window, images and
+     * glyphs are not drawn.
+     */
     gfx_device *device;
 
     /** The frame buffer index of the image we are currently rendering.
      */
     std::size_t frame_buffer_index;
 
-    /** This is the rectangle of the window that is being redrawn.
+    /** The parts of the window that are being redrawn.
+     *
+     * Widgets outside of each rectangle of the region do not need to be drawn,
+     * the frame buffer is only modified inside the region.
      */
-    aarectangle scissor_rectangle;
+    damage_region redraw_region;
 
     /** The subpixel orientation for rendering glyphs.
      */
@@ -234,6 +353,14 @@ public:
      */
     utc_nanoseconds display_time_point;
 
+    /** The generation of the widget tree.
+     *
+     * The window increments the generation when all widgets are constrained,
+     * for example when the theme changes. Recordings are only replayed
+     * within the same generation.
+     */
+    std::size_t generation = 0;
+
     draw_context(draw_context const& rhs) noexcept = default;
     draw_context(draw_context&& rhs) noexcept = default;
     draw_context& operator=(draw_context const& rhs) noexcept = default;
@@ -242,6 +369,18 @@ public:
 
     draw_context(
         gfx_device& device,
+        vector_span<gfx_pipeline_box::vertex>& box_vertices,
+        vector_span<gfx_pipeline_image::vertex>& image_vertices,
+        vector_span<gfx_pipeline_SDF::vertex>& sdf_vertices,
+        std::vector<glyph_allocation_id>& glyphs,
+        vector_span<gfx_pipeline_override::vertex>& override_vertices) noexcept;
+
+    /** Create a draw context without a device.
+     *
+     * Boxes and lines are drawn, images and glyphs are not drawn since they
+     * need the atlases of a device.
+     */
+    draw_context(
         vector_span<gfx_pipeline_box::vertex>& box_vertices,
         vector_span<gfx_pipeline_image::vertex>& image_vertices,
         vector_span<gfx_pipeline_SDF::vertex>& sdf_vertices,
@@ -254,6 +393,58 @@ public:
         return frame_buffer_index != std::numeric_limits<size_t>::max();
     }
 
+    /** Get the current position in each of the vertex buffers.
+     */
+    [[nodiscard]] draw_mark mark() const noexcept
+    {
+        return {
+            _box_vertices->size(),
+            _image_vertices->size(),
+            _sdf_vertices->size(),
+            _override_vertices->size(),
+            _glyphs ? _glyphs->size() : 0_uz};
+    }
+
+    /** Start recording the vertices drawn.
+     *
+     * @param recording The recording to overwrite.
+     * @return A copy of this context, the vertices drawn with the copy are recorded.
+     */
+    [[nodiscard]] draw_context start_recording(draw_recording& recording) const noexcept;
+
+    /** Finish the recording started with `start_recording()`.
+     *
+     * The vertices drawn since the start are copied into the recording, except
+     * for the vertices of the recordings added with `add_recording()`; these
+     * are referenced instead.
+     *
+     * This function must be called on the context returned by `start_recording()`.
+     */
+    void finish_recording() const noexcept;
+
+    /** Add a recording to the recording in progress.
+     *
+     * This is used by a child widget after it has drawn or replayed its own
+     * recording, so that the recording of the parent refers to the child's
+     * recording instead of copying it.
+     *
+     * @param recording The recording of the child.
+     * @param start The mark taken before the child drew or replayed its recording.
+     * @param offset The translation with which the recording was replayed.
+     */
+    void add_recording(std::shared_ptr<draw_recording const> recording, draw_mark const& start, vector2 offset) const noexcept;
+
+    /** Copy the vertices of a recording into the vertex buffers.
+     *
+     * The glyphs used by the recording are marked as used in the atlas.
+     *
+     * @param recording The recording made during a previous frame.
+     * @param offset The translation in window coordinates since the recording was made.
+     * @return True if the recording was replayed, false if the recording is stale or
+     *         does not fit in the vertex buffers.
+     */
+    [[nodiscard]] bool replay(draw_recording const& recording, vector2 offset) const noexcept;
+
     /** Draw a box.
      *
      * @param layout The layout to use, specifically the to_window transformation matrix and the clipping rectangle.
@@ -605,7 +796,7 @@ public:
 
     /** Checks if a widget's layout overlaps with the part of the window that is being drawn.
      *
-     * @param context The draw context which contains the scissor rectangle.
+     * @param context The draw context which contains the redraw region.
      * @param layout The layout of a widget which contains the rectangle where the widget is located
      *               on the window
      * @return True if the widget needs to draw into the context.
@@ -613,7 +804,7 @@ public:
     template<std::same_as<widget_layout> WidgetLayout>
     [[nodiscard]] friend bool overlaps(draw_context const& context, WidgetLayout const& layout) noexcept
     {
-        return overlaps(context.scissor_rectangle, layout.clipping_rectangle_on_window());
+        return overlaps(context.redraw_region, layout.clipping_rectangle_on_window());
     }
 
 private:
@@ -622,6 +813,24 @@ private:
     vector_span<gfx_pipeline_SDF::vertex> *_sdf_vertices;
     vector_span<gfx_pipeline_override::vertex> *_override_vertices;
 
+    /** The atlas allocation of each glyph in the SDF vertices.
+     *
+     * This is nullptr when there is no device.
+     */
+    std::vector<glyph_allocation_id> *_glyphs = nullptr;
+
+    /** The recording in progress, or nullptr.
+     */
+    draw_recording *_recording = nullptr;
+
+    /** The mark taken at the start of the recording in progress.
+     */
+    draw_mark _recording_start = {};
+
+    /** Copy the vertices of a recording, and of its children, into the vertex buffers.
+     */
+    void _replay(draw_recording const& recording, vector2 offset) const noexcept;
+
     template<draw_quad_shape Shape>
     [[nodiscard]] constexpr static quad make_quad(Shape const& shape) noexcept
     {
@@ -15,9 +15,12 @@ hi_export_module(hikogui.GFX : gfx_pipeline_SDF_impl);
 
 hi_export namespace hi { inline namespace v1 {
 
-hi_inline void gfx_pipeline_SDF::draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context)
+hi_inline void gfx_pipeline_SDF::draw_in_command_buffer(
+    vk::CommandBuffer commandBuffer,
+    draw_context const& context,
+    std::span<vk::Rect2D const> scissors)
 {
-    gfx_pipeline::draw_in_command_buffer(commandBuffer, context);
+    gfx_pipeline::draw_in_command_buffer(commandBuffer, context, scissors);
 
     hi_axiom_not_null(device());
     device()->flushAllocation(vertexBufferAllocation, 0, vertexBufferData.size() * sizeof(vertex));
@@ -70,8 +73,13 @@ hi_inline void gfx_pipeline_SDF::draw_in_command_buffer(vk::CommandBuffer comman
     hilet numberOfRectangles = vertexBufferData.size() / 4;
     hilet numberOfTriangles = numberOfRectangles * 2;
     device()->cmdBeginDebugUtilsLabelEXT(commandBuffer, "draw glyphs");
-    commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    for (hilet& scissor : scissors) {
+        commandBuffer.setScissor(0, 1, &scissor);
+        commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    }
     device()->cmdEndDebugUtilsLabelEXT(commandBuffer);
+
+    device()->SDF_pipeline->next_frame();
 }
 
 hi_inline std::vector<vk::PipelineShaderStageCreateInfo> gfx_pipeline_SDF::createShaderStages() const
@@ -218,49 +226,64 @@ hi_inline void gfx_pipeline_SDF::device_shared::destroy(gfx_device const *vulkan
     teardownAtlas(vulkanDevice);
 }
 
-[[nodiscard]] hi_inline glyph_atlas_info gfx_pipeline_SDF::device_shared::allocate_rect(extent2 draw_extent, scale2 draw_scale) noexcept
+[[nodiscard]] hi_inline glyph_atlas_info gfx_pipeline_SDF::device_shared::allocate_rect(
+    hi::font const& font,
+    glyph_id glyph,
+    extent2 draw_extent,
+    scale2 draw_scale) noexcept
 {
-    auto image_width = ceil_cast<int>(draw_extent.width());
-    auto image_height = ceil_cast<int>(draw_extent.height());
-
-    // Check if the glyph still fits in the same line of glyphs.
-    // Otherwise go to the next line.
-    if (atlas_allocation_position.x() + image_width > atlasImageWidth) {
-        atlas_allocation_position.x() = 0;
-        atlas_allocation_position.y() = atlas_allocation_position.y() + atlasAllocationMaxHeight;
-        atlasAllocationMaxHeight = 0;
-    }
+    hilet image_width = ceil_cast<size_t>(draw_extent.width());
+    hilet image_height = ceil_cast<size_t>(draw_extent.height());
 
-    // Check if the glyph still fits in the image.
-    // Otherwise allocate a new image.
-    if (atlas_allocation_position.y() + image_height > atlasImageHeight) {
-        atlas_allocation_position.x() = 0;
-        atlas_allocation_position.y() = 0;
-        atlas_allocation_position.z() = atlas_allocation_position.z() + 1;
-        atlasAllocationMaxHeight = 0;
+    auto evicted = std::vector<std::pair<hi::font const *, glyph_id>>{};
+    hilet allocation = glyph_allocator.allocate({&font, glyph}, image_width, image_height, frame_count, evicted);
+    forget_glyphs(evicted);
 
-        if (atlas_allocation_position.z() >= atlasMaximumNrImages) {
-            hi_log_fatal("gfx_pipeline_SDF atlas overflow, too many glyphs in use.");
-        }
+    if (not allocation) {
+        hi_log_fatal("gfx_pipeline_SDF atlas overflow, too many glyphs in use.");
+    }
 
-        if (atlas_allocation_position.z() >= atlasTextures.size()) {
-            addAtlasImage();
-        }
+    while (allocation->page >= atlasTextures.size()) {
+        addAtlasImage();
     }
 
-    auto r = glyph_atlas_info{atlas_allocation_position, draw_extent, draw_scale, scale2{atlasTextureCoordinateMultiplier}};
-    atlas_allocation_position.x() = atlas_allocation_position.x() + image_width;
-    atlasAllocationMaxHeight = std::max(atlasAllocationMaxHeight, image_height);
+    hilet position = point3{narrow_cast<float>(allocation->x), narrow_cast<float>(allocation->y), narrow_cast<float>(allocation->page)};
+    auto r = glyph_atlas_info{position, draw_extent, draw_scale, scale2{atlasTextureCoordinateMultiplier}};
+    r.allocation_id = allocation->id;
     return r;
 }
 
+hi_inline void gfx_pipeline_SDF::device_shared::forget_glyphs(std::vector<std::pair<hi::font const *, glyph_id>> const& evicted) noexcept
+{
+    if (evicted.empty()) {
+        return;
+    }
+
+    ++atlas_eviction_count;
+    for (hilet [font, glyph] : evicted) {
+        font->atlas_info(glyph) = {};
+    }
+}
+
+hi_inline void gfx_pipeline_SDF::device_shared::next_frame() noexcept
+{
+    hilet lock = std::scoped_lock(gfx_system_mutex);
+
+    if (++frame_count % atlasCompactionInterval == 0) {
+        // Evict pages where less than a quarter is covered by glyphs used since the last compaction.
+        auto evicted = std::vector<std::pair<hi::font const *, glyph_id>>{};
+        glyph_allocator.compact(frame_count, atlasCompactionInterval, 0.25f, evicted);
+        forget_glyphs(evicted);
+    }
+}
+
 hi_inline void gfx_pipeline_SDF::device_shared::uploadStagingPixmapToAtlas(glyph_atlas_info const& location)
 {
     // Flush the given image, included the border.
     device.flushAllocation(
-        stagingTexture.allocation, 0, (stagingTexture.pixmap.height() * stagingTexture.pixmap.stride()) * sizeof(sdf_r8));
+        stagingTexture.allocation, 0, (stagingTexture.pixmap.height() * stagingTexture.pixmap.stride()) * sizeof(atlas_pixel_type));
 
-    stagingTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eTransferSrcOptimal);
+    stagingTexture.transitionLayout(device, atlasFormat, vk::ImageLayout::eTransferSrcOptimal);
 
     std::array<std::vector<vk::ImageCopy>, atlasMaximumNrImages> regionsToCopyPerAtlasTexture;
 
@@ -272,7 +295,7 @@ hi_inline void gfx_pipeline_SDF::device_shared::uploadStagingPixmapToAtlas(glyph
         {ceil_cast<uint32_t>(location.size.width()), ceil_cast<uint32_t>(location.size.height()), 1}}};
 
     auto& atlasTexture = atlasTextures.at(floor_cast<std::size_t>(location.position.z()));
-    atlasTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eTransferDstOptimal);
+    atlasTexture.transitionLayout(device, atlasFormat, vk::ImageLayout::eTransferDstOptimal);
 
     device.copyImage(
         stagingTexture.image,
@@ -284,62 +307,69 @@ hi_inline void gfx_pipeline_SDF::device_shared::uploadStagingPixmapToAtlas(glyph
 
 hi_inline void gfx_pipeline_SDF::device_shared::prepareStagingPixmapForDrawing()
 {
-    stagingTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eGeneral);
+    stagingTexture.transitionLayout(device, atlasFormat, vk::ImageLayout::eGeneral);
 }
 
 hi_inline void gfx_pipeline_SDF::device_shared::prepare_atlas_for_rendering()
 {
     hilet lock = std::scoped_lock(gfx_system_mutex);
     for (auto& atlasTexture : atlasTextures) {
-        atlasTexture.transitionLayout(device, vk::Format::eR8Snorm, vk::ImageLayout::eShaderReadOnlyOptimal);
+        atlasTexture.transitionLayout(device, atlasFormat, vk::ImageLayout::eShaderReadOnlyOptimal);
     }
 }
 
-/** Prepare the atlas for drawing a text.
- *
- *  +---------------------+
- *  |     draw border     |
- *  |  +---------------+  |
- *  |  | render border |  |
- *  |  |  +---------+  |  |
- *  |  |  |  glyph  |  |  |
- *  |  |  | bounding|  |  |
- *  |  |  |   box   |  |  |
- *  |  |  +---------+  |  |
- *  |  |               |  |
- *  |  +---------------+  |
- *  |                     |
- *  O---------------------+
- */
+hi_inline glyph_atlas_info gfx_pipeline_SDF::device_shared::upload_glyph_tile(glyph_sdf_tile const& tile) noexcept
+{
+    hi_axiom(gfx_system_mutex.recurse_lock_count());
+
+    // Draw glyphs into staging buffer of the atlas and upload it to the correct position in the atlas.
+    prepareStagingPixmapForDrawing();
+    hilet info = allocate_rect(*tile.font, tile.glyph, tile.size, tile.border_scale);
+    hilet& pixels = tile.get_pixels<atlas_pixel_type>();
+    auto pixmap = stagingTexture.pixmap.subimage(0, 0, pixels.width(), pixels.height());
+    copy(pixmap_span<atlas_pixel_type const>{pixels}, pixmap);
+    uploadStagingPixmapToAtlas(info);
+    return info;
+}
+
 hi_inline void gfx_pipeline_SDF::device_shared::add_glyph_to_atlas(hi::font const &font, glyph_id glyph, glyph_atlas_info& info) noexcept
 {
-    hilet glyph_metrics = font.get_metrics(glyph);
-    hilet glyph_path = font.get_path(glyph);
-    hilet glyph_bounding_box = glyph_metrics.bounding_rectangle;
+    // The glyph is drawn at a fixed size into the texture, with a border for
+    // proper bi-linear interpolation on the edges.
+    hilet tile = rasterize_glyph(font, glyph, drawfontSize, drawBorder, atlasGlyphMode);
 
-    hilet draw_scale = scale2{drawfontSize, drawfontSize};
-    hilet draw_bounding_box = draw_scale * glyph_bounding_box;
+    hilet lock = std::scoped_lock(gfx_system_mutex);
+    info = upload_glyph_tile(tile);
+}
 
-    // We will draw the font at a fixed size into the texture. And we need a border for the texture to
-    // allow proper bi-linear interpolation on the edges.
+hi_inline void gfx_pipeline_SDF::device_shared::prewarm_glyphs(std::span<std::pair<hi::font const *, glyph_id> const> glyphs) noexcept
+{
+    auto todo = std::vector<std::pair<hi::font const *, glyph_id>>{};
+    {
+        hilet lock = std::scoped_lock(gfx_system_mutex);
+        for (hilet& [font, glyph] : glyphs) {
+            hi_assert_not_null(font);
+            if (not font->atlas_info(glyph)) {
+                todo.emplace_back(font, glyph);
+            }
+        }
+    }
 
-    // Determine the size of the image in the atlas.
-    // This is the bounding box sized to the fixed font size and a border
-    hilet draw_offset = point2{drawBorder, drawBorder} - get<0>(draw_bounding_box);
-    hilet draw_extent = draw_bounding_box.size() + 2.0f * drawBorder;
-    hilet image_size = ceil(draw_extent);
+    // Sort and remove duplicates, so that each glyph is rasterized only once.
+    std::sort(todo.begin(), todo.end());
+    todo.erase(std::unique(todo.begin(), todo.end()), todo.end());
 
-    // Transform the path to the scale of the fixed font size and drawing the bounding box inside the image.
-    hilet draw_path = (translate2{draw_offset} * draw_scale) * glyph_path;
+    hilet tiles = rasterize_glyphs(todo, drawfontSize, drawBorder, atlasGlyphMode);
 
-    // Draw glyphs into staging buffer of the atlas and upload it to the correct position in the atlas.
     hilet lock = std::scoped_lock(gfx_system_mutex);
-    prepareStagingPixmapForDrawing();
-    info = allocate_rect(image_size, image_size / draw_bounding_box.size());
-    auto pixmap =
-        stagingTexture.pixmap.subimage(0, 0, ceil_cast<size_t>(info.size.width()), ceil_cast<size_t>(info.size.height()));
-    fill(pixmap, draw_path);
-    uploadStagingPixmapToAtlas(info);
+    for (hilet& tile : tiles) {
+        auto& info = tile.font->atlas_info(tile.glyph);
+        // The glyph may have been added while rasterizing.
+        if (not info) {
+            info = upload_glyph_tile(tile);
+        }
+    }
+    prepare_atlas_for_rendering();
 }
 
 hi_inline bool gfx_pipeline_SDF::device_shared::place_vertices(
@@ -375,6 +405,7 @@ hi_inline void gfx_pipeline_SDF::device_shared::buildShaders()
 {
     specializationConstants.sdf_r8maxDistance = sdf_r8::max_distance;
     specializationConstants.atlasImageWidth = atlasImageWidth;
+    specializationConstants.multiChannel = atlasGlyphMode == glyph_mode::msdf;
 
     fragmentShaderSpecializationMapEntries = specialization_constants::specializationConstantMapEntries();
     fragmentShaderSpecializationInfo = specializationConstants.specializationInfo(fragmentShaderSpecializationMapEntries);
@@ -407,7 +438,7 @@ hi_inline void gfx_pipeline_SDF::device_shared::addAtlasImage()
     vk::ImageCreateInfo const imageCreateInfo = {
         vk::ImageCreateFlags(),
         vk::ImageType::e2D,
-        vk::Format::eR8Snorm,
+        atlasFormat,
         vk::Extent3D(atlasImageWidth, atlasImageHeight, 1),
         1, // mipLevels
         1, // arrayLayers
@@ -467,7 +498,7 @@ hi_inline void gfx_pipeline_SDF::device_shared::buildAtlas()
     vk::ImageCreateInfo const imageCreateInfo = {
         vk::ImageCreateFlags(),
         vk::ImageType::e2D,
-        vk::Format::eR8Snorm,
+        atlasFormat,
         vk::Extent3D(stagingImageWidth, stagingImageHeight, 1),
         1, // mipLevels
         1, // arrayLayers
@@ -484,13 +515,13 @@ hi_inline void gfx_pipeline_SDF::device_shared::buildAtlas()
     allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
     hilet[image, allocation] = device.createImage(imageCreateInfo, allocationCreateInfo);
     device.setDebugUtilsObjectNameEXT(image, "sdf-pipeline staging image");
-    hilet data = device.mapMemory<sdf_r8>(allocation);
+    hilet data = device.mapMemory<atlas_pixel_type>(allocation);
 
     stagingTexture = {
         image,
         allocation,
         vk::ImageView(),
-        hi::pixmap_span<sdf_r8>{data.data(), imageCreateInfo.extent.width, imageCreateInfo.extent.height}};
+        hi::pixmap_span<atlas_pixel_type>{data.data(), imageCreateInfo.extent.width, imageCreateInfo.extent.height}};
 
     vk::SamplerCreateInfo const samplerCreateInfo = {
         vk::SamplerCreateFlags(),
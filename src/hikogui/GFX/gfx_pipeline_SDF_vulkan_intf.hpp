@@ -13,6 +13,9 @@
 #include <vulkan/vulkan.hpp>
 #include <vma/vk_mem_alloc.h>
 #include <span>
+#include <vector>
+#include <utility>
+#include <type_traits>
 
 hi_export_module(hikogui.GFX : gfx_pipeline_SDF_intf);
 
@@ -73,9 +76,22 @@ public:
         }
     };
 
+    /** The type of distance field of the glyphs in the atlas.
+     *
+     * A multi-channel signed distance field keeps the corners of glyphs sharp,
+     * which allows glyphs to be drawn at a smaller size into the atlas.
+     */
+    constexpr static glyph_mode atlasGlyphMode = glyph_mode::sdf;
+
+    using atlas_pixel_type = std::conditional_t<atlasGlyphMode == glyph_mode::msdf, sdf_rgba8, sdf_r8>;
+
+    constexpr static vk::Format atlasFormat =
+        atlasGlyphMode == glyph_mode::msdf ? vk::Format::eR8G8B8A8Snorm : vk::Format::eR8Snorm;
+
     struct specialization_constants {
         float sdf_r8maxDistance;
         float atlasImageWidth;
+        VkBool32 multiChannel;
 
         [[nodiscard]] vk::SpecializationInfo specializationInfo(std::vector<vk::SpecializationMapEntry>& entries) const noexcept
         {
@@ -87,6 +103,7 @@ public:
             return {
                 {0, offsetof(specialization_constants, sdf_r8maxDistance), sizeof(sdf_r8maxDistance)},
                 {1, offsetof(specialization_constants, atlasImageWidth), sizeof(atlasImageWidth)},
+                {2, offsetof(specialization_constants, multiChannel), sizeof(multiChannel)},
             };
         }
     };
@@ -95,7 +112,7 @@ public:
         vk::Image image;
         VmaAllocation allocation = {};
         vk::ImageView view;
-        hi::pixmap_span<sdf_r8> pixmap;
+        hi::pixmap_span<atlas_pixel_type> pixmap;
         vk::ImageLayout layout = vk::ImageLayout::eUndefined;
 
         void transitionLayout(const gfx_device& device, vk::Format format, vk::ImageLayout nextLayout);
@@ -117,7 +134,7 @@ public:
         constexpr static int stagingImageHeight = 64;
 
         constexpr static float atlasTextureCoordinateMultiplier = 1.0f / atlasImageWidth;
-        constexpr static float drawfontSize = 28.0f;
+        constexpr static float drawfontSize = atlasGlyphMode == glyph_mode::msdf ? 16.0f : 28.0f;
         constexpr static float drawBorder = sdf_r8::max_distance;
         constexpr static float scaledDrawBorder = drawBorder / drawfontSize;
 
@@ -138,9 +155,34 @@ public:
         vk::Sampler atlasSampler;
         vk::DescriptorImageInfo atlasSamplerDescriptorImageInfo;
 
-        point3 atlas_allocation_position = {};
-        /// During allocation on a row, we keep track of the tallest glyph.
-        int atlasAllocationMaxHeight = 0;
+        /** The number of frames after last use before a glyph may be evicted from the atlas.
+         */
+        constexpr static uint64_t atlasProtectedFrames = 4;
+
+        /** The number of frames between compaction of the atlas.
+         */
+        constexpr static uint64_t atlasCompactionInterval = 1024;
+
+        using glyph_allocator_type = atlas_allocator<std::pair<hi::font const *, glyph_id>>;
+
+        /** Allocates the glyphs in the atlas textures.
+         */
+        glyph_allocator_type glyph_allocator = {
+            atlasImageWidth,
+            atlasImageHeight,
+            atlasMaximumNrImages,
+            atlasProtectedFrames};
+
+        /** The current frame, used to record when a glyph was last used.
+         */
+        uint64_t frame_count = 0;
+
+        /** The number of times glyphs were evicted from the atlas.
+         *
+         * Vertices retained from an earlier frame may refer to evicted glyphs
+         * when this count has changed.
+         */
+        uint64_t atlas_eviction_count = 0;
 
         device_shared(gfx_device const& device);
         ~device_shared();
@@ -157,8 +199,23 @@ public:
 
         /** Allocate an glyph in the atlas.
          * This may allocate an atlas texture, up to atlasMaximumNrImages.
+         * When the atlas is full the least recently used glyphs are evicted.
+         */
+        [[nodiscard]] glyph_atlas_info
+        allocate_rect(hi::font const& font, glyph_id glyph, extent2 draw_extent, scale2 draw_scale) noexcept;
+
+        /** Advance to the next frame.
+         *
+         * Periodically compacts the atlas by evicting glyphs that are no longer used.
+         */
+        void next_frame() noexcept;
+
+        /** Get statistics about the use of the atlas.
          */
-        [[nodiscard]] glyph_atlas_info allocate_rect(extent2 draw_extent, scale2 draw_scale) noexcept;
+        [[nodiscard]] decltype(glyph_allocator)::statistics atlas_statistics() const noexcept
+        {
+            return glyph_allocator.get_statistics();
+        }
 
         void drawInCommandBuffer(vk::CommandBuffer const& commandBuffer);
 
@@ -193,6 +250,29 @@ public:
             glyph_id glyph,
             quad_color colors) noexcept;
 
+        /** Mark glyphs in the atlas as used in the current frame.
+         *
+         * This is used when vertices that refer to these glyphs are reused from
+         * an earlier frame, so that the glyphs are not evicted while in use.
+         *
+         * @param allocations The allocations of the glyphs in the atlas.
+         */
+        void touch_glyphs(std::span<glyph_allocator_type::id_type const> allocations) noexcept
+        {
+            for (hilet allocation : allocations) {
+                glyph_allocator.touch(allocation, frame_count);
+            }
+        }
+
+        /** Add a set of glyphs to the atlas ahead of drawing.
+         *
+         * The glyphs that are not yet in the atlas are rasterized in parallel
+         * without holding the gfx_system_mutex, then uploaded to the atlas.
+         *
+         * @param glyphs The font and glyph pairs to add to the atlas.
+         */
+        void prewarm_glyphs(std::span<std::pair<hi::font const *, glyph_id> const> glyphs) noexcept;
+
     private:
         void buildShaders();
         void teardownShaders(gfx_device const *vulkanDevice);
@@ -201,6 +281,16 @@ public:
         void teardownAtlas(gfx_device const *vulkanDevice);
         void add_glyph_to_atlas(hi::font const& font, glyph_id glyph, glyph_atlas_info& info) noexcept;
 
+        /** Remove glyphs that were evicted by the allocator from their fonts.
+         */
+        void forget_glyphs(std::vector<std::pair<hi::font const *, glyph_id>> const& evicted) noexcept;
+
+        /** Allocate space in the atlas for a rasterized glyph and upload it.
+         *
+         * The gfx_system_mutex must be held.
+         */
+        [[nodiscard]] glyph_atlas_info upload_glyph_tile(glyph_sdf_tile const& tile) noexcept;
+
         /**
          * @return The Atlas rectangle and true if a new glyph was added to the atlas.
          */
@@ -210,6 +300,7 @@ public:
             auto& info = font.atlas_info(glyph);
 
             if (info) [[likely]] {
+                glyph_allocator.touch(info.allocation_id, frame_count);
                 return {&info, false};
 
             } else {
@@ -221,6 +312,10 @@ public:
 
     vector_span<vertex> vertexBufferData;
 
+    /** The atlas allocation of each glyph in vertexBufferData.
+     */
+    std::vector<device_shared::glyph_allocator_type::id_type> glyphAllocationData;
+
     ~gfx_pipeline_SDF() = default;
     gfx_pipeline_SDF(const gfx_pipeline_SDF&) = delete;
     gfx_pipeline_SDF& operator=(const gfx_pipeline_SDF&) = delete;
@@ -229,7 +324,8 @@ public:
 
     gfx_pipeline_SDF(gfx_surface *surface) : gfx_pipeline(surface) {}
 
-    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context) override;
+    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context, std::span<vk::Rect2D const> scissors)
+        override;
 
 private:
     push_constants pushConstants;
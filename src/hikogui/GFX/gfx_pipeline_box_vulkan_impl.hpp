@@ -14,9 +14,12 @@ hi_export_module(hikogui.GFX : gfx_pipeline_box_impl);
 
 hi_export namespace hi { inline namespace v1 {
 
-hi_inline void gfx_pipeline_box::draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context)
+hi_inline void gfx_pipeline_box::draw_in_command_buffer(
+    vk::CommandBuffer commandBuffer,
+    draw_context const& context,
+    std::span<vk::Rect2D const> scissors)
 {
-    gfx_pipeline::draw_in_command_buffer(commandBuffer, context);
+    gfx_pipeline::draw_in_command_buffer(commandBuffer, context, scissors);
 
     hi_axiom_not_null(device());
     device()->flushAllocation(vertexBufferAllocation, 0, vertexBufferData.size() * sizeof(vertex));
@@ -42,7 +45,10 @@ hi_inline void gfx_pipeline_box::draw_in_command_buffer(vk::CommandBuffer comman
     hilet numberOfTriangles = numberOfRectangles * 2;
 
     device()->cmdBeginDebugUtilsLabelEXT(commandBuffer, "draw boxes");
-    commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    for (hilet& scissor : scissors) {
+        commandBuffer.setScissor(0, 1, &scissor);
+        commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    }
     device()->cmdEndDebugUtilsLabelEXT(commandBuffer);
 }
 
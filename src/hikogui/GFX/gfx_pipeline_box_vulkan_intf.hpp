@@ -151,7 +151,8 @@ public:
 
     gfx_pipeline_box(gfx_surface *surface) : gfx_pipeline(surface) {}
 
-    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context) override;
+    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context, std::span<vk::Rect2D const> scissors)
+        override;
 
 protected:
     push_constants pushConstants;
@@ -266,7 +266,8 @@ public:
 
     gfx_pipeline_image(gfx_surface *surface) : gfx_pipeline(surface) {}
 
-    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context) override;
+    void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context, std::span<vk::Rect2D const> scissors)
+        override;
 
 private:
     push_constants pushConstants;
@@ -34,9 +34,12 @@ hi_inline std::vector<vk::PipelineColorBlendAttachmentState> gfx_pipeline_overri
              vk::ColorComponentFlagBits::eA}};
 }
 
-hi_inline void gfx_pipeline_override::draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context)
+hi_inline void gfx_pipeline_override::draw_in_command_buffer(
+    vk::CommandBuffer commandBuffer,
+    draw_context const& context,
+    std::span<vk::Rect2D const> scissors)
 {
-    gfx_pipeline::draw_in_command_buffer(commandBuffer, context);
+    gfx_pipeline::draw_in_command_buffer(commandBuffer, context, scissors);
 
     hi_axiom_not_null(device());
     device()->flushAllocation(vertexBufferAllocation, 0, vertexBufferData.size() * sizeof(vertex));
@@ -62,7 +65,10 @@ hi_inline void gfx_pipeline_override::draw_in_command_buffer(vk::CommandBuffer c
     hilet numberOfTriangles = numberOfRectangles * 2;
 
     device()->cmdBeginDebugUtilsLabelEXT(commandBuffer, "draw alpha overlays");
-    commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    for (hilet& scissor : scissors) {
+        commandBuffer.setScissor(0, 1, &scissor);
+        commandBuffer.drawIndexed(narrow_cast<uint32_t>(numberOfTriangles * 3), 1, 0, 0, 0);
+    }
     device()->cmdEndDebugUtilsLabelEXT(commandBuffer);
 }
 
@@ -15,9 +15,12 @@ hi_export_module(hikogui.GFX : gfx_pipeline_tone_mapper_impl);
 
 hi_export namespace hi { inline namespace v1 {
 
-hi_inline void gfx_pipeline_tone_mapper::draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const& context)
+hi_inline void gfx_pipeline_tone_mapper::draw_in_command_buffer(
+    vk::CommandBuffer commandBuffer,
+    draw_context const& context,
+    std::span<vk::Rect2D const> scissors)
 {
-    gfx_pipeline::draw_in_command_buffer(commandBuffer, context);
+    gfx_pipeline::draw_in_command_buffer(commandBuffer, context, scissors);
 
     hi_axiom_not_null(device());
     device()->tone_mapper_pipeline->drawInCommandBuffer(commandBuffer);
@@ -26,7 +29,10 @@ hi_inline void gfx_pipeline_tone_mapper::draw_in_command_buffer(vk::CommandBuffe
     commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(push_constants), &_push_constants);
 
     device()->cmdBeginDebugUtilsLabelEXT(commandBuffer, "tone mapping");
-    commandBuffer.draw(3, 1, 0, 0);
+    for (hilet& scissor : scissors) {
+        commandBuffer.setScissor(0, 1, &scissor);
+        commandBuffer.draw(3, 1, 0, 0);
+    }
     device()->cmdEndDebugUtilsLabelEXT(commandBuffer);
 }
 
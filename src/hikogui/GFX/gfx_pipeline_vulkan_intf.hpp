@@ -8,6 +8,7 @@
 #include <vulkan/vulkan.hpp>
 #include <string>
 #include <vector>
+#include <span>
 
 hi_export_module(hikogui.GFX : gfx_pipeline_intf);
 
@@ -29,7 +30,17 @@ public:
     gfx_pipeline(gfx_pipeline &&) = delete;
     gfx_pipeline &operator=(gfx_pipeline &&) = delete;
 
-    virtual void draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const &context);
+    /** Record the draw commands of this pipeline.
+     *
+     * The pipeline, vertex buffers and push-constants are recorded once; only
+     * the scissor and the draw command are recorded for each rectangle.
+     *
+     * @param commandBuffer The command buffer to record into.
+     * @param context The draw context of the frame.
+     * @param scissors The rectangles of the redraw region.
+     */
+    virtual void
+    draw_in_command_buffer(vk::CommandBuffer commandBuffer, draw_context const &context, std::span<vk::Rect2D const> scissors);
 
     void build_for_new_device();
     void teardown_for_device_lost();
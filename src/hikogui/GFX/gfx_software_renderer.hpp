@@ -0,0 +1,653 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file GFX/gfx_software_renderer.hpp Defines the gfx_software_renderer type.
+ */
+
+#pragma once
+
+#include "gfx_pipeline_box_vulkan_intf.hpp"
+#include "gfx_pipeline_image_vulkan_intf.hpp"
+#include "gfx_pipeline_SDF_vulkan_intf.hpp"
+#include "gfx_pipeline_override_vulkan_intf.hpp"
+#include "../container/container.hpp"
+#include "../image/image.hpp"
+#include "../SIMD/SIMD.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <array>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+#include <memory>
+
+hi_export_module(hikogui.GFX : gfx_software_renderer);
+
+hi_export namespace hi { inline namespace v1 {
+namespace detail {
+
+/** A rectangular region of pixels of the frame buffer.
+ */
+struct software_tile {
+    size_t left;
+    size_t top;
+    size_t right;
+    size_t bottom;
+};
+
+/** Convert a pixel of an atlas to red, green, blue and alpha values.
+ */
+template<typename T>
+[[nodiscard]] hi_force_inline f32x4 software_texel(T const& pixel) noexcept
+{
+    if constexpr (std::is_same_v<T, sfloat_rgba16>) {
+        return f32x4{static_cast<f16x4>(pixel)};
+    } else if constexpr (std::is_same_v<T, sdf_rgba8>) {
+        return static_cast<f32x4>(pixel);
+    } else if constexpr (std::is_same_v<T, sdf_r8>) {
+        return f32x4::broadcast(static_cast<float>(pixel));
+    } else {
+        hi_static_no_default();
+    }
+}
+
+/** Bi-linearly sample an image, clamped to the edge.
+ *
+ * @param image The image to sample.
+ * @param x The horizontal coordinate in pixels, the center of the left column is at 0.5.
+ * @param y The vertical coordinate in pixels, the center of the top row is at 0.5.
+ */
+template<typename T>
+[[nodiscard]] hi_inline f32x4 software_sample(pixmap_span<T const> image, float x, float y) noexcept
+{
+    hi_axiom(not image.empty());
+
+    hilet max_x = static_cast<float>(image.width() - 1);
+    hilet max_y = static_cast<float>(image.height() - 1);
+    x = std::clamp(x - 0.5f, 0.0f, max_x);
+    y = std::clamp(y - 0.5f, 0.0f, max_y);
+
+    hilet x0 = static_cast<size_t>(x);
+    hilet y0 = static_cast<size_t>(y);
+    hilet x1 = std::min(x0 + 1, image.width() - 1);
+    hilet y1 = std::min(y0 + 1, image.height() - 1);
+    hilet fx = x - static_cast<float>(x0);
+    hilet fy = y - static_cast<float>(y0);
+
+    hilet top = software_texel(image[y0][x0]) * (1.0f - fx) + software_texel(image[y0][x1]) * fx;
+    hilet bottom = software_texel(image[y1][x0]) * (1.0f - fx) + software_texel(image[y1][x1]) * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
+
+/** Convert coverage to a perceptional uniform alpha.
+ *
+ * @see coverage_to_alpha() in utils_vulkan.glsl
+ */
+[[nodiscard]] hi_force_inline f32x4 software_coverage_to_alpha(f32x4 coverage, f32x4 sqrt_foreground) noexcept
+{
+    hilet coverage_sq = coverage * coverage;
+    hilet coverage_2 = coverage + coverage;
+    hilet dark = coverage_2 - coverage_sq;
+    return dark + (coverage_sq - dark) * sqrt_foreground;
+}
+
+/** Multiply the color with the alpha.
+ */
+[[nodiscard]] hi_force_inline f32x4 software_multiply_alpha(f32x4 color) noexcept
+{
+    return f32x4{color.x() * color.w(), color.y() * color.w(), color.z() * color.w(), color.w()};
+}
+
+/** Convert linear RGB to luminance.
+ */
+[[nodiscard]] hi_force_inline float software_rgb_to_y(f32x4 color) noexcept
+{
+    return color.x() * 0.2126f + color.y() * 0.7152f + color.z() * 0.0722f;
+}
+
+/** Rasterize a quad of four vertices as the two triangles (0, 1, 2) and (2, 1, 3).
+ *
+ * The varyings are linearly interpolated over each triangle and passed to
+ * the fragment function together with their horizontal derivative. The
+ * fragment function returns false to discard the fragment, otherwise the
+ * depth of the fragment is written to the depth buffer.
+ *
+ * @param tile The region of the frame buffer to rasterize.
+ * @param depth_buffer The depth buffer, with reverse-z.
+ * @param positions The window position of each vertex, y-axis up.
+ * @param clipping_rectangle The clipping rectangle in window coordinates, y-axis up.
+ * @param varyings The attributes of each vertex.
+ * @param fragment A function `bool(size_t x, size_t y, std::array<f32x4, N> const& varying, std::array<f32x4, N> const& ddx)`.
+ */
+template<size_t N, typename Fragment>
+hi_inline void rasterize_software_quad(
+    software_tile const& tile,
+    pixmap_span<float> depth_buffer,
+    std::array<f32x4, 4> const& positions,
+    f32x4 clipping_rectangle,
+    std::array<std::array<f32x4, N>, 4> const& varyings,
+    Fragment&& fragment) noexcept
+{
+    hilet height = static_cast<float>(depth_buffer.height());
+
+    // The clipping rectangle in frame buffer coordinates, y-axis down.
+    hilet clip_left = std::max(clipping_rectangle.x(), static_cast<float>(tile.left));
+    hilet clip_right = std::min(clipping_rectangle.z(), static_cast<float>(tile.right));
+    hilet clip_top = std::max(height - clipping_rectangle.w(), static_cast<float>(tile.top));
+    hilet clip_bottom = std::min(height - clipping_rectangle.y(), static_cast<float>(tile.bottom));
+    if (clip_left >= clip_right or clip_top >= clip_bottom) {
+        return;
+    }
+
+    constexpr auto triangles = std::array{std::array{0_uz, 1_uz, 2_uz}, std::array{3_uz, 2_uz, 1_uz}};
+    for (auto triangle_nr = 0_uz; triangle_nr != 2; ++triangle_nr) {
+        hilet[i0, i1, i2] = triangles[triangle_nr];
+
+        // Positions in frame buffer coordinates; z is the reverse-z depth.
+        hilet to_frame_buffer = [&](f32x4 p) {
+            return f32x4{p.x(), height - p.y(), 1.0f - p.z() * 0.01f, 0.0f};
+        };
+        hilet p0 = to_frame_buffer(positions[i0]);
+        hilet p1 = to_frame_buffer(positions[i1]);
+        hilet p2 = to_frame_buffer(positions[i2]);
+
+        hilet e1 = p1 - p0;
+        hilet e2 = p2 - p0;
+        hilet det = e1.x() * e2.y() - e1.y() * e2.x();
+        if (std::abs(det) < 1e-6f) {
+            continue;
+        }
+        hilet rcp_det = 1.0f / det;
+
+        // The derivatives of the barycentric coordinates (u, v) in x and y.
+        hilet du_dx = e2.y() * rcp_det;
+        hilet du_dy = -e2.x() * rcp_det;
+        hilet dv_dx = -e1.y() * rcp_det;
+        hilet dv_dy = e1.x() * rcp_det;
+
+        auto ddx = std::array<f32x4, N>{};
+        auto dvu = std::array<f32x4, N>{};
+        auto dvv = std::array<f32x4, N>{};
+        for (auto i = 0_uz; i != N; ++i) {
+            dvu[i] = varyings[i1][i] - varyings[i0][i];
+            dvv[i] = varyings[i2][i] - varyings[i0][i];
+            ddx[i] = dvu[i] * du_dx + dvv[i] * dv_dx;
+        }
+
+        // The bounding box of the triangle, clipped.
+        hilet min_x = std::max(std::min({p0.x(), p1.x(), p2.x()}), clip_left);
+        hilet max_x = std::min(std::max({p0.x(), p1.x(), p2.x()}), clip_right);
+        hilet min_y = std::max(std::min({p0.y(), p1.y(), p2.y()}), clip_top);
+        hilet max_y = std::min(std::max({p0.y(), p1.y(), p2.y()}), clip_bottom);
+        if (min_x >= max_x or min_y >= max_y) {
+            continue;
+        }
+
+        // Only pixels whose center is inside the clipping rectangle.
+        hilet first_x = static_cast<size_t>(std::max(std::ceil(min_x - 0.5f), clip_left));
+        hilet last_x = static_cast<size_t>(std::ceil(max_x - 0.5f));
+        hilet first_y = static_cast<size_t>(std::max(std::ceil(min_y - 0.5f), clip_top));
+        hilet last_y = static_cast<size_t>(std::ceil(max_y - 0.5f));
+
+        auto varying = std::array<f32x4, N>{};
+        for (auto y = first_y; y < last_y; ++y) {
+            hilet depth_row = depth_buffer[y];
+            hilet dy = static_cast<float>(y) + 0.5f - p0.y();
+
+            for (auto x = first_x; x < last_x; ++x) {
+                hilet dx = static_cast<float>(x) + 0.5f - p0.x();
+                hilet u = dx * du_dx + dy * du_dy;
+                hilet v = dx * dv_dx + dy * dv_dy;
+
+                // The shared edge between the two triangles belongs to the second triangle.
+                if (u < 0.0f or v < 0.0f or (triangle_nr == 0 ? u + v >= 1.0f : u + v > 1.0f)) {
+                    continue;
+                }
+
+                hilet depth = p0.z() + e1.z() * u + e2.z() * v;
+                auto& depth_pixel = depth_row[x];
+                if (not(depth >= depth_pixel)) {
+                    continue;
+                }
+
+                for (auto i = 0_uz; i != N; ++i) {
+                    varying[i] = varyings[i0][i] + dvu[i] * u + dvv[i] * v;
+                }
+
+                if (fragment(x, y, varying, ddx)) {
+                    depth_pixel = depth;
+                }
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/** A renderer which draws the vertices of a draw_context on the CPU.
+ *
+ * The vertices of the box, image, SDF and override pipelines are rasterized
+ * in the same order and with the same shading as the Vulkan pipelines. This
+ * allows for rendering without a GPU; for tests with golden images,
+ * benchmarks of frame-times, or as a fallback when no Vulkan driver exists.
+ *
+ * The frame buffer is divided in tiles which are rendered in parallel. The
+ * quads are sorted into the tiles they overlap before rendering.
+ *
+ * The image is in linear-sRGB with pre-multiplied alpha, the same as the
+ * color attachment before tone-mapping. Sub-pixel anti-aliasing of glyphs is
+ * not implemented.
+ */
+hi_export class gfx_software_renderer {
+public:
+    using box_vertex = gfx_pipeline_box::vertex;
+    using image_vertex = gfx_pipeline_image::vertex;
+    using sdf_vertex = gfx_pipeline_SDF::vertex;
+    using override_vertex = gfx_pipeline_override::vertex;
+    using sdf_pixel_type = gfx_pipeline_SDF::atlas_pixel_type;
+
+    /** The width and height of a tile in pixels.
+     */
+    constexpr static size_t tile_size = 64;
+
+    ~gfx_software_renderer() = default;
+    gfx_software_renderer(gfx_software_renderer const&) = delete;
+    gfx_software_renderer(gfx_software_renderer&&) noexcept = default;
+    gfx_software_renderer& operator=(gfx_software_renderer const&) = delete;
+    gfx_software_renderer& operator=(gfx_software_renderer&&) noexcept = default;
+
+    /** Create a software renderer.
+     *
+     * @param num_threads The maximum number of threads used for rendering.
+     */
+    gfx_software_renderer(size_t num_threads = std::thread::hardware_concurrency()) noexcept :
+        _num_threads(std::max(num_threads, 1_uz))
+    {
+    }
+
+    /** Set the pages of the image atlas.
+     *
+     * The z-coordinate of the atlas position in an image vertex is the index in this list.
+     */
+    void set_image_atlas(std::vector<pixmap_span<sfloat_rgba16 const>> pages) noexcept
+    {
+        _image_atlas = std::move(pages);
+    }
+
+    /** Set the pages of the glyph atlas.
+     *
+     * The z-coordinate of the texture coordinate in an SDF vertex is the index in this list.
+     */
+    void set_sdf_atlas(std::vector<pixmap_span<sdf_pixel_type const>> pages) noexcept
+    {
+        _sdf_atlas = std::move(pages);
+    }
+
+    /** Render the vertices into an image.
+     *
+     * @param image The image to render into.
+     * @param box_vertices The vertices of the box pipeline.
+     * @param image_vertices The vertices of the image pipeline.
+     * @param sdf_vertices The vertices of the SDF pipeline.
+     * @param override_vertices The vertices of the override pipeline.
+     * @param clear_color The color to clear the image with before rendering.
+     */
+    void render(
+        pixmap_span<sfloat_rgba16> image,
+        vector_span<box_vertex> const& box_vertices,
+        vector_span<image_vertex> const& image_vertices,
+        vector_span<sdf_vertex> const& sdf_vertices,
+        vector_span<override_vertex> const& override_vertices,
+        f32x4 clear_color = f32x4{}) noexcept
+    {
+        if (_depth_buffer.width() != image.width() or _depth_buffer.height() != image.height()) {
+            _depth_buffer = pixmap<float>{image.width(), image.height()};
+        }
+
+        _num_columns = (image.width() + tile_size - 1) / tile_size;
+        hilet num_rows = (image.height() + tile_size - 1) / tile_size;
+        hilet num_tiles = _num_columns * num_rows;
+
+        bin(_box_bins, num_tiles, image.height(), box_vertices);
+        bin(_image_bins, num_tiles, image.height(), image_vertices);
+        bin(_sdf_bins, num_tiles, image.height(), sdf_vertices);
+        bin(_override_bins, num_tiles, image.height(), override_vertices);
+
+        auto next_tile = std::atomic<size_t>{0};
+        hilet worker = [&] {
+            for (auto i = next_tile.fetch_add(1, std::memory_order::relaxed); i < num_tiles;
+                 i = next_tile.fetch_add(1, std::memory_order::relaxed)) {
+                hilet left = (i % _num_columns) * tile_size;
+                hilet top = (i / _num_columns) * tile_size;
+                hilet tile = detail::software_tile{
+                    left, top, std::min(left + tile_size, image.width()), std::min(top + tile_size, image.height())};
+
+                render_tile(image, tile, i, clear_color, box_vertices, image_vertices, sdf_vertices, override_vertices);
+            }
+        };
+
+        // The calling thread takes part in rendering the tiles.
+        hilet num_workers = std::min(_num_threads, num_tiles);
+        {
+            auto threads = std::vector<std::jthread>{};
+            for (auto i = 1_uz; i < num_workers; ++i) {
+                threads.emplace_back(worker);
+            }
+            worker();
+        }
+    }
+
+private:
+    size_t _num_threads;
+    size_t _num_columns = 0;
+    pixmap<float> _depth_buffer;
+    std::vector<pixmap_span<sfloat_rgba16 const>> _image_atlas;
+    std::vector<pixmap_span<sdf_pixel_type const>> _sdf_atlas;
+
+    /** For each tile the index of the quads that overlap the tile, in drawing order.
+     */
+    std::vector<std::vector<uint32_t>> _box_bins;
+    std::vector<std::vector<uint32_t>> _image_bins;
+    std::vector<std::vector<uint32_t>> _sdf_bins;
+    std::vector<std::vector<uint32_t>> _override_bins;
+
+    /** Sort the quads into the tiles that they overlap.
+     */
+    template<typename Vertex>
+    void bin(std::vector<std::vector<uint32_t>>& bins, size_t num_tiles, size_t height, vector_span<Vertex> const& vertices)
+        const noexcept
+    {
+        bins.resize(num_tiles);
+        for (auto& tile_bin : bins) {
+            tile_bin.clear();
+        }
+
+        hilet num_rows = num_tiles / _num_columns;
+        hilet height_ = static_cast<float>(height);
+        for (auto quad_nr = 0_uz; quad_nr != vertices.size() / 4; ++quad_nr) {
+            auto min_p = f32x4::broadcast(std::numeric_limits<float>::max());
+            auto max_p = f32x4::broadcast(-std::numeric_limits<float>::max());
+            for (auto i = 0_uz; i != 4; ++i) {
+                hilet p = static_cast<f32x4>(vertices[quad_nr * 4 + i].position);
+                min_p = min(min_p, p);
+                max_p = max(max_p, p);
+            }
+            hilet clip = static_cast<f32x4>(vertices[quad_nr * 4].clipping_rectangle);
+
+            // Convert to frame buffer coordinates, y-axis down.
+            hilet left = std::max(min_p.x(), clip.x());
+            hilet right = std::min(max_p.x(), clip.z());
+            hilet top = height_ - std::min(max_p.y(), clip.w());
+            hilet bottom = height_ - std::max(min_p.y(), clip.y());
+            if (left >= right or top >= bottom or right <= 0.0f or bottom <= 0.0f) {
+                continue;
+            }
+
+            hilet first_column = static_cast<size_t>(std::max(left, 0.0f)) / tile_size;
+            hilet first_row = static_cast<size_t>(std::max(top, 0.0f)) / tile_size;
+            hilet last_column = std::min(static_cast<size_t>(right) / tile_size, _num_columns - 1);
+            hilet last_row = std::min(static_cast<size_t>(bottom) / tile_size, num_rows - 1);
+            for (auto row = first_row; row <= last_row; ++row) {
+                for (auto column = first_column; column <= last_column; ++column) {
+                    bins[row * _num_columns + column].push_back(narrow_cast<uint32_t>(quad_nr));
+                }
+            }
+        }
+    }
+
+    void render_tile(
+        pixmap_span<sfloat_rgba16> image,
+        detail::software_tile const& tile,
+        size_t tile_nr,
+        f32x4 clear_color,
+        vector_span<box_vertex> const& box_vertices,
+        vector_span<image_vertex> const& image_vertices,
+        vector_span<sdf_vertex> const& sdf_vertices,
+        vector_span<override_vertex> const& override_vertices) noexcept
+    {
+        // The depth buffer is used with reverse-z, it is cleared to the far plane.
+        auto depth_buffer = pixmap_span<float>{_depth_buffer};
+        for (auto y = tile.top; y != tile.bottom; ++y) {
+            hilet color_row = image[y];
+            hilet depth_row = depth_buffer[y];
+            for (auto x = tile.left; x != tile.right; ++x) {
+                color_row[x] = clear_color;
+                depth_row[x] = 0.0f;
+            }
+        }
+
+        for (hilet quad_nr : _box_bins[tile_nr]) {
+            render_box(image, depth_buffer, tile, std::addressof(box_vertices[quad_nr * 4]));
+        }
+        for (hilet quad_nr : _image_bins[tile_nr]) {
+            render_image(image, depth_buffer, tile, std::addressof(image_vertices[quad_nr * 4]));
+        }
+        for (hilet quad_nr : _sdf_bins[tile_nr]) {
+            render_sdf(image, depth_buffer, tile, std::addressof(sdf_vertices[quad_nr * 4]));
+        }
+        for (hilet quad_nr : _override_bins[tile_nr]) {
+            render_override(image, depth_buffer, tile, std::addressof(override_vertices[quad_nr * 4]));
+        }
+    }
+
+    template<typename Vertex>
+    [[nodiscard]] static std::array<f32x4, 4> get_positions(Vertex const *vertices) noexcept
+    {
+        return {
+            static_cast<f32x4>(vertices[0].position),
+            static_cast<f32x4>(vertices[1].position),
+            static_cast<f32x4>(vertices[2].position),
+            static_cast<f32x4>(vertices[3].position)};
+    }
+
+    /** Render a quad of the box pipeline.
+     *
+     * @see box_vulkan.vert and box_vulkan.frag
+     */
+    static void render_box(
+        pixmap_span<sfloat_rgba16> image,
+        pixmap_span<float> depth_buffer,
+        detail::software_tile const& tile,
+        box_vertex const *vertices) noexcept
+    {
+        hilet line_width = vertices[0].line_width;
+        hilet border_start = 1.0f;
+        hilet border_middle = border_start + line_width * 0.5f;
+        hilet border_end = border_start + line_width;
+        hilet corner_radii = static_cast<f32x4>(vertices[0].corner_radii) + border_middle;
+
+        // The varyings are: edge distances, fill color, border color and the sqrt of the border luminance.
+        auto varyings = std::array<std::array<f32x4, 4>, 4>{};
+        for (auto i = 0_uz; i != 4; ++i) {
+            hilet border_color = detail::software_multiply_alpha(f32x4{static_cast<f16x4>(vertices[i].line_color)});
+            varyings[i][0] = static_cast<f32x4>(vertices[i].corner_coordinate);
+            varyings[i][1] = detail::software_multiply_alpha(f32x4{static_cast<f16x4>(vertices[i].fill_color)});
+            varyings[i][2] = border_color;
+            varyings[i][3] = f32x4::broadcast(std::sqrt(std::clamp(detail::software_rgb_to_y(border_color), 0.0f, 1.0f)));
+        }
+
+        detail::rasterize_software_quad<4>(
+            tile,
+            depth_buffer,
+            get_positions(vertices),
+            static_cast<f32x4>(vertices[0].clipping_rectangle),
+            varyings,
+            [&](size_t x, size_t y, std::array<f32x4, 4> const& varying, std::array<f32x4, 4> const&) {
+                hilet& edge_distances = varying[0];
+
+                auto distance = 0.0f;
+                if (edge_distances.x() < corner_radii.x() and edge_distances.y() < corner_radii.x()) {
+                    distance = corner_radii.x() - std::hypot(corner_radii.x() - edge_distances.x(), corner_radii.x() - edge_distances.y());
+                } else if (edge_distances.z() < corner_radii.y() and edge_distances.y() < corner_radii.y()) {
+                    distance = corner_radii.y() - std::hypot(corner_radii.y() - edge_distances.z(), corner_radii.y() - edge_distances.y());
+                } else if (edge_distances.x() < corner_radii.z() and edge_distances.w() < corner_radii.z()) {
+                    distance = corner_radii.z() - std::hypot(corner_radii.z() - edge_distances.x(), corner_radii.z() - edge_distances.w());
+                } else if (edge_distances.z() < corner_radii.w() and edge_distances.w() < corner_radii.w()) {
+                    distance = corner_radii.w() - std::hypot(corner_radii.w() - edge_distances.z(), corner_radii.w() - edge_distances.w());
+                } else {
+                    distance = std::min({edge_distances.x(), edge_distances.y(), edge_distances.z(), edge_distances.w()});
+                }
+
+                hilet border_coverage = std::clamp(distance - border_start + 0.5f, 0.0f, 1.0f);
+                if (border_coverage == 0.0f) {
+                    return false;
+                }
+                hilet fill_coverage = std::clamp(border_end - distance + 0.5f, 0.0f, 1.0f);
+
+                hilet sqrt_y = varying[3];
+                hilet border_alpha = detail::software_coverage_to_alpha(f32x4::broadcast(border_coverage), sqrt_y);
+                hilet fill_alpha = detail::software_coverage_to_alpha(f32x4::broadcast(fill_coverage), sqrt_y);
+
+                hilet border_color = varying[2] * fill_alpha;
+                hilet combined_color = varying[1] * (1.0f - border_color.w()) + border_color;
+                hilet color = combined_color * border_alpha;
+
+                auto& pixel = image[y][x];
+                pixel = color + f32x4{static_cast<f16x4>(pixel)} * (1.0f - color.w());
+                return true;
+            });
+    }
+
+    /** Render a quad of the image pipeline.
+     *
+     * @see image_vulkan.vert and image_vulkan.frag
+     */
+    void render_image(
+        pixmap_span<sfloat_rgba16> image,
+        pixmap_span<float> depth_buffer,
+        detail::software_tile const& tile,
+        image_vertex const *vertices) const noexcept
+    {
+        hilet page_nr = static_cast<size_t>(static_cast<f32x4>(vertices[0].atlas_position).z());
+        if (page_nr >= _image_atlas.size()) {
+            return;
+        }
+        hilet& page = _image_atlas[page_nr];
+
+        auto varyings = std::array<std::array<f32x4, 1>, 4>{};
+        for (auto i = 0_uz; i != 4; ++i) {
+            varyings[i][0] = static_cast<f32x4>(vertices[i].atlas_position);
+        }
+
+        detail::rasterize_software_quad<1>(
+            tile,
+            depth_buffer,
+            get_positions(vertices),
+            static_cast<f32x4>(vertices[0].clipping_rectangle),
+            varyings,
+            [&](size_t x, size_t y, std::array<f32x4, 1> const& varying, std::array<f32x4, 1> const&) {
+                // The atlas is in pre-multiplied alpha.
+                hilet color = detail::software_sample(page, varying[0].x(), varying[0].y());
+
+                auto& pixel = image[y][x];
+                pixel = color + f32x4{static_cast<f16x4>(pixel)} * (1.0f - color.w());
+                return true;
+            });
+    }
+
+    /** Render a quad of the SDF pipeline.
+     *
+     * @see SDF_vulkan.vert and SDF_vulkan.frag
+     */
+    void render_sdf(
+        pixmap_span<sfloat_rgba16> image,
+        pixmap_span<float> depth_buffer,
+        detail::software_tile const& tile,
+        sdf_vertex const *vertices) const noexcept
+    {
+        hilet page_nr = static_cast<size_t>(static_cast<f32x4>(vertices[0].textureCoord).z());
+        if (page_nr >= _sdf_atlas.size()) {
+            return;
+        }
+        hilet& page = _sdf_atlas[page_nr];
+        hilet page_width = static_cast<float>(page.width());
+        hilet page_height = static_cast<float>(page.height());
+
+        // The varyings are: texture coordinate, color and the sqrt of the color and luminance.
+        auto varyings = std::array<std::array<f32x4, 3>, 4>{};
+        for (auto i = 0_uz; i != 4; ++i) {
+            hilet color = detail::software_multiply_alpha(f32x4{static_cast<f16x4>(vertices[i].color)});
+            hilet rgby = f32x4{color.x(), color.y(), color.z(), detail::software_rgb_to_y(color)};
+
+            varyings[i][0] = static_cast<f32x4>(vertices[i].textureCoord);
+            varyings[i][1] = color;
+            varyings[i][2] = sqrt(clamp(rgby, f32x4{}, f32x4::broadcast(1.0f)));
+        }
+
+        detail::rasterize_software_quad<3>(
+            tile,
+            depth_buffer,
+            get_positions(vertices),
+            static_cast<f32x4>(vertices[0].clippingRectangle),
+            varyings,
+            [&](size_t x, size_t y, std::array<f32x4, 3> const& varying, std::array<f32x4, 3> const& ddx) {
+                hilet texture_coord = varying[0];
+                hilet distances = detail::software_sample(page, texture_coord.x() * page_width, texture_coord.y() * page_height);
+
+                auto distance = distances.x();
+                if constexpr (std::is_same_v<sdf_pixel_type, sdf_rgba8>) {
+                    distance =
+                        std::max(std::min(distances.x(), distances.y()), std::min(std::max(distances.x(), distances.y()), distances.z()));
+                }
+
+                // Convert the distance in pixels of the atlas to pixels of the frame buffer.
+                hilet texture_stride = std::hypot(ddx[0].x() * page_width, ddx[0].y() * page_height);
+                distance /= texture_stride;
+
+                hilet coverage = std::clamp(distance + 0.5f, 0.0f, 1.0f);
+                if (coverage == 0.0f) {
+                    return false;
+                }
+
+                hilet color = varying[1];
+                hilet alpha = detail::software_coverage_to_alpha(f32x4::broadcast(coverage), varying[2]);
+                hilet out_color = color * alpha;
+                hilet blend_factor = alpha * color.w();
+
+                // Dual-source blending, the same as when the GPU supports this feature.
+                auto& pixel = image[y][x];
+                pixel = out_color + f32x4{static_cast<f16x4>(pixel)} * (f32x4::broadcast(1.0f) - blend_factor);
+                return true;
+            });
+    }
+
+    /** Render a quad of the override pipeline.
+     *
+     * @see override_vulkan.vert and override_vulkan.frag
+     */
+    static void render_override(
+        pixmap_span<sfloat_rgba16> image,
+        pixmap_span<float> depth_buffer,
+        detail::software_tile const& tile,
+        override_vertex const *vertices) noexcept
+    {
+        auto varyings = std::array<std::array<f32x4, 2>, 4>{};
+        for (auto i = 0_uz; i != 4; ++i) {
+            varyings[i][0] = f32x4{static_cast<f16x4>(vertices[i].color)};
+            varyings[i][1] = f32x4{static_cast<f16x4>(vertices[i].blend_factor)};
+        }
+
+        detail::rasterize_software_quad<2>(
+            tile,
+            depth_buffer,
+            get_positions(vertices),
+            static_cast<f32x4>(vertices[0].clipping_rectangle),
+            varyings,
+            [&](size_t x, size_t y, std::array<f32x4, 2> const& varying, std::array<f32x4, 2> const&) {
+                hilet blend_factor = varying[1];
+
+                auto& pixel = image[y][x];
+                pixel = varying[0] * blend_factor + f32x4{static_cast<f16x4>(pixel)} * (f32x4::broadcast(1.0f) - blend_factor);
+                return true;
+            });
+    }
+};
+
+}} // namespace hi::v1
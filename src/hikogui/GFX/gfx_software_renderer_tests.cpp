@@ -0,0 +1,151 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "gfx_software_renderer.hpp"
+#include "gfx_pipeline_box_vulkan_impl.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <span>
+
+using namespace hi;
+
+namespace {
+
+using box_vertex = gfx_software_renderer::box_vertex;
+
+/** Vertices of the box pipeline, with the storage to hold them.
+ */
+struct box_vertices {
+    std::vector<box_vertex> buffer = std::vector<box_vertex>(64);
+    vector_span<box_vertex> vertices = std::span{buffer};
+
+    /** Add a white box without a border.
+     */
+    void add(aarectangle box, aarectangle clipping_rectangle, hi::corner_radii corner_radii = hi::corner_radii{0.0f})
+    {
+        gfx_pipeline_box::device_shared::place_vertices(
+            vertices, clipping_rectangle, box, color{1.0f, 1.0f, 1.0f, 1.0f}, color{0.0f, 0.0f, 0.0f, 0.0f}, 0.0f, corner_radii);
+    }
+};
+
+/** Render the boxes in an image.
+ */
+[[nodiscard]] pixmap<sfloat_rgba16> render(box_vertices const& boxes, size_t width, size_t height, size_t num_threads = 1)
+{
+    auto image = pixmap<sfloat_rgba16>{width, height};
+    auto renderer = gfx_software_renderer{num_threads};
+    renderer.render(image, boxes.vertices, {}, {}, {});
+    return image;
+}
+
+/** Get the alpha of a pixel.
+ *
+ * @param x The column, from left to right.
+ * @param y The row, from bottom to top; the same direction as the y-axis of the window.
+ */
+[[nodiscard]] float alpha(pixmap<sfloat_rgba16> const& image, size_t x, size_t y)
+{
+    return f32x4{static_cast<f16x4>(image[image.height() - y - 1][x])}.w();
+}
+
+} // namespace
+
+TEST(gfx_software_renderer, box_coverage)
+{
+    auto boxes = box_vertices{};
+    boxes.add(aarectangle{5.0f, 5.0f, 10.0f, 10.0f}, aarectangle{0.0f, 0.0f, 20.0f, 20.0f});
+    hilet image = render(boxes, 20, 20);
+
+    // A box on pixel boundaries covers whole pixels.
+    for (auto y = 0_uz; y != 20; ++y) {
+        for (auto x = 0_uz; x != 20; ++x) {
+            hilet inside = x >= 5 and x < 15 and y >= 5 and y < 15;
+            ASSERT_NEAR(alpha(image, x, y), inside ? 1.0f : 0.0f, 0.001f) << "x=" << x << " y=" << y;
+        }
+    }
+
+    // The color is white with pre-multiplied alpha.
+    ASSERT_EQ(f32x4{static_cast<f16x4>(image[10][10])}, (f32x4{1.0f, 1.0f, 1.0f, 1.0f}));
+}
+
+TEST(gfx_software_renderer, box_partial_coverage)
+{
+    auto boxes = box_vertices{};
+    boxes.add(aarectangle{5.5f, 5.0f, 9.0f, 10.0f}, aarectangle{0.0f, 0.0f, 20.0f, 20.0f});
+    hilet image = render(boxes, 20, 20);
+
+    // The pixels on the left and right edge are half covered; the alpha is
+    // corrected for the dark border: 2c - c^2 with a coverage of 0.5.
+    ASSERT_NEAR(alpha(image, 5, 10), 0.75f, 0.01f);
+    ASSERT_NEAR(alpha(image, 14, 10), 0.75f, 0.01f);
+    ASSERT_NEAR(alpha(image, 6, 10), 1.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 4, 10), 0.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 15, 10), 0.0f, 0.001f);
+}
+
+TEST(gfx_software_renderer, clipping)
+{
+    // The box and the clipping rectangle cross the boundaries between the 64 x 64 pixel tiles.
+    auto boxes = box_vertices{};
+    boxes.add(aarectangle{0.0f, 0.0f, 100.0f, 100.0f}, aarectangle{60.0f, 50.0f, 10.0f, 20.0f});
+    hilet image = render(boxes, 100, 100);
+
+    for (auto y = 0_uz; y != 100; ++y) {
+        for (auto x = 0_uz; x != 100; ++x) {
+            hilet inside = x >= 60 and x < 70 and y >= 50 and y < 70;
+            ASSERT_NEAR(alpha(image, x, y), inside ? 1.0f : 0.0f, 0.001f) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST(gfx_software_renderer, corner_radii)
+{
+    // Only the left-bottom corner is rounded.
+    auto boxes = box_vertices{};
+    boxes.add(aarectangle{0.0f, 0.0f, 20.0f, 20.0f}, aarectangle{0.0f, 0.0f, 20.0f, 20.0f}, hi::corner_radii{8.0f, 0.0f, 0.0f, 0.0f});
+    hilet image = render(boxes, 20, 20);
+
+    // Outside of the rounded corner.
+    ASSERT_NEAR(alpha(image, 0, 0), 0.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 1, 0), 0.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 0, 1), 0.0f, 0.001f);
+
+    // On the edge of the rounded corner.
+    ASSERT_GT(alpha(image, 2, 2), 0.0f);
+    ASSERT_LT(alpha(image, 2, 2), 1.0f);
+
+    // Inside the rounded corner, and along the straight edges.
+    ASSERT_NEAR(alpha(image, 4, 4), 1.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 8, 0), 1.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 0, 8), 1.0f, 0.001f);
+
+    // The other corners are square.
+    ASSERT_NEAR(alpha(image, 19, 0), 1.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 0, 19), 1.0f, 0.001f);
+    ASSERT_NEAR(alpha(image, 19, 19), 1.0f, 0.001f);
+
+    // The rounded corner is symmetric.
+    for (auto i = 0_uz; i != 8; ++i) {
+        for (auto j = 0_uz; j != 8; ++j) {
+            ASSERT_NEAR(alpha(image, i, j), alpha(image, j, i), 0.001f);
+        }
+    }
+}
+
+TEST(gfx_software_renderer, threads)
+{
+    auto boxes = box_vertices{};
+    boxes.add(aarectangle{10.5f, 20.25f, 150.0f, 90.0f}, aarectangle{0.0f, 0.0f, 200.0f, 150.0f}, hi::corner_radii{12.0f});
+    boxes.add(aarectangle{60.0f, 5.0f, 130.0f, 60.0f}, aarectangle{50.0f, 0.0f, 100.0f, 150.0f}, hi::corner_radii{4.0f});
+
+    // The tiles are rendered in parallel, the result is the same as when rendered by a single thread.
+    hilet expected = render(boxes, 200, 150, 1);
+    hilet image = render(boxes, 200, 150, 4);
+    for (auto y = 0_uz; y != 150; ++y) {
+        for (auto x = 0_uz; x != 200; ++x) {
+            ASSERT_EQ(f32x4{static_cast<f16x4>(image[y][x])}, f32x4{static_cast<f16x4>(expected[y][x])});
+        }
+    }
+}
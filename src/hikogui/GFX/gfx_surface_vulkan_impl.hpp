@@ -388,10 +388,10 @@ hi_inline void gfx_surface::update(extent2 new_size) noexcept
     build(new_size);
 }
 
-hi_inline draw_context gfx_surface::render_start(aarectangle redraw_rectangle)
+hi_inline draw_context gfx_surface::render_start(damage_region redraw_region)
 {
-    // Extent the redraw_rectangle to the render-area-granularity to improve performance on tile based GPUs.
-    redraw_rectangle = ceil(redraw_rectangle, _render_area_granularity);
+    // Extent the redraw_region to the render-area-granularity to improve performance on tile based GPUs.
+    redraw_region = ceil(redraw_region, _render_area_granularity);
 
     hilet lock = std::scoped_lock(gfx_system_mutex);
 
@@ -400,10 +400,11 @@ hi_inline draw_context gfx_surface::render_start(aarectangle redraw_rectangle)
         box_pipeline->vertexBufferData,
         image_pipeline->vertexBufferData,
         SDF_pipeline->vertexBufferData,
+        SDF_pipeline->glyphAllocationData,
         override_pipeline->vertexBufferData};
 
     // Bail out when the window is not yet ready to be rendered, or if there is nothing to render.
-    if (state != gfx_surface_state::has_swapchain or not redraw_rectangle) {
+    if (state != gfx_surface_state::has_swapchain or not redraw_region) {
         return r;
     }
 
@@ -419,14 +420,13 @@ hi_inline draw_context gfx_surface::render_start(aarectangle redraw_rectangle)
 
     // Record which part of the image will be redrawn on the current swapchain image.
     auto& current_image = swapchain_image_infos.at(r.frame_buffer_index);
-    current_image.redraw_rectangle = redraw_rectangle;
+    current_image.redraw_region = redraw_region;
 
-    // Calculate the scissor rectangle, from the combined redraws of the complete swapchain.
+    // Calculate the redraw region, from the combined redraws of the complete swapchain.
     // We need to do this so that old redraws are also executed in the current swapchain image.
-    r.scissor_rectangle =
-        std::accumulate(swapchain_image_infos.cbegin(), swapchain_image_infos.cend(), aarectangle{}, [](hilet& sum, hilet& item) {
-            return sum | item.redraw_rectangle;
-        });
+    for (hilet& image : swapchain_image_infos) {
+        r.redraw_region |= image.redraw_region;
+    }
 
     // Wait until previous rendering has finished, before the next rendering.
     _device->waitForFences({renderFinishedFence}, VK_TRUE, std::numeric_limits<uint64_t>::max());
@@ -437,6 +437,20 @@ hi_inline draw_context gfx_surface::render_start(aarectangle redraw_rectangle)
     return r;
 }
 
+hi_inline vk::Rect2D gfx_surface::make_rect2D(aarectangle rectangle) const noexcept
+{
+    // Clamp the rectangle to the size of the window.
+    rectangle = intersect(
+        rectangle,
+        aarectangle{0, 0, narrow_cast<float>(swapchainImageExtent.width), narrow_cast<float>(swapchainImageExtent.height)});
+
+    return vk::Rect2D{
+        vk::Offset2D(
+            round_cast<uint32_t>(rectangle.left()),
+            round_cast<uint32_t>(swapchainImageExtent.height - rectangle.bottom() - rectangle.height())),
+        vk::Extent2D(round_cast<uint32_t>(rectangle.width()), round_cast<uint32_t>(rectangle.height()))};
+}
+
 hi_inline void gfx_surface::render_finish(draw_context const& context)
 {
     hilet lock = std::scoped_lock(gfx_system_mutex);
@@ -453,18 +467,7 @@ hi_inline void gfx_surface::render_finish(draw_context const& context)
         current_image.layout_is_present = true;
     }
 
-    // Clamp the scissor rectangle to the size of the window.
-    hilet clamped_scissor_rectangle = intersect(
-        context.scissor_rectangle,
-        aarectangle{0, 0, narrow_cast<float>(swapchainImageExtent.width), narrow_cast<float>(swapchainImageExtent.height)});
-
-    hilet render_area = vk::Rect2D{
-        vk::Offset2D(
-            round_cast<uint32_t>(clamped_scissor_rectangle.left()),
-            round_cast<uint32_t>(
-                swapchainImageExtent.height - clamped_scissor_rectangle.bottom() - clamped_scissor_rectangle.height())),
-        vk::Extent2D(
-            round_cast<uint32_t>(clamped_scissor_rectangle.width()), round_cast<uint32_t>(clamped_scissor_rectangle.height()))};
+    hilet render_area = make_rect2D(bounding_rectangle(context.redraw_region));
 
     // Start the first delegate when the swapchain-image becomes available.
     auto start_semaphore = imageAvailableSemaphore;
@@ -513,23 +516,28 @@ hi_inline void gfx_surface::fill_command_buffer(
         vk::ClearValue{sdfClearValue},
         vk::ClearValue{colorClearValue}};
 
-    // The scissor and render area makes sure that the frame buffer is not modified where we are not drawing the widgets.
-    hilet scissors = std::array{render_area};
-    commandBuffer.setScissor(0, scissors);
+    // The scissors and render area makes sure that the frame buffer is not modified where we are not drawing the widgets.
+    // The render area encloses the redraw region, each pipeline records a draw for each rectangle of the region
+    // so that the parts of the render area between the rectangles are not modified.
+    auto scissors = std::vector<vk::Rect2D>{};
+    scissors.reserve(context.redraw_region.size());
+    for (hilet& rectangle : context.redraw_region) {
+        scissors.push_back(make_rect2D(rectangle));
+    }
 
     commandBuffer.beginRenderPass(
         {renderPass, current_image.frame_buffer, render_area, narrow_cast<uint32_t>(clearValues.size()), clearValues.data()},
         vk::SubpassContents::eInline);
 
-    box_pipeline->draw_in_command_buffer(commandBuffer, context);
+    box_pipeline->draw_in_command_buffer(commandBuffer, context, scissors);
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    image_pipeline->draw_in_command_buffer(commandBuffer, context);
+    image_pipeline->draw_in_command_buffer(commandBuffer, context, scissors);
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    SDF_pipeline->draw_in_command_buffer(commandBuffer, context);
+    SDF_pipeline->draw_in_command_buffer(commandBuffer, context, scissors);
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    override_pipeline->draw_in_command_buffer(commandBuffer, context);
+    override_pipeline->draw_in_command_buffer(commandBuffer, context, scissors);
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    tone_mapper_pipeline->draw_in_command_buffer(commandBuffer, context);
+    tone_mapper_pipeline->draw_in_command_buffer(commandBuffer, context, scissors);
 
     commandBuffer.endRenderPass();
     commandBuffer.end();
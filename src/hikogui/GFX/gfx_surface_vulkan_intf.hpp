@@ -26,7 +26,7 @@ struct swapchain_image_info {
     vk::Image image;
     vk::ImageView image_view;
     vk::Framebuffer frame_buffer;
-    aarectangle redraw_rectangle;
+    damage_region redraw_region;
     bool layout_is_present = false;
 };
 
@@ -112,7 +112,7 @@ public:
 
     void update(extent2 new_size) noexcept;
 
-    [[nodiscard]] draw_context render_start(aarectangle redraw_rectangle);
+    [[nodiscard]] draw_context render_start(damage_region redraw_region);
     void render_finish(draw_context const& context);
 
     void add_delegate(gfx_surface_delegate *delegate) noexcept;
@@ -143,11 +143,19 @@ private:
     void teardown_for_window_lost() noexcept;
 
     std::optional<uint32_t> acquire_next_image_from_swapchain();
+
+    /** Convert a rectangle of the window to a rectangle of the swapchain-image.
+     *
+     * @param rectangle A rectangle in window coordinates, y-axis up.
+     * @return The part of the rectangle inside the swapchain-image, y-axis down.
+     */
+    [[nodiscard]] vk::Rect2D make_rect2D(aarectangle rectangle) const noexcept;
     void present_image_to_queue(uint32_t frameBufferIndex, vk::Semaphore renderFinishedSemaphore);
 
     /**
      * @param current_image Information about the swapchain-image to be rendered.
      * @param context The drawing context.
+     * @param render_area The bounding rectangle of the redraw region of @a context.
      */
     void fill_command_buffer(swapchain_image_info const& current_image, draw_context const& context, vk::Rect2D render_area);
 
@@ -2,10 +2,15 @@
 #pragma once
 
 #include "gui_event.hpp" // export
+#include "gui_event_script.hpp" // export
 #include "gui_event_type.hpp" // export
 #include "gui_event_variant.hpp" // export
+#include "gui_window_base.hpp" // export
+#include "gui_window_headless.hpp" // export
 #include "gui_window_size.hpp" // export
+#if HI_OPERATING_SYSTEM == HI_OS_WINDOWS
 #include "gui_window_win32.hpp" // export
+#endif
 #include "hitbox.hpp" // export
 #include "keyboard_bindings.hpp" // export
 #include "keyboard_focus_direction.hpp" // export
@@ -14,7 +19,9 @@
 #include "keyboard_modifiers.hpp" // export
 #include "keyboard_state.hpp" // export
 #include "keyboard_virtual_key_intf.hpp" // export
+#if HI_OPERATING_SYSTEM == HI_OS_WINDOWS
 #include "keyboard_virtual_key_win32_impl.hpp" // export
+#endif
 #include "mouse_buttons.hpp" // export
 #include "mouse_cursor.hpp" // export
 #include "theme.hpp" // export
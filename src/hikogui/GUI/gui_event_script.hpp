@@ -0,0 +1,262 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file GUI/gui_event_script.hpp Defines gui_event_script.
+ * @ingroup GUI
+ */
+
+#pragma once
+
+#include "gui_event.hpp"
+#include "keyboard_key.hpp"
+#include "../codec/codec.hpp"
+#include "../geometry/geometry.hpp"
+#include "../unicode/unicode.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+hi_export_module(hikogui.GUI : gui_event_script);
+
+hi_export namespace hi::inline v1 {
+
+/** A script of events to send to a window, frame by frame.
+ *
+ * The script is used to replay user interaction on a headless window.
+ * It is loaded from a JSON file of the following form:
+ *
+ * ```json
+ * {
+ *     "size": [800, 600],
+ *     "frame_duration": 16.667,
+ *     "frames": [
+ *         {"events": [{"type": "mouse_move", "position": [10, 20]}]},
+ *         {"events": [{"type": "mouse_down", "position": [10, 20], "button": "left"}, {"type": "mouse_up", "position": [10, 20], "button": "left"}]},
+ *         {"events": [{"type": "keyboard_down", "key": "ctrl+A"}]},
+ *         {"events": [{"type": "keyboard_grapheme", "text": "hello"}]},
+ *         {"resize": [640, 480]},
+ *         {"repeat": 100}
+ *     ]
+ * }
+ * ```
+ *
+ * The position of mouse events is in window coordinates, with the origin
+ * at the bottom-left corner. The frame duration is in milliseconds.
+ *
+ * @ingroup GUI
+ */
+class gui_event_script {
+public:
+    struct frame_type {
+        /** The new size of the window, before the events are sent.
+         */
+        std::optional<extent2> resize;
+
+        /** The events to send to the window during this frame.
+         */
+        std::vector<gui_event> events;
+
+        /** The number of times this frame is rendered.
+         */
+        std::size_t repeat = 1;
+    };
+
+    /** The initial size of the window, or empty for the preferred size of the widgets.
+     */
+    extent2 size;
+
+    /** The time between the frames.
+     */
+    std::chrono::nanoseconds frame_duration = std::chrono::nanoseconds{16'666'667};
+
+    std::vector<frame_type> frames;
+
+    gui_event_script() noexcept = default;
+
+    /** Parse a script.
+     *
+     * @param data The script as parsed JSON.
+     * @throws parse_error When the script is invalid.
+     */
+    explicit gui_event_script(datum const& data)
+    {
+        hi_check(holds_alternative<datum::map_type>(data), "Expecting object at top level.");
+
+        if (data.contains("size")) {
+            size = parse_extent(data["size"]);
+        }
+
+        if (data.contains("frame_duration")) {
+            hilet duration = static_cast<double>(data["frame_duration"]);
+            hi_check(duration >= 0.0, "Expecting a positive 'frame_duration', got {}", duration);
+            frame_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::milli>{duration});
+        }
+
+        hi_check(data.contains("frames"), "Missing key 'frames' at top level.");
+        hilet frame_list = data["frames"];
+        hi_check(holds_alternative<datum::vector_type>(frame_list), "Expecting array value for key 'frames' at top level.");
+
+        for (hilet& frame : frame_list) {
+            frames.push_back(parse_frame(frame));
+        }
+    }
+
+    /** Load a script from a JSON file.
+     *
+     * @param path The path to the JSON file.
+     * @throws io_error When the file could not be read or the script is invalid.
+     */
+    [[nodiscard]] static gui_event_script load(std::filesystem::path const& path)
+    {
+        hilet data = parse_JSON(path);
+
+        try {
+            return gui_event_script{data};
+        } catch (std::exception const& e) {
+            throw io_error(std::format("{}: Could not load GUI event script.\n{}", path.string(), e.what()));
+        }
+    }
+
+    /** The total number of frames, including repeats.
+     */
+    [[nodiscard]] std::size_t num_frames() const noexcept
+    {
+        auto r = 0_uz;
+        for (hilet& frame : frames) {
+            r += frame.repeat;
+        }
+        return r;
+    }
+
+private:
+    [[nodiscard]] static float parse_float(datum const& value)
+    {
+        hi_check(holds_alternative<double>(value) or holds_alternative<long long>(value), "Expecting a number, got {}", value);
+        return static_cast<float>(value);
+    }
+
+    [[nodiscard]] static extent2 parse_extent(datum const& value)
+    {
+        hi_check(holds_alternative<datum::vector_type>(value) and value.size() == 2, "Expecting [width, height], got {}", value);
+        return extent2{parse_float(value[0]), parse_float(value[1])};
+    }
+
+    [[nodiscard]] static point2 parse_point(datum const& value)
+    {
+        hi_check(holds_alternative<datum::vector_type>(value) and value.size() == 2, "Expecting [x, y], got {}", value);
+        return point2{parse_float(value[0]), parse_float(value[1])};
+    }
+
+    [[nodiscard]] static mouse_buttons parse_mouse_button(datum const& value)
+    {
+        hilet name = static_cast<std::string>(value);
+
+        auto r = mouse_buttons{};
+        if (name == "left") {
+            r.left_button = true;
+        } else if (name == "middle") {
+            r.middle_button = true;
+        } else if (name == "right") {
+            r.right_button = true;
+        } else {
+            throw parse_error(std::format("Could not parse mouse button '{}'", name));
+        }
+        return r;
+    }
+
+    [[nodiscard]] static frame_type parse_frame(datum const& frame)
+    {
+        hi_check(holds_alternative<datum::map_type>(frame), "Expecting object for a frame, got {}", frame);
+
+        auto r = frame_type{};
+        if (frame.contains("resize")) {
+            r.resize = parse_extent(frame["resize"]);
+        }
+
+        if (frame.contains("repeat")) {
+            r.repeat = static_cast<std::size_t>(frame["repeat"]);
+        }
+
+        if (frame.contains("events")) {
+            hilet event_list = frame["events"];
+            hi_check(holds_alternative<datum::vector_type>(event_list), "Expecting array value for key 'events', got {}", event_list);
+
+            for (hilet& event : event_list) {
+                parse_event(r.events, event);
+            }
+        }
+        return r;
+    }
+
+    static void parse_event(std::vector<gui_event>& events, datum const& event)
+    {
+        using enum gui_event_type;
+
+        hi_check(holds_alternative<datum::map_type>(event), "Expecting object for an event, got {}", event);
+        hi_check(event.contains("type"), "Expecting required 'type' for an event, got {}", event);
+
+        hilet type_name = static_cast<std::string>(event["type"]);
+        hilet type = to_gui_event_type(type_name);
+
+        switch (type) {
+        case mouse_move:
+        case mouse_drag:
+        case mouse_down:
+        case mouse_up:
+        case mouse_wheel:
+            {
+                hi_check(event.contains("position"), "Expecting required 'position' for a mouse event, got {}", event);
+
+                auto e = gui_event{type};
+                e.mouse().position = parse_point(event["position"]);
+                if (event.contains("button")) {
+                    e.mouse().cause = parse_mouse_button(event["button"]);
+                }
+                if (type == mouse_drag) {
+                    e.mouse().down = e.mouse().cause;
+                }
+                if (type == mouse_down) {
+                    e.mouse().down_position = e.mouse().position;
+                    e.mouse().click_count = 1;
+                }
+                if (event.contains("wheel")) {
+                    hilet delta = parse_point(event["wheel"]);
+                    e.mouse().wheel_delta = vector2{delta.x(), delta.y()};
+                }
+                events.push_back(e);
+            }
+            break;
+
+        case mouse_exit_window:
+            events.emplace_back(type);
+            break;
+
+        case keyboard_down:
+        case keyboard_up:
+            {
+                hi_check(event.contains("key"), "Expecting required 'key' for a keyboard event, got {}", event);
+
+                hilet key = keyboard_key(static_cast<std::string>(event["key"]));
+                events.emplace_back(type, key.virtual_key, key.modifiers);
+            }
+            break;
+
+        case keyboard_grapheme:
+            hi_check(event.contains("text"), "Expecting required 'text' for a keyboard_grapheme event, got {}", event);
+
+            for (hilet grapheme : to_gstring(static_cast<std::string>(event["text"]))) {
+                events.push_back(gui_event::keyboard_grapheme(grapheme));
+            }
+            break;
+
+        default:
+            throw parse_error(std::format("Could not parse event type '{}'", type_name));
+        }
+    }
+};
+
+} // namespace hi::inline v1
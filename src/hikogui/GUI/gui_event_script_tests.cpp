@@ -0,0 +1,48 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "gui_event_script.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+
+using namespace hi;
+
+TEST(gui_event_script, parse)
+{
+    hilet script = gui_event_script{parse_JSON(R"({
+        "size": [800, 600],
+        "frame_duration": 10,
+        "frames": [
+            {"events": [{"type": "mouse_down", "position": [10, 20.5], "button": "left"}]},
+            {"events": [{"type": "keyboard_down", "key": "ctrl+a"}, {"type": "keyboard_grapheme", "text": "hi"}]},
+            {"resize": [640, 480], "repeat": 3}
+        ]
+    })")};
+
+    ASSERT_EQ(script.size, (extent2{800.0f, 600.0f}));
+    ASSERT_EQ(script.frame_duration, std::chrono::milliseconds(10));
+    ASSERT_EQ(script.frames.size(), 3);
+    ASSERT_EQ(script.num_frames(), 5);
+
+    hilet& mouse = script.frames[0].events.at(0);
+    ASSERT_EQ(mouse.type(), gui_event_type::mouse_down);
+    ASSERT_EQ(mouse.mouse().position, (point2{10.0f, 20.5f}));
+    ASSERT_TRUE(mouse.mouse().cause.left_button);
+
+    ASSERT_EQ(script.frames[1].events.size(), 3);
+    ASSERT_EQ(script.frames[1].events[0].key(), keyboard_virtual_key::A);
+    ASSERT_EQ(script.frames[1].events[0].keyboard_modifiers, keyboard_modifiers::control);
+    ASSERT_EQ(script.frames[1].events[2].grapheme(), grapheme{'i'});
+
+    ASSERT_EQ(script.frames[2].resize, (extent2{640.0f, 480.0f}));
+    ASSERT_TRUE(script.frames[2].events.empty());
+}
+
+TEST(gui_event_script, bad_event)
+{
+    ASSERT_THROW(
+        gui_event_script{parse_JSON(R"({"frames": [{"events": [{"type": "mouse_down"}]}]})")}, parse_error);
+    ASSERT_THROW(
+        gui_event_script{parse_JSON(R"({"frames": [{"events": [{"type": "foo"}]}]})")}, parse_error);
+}
@@ -0,0 +1,556 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file GUI/gui_window_base.hpp Defines gui_window_base.
+ * @ingroup GUI
+ */
+
+#pragma once
+
+#include "gui_event.hpp"
+#include "gui_window_size.hpp"
+#include "hitbox.hpp"
+#include "keyboard_bindings.hpp"
+#include "theme_book.hpp"
+#include "widget_intf.hpp"
+#include "mouse_cursor.hpp"
+#include "../GFX/GFX.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../macros.hpp"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+hi_export_module(hikogui.GUI : gui_window_base);
+
+hi_export namespace hi::inline v1 {
+
+/** The part of a window that is shared by all kinds of windows.
+ *
+ * The window owns the top-level widget, and dispatches events to the widgets
+ * by hit-testing mouse events and by tracking the keyboard focus.
+ *
+ * The operating system specific parts, such as the clipboard, the size of
+ * the window and the mouse cursor, are implemented by a sub-class.
+ *
+ * @ingroup GUI
+ */
+class gui_window_base {
+public:
+    /** The surface to draw on; empty for a window without a GPU device.
+     */
+    std::unique_ptr<gfx_surface> surface;
+
+    /** The current rectangle of the window relative to the screen.
+     *
+     * The size of this rectangle is used to layout the widgets.
+     */
+    aarectangle rectangle;
+
+    /** The current cursor.
+     * Used for optimizing when the operating system cursor is updated.
+     * Set to mouse_cursor::None at the start (for the wait icon) and when the
+     * operating system is going to display another icon to make sure
+     * when it comes back in the application the cursor will be updated
+     * correctly.
+     */
+    mouse_cursor current_mouse_cursor = mouse_cursor::None;
+
+    /*! The window is currently being resized by the user.
+     * We can disable expensive redraws during rendering until this
+     * is false again.
+     */
+    bool resizing = false;
+
+    /*! The window is currently active.
+     * Widgets may want to reduce redraws, or change colors.
+     */
+    bool active = false;
+
+    /*! Dots-per-inch of the screen where the window is located.
+     * If the window is located on multiple screens then one of the screens is used as
+     * the source for the DPI value.
+     */
+    float dpi = 72.0;
+
+    /** Theme to use to draw the widgets on this window.
+     * The sizes and colors of the theme have already been adjusted to the window's state and dpi.
+     */
+    hi::theme theme = {};
+
+    /** The size of the widget.
+     */
+    extent2 widget_size;
+
+    /** Notifier used when the window is closing.
+     * It is expected that after notifying these callbacks the instance of this class is destroyed.
+     */
+    notifier<void()> closing;
+
+    virtual ~gui_window_base()
+    {
+        // Destroy the top-level widget, before Window-members that the widgets require from the window during their destruction.
+        _widget = {};
+    }
+
+    gui_window_base(gui_window_base const&) = delete;
+    gui_window_base& operator=(gui_window_base const&) = delete;
+    gui_window_base(gui_window_base&&) = delete;
+    gui_window_base& operator=(gui_window_base&&) = delete;
+
+    template<typename Widget>
+    [[nodiscard]] Widget& widget() const noexcept
+    {
+        return up_cast<Widget>(*_widget);
+    }
+
+    void set_title(label title) noexcept
+    {
+        _title = std::move(title);
+    }
+
+    /** Get the size-state of the window.
+     */
+    [[nodiscard]] gui_window_size size_state() const noexcept
+    {
+        return _size_state;
+    }
+
+    /** Set the mouse cursor icon.
+     */
+    virtual void set_cursor(mouse_cursor cursor) noexcept = 0;
+
+    /** Ask the operating system to close this window.
+     */
+    virtual void close_window() = 0;
+
+    /** Set the size-state of the window.
+     *
+     * This function is used to change the size of the window to one
+     * of the predefined states: normal, minimized, maximized or full-screen.
+     */
+    virtual void set_size_state(gui_window_size state) noexcept = 0;
+
+    [[nodiscard]] virtual hi::subpixel_orientation subpixel_orientation() const noexcept = 0;
+
+    /** Open the system menu of the window.
+     */
+    virtual void open_system_menu() = 0;
+
+    /** Ask the operating system to set the size of this window.
+     */
+    virtual void set_window_size(extent2 new_extent) = 0;
+
+    /** Get text from the clipboard.
+     *
+     * @note This is part of the window as some operating systems need to know from which window the text was posted.
+     * @return The text from the clipboard.
+     * @retval empty When the clipboard is locked by another application, on error, if the data on the clipboard can not
+     *               be converted to text or if the clipboard is empty.
+     */
+    [[nodiscard]] virtual std::optional<gstring> get_text_from_clipboard() const noexcept = 0;
+
+    /** Put text on the clipboard.
+     *
+     * @note This is part of the window as some operating systems need to know from which window the text was posted.
+     * @param text The text to place on the clipboard.
+     */
+    virtual void put_text_on_clipboard(gstring_view text) const noexcept = 0;
+
+    /** Check if the window is displayed without a GPU device.
+     *
+     * Images and glyphs can not be uploaded for a headless window; widgets
+     * should not wait for them to become available.
+     */
+    [[nodiscard]] virtual bool headless() const noexcept
+    {
+        return false;
+    }
+
+    [[nodiscard]] translate2 window_to_screen() const noexcept
+    {
+        return translate2{rectangle.left(), rectangle.bottom()};
+    }
+
+    [[nodiscard]] translate2 screen_to_window() const noexcept
+    {
+        return ~window_to_screen();
+    }
+
+    void update_mouse_target(widget_id new_target_id, point2 position = {}) noexcept
+    {
+        hi_axiom(loop::main().on_thread());
+
+        if (_mouse_target_id != 0) {
+            if (new_target_id == _mouse_target_id) {
+                // Focus does not change.
+                return;
+            }
+
+            // The mouse target needs to be updated, send exit to previous target.
+            send_events_to_widget(_mouse_target_id, std::vector{gui_event{gui_event_type::mouse_exit}});
+        }
+
+        if (new_target_id != 0) {
+            _mouse_target_id = new_target_id;
+            send_events_to_widget(new_target_id, std::vector{gui_event::make_mouse_enter(position)});
+        } else {
+            _mouse_target_id = {};
+        }
+    }
+
+    /** Change the keyboard focus to the given widget.
+     * If the group of the widget is incorrect then no widget will be in focus.
+     *
+     * @param widget The new widget to focus, or empty to remove all keyboard focus.
+     * @param group The group the widget must belong to.
+     */
+    void update_keyboard_target(widget_id new_target_id, keyboard_focus_group group = keyboard_focus_group::normal) noexcept
+    {
+        hi_axiom(loop::main().on_thread());
+
+        auto new_target_widget = get_if(_widget.get(), new_target_id, false);
+
+        // Before we are going to make new_target_widget empty, due to the rules below;
+        // capture which parents there are.
+        auto new_target_parent_chain = new_target_widget ? new_target_widget->parent_chain() : std::vector<widget_id>{};
+
+        // If the new target widget does not accept focus, for example when clicking
+        // on a disabled widget, or empty part of a window.
+        // In that case no widget will get focus.
+        if (new_target_widget == nullptr or not new_target_widget->accepts_keyboard_focus(group)) {
+            new_target_widget = nullptr;
+        }
+
+        if (auto const *const keyboard_target_widget = get_if(_widget.get(), _keyboard_target_id, false)) {
+            // keyboard target still exists and visible.
+            if (new_target_widget == keyboard_target_widget) {
+                // Focus does not change.
+                return;
+            }
+
+            send_events_to_widget(_keyboard_target_id, std::vector{gui_event{gui_event_type::keyboard_exit}});
+        }
+
+        // Tell "escape" to all the widget that are not parents of the new widget
+        _widget->handle_event_recursive(gui_event_type::gui_cancel, new_target_parent_chain);
+
+        // Tell the new widget that keyboard focus was entered.
+        if (new_target_widget != nullptr) {
+            _keyboard_target_id = new_target_widget->id;
+            send_events_to_widget(_keyboard_target_id, std::vector{gui_event{gui_event_type::keyboard_enter}});
+        } else {
+            _keyboard_target_id = {};
+        }
+    }
+
+    /** Change the keyboard focus to the previous or next widget from the given widget.
+     * This function will find the closest widget from the given widget which belongs to the given
+     * group; if none is found, or if the original selected widget is found, then no widget will be in focus.
+     *
+     * @param start_widget The widget to use as the start point for a new widget to select.
+     * @param group The group the widget must belong to.
+     * @param direction The direction to search in, or current to select the current widget.
+     */
+    void update_keyboard_target(widget_id start_widget, keyboard_focus_group group, keyboard_focus_direction direction) noexcept
+    {
+        hi_axiom(loop::main().on_thread());
+
+        if (auto tmp = _widget->find_next_widget(start_widget, group, direction); tmp != start_widget) {
+            update_keyboard_target(tmp, group);
+
+        } else if (group == keyboard_focus_group::normal) {
+            // Could not find a next widget, loop around.
+            // menu items should not loop back.
+            tmp = _widget->find_next_widget({}, group, direction);
+            update_keyboard_target(tmp, group);
+        }
+    }
+
+    /** Change the keyboard focus to the given, previous or next widget.
+     * This function will find the closest widget from the current widget which belongs to the given
+     * group; if none is found, or if the original selected widget is found, then no widget will be in focus.
+     *
+     * @param group The group the widget must belong to.
+     * @param direction The direction to search in, or current to select the current widget.
+     */
+    void update_keyboard_target(keyboard_focus_group group, keyboard_focus_direction direction) noexcept
+    {
+        return update_keyboard_target(_keyboard_target_id, group, direction);
+    }
+
+    /** Process the event.
+     *
+     * This is called by the event handler to start processing events.
+     * The events are translated and then uses `send_event_to_widget()` to send the
+     * events to the widgets in some priority ordering.
+     *
+     * It may also be called from within the `event_handle()` of widgets.
+     */
+    virtual bool process_event(gui_event event) noexcept
+    {
+        using enum gui_event_type;
+
+        hi_axiom(loop::main().on_thread());
+
+        switch (event.type()) {
+        case window_redraw:
+            _redraw_region |= event.rectangle();
+            return true;
+
+        case window_relayout:
+        case window_reconstrain:
+            // The widgets that sent this event, and their parents, have been
+            // marked to be updated on the next frame.
+            if (_widget) {
+                _widget->discard_retained(event);
+            }
+            return true;
+
+        case window_resize:
+            _resize.store(true, std::memory_order_relaxed);
+            return true;
+
+        case window_minimize:
+            set_size_state(gui_window_size::minimized);
+            return true;
+
+        case window_maximize:
+            set_size_state(gui_window_size::maximized);
+            return true;
+
+        case window_normalize:
+            set_size_state(gui_window_size::normal);
+            return true;
+
+        case window_close:
+            close_window();
+            return true;
+
+        case window_open_sysmenu:
+            open_system_menu();
+            return true;
+
+        case window_set_keyboard_target:
+            {
+                hilet& target = event.keyboard_target();
+                if (target.widget_id == 0) {
+                    update_keyboard_target(target.group, target.direction);
+                } else if (target.direction == keyboard_focus_direction::here) {
+                    update_keyboard_target(target.widget_id, target.group);
+                } else {
+                    update_keyboard_target(target.widget_id, target.group, target.direction);
+                }
+            }
+            return true;
+
+        case window_set_clipboard:
+            put_text_on_clipboard(event.clipboard_data());
+            return true;
+
+        case mouse_exit_window: // Mouse left window.
+            update_mouse_target({});
+            break;
+
+        case mouse_up:
+        case mouse_drag:
+        case mouse_down:
+        case mouse_move:
+            event.mouse().hitbox = _widget->hitbox_test(event.mouse().position);
+            if (event == mouse_down or event == mouse_move) {
+                update_mouse_target(event.mouse().hitbox.widget_id, event.mouse().position);
+            }
+            if (event == mouse_down) {
+                update_keyboard_target(event.mouse().hitbox.widget_id, keyboard_focus_group::all);
+            }
+            break;
+
+        default:;
+        }
+
+        // Translate keyboard events, using the keybindings.
+        auto events = std::vector<gui_event>{event};
+        if (event.type() == keyboard_down) {
+            for (auto& e : translate_keyboard_event(event)) {
+                events.push_back(e);
+            }
+        }
+
+        for (auto& event_ : events) {
+            if (event_.type() == gui_event_type::text_edit_paste) {
+                // The text-edit-paste operation was generated by keyboard bindings,
+                // it needs the actual text to be pasted added.
+                if (auto optional_text = get_text_from_clipboard()) {
+                    event_.clipboard_data() = *optional_text;
+                }
+            }
+        }
+
+        // Send the event to the correct widget.
+        hilet handled = send_events_to_widget(
+            events.front().variant() == gui_event_variant::mouse ? _mouse_target_id : _keyboard_target_id, events);
+
+        // Intercept the keyboard generated escape.
+        // A keyboard generated escape should always remove keyboard focus.
+        // The update_keyboard_target() function will send gui_keyboard_exit and a
+        // potential duplicate gui_cancel messages to all widgets that need it.
+        for (hilet event_ : events) {
+            if (event_ == gui_cancel) {
+                update_keyboard_target({}, keyboard_focus_group::all);
+            }
+        }
+
+        return handled;
+    }
+
+protected:
+    /** The label of the window that is passed to the operating system.
+     */
+    label _title;
+
+    /** The widget covering the complete window.
+     */
+    std::unique_ptr<widget_intf> _widget;
+
+    box_constraints _widget_constraints = {};
+
+    /** Incremented each time all the widgets are reconstrained.
+     *
+     * Widgets do not replay their retained vertices from an earlier generation.
+     */
+    std::size_t _widget_generation = 0;
+
+    /** The parts of the window that need to be redrawn on the next frame.
+     */
+    damage_region _redraw_region;
+
+    /** A widget requested the window to be resized to its preferred size.
+     */
+    std::atomic<bool> _resize = false;
+
+    /** All widgets need to be reconstrained on the next frame.
+     */
+    bool _reconstrain_all = false;
+
+    /** Current size state of the window.
+     */
+    gui_window_size _size_state = gui_window_size::normal;
+
+    /** Target of the mouse
+     * Since any mouse event will change the target this is used
+     * to check if the target has changed, to send exit events to the previous mouse target.
+     */
+    widget_id _mouse_target_id;
+
+    /** Target of the keyboard
+     * widget where keyboard events are sent to.
+     */
+    widget_id _keyboard_target_id;
+
+    gui_window_base(std::unique_ptr<widget_intf> widget) noexcept : _widget(std::move(widget))
+    {
+        hi_assert_not_null(_widget);
+    }
+
+    /** Register the fonts, themes and keyboard bindings.
+     *
+     * This is done once, when the first window is opened.
+     */
+    static void register_resources() noexcept
+    {
+        if (not std::exchange(_first_window, false)) {
+            return;
+        }
+
+        register_font_file(URL{"resource:elusiveicons-webfont.ttf"});
+        register_font_file(URL{"resource:hikogui_icons.ttf"});
+        register_font_directories(font_dirs());
+
+        register_theme_directories(theme_dirs());
+
+        try {
+            load_system_keyboard_bindings(URL{"resource:win32.keybinds.json"});
+        } catch (std::exception const& e) {
+            hi_log_fatal("Could not load keyboard bindings. \"{}\"", e.what());
+        }
+    }
+
+    /** Attach the top-level widget to the window and constrain it.
+     *
+     * This is called from the constructor of the sub-class, so that the
+     * widgets see the complete window.
+     *
+     * @return The constraints of the top-level widget.
+     */
+    box_constraints attach_widget() noexcept
+    {
+        _widget->set_window(this);
+
+        // Execute a constraint check to determine initial window size.
+        theme = get_selected_theme().transform(dpi);
+        _widget_constraints = _widget->update_constraints_retained();
+
+        // Reset the keyboard target to not focus anything.
+        update_keyboard_target({});
+
+        // Subscribe on theme changes.
+        _selected_theme_cbt = theme_book::global().selected_theme.subscribe(
+            [this](auto...) {
+                ++global_counter<"gui_window:selected_theme:constrain">;
+                reconstrain_all();
+            },
+            callback_flags::main);
+
+        return _widget_constraints;
+    }
+
+    /** Reconstrain, relayout and redraw all the widgets on the next frame.
+     *
+     * This is used for window-wide changes, such as the theme, language or dpi.
+     */
+    void reconstrain_all() noexcept
+    {
+        hi_axiom(loop::main().on_thread());
+        _reconstrain_all = true;
+    }
+
+    /** Send event to a target widget.
+     *
+     * The commands are send in order, until the command is handled, then processing stops immediately.
+     * All commands are tried in a batch to the following handlers:
+     *  - The target widget
+     *  - The parents of the widget up to and including the root widget.
+     *  - The window itself.
+     */
+    bool send_events_to_widget(widget_id target_id, std::vector<gui_event> const& events) noexcept
+    {
+        if (target_id == 0) {
+            // If there was no target, send the event to the window's widget.
+            target_id = _widget->id;
+        }
+
+        auto target_widget = get_if(_widget.get(), target_id, false);
+        while (target_widget) {
+            // Each widget will try to handle the first event it can.
+            for (hilet& event : events) {
+                if (target_widget->handle_event(target_widget->layout().from_window * event)) {
+                    return true;
+                }
+            }
+
+            // Forward the events to the parent of the target.
+            target_widget = target_widget->parent;
+        }
+
+        return false;
+    }
+
+private:
+    inline static bool _first_window = true;
+
+    callback<void(std::string)> _selected_theme_cbt;
+};
+
+} // namespace hi::inline v1
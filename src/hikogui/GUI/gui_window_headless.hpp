@@ -0,0 +1,364 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file GUI/gui_window_headless.hpp Defines gui_window_headless.
+ * @ingroup GUI
+ */
+
+#pragma once
+
+#include "gui_window_base.hpp"
+#include "gui_event.hpp"
+#include "gui_window_size.hpp"
+#include "mouse_cursor.hpp"
+#include "../GFX/GFX.hpp"
+#include "../image/image.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <chrono>
+#include <vector>
+#include <optional>
+
+hi_export_module(hikogui.GUI : gui_window_headless);
+
+hi_export namespace hi::inline v1 {
+
+/** The time spent and the memory allocated for a frame of a headless window.
+ *
+ * The number of allocations is only counted when the executable enables
+ * counting, see `allocation_count()`.
+ *
+ * @ingroup GUI
+ */
+struct gui_window_frame_statistics {
+    std::chrono::nanoseconds event_duration = {};
+    std::chrono::nanoseconds constrain_duration = {};
+    std::chrono::nanoseconds layout_duration = {};
+    std::chrono::nanoseconds draw_duration = {};
+    std::chrono::nanoseconds capture_duration = {};
+
+    uint64_t event_allocations = 0;
+    uint64_t constrain_allocations = 0;
+    uint64_t layout_allocations = 0;
+    uint64_t draw_allocations = 0;
+    uint64_t capture_allocations = 0;
+
+    /** The number of rectangles that were redrawn.
+     */
+    std::size_t num_redraw_rectangles = 0;
+
+    /** The number of quads that were drawn.
+     */
+    std::size_t num_quads = 0;
+
+    [[nodiscard]] std::chrono::nanoseconds duration() const noexcept
+    {
+        return event_duration + constrain_duration + layout_duration + draw_duration + capture_duration;
+    }
+
+    [[nodiscard]] uint64_t allocations() const noexcept
+    {
+        return event_allocations + constrain_allocations + layout_allocations + draw_allocations + capture_allocations;
+    }
+};
+
+/** A window that is not displayed by the operating system.
+ *
+ * The headless window owns a widget tree, and is driven completely by the
+ * application: events are sent using `process_event()`, and each call to
+ * `render()` runs the constrain, layout and draw passes over the widgets.
+ * It is available on every platform, next to the operating system's `gui_window`.
+ *
+ * This is used to replay a script of events and measure the time spent
+ * on each frame, for example for detecting performance regressions on
+ * machines without a display.
+ *
+ * The vertices that the widgets draw are discarded, or when capturing is
+ * enabled are rendered by the `gfx_software_renderer` into an image.
+ *
+ * Limitations, as there is no GPU device to hold the glyph and image atlases:
+ * - Text and glyphs are not drawn; the time spent on shaping and layout of
+ *   text is measured, but not the time to rasterize glyphs into the atlas.
+ * - Images, such as pixmap icons, are not drawn. The `icon_widget` does not
+ *   retry uploading a pixmap on a headless window, so it does not cause a
+ *   reconstrain on every frame.
+ *
+ * @ingroup GUI
+ */
+class gui_window_headless final : public gui_window_base {
+public:
+    /** Create a headless window.
+     *
+     * @param widget The top level widget.
+     * @param size The size of the window, or empty for the preferred size of the widget.
+     */
+    gui_window_headless(std::unique_ptr<widget_intf> widget, extent2 size = {}) noexcept :
+        gui_window_base(std::move(widget))
+    {
+        register_resources();
+
+        active = true;
+
+        hilet constraints = attach_widget();
+        rectangle = aarectangle{size == extent2{} ? constraints.preferred : size};
+    }
+
+    /** Enable rendering the vertices into an image.
+     *
+     * @param enable True to render each frame into `capture()`.
+     */
+    void set_capture(bool enable) noexcept
+    {
+        if (enable and not _renderer) {
+            _renderer.emplace();
+        } else if (not enable) {
+            _renderer.reset();
+            _capture = {};
+        }
+    }
+
+    /** The image of the last frame.
+     *
+     * The image is in linear-sRGB with pre-multiplied alpha, and is empty
+     * unless capturing was enabled with `set_capture()`.
+     */
+    [[nodiscard]] pixmap<sfloat_rgba16> const& capture() const noexcept
+    {
+        return _capture;
+    }
+
+    /** Constrain, layout and draw the widgets.
+     *
+     * Like an operating system window, only the widgets that requested
+     * it are updated.
+     *
+     * Events that the widgets send to the window during rendering are
+     * included in the time of the pass that sent them.
+     *
+     * @param display_time_point The time when the frame would be displayed.
+     * @return The time spent and the number of allocations of each pass, and
+     *         of the events that were processed since the previous frame.
+     */
+    gui_window_frame_statistics render(utc_nanoseconds display_time_point)
+    {
+        hi_axiom(loop::main().on_thread());
+        hi_assert_not_null(_widget);
+
+        // Events sent by widgets during rendering are not timed separately.
+        ++_event_depth;
+        hilet d = defer([&] {
+            --_event_depth;
+        });
+
+        auto r = std::exchange(_statistics, {});
+
+        auto t = std::chrono::steady_clock::now();
+        auto a = allocation_count();
+        hilet measure = [&](std::chrono::nanoseconds& duration, uint64_t& allocations) {
+            hilet t2 = std::chrono::steady_clock::now();
+            hilet a2 = allocation_count();
+            duration += t2 - t;
+            allocations += a2 - a;
+            t = t2;
+            a = a2;
+        };
+
+        if (std::exchange(_reconstrain_all, false)) {
+            theme = get_selected_theme().transform(dpi);
+
+            discard_retained_recursive(*_widget);
+            ++_widget_generation;
+            _redraw_region = aarectangle{rectangle.size()};
+        }
+
+        if (_widget->constraints_dirty()) {
+            hilet t2 = trace<"window::constrain">();
+            _widget_constraints = _widget->update_constraints_retained();
+        }
+
+        // There is no operating system to refuse a size; the window is resized immediately.
+        if (_resize.exchange(false, std::memory_order::relaxed)) {
+            set_window_size(_widget_constraints.preferred);
+        }
+        rectangle = aarectangle{get<0>(rectangle), clamp(rectangle.size(), _widget_constraints.minimum, _widget_constraints.maximum)};
+        measure(r.constrain_duration, r.constrain_allocations);
+
+        if (_widget->layout_dirty() or widget_size != rectangle.size()) {
+            hilet t2 = trace<"window::layout">();
+            if (widget_size != rectangle.size()) {
+                _redraw_region = aarectangle{rectangle.size()};
+            }
+            widget_size = rectangle.size();
+
+            hilet widget_layout_size = max(_widget_constraints.minimum, widget_size);
+            _widget->set_layout_retained(widget_layout{widget_layout_size, _size_state, subpixel_orientation(), display_time_point});
+        }
+        measure(r.layout_duration, r.layout_allocations);
+
+        if (_renderer and _redraw_region) {
+            // The vertices are not retained between frames, so the captured image needs a complete redraw.
+            _redraw_region = aarectangle{widget_size};
+        }
+
+        if (_redraw_region) {
+            hilet t2 = trace<"window::draw">();
+
+            auto context = draw_context{_box_vertices, _image_vertices, _sdf_vertices, _override_vertices};
+            context.redraw_region = std::exchange(_redraw_region, {});
+            context.display_time_point = display_time_point;
+            context.subpixel_orientation = subpixel_orientation();
+            context.active = active;
+            context.saturation = 1.0f;
+            context.generation = _widget_generation;
+
+            _widget->draw(context);
+
+            r.num_redraw_rectangles = context.redraw_region.size();
+            r.num_quads = (_box_vertices.size() + _image_vertices.size() + _sdf_vertices.size() + _override_vertices.size()) / 4;
+            measure(r.draw_duration, r.draw_allocations);
+
+            if (_renderer) {
+                hilet t3 = trace<"window::capture">();
+
+                hilet width = round_cast<std::size_t>(widget_size.width());
+                hilet height = round_cast<std::size_t>(widget_size.height());
+                if (_capture.width() != width or _capture.height() != height) {
+                    _capture = pixmap<sfloat_rgba16>{width, height};
+                }
+
+                hilet clear_color = static_cast<f32x4>(theme.color(semantic_color::fill, 0));
+                _renderer->render(_capture, _box_vertices, _image_vertices, _sdf_vertices, _override_vertices, clear_color);
+                measure(r.capture_duration, r.capture_allocations);
+            }
+        }
+
+        return r;
+    }
+
+    void set_cursor(mouse_cursor cursor) noexcept override
+    {
+        current_mouse_cursor = cursor;
+    }
+
+    /** Close the window.
+     *
+     * The window notifies `closing`, it is expected that the owner destroys the window.
+     */
+    void close_window() override
+    {
+        hi_axiom(loop::main().on_thread());
+        closing();
+    }
+
+    /** Set the size-state of the window.
+     *
+     * The size of the window does not change; there is no screen to maximize to.
+     */
+    void set_size_state(gui_window_size state) noexcept override
+    {
+        hi_axiom(loop::main().on_thread());
+        if (std::exchange(_size_state, state) != state) {
+            _widget->discard_retained(gui_event_type::window_relayout);
+        }
+    }
+
+    [[nodiscard]] hi::subpixel_orientation subpixel_orientation() const noexcept override
+    {
+        // Sub-pixel anti-aliasing is not rendered by the software renderer.
+        return hi::subpixel_orientation::unknown;
+    }
+
+    void open_system_menu() override {}
+
+    /** Set the size of the window.
+     *
+     * The new size is used on the next call to `render()`.
+     */
+    void set_window_size(extent2 new_extent) override
+    {
+        hi_axiom(loop::main().on_thread());
+        rectangle = aarectangle{get<0>(rectangle), new_extent};
+    }
+
+    /** Get text from the clipboard of this window.
+     *
+     * The headless window has its own clipboard, so that replaying events is not
+     * influenced by other applications.
+     */
+    [[nodiscard]] std::optional<gstring> get_text_from_clipboard() const noexcept override
+    {
+        return _clipboard;
+    }
+
+    void put_text_on_clipboard(gstring_view text) const noexcept override
+    {
+        _clipboard = gstring{text};
+    }
+
+    [[nodiscard]] bool headless() const noexcept override
+    {
+        return true;
+    }
+
+    /** Process the event.
+     *
+     * Mouse events are hit-tested against the widgets, keyboard events are
+     * translated using the keyboard bindings; in the same way as for an
+     * operating system window.
+     *
+     * The time spent is added to the event statistics of the next frame.
+     * Events sent by the widgets while handling an event, or while
+     * rendering, are part of the time of the outer call.
+     */
+    bool process_event(gui_event event) noexcept override
+    {
+        hi_axiom(loop::main().on_thread());
+
+        if (_event_depth != 0) {
+            return gui_window_base::process_event(std::move(event));
+        }
+
+        ++_event_depth;
+        hilet t = std::chrono::steady_clock::now();
+        hilet a = allocation_count();
+        hilet r = gui_window_base::process_event(std::move(event));
+        _statistics.event_duration += std::chrono::steady_clock::now() - t;
+        _statistics.event_allocations += allocation_count() - a;
+        --_event_depth;
+        return r;
+    }
+
+private:
+    /** The maximum number of vertices of each pipeline.
+     */
+    constexpr static std::size_t _max_num_vertices = 1 << 16;
+
+    mutable std::optional<gstring> _clipboard;
+
+    /** The time spent processing events since the last frame.
+     */
+    gui_window_frame_statistics _statistics;
+
+    /** The number of nested calls to `process_event()` and `render()`.
+     *
+     * Only the outermost call to `process_event()` is timed.
+     */
+    std::size_t _event_depth = 0;
+
+    std::vector<gfx_pipeline_box::vertex> _box_vertex_buffer = std::vector<gfx_pipeline_box::vertex>(_max_num_vertices);
+    std::vector<gfx_pipeline_image::vertex> _image_vertex_buffer = std::vector<gfx_pipeline_image::vertex>(_max_num_vertices);
+    std::vector<gfx_pipeline_SDF::vertex> _sdf_vertex_buffer = std::vector<gfx_pipeline_SDF::vertex>(_max_num_vertices);
+    std::vector<gfx_pipeline_override::vertex> _override_vertex_buffer =
+        std::vector<gfx_pipeline_override::vertex>(_max_num_vertices);
+    vector_span<gfx_pipeline_box::vertex> _box_vertices = std::span{_box_vertex_buffer};
+    vector_span<gfx_pipeline_image::vertex> _image_vertices = std::span{_image_vertex_buffer};
+    vector_span<gfx_pipeline_SDF::vertex> _sdf_vertices = std::span{_sdf_vertex_buffer};
+    vector_span<gfx_pipeline_override::vertex> _override_vertices = std::span{_override_vertex_buffer};
+
+    std::optional<gfx_software_renderer> _renderer;
+    pixmap<sfloat_rgba16> _capture;
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,219 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "gui_window_headless.hpp"
+#include "../widgets/widget.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+
+using namespace hi;
+using namespace std::chrono_literals;
+
+namespace {
+
+/** A top-level widget which counts how often it is updated.
+ */
+class headless_test_widget final : public widget {
+public:
+    int num_constrains = 0;
+    int num_layouts = 0;
+    int num_draws = 0;
+    int num_clicks = 0;
+
+    /** Request a redraw from inside `draw()`.
+     */
+    bool redraw_while_drawing = false;
+
+    headless_test_widget() noexcept : widget(nullptr) {}
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        ++num_constrains;
+        _layout = {};
+        return {{100, 50}, {200, 100}, {300, 200}, alignment{}, theme().margin()};
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        if (compare_store(_layout, context)) {
+            ++num_layouts;
+        }
+    }
+
+    void draw(draw_context const& context) noexcept override
+    {
+        if (overlaps(context, layout())) {
+            ++num_draws;
+            context.draw_box(layout(), layout().rectangle(), theme().color(semantic_color::blue));
+
+            if (redraw_while_drawing) {
+                request_redraw();
+            }
+        }
+    }
+
+    [[nodiscard]] hitbox hitbox_test(point2 position) const noexcept override
+    {
+        if (layout().contains(position)) {
+            return {id, _layout.elevation, hitbox_type::button};
+        } else {
+            return {};
+        }
+    }
+
+    bool handle_event(gui_event const& event) noexcept override
+    {
+        if (event == gui_event_type::mouse_down) {
+            ++num_clicks;
+            // Sends a nested event to the window.
+            request_redraw();
+            return true;
+        }
+        return super::handle_event(event);
+    }
+
+    bool process_event(gui_event const& event) const noexcept override
+    {
+        discard_retained(event);
+        return _window ? _window->process_event(event) : true;
+    }
+
+    void set_window(gui_window_base *window) noexcept override
+    {
+        _window = window;
+    }
+
+    [[nodiscard]] gui_window_base *window() const noexcept override
+    {
+        return _window;
+    }
+
+private:
+    using super = widget;
+
+    gui_window_base *_window = nullptr;
+};
+
+[[nodiscard]] gui_event make_mouse_down(point2 position) noexcept
+{
+    auto r = gui_event{gui_event_type::mouse_down};
+    r.mouse().position = position;
+    r.mouse().down_position = position;
+    r.mouse().cause.left_button = true;
+    r.mouse().click_count = 1;
+    return r;
+}
+
+} // namespace
+
+TEST(gui_window_headless, render)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>()};
+    auto& w = window.widget<headless_test_widget>();
+    ASSERT_TRUE(window.headless());
+
+    // The window has the preferred size of the widget.
+    ASSERT_EQ(window.rectangle.size(), (extent2{200.0f, 100.0f}));
+    ASSERT_EQ(w.num_constrains, 1);
+
+    // The first frame lays out and draws the complete window.
+    hilet first = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(window.widget_size, (extent2{200.0f, 100.0f}));
+    ASSERT_EQ(w.num_layouts, 1);
+    ASSERT_EQ(w.num_draws, 1);
+    ASSERT_EQ(first.num_redraw_rectangles, 1);
+    ASSERT_EQ(first.num_quads, 1);
+    ASSERT_EQ(first.event_duration, 0ns);
+
+    // Nothing changed, so nothing is updated.
+    hilet second = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(w.num_constrains, 1);
+    ASSERT_EQ(w.num_layouts, 1);
+    ASSERT_EQ(w.num_draws, 1);
+    ASSERT_EQ(second.num_redraw_rectangles, 0);
+    ASSERT_EQ(second.num_quads, 0);
+    ASSERT_EQ(second.draw_duration, 0ns);
+}
+
+TEST(gui_window_headless, resize)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>(), extent2{250.0f, 150.0f}};
+    auto& w = window.widget<headless_test_widget>();
+    ASSERT_EQ(window.rectangle.size(), (extent2{250.0f, 150.0f}));
+
+    std::ignore = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(window.widget_size, (extent2{250.0f, 150.0f}));
+
+    // The size of the window is clamped to the constraints of the widget.
+    window.set_window_size(extent2{1000.0f, 1000.0f});
+    std::ignore = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(window.widget_size, (extent2{300.0f, 200.0f}));
+    ASSERT_EQ(w.num_layouts, 2);
+
+    // A widget may ask for the preferred size.
+    ASSERT_TRUE(window.process_event({gui_event_type::window_resize}));
+    hilet r = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(window.widget_size, (extent2{200.0f, 100.0f}));
+    ASSERT_EQ(r.num_redraw_rectangles, 1);
+}
+
+TEST(gui_window_headless, event_statistics)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>()};
+    auto& w = window.widget<headless_test_widget>();
+    std::ignore = window.render(std::chrono::utc_clock::now());
+
+    // The mouse event is hit-tested against the widget, which requests a redraw.
+    ASSERT_TRUE(window.process_event(make_mouse_down(point2{10.0f, 10.0f})));
+    ASSERT_EQ(w.num_clicks, 1);
+
+    // The time spent on the event is reported on the next frame.
+    hilet first = window.render(std::chrono::utc_clock::now());
+    ASSERT_GT(first.event_duration, 0ns);
+    ASSERT_EQ(w.num_draws, 2);
+
+    // And only once.
+    hilet second = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(second.event_duration, 0ns);
+    ASSERT_EQ(second.event_allocations, 0);
+}
+
+TEST(gui_window_headless, events_during_render)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>()};
+    auto& w = window.widget<headless_test_widget>();
+    w.redraw_while_drawing = true;
+
+    // The redraw requested while drawing is part of the draw pass, not of
+    // the events of the next frame.
+    std::ignore = window.render(std::chrono::utc_clock::now());
+    hilet r = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(r.event_duration, 0ns);
+    ASSERT_EQ(w.num_draws, 2);
+}
+
+TEST(gui_window_headless, clipboard)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>()};
+    ASSERT_FALSE(window.get_text_from_clipboard());
+
+    window.put_text_on_clipboard(to_gstring("hello"));
+    ASSERT_EQ(window.get_text_from_clipboard(), to_gstring("hello"));
+}
+
+TEST(gui_window_headless, capture)
+{
+    auto window = gui_window_headless{std::make_unique<headless_test_widget>()};
+    window.set_capture(true);
+
+    hilet r = window.render(std::chrono::utc_clock::now());
+    ASSERT_EQ(window.capture().width(), 200);
+    ASSERT_EQ(window.capture().height(), 100);
+    ASSERT_GT(r.capture_duration, 0ns);
+
+    window.set_capture(false);
+    ASSERT_EQ(window.capture().width(), 0);
+}
@@ -6,12 +6,10 @@
 
 #include "../win32_headers.hpp"
 
+#include "gui_window_base.hpp"
 #include "gui_event.hpp"
 #include "gui_window_size.hpp"
-#include "hitbox.hpp"
 #include "keyboard_bindings.hpp"
-#include "theme_book.hpp"
-#include "widget_intf.hpp"
 #include "mouse_cursor.hpp"
 #include "../GFX/GFX.hpp"
 #include "../crt/crt.hpp"
@@ -22,117 +20,34 @@ hi_export_module(hikogui.GUI : gui_window);
 
 hi_export namespace hi::inline v1 {
 
-class gui_window {
+class gui_window : public gui_window_base {
 public:
     HWND win32Window = nullptr;
 
-    std::unique_ptr<gfx_surface> surface;
-
-    /** The current rectangle of the window relative to the screen.
-     * The screen rectangle is set by the operating system event loop.
-     *
-     * This rectangle is used by the operating system event loop hit-testing
-     * to determine the position of screen coordinates to window coordinates.
-     *
-     * The size of this rectangle is used to laying out widgets and setting
-     * the size of the gfx_surface during rendering.
-     */
-    aarectangle rectangle;
-
-    /** The current cursor.
-     * Used for optimizing when the operating system cursor is updated.
-     * Set to mouse_cursor::None at the start (for the wait icon) and when the
-     * operating system is going to display another icon to make sure
-     * when it comes back in the application the cursor will be updated
-     * correctly.
-     */
-    mouse_cursor current_mouse_cursor = mouse_cursor::None;
-
-    /*! The window is currently being resized by the user.
-     * We can disable expensive redraws during rendering until this
-     * is false again.
-     */
-    bool resizing = false;
-
-    /*! The window is currently active.
-     * Widgets may want to reduce redraws, or change colors.
-     */
-    bool active = false;
-
-    /*! Dots-per-inch of the screen where the window is located.
-     * If the window is located on multiple screens then one of the screens is used as
-     * the source for the DPI value.
-     */
-    float dpi = 72.0;
-
-    /** Theme to use to draw the widgets on this window.
-     * The sizes and colors of the theme have already been adjusted to the window's state and dpi.
-     */
-    hi::theme theme = {};
-
-    /** The size of the widget.
-     */
-    extent2 widget_size;
-
-    /** Notifier used when the window is closing.
-     * It is expected that after notifying these callbacks the instance of this class is destroyed.
-     */
-    notifier<void()> closing;
-
     gui_window(gui_window const&) = delete;
     gui_window& operator=(gui_window const&) = delete;
     gui_window(gui_window&&) = delete;
     gui_window& operator=(gui_window&&) = delete;
 
-    gui_window(std::unique_ptr<widget_intf> widget) noexcept : _widget(std::move(widget)), track_mouse_leave_event_parameters()
+    gui_window(std::unique_ptr<widget_intf> widget) noexcept :
+        gui_window_base(std::move(widget)), track_mouse_leave_event_parameters()
     {
-        if (_first_window) {
-            if (not os_settings::start_subsystem()) {
-                hi_log_fatal("Could not start the os_settings subsystem.");
-            }
-
-            register_font_file(URL{"resource:elusiveicons-webfont.ttf"});
-            register_font_file(URL{"resource:hikogui_icons.ttf"});
-            register_font_directories(font_dirs());
-
-            register_theme_directories(theme_dirs());
-
-            try {
-                load_system_keyboard_bindings(URL{"resource:win32.keybinds.json"});
-            } catch (std::exception const& e) {
-                hi_log_fatal("Could not load keyboard bindings. \"{}\"", e.what());
-            }
-
-            _first_window = true;
+        if (not os_settings::start_subsystem()) {
+            hi_log_fatal("Could not start the os_settings subsystem.");
         }
+        register_resources();
 
         SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
-        _widget->set_window(this);
-
-        // Execute a constraint check to determine initial window size.
-        theme = get_selected_theme().transform(dpi);
-
-        _widget_constraints = _widget->update_constraints();
-        hilet new_size = _widget_constraints.preferred;
-
-        // Reset the keyboard target to not focus anything.
-        update_keyboard_target({});
+        // Determine the initial window size from the constraints of the widgets.
+        hilet new_size = attach_widget().preferred;
 
         // For changes in setting on the OS we should reconstrain/layout/redraw the window
         // For example when the language or theme changes.
         _setting_change_cbt = os_settings::subscribe(
             [this] {
                 ++global_counter<"gui_window:os_setting:constrain">;
-                this->process_event({gui_event_type::window_reconstrain});
-            },
-            callback_flags::main);
-
-        // Subscribe on theme changes.
-        _selected_theme_cbt = theme_book::global().selected_theme.subscribe(
-            [this](auto...) {
-                ++global_counter<"gui_window:selected_theme:constrain">;
-                this->process_event({gui_event_type::window_reconstrain});
+                reconstrain_all();
             },
             callback_flags::main);
 
@@ -170,17 +85,6 @@ public:
         }
     }
 
-    template<typename Widget>
-    [[nodiscard]] Widget& widget() const noexcept
-    {
-        return up_cast<Widget>(*_widget);
-    }
-
-    void set_title(label title) noexcept
-    {
-        _title = std::move(title);
-    }
-
     /** Update window.
      * This will update animations and redraw all widgets managed by this window.
      */
@@ -197,21 +101,29 @@ public:
         hi_assert_not_null(surface);
         hi_assert_not_null(_widget);
 
-        // When a widget requests it or a window-wide event like language change
-        // has happened all the widgets will be set_constraints().
-        auto need_reconstrain = _reconstrain.exchange(false, std::memory_order_relaxed);
+        // When a window-wide event like language change has happened all the
+        // widgets will be reconstrained.
+        auto need_reconstrain_all = std::exchange(_reconstrain_all, false);
 
 #if 0
         // For performance checks force reconstrain.
-        need_reconstrain = true;
+        need_reconstrain_all = true;
 #endif
 
+        if (need_reconstrain_all) {
+            theme = get_selected_theme().transform(dpi);
+
+            discard_retained_recursive(*_widget);
+            ++_widget_generation;
+        }
+
+        // Only the widgets that requested a reconstrain, and their parents,
+        // will have their constraints updated.
+        hilet need_reconstrain = _widget->constraints_dirty();
         if (need_reconstrain) {
             hilet t2 = trace<"window::constrain">();
 
-            theme = get_selected_theme().transform(dpi);
-
-            _widget_constraints = _widget->update_constraints();
+            _widget_constraints = _widget->update_constraints_retained();
         }
 
         // Check if the window size matches the preferred size of the window_widget.
@@ -253,7 +165,9 @@ public:
         surface->update(rectangle.size());
 
         // Make sure the widget's layout is updated before draw, but after window resize.
-        auto need_relayout = _relayout.exchange(false, std::memory_order_relaxed);
+        // Only the widgets that requested a relayout, or whose rectangle changed, will
+        // have their layout updated.
+        auto need_relayout = _widget->layout_dirty();
 
 #if 0
         // For performance checks force relayout.
@@ -262,28 +176,33 @@ public:
 
         if (need_reconstrain or need_relayout or widget_size != rectangle.size()) {
             hilet t2 = trace<"window::layout">();
+
+            // Each widget whose layout is updated requests a redraw of its old and new rectangle.
+            // Only when the window changes size, or when all widgets were reconstrained, is the
+            // complete window redrawn.
+            if (need_reconstrain_all or widget_size != rectangle.size()) {
+                _redraw_region = aarectangle{rectangle.size()};
+            }
             widget_size = rectangle.size();
 
             // Guarantee that the layout size is always at least the minimum size.
             // We do this because it simplifies calculations if no minimum checks are necessary inside widget.
             hilet widget_layout_size = max(_widget_constraints.minimum, widget_size);
-            _widget->set_layout(widget_layout{widget_layout_size, _size_state, subpixel_orientation(), display_time_point});
-
-            // After layout do a complete redraw.
-            _redraw_rectangle = aarectangle{widget_size};
+            _widget->set_layout_retained(widget_layout{widget_layout_size, _size_state, subpixel_orientation(), display_time_point});
         }
 
 #if 0
         // For performance checks force redraw.
-        _redraw_rectangle = aarectangle{widget_size};
+        _redraw_region = aarectangle{widget_size};
 #endif
 
-        // Draw widgets if the _redraw_rectangle was set.
-        if (auto draw_context = surface->render_start(_redraw_rectangle)) {
-            _redraw_rectangle = aarectangle{};
+        // Draw widgets if the _redraw_region was set.
+        if (auto draw_context = surface->render_start(_redraw_region)) {
+            _redraw_region.clear();
             draw_context.display_time_point = display_time_point;
             draw_context.subpixel_orientation = subpixel_orientation();
             draw_context.active = active;
+            draw_context.generation = _widget_generation;
 
             switch (_animated_active.update(active ? 1.0f : 0.0f, display_time_point)) {
             case animator_state::idle:
@@ -311,7 +230,7 @@ public:
 
     /** Set the mouse cursor icon.
      */
-    void set_cursor(mouse_cursor cursor) noexcept
+    void set_cursor(mouse_cursor cursor) noexcept override
     {
         hi_axiom(loop::main().on_thread());
 
@@ -353,7 +272,7 @@ public:
 
     /** Ask the operating system to close this window.
      */
-    void close_window()
+    void close_window() override
     {
         hi_axiom(loop::main().on_thread());
         if (not PostMessageW(win32Window, WM_CLOSE, 0, 0)) {
@@ -366,7 +285,7 @@ public:
      * This function is used to change the size of the window to one
      * of the predefined states: normal, minimized, maximized or full-screen.
      */
-    void set_size_state(gui_window_size state) noexcept
+    void set_size_state(gui_window_size state) noexcept override
     {
         hi_axiom(loop::main().on_thread());
 
@@ -486,14 +405,7 @@ public:
         return aarectangle{left, inv_bottom, width, height};
     }
 
-    /** Get the size-state of the window.
-     */
-    gui_window_size size_state() const noexcept
-    {
-        return _size_state;
-    }
-
-    [[nodiscard]] hi::subpixel_orientation subpixel_orientation() const noexcept
+    [[nodiscard]] hi::subpixel_orientation subpixel_orientation() const noexcept override
     {
         // The table for viewing distance are:
         //
@@ -520,7 +432,7 @@ public:
      *
      * On windows 10 this is activated by pressing Alt followed by Spacebar.
      */
-    void open_system_menu()
+    void open_system_menu() override
     {
         hi_axiom(loop::main().on_thread());
 
@@ -542,7 +454,7 @@ public:
 
     /** Ask the operating system to set the size of this window.
      */
-    void set_window_size(extent2 new_extent)
+    void set_window_size(extent2 new_extent) override
     {
         hi_axiom(loop::main().on_thread());
 
@@ -567,108 +479,6 @@ public:
             SWP_NOACTIVATE | SWP_NOOWNERZORDER | SWP_NOREDRAW | SWP_DEFERERASE | SWP_NOCOPYBITS | SWP_FRAMECHANGED);
     }
 
-    void update_mouse_target(widget_id new_target_id, point2 position = {}) noexcept
-    {
-        hi_axiom(loop::main().on_thread());
-
-        if (_mouse_target_id != 0) {
-            if (new_target_id == _mouse_target_id) {
-                // Focus does not change.
-                return;
-            }
-
-            // The mouse target needs to be updated, send exit to previous target.
-            send_events_to_widget(_mouse_target_id, std::vector{gui_event{gui_event_type::mouse_exit}});
-        }
-
-        if (new_target_id != 0) {
-            _mouse_target_id = new_target_id;
-            send_events_to_widget(new_target_id, std::vector{gui_event::make_mouse_enter(position)});
-        } else {
-            _mouse_target_id = {};
-        }
-    }
-
-    /** Change the keyboard focus to the given widget.
-     * If the group of the widget is incorrect then no widget will be in focus.
-     *
-     * @param widget The new widget to focus, or empty to remove all keyboard focus.
-     * @param group The group the widget must belong to.
-     */
-    void update_keyboard_target(widget_id new_target_id, keyboard_focus_group group = keyboard_focus_group::normal) noexcept
-    {
-        hi_axiom(loop::main().on_thread());
-
-        auto new_target_widget = get_if(_widget.get(), new_target_id, false);
-
-        // Before we are going to make new_target_widget empty, due to the rules below;
-        // capture which parents there are.
-        auto new_target_parent_chain = new_target_widget ? new_target_widget->parent_chain() : std::vector<widget_id>{};
-
-        // If the new target widget does not accept focus, for example when clicking
-        // on a disabled widget, or empty part of a window.
-        // In that case no widget will get focus.
-        if (new_target_widget == nullptr or not new_target_widget->accepts_keyboard_focus(group)) {
-            new_target_widget = nullptr;
-        }
-
-        if (auto const *const keyboard_target_widget = get_if(_widget.get(), _keyboard_target_id, false)) {
-            // keyboard target still exists and visible.
-            if (new_target_widget == keyboard_target_widget) {
-                // Focus does not change.
-                return;
-            }
-
-            send_events_to_widget(_keyboard_target_id, std::vector{gui_event{gui_event_type::keyboard_exit}});
-        }
-
-        // Tell "escape" to all the widget that are not parents of the new widget
-        _widget->handle_event_recursive(gui_event_type::gui_cancel, new_target_parent_chain);
-
-        // Tell the new widget that keyboard focus was entered.
-        if (new_target_widget != nullptr) {
-            _keyboard_target_id = new_target_widget->id;
-            send_events_to_widget(_keyboard_target_id, std::vector{gui_event{gui_event_type::keyboard_enter}});
-        } else {
-            _keyboard_target_id = {};
-        }
-    }
-
-    /** Change the keyboard focus to the previous or next widget from the given widget.
-     * This function will find the closest widget from the given widget which belongs to the given
-     * group; if none is found, or if the original selected widget is found, then no widget will be in focus.
-     *
-     * @param start_widget The widget to use as the start point for a new widget to select.
-     * @param group The group the widget must belong to.
-     * @param direction The direction to search in, or current to select the current widget.
-     */
-    void update_keyboard_target(widget_id start_widget, keyboard_focus_group group, keyboard_focus_direction direction) noexcept
-    {
-        hi_axiom(loop::main().on_thread());
-
-        if (auto tmp = _widget->find_next_widget(start_widget, group, direction); tmp != start_widget) {
-            update_keyboard_target(tmp, group);
-
-        } else if (group == keyboard_focus_group::normal) {
-            // Could not find a next widget, loop around.
-            // menu items should not loop back.
-            tmp = _widget->find_next_widget({}, group, direction);
-            update_keyboard_target(tmp, group);
-        }
-    }
-
-    /** Change the keyboard focus to the given, previous or next widget.
-     * This function will find the closest widget from the current widget which belongs to the given
-     * group; if none is found, or if the original selected widget is found, then no widget will be in focus.
-     *
-     * @param group The group the widget must belong to.
-     * @param direction The direction to search in, or current to select the current widget.
-     */
-    void update_keyboard_target(keyboard_focus_group group, keyboard_focus_direction direction) noexcept
-    {
-        return update_keyboard_target(_keyboard_target_id, group, direction);
-    }
-
     /** Get text from the clipboard.
      *
      * @note This is part of the window as some operating systems need to know from which window the text was posted.
@@ -676,7 +486,7 @@ public:
      * @retval empty When the clipboard is locked by another application, on error, if the data on the clipboard can not
      *               be converted to text or if the clipboard is empty.
      */
-    [[nodiscard]] std::optional<gstring> get_text_from_clipboard() const noexcept
+    [[nodiscard]] std::optional<gstring> get_text_from_clipboard() const noexcept override
     {
         if (not OpenClipboard(win32Window)) {
             // Another application could have the clipboard locked.
@@ -735,7 +545,7 @@ public:
      * @note This is part of the window as some operating systems need to know from which window the text was posted.
      * @param text The text to place on the clipboard.
      */
-    void put_text_on_clipboard(gstring_view text) const noexcept
+    void put_text_on_clipboard(gstring_view text) const noexcept override
     {
         if (not OpenClipboard(win32Window)) {
             // Another application could have the clipboard locked.
@@ -791,168 +601,15 @@ public:
         }
     }
 
-    [[nodiscard]] translate2 window_to_screen() const noexcept
-    {
-        return translate2{rectangle.left(), rectangle.bottom()};
-    }
-
-    [[nodiscard]] translate2 screen_to_window() const noexcept
-    {
-        return ~window_to_screen();
-    }
-
-    /** Process the event.
-     *
-     * This is called by the event handler to start processing events.
-     * The events are translated and then uses `send_event_to_widget()` to send the
-     * events to the widgets in some priority ordering.
-     *
-     * It may also be called from within the `event_handle()` of widgets.
-     */
-    bool process_event(gui_event event) noexcept
-    {
-        using enum gui_event_type;
-
-        hi_axiom(loop::main().on_thread());
-
-        switch (event.type()) {
-        case window_redraw:
-            _redraw_rectangle.fetch_or(event.rectangle());
-            return true;
-
-        case window_relayout:
-            _relayout.store(true, std::memory_order_relaxed);
-            return true;
-
-        case window_reconstrain:
-            _reconstrain.store(true, std::memory_order_relaxed);
-            return true;
-
-        case window_resize:
-            _resize.store(true, std::memory_order_relaxed);
-            return true;
-
-        case window_minimize:
-            set_size_state(gui_window_size::minimized);
-            return true;
-
-        case window_maximize:
-            set_size_state(gui_window_size::maximized);
-            return true;
-
-        case window_normalize:
-            set_size_state(gui_window_size::normal);
-            return true;
-
-        case window_close:
-            close_window();
-            return true;
-
-        case window_open_sysmenu:
-            open_system_menu();
-            return true;
-
-        case window_set_keyboard_target:
-            {
-                hilet& target = event.keyboard_target();
-                if (target.widget_id == 0) {
-                    update_keyboard_target(target.group, target.direction);
-                } else if (target.direction == keyboard_focus_direction::here) {
-                    update_keyboard_target(target.widget_id, target.group);
-                } else {
-                    update_keyboard_target(target.widget_id, target.group, target.direction);
-                }
-            }
-            return true;
-
-        case window_set_clipboard:
-            put_text_on_clipboard(event.clipboard_data());
-            return true;
-
-        case mouse_exit_window: // Mouse left window.
-            update_mouse_target({});
-            break;
-
-        case mouse_up:
-        case mouse_drag:
-        case mouse_down:
-        case mouse_move:
-            event.mouse().hitbox = _widget->hitbox_test(event.mouse().position);
-            if (event == mouse_down or event == mouse_move) {
-                update_mouse_target(event.mouse().hitbox.widget_id, event.mouse().position);
-            }
-            if (event == mouse_down) {
-                update_keyboard_target(event.mouse().hitbox.widget_id, keyboard_focus_group::all);
-            }
-            break;
-
-        default:;
-        }
-
-        // Translate keyboard events, using the keybindings.
-        auto events = std::vector<gui_event>{event};
-        if (event.type() == keyboard_down) {
-            for (auto& e : translate_keyboard_event(event)) {
-                events.push_back(e);
-            }
-        }
-
-        for (auto& event_ : events) {
-            if (event_.type() == gui_event_type::text_edit_paste) {
-                // The text-edit-paste operation was generated by keyboard bindings,
-                // it needs the actual text to be pasted added.
-                if (auto optional_text = get_text_from_clipboard()) {
-                    event_.clipboard_data() = *optional_text;
-                }
-            }
-        }
-
-        // Send the event to the correct widget.
-        hilet handled = send_events_to_widget(
-            events.front().variant() == gui_event_variant::mouse ? _mouse_target_id : _keyboard_target_id, events);
-
-        // Intercept the keyboard generated escape.
-        // A keyboard generated escape should always remove keyboard focus.
-        // The update_keyboard_target() function will send gui_keyboard_exit and a
-        // potential duplicate gui_cancel messages to all widgets that need it.
-        for (hilet event_ : events) {
-            if (event_ == gui_cancel) {
-                update_keyboard_target({}, keyboard_focus_group::all);
-            }
-        }
-
-        return handled;
-    }
-
 private:
     constexpr static UINT_PTR move_and_resize_timer_id = 2;
     constexpr static std::chrono::nanoseconds _animation_duration = std::chrono::milliseconds(150);
 
-    inline static bool _first_window = true;
     inline static const wchar_t *win32WindowClassName = nullptr;
     inline static WNDCLASSW win32WindowClass = {};
     inline static bool win32WindowClassIsRegistered = false;
     inline static bool firstWindowHasBeenOpened = false;
 
-    /** The label of the window that is passed to the operating system.
-     */
-    label _title;
-
-    /** The widget covering the complete window.
-     */
-    std::unique_ptr<widget_intf> _widget;
-
-    box_constraints _widget_constraints = {};
-
-    std::atomic<aarectangle> _redraw_rectangle = aarectangle{};
-    std::atomic<bool> _relayout = false;
-    std::atomic<bool> _reconstrain = false;
-    std::atomic<bool> _resize = false;
-
-    /** Current size state of the window.
-     */
-    gui_window_size _size_state = gui_window_size::normal;
-
     /** When the window is minimized, maximized or made full-screen the original size is stored here.
      */
     aarectangle _restore_rectangle;
@@ -970,17 +627,6 @@ private:
      */
     animator<float> _animated_active = _animation_duration;
 
-    /** Target of the mouse
-     * Since any mouse event will change the target this is used
-     * to check if the target has changed, to send exit events to the previous mouse target.
-     */
-    widget_id _mouse_target_id;
-
-    /** Target of the keyboard
-     * widget where keyboard events are sent to.
-     */
-    widget_id _keyboard_target_id;
-
     TRACKMOUSEEVENT track_mouse_leave_event_parameters;
     bool tracking_mouse_leave_event = false;
     char32_t high_surrogate = 0;
@@ -992,40 +638,8 @@ private:
     bool keymenu_pressed = false;
 
     callback<void()> _setting_change_cbt;
-    callback<void(std::string)> _selected_theme_cbt;
     callback<void(utc_nanoseconds)> _render_cbt;
 
-    /** Send event to a target widget.
-     *
-     * The commands are send in order, until the command is handled, then processing stops immediately.
-     * All commands are tried in a batch to the following handlers:
-     *  - The target widget
-     *  - The parents of the widget up to and including the root widget.
-     *  - The window itself.
-     */
-    bool send_events_to_widget(widget_id target_id, std::vector<gui_event> const& events) noexcept
-    {
-        if (target_id == 0) {
-            // If there was no target, send the event to the window's widget.
-            target_id = _widget->id;
-        }
-
-        auto target_widget = get_if(_widget.get(), target_id, false);
-        while (target_widget) {
-            // Each widget will try to handle the first event it can.
-            for (hilet& event : events) {
-                if (target_widget->handle_event(target_widget->layout().from_window * event)) {
-                    return true;
-                }
-            }
-
-            // Forward the events to the parent of the target.
-            target_widget = target_widget->parent;
-        }
-
-        return false;
-    }
-
     void setOSWindowRectangleFromRECT(RECT new_rectangle) noexcept
     {
         hi_axiom(loop::main().on_thread());
@@ -1519,7 +1133,7 @@ private:
                 hi_log_error("Unknown WM_ACTIVE value.");
             }
             ++global_counter<"gui_window:WM_ACTIVATE:constrain">;
-            this->process_event({gui_event_type::window_reconstrain});
+            reconstrain_all();
             break;
 
         case WM_GETMINMAXINFO:
@@ -1714,7 +1328,7 @@ private:
                     new_rectangle->bottom - new_rectangle->top,
                     SWP_NOZORDER | SWP_NOACTIVATE);
                 ++global_counter<"gui_window:WM_DPICHANGED:constrain">;
-                this->process_event({gui_event_type::window_reconstrain});
+                reconstrain_all();
 
                 hi_log_info("DPI has changed to {}", dpi);
             }
@@ -12,11 +12,37 @@
 #include "../coroutine/coroutine.hpp"
 #include "../macros.hpp"
 #include <coroutine>
+#include <vector>
+#include <utility>
+#include <limits>
+#include <memory>
 
 hi_export_module(hikogui.GUI : widget_intf);
 
 hi_export namespace hi { inline namespace v1 {
-class gui_window;
+class gui_window_base;
+class widget_intf;
+
+namespace detail {
+
+/** All widgets indexed by their widget_id.
+ *
+ * The ids of widgets are small integers that are reused after a widget is
+ * destroyed, this allows a widget to be found in constant time.
+ *
+ * @note Widgets are created and destroyed on the main thread.
+ */
+hi_inline std::vector<widget_intf *> widget_registry;
+
+/** Incremented each time the visibility of a widget changes.
+ *
+ * Each widget caches whether it and its parents are visible, and containers
+ * like grid_widget cache which children may be hit by the mouse; these caches
+ * are valid as long as the generation is unchanged.
+ */
+hi_inline std::size_t widget_visibility_generation = 0;
+
+}
 
 class widget_intf {
 public:
@@ -31,16 +57,31 @@ public:
      */
     widget_intf *parent = nullptr;
 
+    /** Pointer to the top level widget of the tree.
+     * The parent of a widget never changes, so this is set once by the constructor.
+     */
+    widget_intf *top = nullptr;
+
     /** Notifier which is called after an action is completed by a widget.
      */
     hi::notifier<void()> notifier;
 
     virtual ~widget_intf()
     {
+        detail::widget_registry[std::to_underlying(id)] = nullptr;
         release_widget_id(id);
     }
 
-    widget_intf(widget_intf const *parent) noexcept : id(make_widget_id()), parent(const_cast<widget_intf *>(parent)) {}
+    widget_intf(widget_intf const *parent) noexcept : id(make_widget_id()), parent(const_cast<widget_intf *>(parent))
+    {
+        hilet index = std::to_underlying(id);
+        if (index >= detail::widget_registry.size()) {
+            detail::widget_registry.resize(index + 1, nullptr);
+        }
+        detail::widget_registry[index] = this;
+
+        top = this->parent ? this->parent->top : this;
+    }
 
     /** Subscribe a callback to be called when an action is completed by the widget.
     */
@@ -62,19 +103,51 @@ public:
      * @param window A pointer to the window that will own this tree of widgets.
      *               or nullptr if the window must be removed.
      */
-    virtual void set_window(gui_window *window) noexcept = 0;
+    virtual void set_window(gui_window_base *window) noexcept = 0;
 
     /** Get the window that the widget is owned by.
      *
      * @return window The window that owns this tree of widgets. Or nullptr
      *                if this tree of widgets is not owned by a window.
      */
-    [[nodiscard]] virtual gui_window *window() const noexcept = 0;
+    [[nodiscard]] virtual gui_window_base *window() const noexcept = 0;
 
     /** Get a list of child widgets.
      */
     [[nodiscard]] virtual generator<widget_intf&> children(bool include_invisible) noexcept = 0;
 
+    /** Check if the widget is visible.
+     *
+     * An implementation must call `visibility_changed()` each time the value
+     * returned by this function changes.
+     *
+     * @return True if the widget would be listed by its parent's `children(false)`.
+     */
+    [[nodiscard]] virtual bool visible() const noexcept = 0;
+
+    /** Invalidate the cached visibility of every widget.
+     */
+    static void visibility_changed() noexcept
+    {
+        ++detail::widget_visibility_generation;
+    }
+
+    /** Check if the widget and each of its parents are visible.
+     *
+     * The result is cached until the visibility of any widget changes, the
+     * cache of the parents is reused, so that repeated calls are constant time.
+     *
+     * @return True if the widget and each of its parents, except the top level widget, are visible.
+     */
+    [[nodiscard]] bool visible_below_top() const noexcept
+    {
+        if (_visibility_generation != detail::widget_visibility_generation) {
+            _visible_below_top = parent == nullptr or (visible() and parent->visible_below_top());
+            _visibility_generation = detail::widget_visibility_generation;
+        }
+        return _visible_below_top;
+    }
+
     /** Get a list of child widgets.
      */
     [[nodiscard]] virtual generator<widget_intf const&> children(bool include_invisible) const noexcept final
@@ -97,6 +170,30 @@ public:
      */
      [[nodiscard]] virtual box_constraints update_constraints() noexcept = 0;
 
+    /** Update the constraints of the widget, or return the constraints of a previous call.
+     *
+     * The constraints are only updated when the widget, or one of its children,
+     * requested a reconstrain since the previous call.
+     *
+     * Container widgets should call this function on their children instead
+     * of `update_constraints()`.
+     *
+     * @return The constraints of the widget.
+     */
+    [[nodiscard]] box_constraints const& update_constraints_retained() noexcept
+    {
+        if (_constraints_dirty) {
+            // Clear the flag first, so that a reconstrain requested while
+            // updating the constraints is handled on the next frame.
+            _constraints_dirty = false;
+            _layout_dirty = true;
+            _retained_constraints = update_constraints();
+        } else {
+            ++global_counter<"widget:constrain:retained">;
+        }
+        return _retained_constraints;
+    }
+
     /** Update the internal layout of the widget.
      * This function is called when the size of this widget must change, or if any of the
      * widget request a re-layout.
@@ -110,6 +207,48 @@ public:
      */
     virtual void set_layout(widget_layout const& context) noexcept = 0;
 
+    /** Update the layout of the widget, unless it is unchanged since a previous call.
+     *
+     * The layout is only updated when the widget, or one of its children,
+     * requested a relayout or reconstrain, or when @a context is different
+     * from the previous call.
+     *
+     * Container widgets should call this function on their children instead
+     * of `set_layout()`.
+     *
+     * @param context The layout for this child.
+     */
+    void set_layout_retained(widget_layout const& context) noexcept
+    {
+        if (_layout_dirty or not same_except_time(_retained_context, context)) {
+            // Clear the flag first, so that a relayout requested while
+            // updating the layout is handled on the next frame.
+            _layout_dirty = false;
+            _retained_context = context;
+
+            // Redraw both where the widget was and where it will be.
+            request_redraw();
+            set_layout(context);
+            request_redraw();
+        } else {
+            ++global_counter<"widget:layout:retained">;
+        }
+    }
+
+    /** Check if the constraints of the widget need to be updated.
+     */
+    [[nodiscard]] bool constraints_dirty() const noexcept
+    {
+        return _constraints_dirty;
+    }
+
+    /** Check if the layout of the widget needs to be updated.
+     */
+    [[nodiscard]] bool layout_dirty() const noexcept
+    {
+        return _layout_dirty or _constraints_dirty;
+    }
+
     /** Get the current layout for this widget.
      */
     virtual widget_layout const& layout() const noexcept = 0;
@@ -130,6 +269,95 @@ public:
      */
     virtual void draw(draw_context const& context) noexcept = 0;
 
+    /** Draw the widget, or replay the vertices it drew on a previous frame.
+     *
+     * The vertices drawn by `draw()` are retained. They are replayed on the
+     * next frame when the widget did not request a redraw, relayout or
+     * reconstrain since, and its layout only moved.
+     *
+     * The vertices of the child widgets are retained by the children
+     * themselves, the retained vertices of this widget refer to them.
+     *
+     * Container widgets should call this function on their children instead
+     * of `draw()`.
+     *
+     * @param context The context to where the widget will draw.
+     */
+    void draw_retained(draw_context const& context) noexcept
+    {
+        hilet& layout_ = layout();
+        hilet start = context.mark();
+
+        if (_retained_vertices and _retained_version == _draw_version and same_except_translation(_retained_layout, layout_)) {
+            hilet offset = layout_.to_window * point2{} - _retained_layout.to_window * point2{};
+            if (context.replay(*_retained_vertices, offset)) {
+                context.add_recording(_retained_vertices, start, offset);
+                ++global_counter<"widget:draw:replay">;
+                return;
+            }
+        }
+
+        // Reuse the recording, unless the recording of a parent still refers to it.
+        if (not _retained_vertices or _retained_vertices.use_count() != 1) {
+            _retained_vertices = std::make_shared<draw_recording>();
+        }
+
+        hilet version = _draw_version;
+        hilet recording_context = context.start_recording(*_retained_vertices);
+        draw(recording_context);
+
+        // Only retain the vertices when the widget was completely drawn
+        // and did not request to be redrawn while drawing.
+        hilet clipping_rectangle = layout_.clipping_rectangle_on_window();
+        if (version == _draw_version and context.redraw_region.contains(clipping_rectangle)) {
+            recording_context.finish_recording();
+            context.add_recording(_retained_vertices, start, vector2{});
+            _retained_layout = layout_;
+            _retained_version = version;
+        } else {
+            // The vertices become part of the recording of the parent.
+            _retained_vertices->clear();
+            _retained_version = std::numeric_limits<std::size_t>::max();
+        }
+    }
+
+    /** Discard the vertices retained by `draw_retained()`.
+     *
+     * This is called when the widget, or one of its children, needs to be
+     * drawn again.
+     */
+    void discard_retained_draw() const noexcept
+    {
+        ++_draw_version;
+    }
+
+    /** Discard what is retained by the widget, as requested by an event.
+     *
+     * This is called by `process_event()` while the event bubbles up
+     * to the window, so that the widget and each of its parents are updated
+     * on the next frame:
+     *  - `gui_event_type::window_reconstrain`: constraints, layout and vertices.
+     *  - `gui_event_type::window_relayout`: layout and vertices.
+     *  - `gui_event_type::window_redraw`: vertices.
+     *
+     * @param event The event that is being processed.
+     */
+    void discard_retained(gui_event const& event) const noexcept
+    {
+        switch (event.type()) {
+        case gui_event_type::window_reconstrain:
+            _constraints_dirty = true;
+            [[fallthrough]];
+        case gui_event_type::window_relayout:
+            _layout_dirty = true;
+            [[fallthrough]];
+        case gui_event_type::window_redraw:
+            discard_retained_draw();
+            break;
+        default:;
+        }
+    }
+
     /** Find the widget that is under the mouse cursor.
      * This function will recursively test with visual child widgets, when
      * widgets overlap on the screen the hitbox object with the highest elevation is returned.
@@ -219,21 +447,147 @@ public:
     {
         scroll_to_show(layout().rectangle());
     }
+
+private:
+    /** The constraints need to be updated by `update_constraints_retained()`.
+     */
+    mutable bool _constraints_dirty = true;
+
+    /** The layout needs to be updated by `set_layout_retained()`.
+     */
+    mutable bool _layout_dirty = true;
+
+    /** The value of `detail::widget_visibility_generation` when `_visible_below_top` was cached.
+     */
+    mutable std::size_t _visibility_generation = std::numeric_limits<std::size_t>::max();
+
+    /** The cached result of `visible_below_top()`.
+     */
+    mutable bool _visible_below_top = false;
+
+    /** The constraints returned by the last call to `update_constraints()`.
+     */
+    box_constraints _retained_constraints;
+
+    /** The context passed to the last call to `set_layout()`.
+     */
+    widget_layout _retained_context;
+
+    /** Incremented each time the retained vertices are discarded.
+     */
+    mutable std::size_t _draw_version = 0;
+
+    /** The value of `_draw_version` when the vertices were retained.
+     */
+    std::size_t _retained_version = std::numeric_limits<std::size_t>::max();
+
+    /** The layout of the widget when the vertices were retained.
+     */
+    widget_layout _retained_layout;
+
+    /** The vertices retained from the previous draw.
+     *
+     * The recording is shared with the recording of the parent widget.
+     */
+    std::shared_ptr<draw_recording> _retained_vertices;
+
+    /** Check if two layouts only differ in their position on the window.
+     */
+    [[nodiscard]] static bool same_except_translation(widget_layout const& lhs, widget_layout rhs) noexcept
+    {
+        rhs.to_parent = lhs.to_parent;
+        rhs.from_parent = lhs.from_parent;
+        rhs.to_window = lhs.to_window;
+        rhs.from_window = lhs.from_window;
+        rhs.display_time_point = lhs.display_time_point;
+        return lhs == rhs;
+    }
+
+    /** Check if two layouts only differ in the time they were made for.
+     */
+    [[nodiscard]] static bool same_except_time(widget_layout const& lhs, widget_layout rhs) noexcept
+    {
+        rhs.display_time_point = lhs.display_time_point;
+        return lhs == rhs;
+    }
 };
 
+/** Check if a widget is a descendant of another widget.
+ *
+ * @param widget The widget to check.
+ * @param ancestor The potential ancestor of the widget.
+ * @param include_invisible If false, the widget and each parent up to the ancestor must be visible.
+ * @return True if @a ancestor is @a widget, or one of its parents.
+ */
+[[nodiscard]] hi_inline bool is_descendant(widget_intf const& widget, widget_intf const& ancestor, bool include_invisible) noexcept
+{
+    if (ancestor.parent == nullptr) {
+        // Searching the whole tree of a window, as done for each event, is constant time.
+        return widget.top == std::addressof(ancestor) and (include_invisible or widget.visible_below_top());
+    }
+
+    for (auto w = std::addressof(widget); w != nullptr; w = w->parent) {
+        if (w == std::addressof(ancestor)) {
+            return true;
+        }
+        if (not include_invisible and not w->visible()) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/** Discard the retained constraints, layout and vertices of a widget and all its descendants.
+ *
+ * This is used for window-wide changes, such as a change of theme or language,
+ * which change the constraints of every widget.
+ *
+ * @param widget The top of the tree of widgets.
+ */
+hi_inline void discard_retained_recursive(widget_intf& widget) noexcept
+{
+    widget.discard_retained(gui_event_type::window_reconstrain);
+    for (auto& child : widget.children(true)) {
+        discard_retained_recursive(child);
+    }
+}
+
+/** Get the area where the mouse may hit a widget or any of its children.
+ *
+ * @param widget The widget, which must have been laid out.
+ * @return The bounding rectangle in the widget's coordinate system.
+ */
+[[nodiscard]] hi_inline aarectangle hitbox_bounds(widget_intf const& widget) noexcept
+{
+    hilet& layout = widget.layout();
+    auto r = intersect(layout.rectangle(), layout.clipping_rectangle);
+    for (hilet& child : widget.children(false)) {
+        r |= child.layout().to_parent * hitbox_bounds(child);
+    }
+    return r;
+}
+
+/** Find a widget by its id.
+ *
+ * @param start The widget to start searching from.
+ * @param id The id of the widget to find.
+ * @param include_invisible Also find widgets that are invisible.
+ * @return The widget with @a id which is @a start or a descendant of @a start, or nullptr if not found.
+ */
 hi_inline widget_intf *get_if(widget_intf *start, widget_id id, bool include_invisible) noexcept
 {
     hi_assert_not_null(start);
 
-    if (start->id == id) {
-        return start;
+    hilet index = std::to_underlying(id);
+    if (index >= detail::widget_registry.size()) {
+        return nullptr;
     }
-    for (auto& child : start->children(include_invisible)) {
-        if (hilet r = get_if(&child, id, include_invisible); r != nullptr) {
-            return r;
-        }
+
+    hilet r = detail::widget_registry[index];
+    if (r == nullptr or not is_descendant(*r, *start, include_invisible)) {
+        return nullptr;
     }
-    return nullptr;
+    return r;
 }
 
 hi_inline widget_intf& get(widget_intf& start, widget_id id, bool include_invisible)
@@ -148,6 +148,13 @@ public:
     weak_callback(std::shared_ptr<base_impl_type> other) noexcept : _impl(std::move(other)) {}
     weak_callback(callback<R(Args...)> const& other) noexcept;
 
+    /** Check if both weak_callbacks refer to the same callback object.
+     */
+    [[nodiscard]] friend bool operator==(weak_callback const& lhs, weak_callback const& rhs) noexcept
+    {
+        return lhs._impl == rhs._impl;
+    }
+
     /** Check if the callback object is expired.
      *
      * @retval false The callback object is functioning.
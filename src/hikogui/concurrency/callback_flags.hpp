@@ -29,6 +29,10 @@ enum class callback_flags {
      */
     timer = 0x03,
 
+    /** Call the function asynchronously from one of the threads of the thread pool.
+     */
+    pool = 0x04,
+
     /** Call the function once, then automatically unsubscribe.
      */
     once = 0x1'00,
@@ -65,4 +69,9 @@ enum class callback_flags {
     return to_bool((std::to_underlying(rhs) & 0xff) == std::to_underlying(callback_flags::timer));
 }
 
+[[nodiscard]] constexpr bool is_pool(callback_flags const& rhs) noexcept
+{
+    return to_bool((std::to_underlying(rhs) & 0xff) == std::to_underlying(callback_flags::pool));
+}
+
 }
@@ -36,7 +36,24 @@ public:
      */
     constexpr rcu(allocator_type allocator = allocator_type{}) noexcept : _allocator(allocator) {}
 
-    ~rcu() = default;
+    /** Destroy the rcu object.
+     *
+     * @note There must be no readers left.
+     */
+    ~rcu()
+    {
+        hi_axiom(not _idle_count.is_locked());
+
+        if (auto *const ptr = _ptr.exchange(nullptr, std::memory_order::acquire)) {
+            std::allocator_traits<allocator_type>::destroy(_allocator, ptr);
+            std::allocator_traits<allocator_type>::deallocate(_allocator, ptr, 1);
+        }
+        for (auto [old_version, old_ptr] : _old_ptrs) {
+            std::allocator_traits<allocator_type>::destroy(_allocator, old_ptr);
+            std::allocator_traits<allocator_type>::deallocate(_allocator, old_ptr, 1);
+        }
+    }
+
     rcu(rcu const&) = delete;
     rcu(rcu&&) = delete;
     rcu& operator=(rcu const&) = delete;
@@ -238,8 +255,10 @@ public:
         _old_ptrs.emplace_back(old_version, old_ptr);
 
         // Destroy all objects from previous idle-count versions.
+        // The idle-count wraps around, but a different idle-count always means
+        // that the critical section was idle after the object was exchanged.
         auto it = _old_ptrs.begin();
-        while (it != _old_ptrs.end() and it->first < new_version) {
+        while (it != _old_ptrs.end() and it->first != new_version) {
             std::allocator_traits<allocator_type>::destroy(_allocator, it->second);
             std::allocator_traits<allocator_type>::deallocate(_allocator, it->second, 1);
             ++it;
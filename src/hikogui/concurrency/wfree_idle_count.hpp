@@ -31,8 +31,8 @@ hi_export namespace hi::inline v1 {
  *
  * ... wait some time ...
  * 
- * auto new_version = idle_count.expanded_version(version);
- * if (new_version > old_version) {
+ * auto new_version = idle_count.version();
+ * if (new_version != old_version) {
  *   // All threads now see the new data.
  *   ... Delete old data ...
  * }
@@ -53,7 +53,7 @@ public:
      */
     [[nodiscard]] hi_force_inline bool is_locked() const noexcept
     {
-        return to_bool(_lock_count.load(std::memory_order::relaxed));
+        return to_bool(_state.load(std::memory_order::relaxed) & count_mask);
     }
 
     /** Start the critical section.
@@ -62,8 +62,8 @@ public:
      */
     hi_force_inline void lock() noexcept
     {
-        hilet lock_count = _lock_count.fetch_add(1, std::memory_order::acquire);
-        hi_axiom(lock_count != std::numeric_limits<uint32_t>::max());
+        hilet state = _state.fetch_add(1, std::memory_order::seq_cst);
+        hi_axiom((state & count_mask) != count_mask);
     }
 
     /** End the critical section.
@@ -72,26 +72,37 @@ public:
      */
     hi_force_inline void unlock() noexcept
     {
-        auto lock_count = _lock_count.fetch_sub(1, std::memory_order::release);
-        hi_axiom(lock_count != 0);
-        if (lock_count == 1) {
+        auto state = _state.fetch_sub(1, std::memory_order::seq_cst);
+        hi_axiom((state & count_mask) != 0);
+        if ((state & count_mask) == 1) {
             // No one is locking, increment the idle count.
-            _version.fetch_add(1, std::memory_order::relaxed);
+            // The lock-count and idle-count are in the same atomic so that the
+            // idle-count is only incremented while there are no threads in
+            // the critical section. If another thread entered the critical
+            // section in the mean time, that thread will increment the idle-count
+            // when it leaves.
+            --state;
+            [[maybe_unused]] hilet incremented =
+                _state.compare_exchange_strong(state, state + version_one, std::memory_order::seq_cst, std::memory_order::relaxed);
         }
     }
 
     /** Get the current idle-count.
      *
-     * @return The number of times the critcal section became idle, modulo 2^23.
+     * @return The number of times the critcal section became idle, modulo 2^32.
      */
     hi_force_inline uint64_t operator*() const noexcept
     {
-        return _version.load(std::memory_order::acquire);
+        return _state.load(std::memory_order::seq_cst) >> 32;
     }
 
 private:
-    std::atomic<uint64_t> _version = 0;
-    std::atomic<uint64_t> _lock_count = 0;
+    constexpr static uint64_t count_mask = 0xffff'ffff;
+    constexpr static uint64_t version_one = 0x1'0000'0000;
+
+    /** The idle-count in the high 32 bits, the lock-count in the low 32 bits.
+     */
+    std::atomic<uint64_t> _state = 0;
 };
 
 } // namespace hi::inline v1
@@ -0,0 +1,442 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <optional>
+#include <limits>
+#include <cstdint>
+
+hi_export_module(hikogui.container.atlas_allocator);
+
+hi_export namespace hi::inline v1 {
+
+/** An allocator of rectangles in the pages of a texture atlas.
+ *
+ * Rectangles are packed using a skyline bottom-left algorithm. Each page
+ * keeps the outline of the top edges of the allocated rectangles, a new
+ * rectangle is placed at the lowest position along this outline where it fits.
+ *
+ * A skyline can not reclaim space of individual rectangles, therefor space
+ * is reclaimed a page at a time:
+ *  - When all pages are full, the least recently used page is evicted.
+ *  - `compact()` evicts pages where most of the entries are no longer used.
+ *
+ * The keys of evicted entries are returned to the caller, so that the
+ * caller can invalidate its references into the atlas.
+ *
+ * This class does not depend on the GPU, the caller is responsible for
+ * uploading images into the allocated rectangles.
+ *
+ * @tparam Key The type of the key that identifies an entry.
+ */
+template<typename Key>
+class atlas_allocator {
+public:
+    using key_type = Key;
+
+    /** The identifier of an allocated entry.
+     */
+    using id_type = uint32_t;
+
+    /** An allocated rectangle.
+     */
+    struct allocation {
+        id_type id;
+        size_t page;
+        size_t x;
+        size_t y;
+        size_t width;
+        size_t height;
+    };
+
+    /** Statistics about the use of the atlas.
+     */
+    struct statistics {
+        size_t num_pages = 0;
+        size_t num_entries = 0;
+
+        /** The total area of all pages.
+         */
+        size_t page_area = 0;
+
+        /** The area of the entries that are still in the atlas.
+         */
+        size_t entry_area = 0;
+
+        /** The number of entries evicted since the atlas was created.
+         */
+        size_t num_evictions = 0;
+
+        /** The fraction of the pages covered by entries.
+         */
+        [[nodiscard]] float occupancy() const noexcept
+        {
+            return page_area == 0 ? 0.0f : static_cast<float>(entry_area) / static_cast<float>(page_area);
+        }
+    };
+
+    atlas_allocator(atlas_allocator const&) = default;
+    atlas_allocator(atlas_allocator&&) noexcept = default;
+    atlas_allocator& operator=(atlas_allocator const&) = default;
+    atlas_allocator& operator=(atlas_allocator&&) noexcept = default;
+
+    /** Create an allocator.
+     *
+     * @param page_width The width of each page in pixels.
+     * @param page_height The height of each page in pixels.
+     * @param max_num_pages The maximum number of pages.
+     * @param num_protected_frames The number of frames after last use during which
+     *        a page may not be evicted, for example because the GPU may still be
+     *        reading from it.
+     */
+    atlas_allocator(size_t page_width, size_t page_height, size_t max_num_pages, uint64_t num_protected_frames = 0) noexcept :
+        _page_width(page_width),
+        _page_height(page_height),
+        _max_num_pages(max_num_pages),
+        _num_protected_frames(num_protected_frames)
+    {
+        hi_assert(page_width > 0);
+        hi_assert(page_height > 0);
+        hi_assert(max_num_pages > 0);
+    }
+
+    [[nodiscard]] size_t page_width() const noexcept
+    {
+        return _page_width;
+    }
+
+    [[nodiscard]] size_t page_height() const noexcept
+    {
+        return _page_height;
+    }
+
+    /** The number of pages that are in use.
+     */
+    [[nodiscard]] size_t num_pages() const noexcept
+    {
+        return _pages.size();
+    }
+
+    /** Allocate a rectangle.
+     *
+     * When there is no space left in any of the pages and no new page can be
+     * added, the least recently used page which is not protected is evicted.
+     *
+     * @param key The key of the entry, returned when the entry is evicted.
+     * @param width The width of the rectangle.
+     * @param height The height of the rectangle.
+     * @param frame The current frame, used as the last use of the entry.
+     * @param[out] evicted The keys of entries that were evicted are appended.
+     * @return The allocated rectangle, or empty if the rectangle does not fit.
+     */
+    [[nodiscard]] std::optional<allocation>
+    allocate(key_type const& key, size_t width, size_t height, uint64_t frame, std::vector<key_type>& evicted) noexcept
+    {
+        if (width > _page_width or height > _page_height) {
+            return std::nullopt;
+        }
+
+        // Select the page where the rectangle is placed lowest.
+        auto best_page = std::numeric_limits<size_t>::max();
+        auto best_position = std::optional<position_type>{};
+        for (auto page_nr = 0_uz; page_nr != _pages.size(); ++page_nr) {
+            if (hilet position = find_position(_pages[page_nr], width, height)) {
+                if (not best_position or position->y < best_position->y) {
+                    best_page = page_nr;
+                    best_position = position;
+                }
+            }
+        }
+
+        if (not best_position and _pages.size() < _max_num_pages) {
+            best_page = _pages.size();
+            _pages.emplace_back(_page_width);
+            best_position = find_position(_pages.back(), width, height);
+        }
+
+        if (not best_position) {
+            hilet victim = least_recently_used_page(frame);
+            if (not victim) {
+                return std::nullopt;
+            }
+
+            best_page = *victim;
+            evict_page(best_page, evicted);
+            best_position = find_position(_pages[best_page], width, height);
+        }
+
+        hi_axiom(best_position.has_value());
+        return insert(key, best_page, *best_position, width, height, frame);
+    }
+
+    /** Mark an entry as used.
+     *
+     * @param id The identifier of the entry.
+     * @param frame The current frame.
+     */
+    void touch(id_type id, uint64_t frame) noexcept
+    {
+        hi_axiom(id < _entries.size());
+        auto& entry = _entries[id];
+        hi_axiom(entry.in_use);
+
+        entry.last_use = frame;
+        inplace_max(_pages[entry.page].last_use, frame);
+    }
+
+    /** Evict pages that are sparsely used.
+     *
+     * A page is compacted when the area of its entries that have been used
+     * within @a max_age frames is less than @a min_occupancy of the page.
+     * All entries of such a page are evicted; entries that are still needed will
+     * be allocated again, packed into other pages.
+     *
+     * @param frame The current frame.
+     * @param max_age The number of frames since last use after which an entry is considered unused.
+     * @param min_occupancy The fraction of the page that needs to be covered by used entries.
+     * @param[out] evicted The keys of entries that were evicted are appended.
+     * @return The number of pages that were compacted.
+     */
+    size_t compact(uint64_t frame, uint64_t max_age, float min_occupancy, std::vector<key_type>& evicted) noexcept
+    {
+        hilet page_area = static_cast<float>(_page_width * _page_height);
+
+        auto r = 0_uz;
+        for (auto page_nr = 0_uz; page_nr != _pages.size(); ++page_nr) {
+            auto& page = _pages[page_nr];
+            if (page.entries.empty() or is_protected(page, frame)) {
+                continue;
+            }
+
+            auto used_area = 0_uz;
+            for (hilet id : page.entries) {
+                hilet& entry = _entries[id];
+                if (entry.last_use + max_age >= frame) {
+                    used_area += entry.width * entry.height;
+                }
+            }
+
+            if (static_cast<float>(used_area) < min_occupancy * page_area) {
+                evict_page(page_nr, evicted);
+                ++r;
+            }
+        }
+        return r;
+    }
+
+    /** Get statistics about the use of the atlas.
+     */
+    [[nodiscard]] statistics get_statistics() const noexcept
+    {
+        auto r = statistics{};
+        r.num_pages = _pages.size();
+        r.page_area = _pages.size() * _page_width * _page_height;
+        r.num_evictions = _num_evictions;
+        for (hilet& page : _pages) {
+            r.num_entries += page.entries.size();
+            for (hilet id : page.entries) {
+                r.entry_area += _entries[id].width * _entries[id].height;
+            }
+        }
+        return r;
+    }
+
+private:
+    /** A horizontal segment of the skyline.
+     */
+    struct segment_type {
+        size_t x;
+        size_t y;
+        size_t width;
+    };
+
+    struct position_type {
+        size_t x;
+        size_t y;
+
+        /** The index of the segment at the left side of the position.
+         */
+        size_t segment_nr;
+    };
+
+    struct page_type {
+        /** The segments of the skyline from left to right, covering the full width of the page.
+         */
+        std::vector<segment_type> skyline;
+
+        /** The entries allocated in this page.
+         */
+        std::vector<id_type> entries;
+
+        /** The last frame any of the entries in this page was used.
+         */
+        uint64_t last_use = 0;
+
+        page_type(size_t width) noexcept : skyline{segment_type{0, 0, width}} {}
+    };
+
+    struct entry_type {
+        key_type key = {};
+        size_t page = 0;
+        size_t width = 0;
+        size_t height = 0;
+        uint64_t last_use = 0;
+        bool in_use = false;
+    };
+
+    size_t _page_width;
+    size_t _page_height;
+    size_t _max_num_pages;
+    uint64_t _num_protected_frames;
+    size_t _num_evictions = 0;
+
+    std::vector<page_type> _pages;
+
+    /** All entries, indexed by id.
+     */
+    std::vector<entry_type> _entries;
+
+    /** The ids of entries that are no longer in use.
+     */
+    std::vector<id_type> _free_ids;
+
+    [[nodiscard]] bool is_protected(page_type const& page, uint64_t frame) const noexcept
+    {
+        return page.last_use + _num_protected_frames >= frame;
+    }
+
+    /** Find the lowest position in a page where a rectangle fits.
+     */
+    [[nodiscard]] std::optional<position_type> find_position(page_type const& page, size_t width, size_t height) const noexcept
+    {
+        auto r = std::optional<position_type>{};
+        auto best_width = std::numeric_limits<size_t>::max();
+
+        hilet& skyline = page.skyline;
+        for (auto i = 0_uz; i != skyline.size() and skyline[i].x + width <= _page_width; ++i) {
+            // The rectangle rests on the highest segment below it.
+            auto y = 0_uz;
+            auto width_left = width;
+            for (auto j = i; width_left != 0; ++j) {
+                hi_axiom(j < skyline.size());
+                inplace_max(y, skyline[j].y);
+                width_left -= std::min(width_left, skyline[j].width);
+            }
+
+            if (y + height > _page_height) {
+                continue;
+            }
+
+            // Prefer the lowest position, then the narrowest segment to reduce waste.
+            if (not r or y < r->y or (y == r->y and skyline[i].width < best_width)) {
+                r = position_type{skyline[i].x, y, i};
+                best_width = skyline[i].width;
+            }
+        }
+        return r;
+    }
+
+    /** Raise the skyline with the new rectangle.
+     */
+    static void add_to_skyline(page_type& page, position_type position, size_t width, size_t height) noexcept
+    {
+        auto& skyline = page.skyline;
+
+        auto i = position.segment_nr;
+        skyline.insert(skyline.begin() + i, segment_type{position.x, position.y + height, width});
+
+        // Shrink or remove the segments now covered by the rectangle.
+        hilet right = position.x + width;
+        ++i;
+        while (i != skyline.size() and skyline[i].x < right) {
+            hilet overlap = right - skyline[i].x;
+            if (skyline[i].width <= overlap) {
+                skyline.erase(skyline.begin() + i);
+            } else {
+                skyline[i].x += overlap;
+                skyline[i].width -= overlap;
+                break;
+            }
+        }
+
+        // Merge neighboring segments of the same height.
+        for (auto j = 1_uz; j < skyline.size();) {
+            if (skyline[j - 1].y == skyline[j].y) {
+                skyline[j - 1].width += skyline[j].width;
+                skyline.erase(skyline.begin() + j);
+            } else {
+                ++j;
+            }
+        }
+    }
+
+    [[nodiscard]] allocation
+    insert(key_type const& key, size_t page_nr, position_type position, size_t width, size_t height, uint64_t frame) noexcept
+    {
+        auto& page = _pages[page_nr];
+        add_to_skyline(page, position, width, height);
+
+        auto id = id_type{};
+        if (_free_ids.empty()) {
+            id = narrow_cast<id_type>(_entries.size());
+            _entries.emplace_back();
+        } else {
+            id = _free_ids.back();
+            _free_ids.pop_back();
+        }
+
+        auto& entry = _entries[id];
+        entry.key = key;
+        entry.page = page_nr;
+        entry.width = width;
+        entry.height = height;
+        entry.last_use = frame;
+        entry.in_use = true;
+
+        page.entries.push_back(id);
+        inplace_max(page.last_use, frame);
+        return allocation{id, page_nr, position.x, position.y, width, height};
+    }
+
+    /** Find the least recently used page that is not protected.
+     */
+    [[nodiscard]] std::optional<size_t> least_recently_used_page(uint64_t frame) const noexcept
+    {
+        auto r = std::optional<size_t>{};
+        for (auto page_nr = 0_uz; page_nr != _pages.size(); ++page_nr) {
+            hilet& page = _pages[page_nr];
+            if (is_protected(page, frame)) {
+                continue;
+            }
+            if (not r or page.last_use < _pages[*r].last_use) {
+                r = page_nr;
+            }
+        }
+        return r;
+    }
+
+    /** Remove all entries from a page and reset its skyline.
+     */
+    void evict_page(size_t page_nr, std::vector<key_type>& evicted) noexcept
+    {
+        auto& page = _pages[page_nr];
+        for (hilet id : page.entries) {
+            auto& entry = _entries[id];
+            evicted.push_back(entry.key);
+            entry = entry_type{};
+            _free_ids.push_back(id);
+            ++_num_evictions;
+        }
+
+        page.entries.clear();
+        page.skyline.assign(1, segment_type{0, 0, _page_width});
+        page.last_use = 0;
+    }
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,108 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "atlas_allocator.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using namespace hi;
+
+TEST(atlas_allocator, pack_without_overlap)
+{
+    auto atlas = atlas_allocator<int>{64, 64, 1};
+    auto evicted = std::vector<int>{};
+
+    auto allocations = std::vector<atlas_allocator<int>::allocation>{};
+    auto area = 0_uz;
+    for (auto i = 0; i != 40; ++i) {
+        hilet width = 5_uz + i % 7;
+        hilet height = 4_uz + i % 5;
+        hilet a = atlas.allocate(i, width, height, 1, evicted);
+        ASSERT_TRUE(a.has_value());
+        ASSERT_LE(a->x + a->width, 64);
+        ASSERT_LE(a->y + a->height, 64);
+        allocations.push_back(*a);
+        area += width * height;
+    }
+    ASSERT_TRUE(evicted.empty());
+
+    for (auto i = 0_uz; i != allocations.size(); ++i) {
+        for (auto j = i + 1; j != allocations.size(); ++j) {
+            hilet& a = allocations[i];
+            hilet& b = allocations[j];
+            hilet overlap = a.x < b.x + b.width and b.x < a.x + a.width and a.y < b.y + b.height and b.y < a.y + a.height;
+            ASSERT_FALSE(overlap);
+        }
+    }
+
+    hilet statistics = atlas.get_statistics();
+    ASSERT_EQ(statistics.num_pages, 1);
+    ASSERT_EQ(statistics.num_entries, 40);
+    ASSERT_EQ(statistics.entry_area, area);
+    ASSERT_EQ(statistics.occupancy(), static_cast<float>(area) / (64.0f * 64.0f));
+}
+
+TEST(atlas_allocator, too_large)
+{
+    auto atlas = atlas_allocator<int>{64, 64, 1};
+    auto evicted = std::vector<int>{};
+
+    ASSERT_FALSE(atlas.allocate(1, 65, 10, 1, evicted).has_value());
+    ASSERT_TRUE(atlas.allocate(2, 64, 64, 1, evicted).has_value());
+    ASSERT_EQ(atlas.num_pages(), 1);
+}
+
+TEST(atlas_allocator, evict_least_recently_used_page)
+{
+    auto atlas = atlas_allocator<int>{32, 32, 2};
+    auto evicted = std::vector<int>{};
+
+    // Fill both pages.
+    hilet a = atlas.allocate(1, 32, 32, 1, evicted);
+    hilet b = atlas.allocate(2, 32, 32, 2, evicted);
+    ASSERT_TRUE(a and b);
+    ASSERT_NE(a->page, b->page);
+
+    // Using the first entry makes the second page the least recently used.
+    atlas.touch(a->id, 3);
+
+    hilet c = atlas.allocate(3, 32, 32, 3, evicted);
+    ASSERT_TRUE(c.has_value());
+    ASSERT_EQ(c->page, b->page);
+    ASSERT_EQ(evicted, std::vector<int>{2});
+    ASSERT_EQ(atlas.get_statistics().num_evictions, 1);
+
+    // Pages used in the current frame are protected.
+    ASSERT_FALSE(atlas.allocate(4, 32, 32, 3, evicted).has_value());
+    ASSERT_EQ(evicted, std::vector<int>{2});
+}
+
+TEST(atlas_allocator, compact)
+{
+    auto atlas = atlas_allocator<int>{32, 32, 2};
+    auto evicted = std::vector<int>{};
+
+    hilet a = atlas.allocate(1, 16, 16, 1, evicted);
+    hilet b = atlas.allocate(2, 16, 16, 1, evicted);
+    ASSERT_TRUE(a and b);
+    atlas.touch(a->id, 10);
+
+    // Only a quarter of the page was used in the last 5 frames.
+    ASSERT_EQ(atlas.compact(20, 5, 0.5f, evicted), 1);
+    std::sort(evicted.begin(), evicted.end());
+    ASSERT_EQ(evicted, (std::vector<int>{1, 2}));
+
+    hilet statistics = atlas.get_statistics();
+    ASSERT_EQ(statistics.num_entries, 0);
+    ASSERT_EQ(statistics.occupancy(), 0.0f);
+
+    // The page is reused from the start.
+    hilet c = atlas.allocate(3, 32, 32, 21, evicted);
+    ASSERT_TRUE(c.has_value());
+    ASSERT_EQ(c->x, 0);
+    ASSERT_EQ(c->y, 0);
+}
@@ -1,9 +1,12 @@
 
 #pragma once
 
+#include "atlas_allocator.hpp" // export
 #include "byte_string.hpp" // export
+#include "fenwick_tree.hpp" // export
 #include "function_fifo.hpp" // export
 #include "lean_vector.hpp" // export
+#include "lru_cache.hpp" // export
 #include "polymorphic_optional.hpp" // export
 #include "secure_vector.hpp" // export
 #include "small_map.hpp" // export
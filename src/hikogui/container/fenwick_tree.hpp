@@ -0,0 +1,159 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file container/fenwick_tree.hpp Defines the fenwick_tree type.
+ */
+
+#pragma once
+
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <span>
+#include <bit>
+#include <cstddef>
+
+hi_export_module(hikogui.container.fenwick_tree);
+
+hi_export namespace hi::inline v1 {
+
+/** A list of values with fast prefix sums.
+ *
+ * A Fenwick tree, or binary indexed tree, allows both changing a value and
+ * calculating the sum of a range of values in O(log n).
+ *
+ * @tparam T The type of the values, which must be addable and subtractable.
+ */
+template<typename T>
+class fenwick_tree {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    constexpr fenwick_tree() noexcept = default;
+    constexpr fenwick_tree(fenwick_tree const&) = default;
+    constexpr fenwick_tree(fenwick_tree&&) noexcept = default;
+    constexpr fenwick_tree& operator=(fenwick_tree const&) = default;
+    constexpr fenwick_tree& operator=(fenwick_tree&&) noexcept = default;
+    [[nodiscard]] constexpr friend bool operator==(fenwick_tree const&, fenwick_tree const&) noexcept = default;
+
+    /** Construct a tree of @a size values equal to zero.
+     */
+    constexpr explicit fenwick_tree(size_type size) : _values(size, value_type{}), _tree(size, value_type{}) {}
+
+    /** Construct a tree from a list of values.
+     *
+     * This is done in O(n).
+     */
+    constexpr explicit fenwick_tree(std::span<value_type const> values) : _values(values.begin(), values.end()), _tree(_values)
+    {
+        for (auto i = 0_uz; i != _tree.size(); ++i) {
+            if (hilet parent = i | (i + 1); parent < _tree.size()) {
+                _tree[parent] += _tree[i];
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+        return _values.size();
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        return _values.empty();
+    }
+
+    /** Get a value.
+     */
+    [[nodiscard]] constexpr value_type const& operator[](size_type index) const noexcept
+    {
+        hi_axiom(index < size());
+        return _values[index];
+    }
+
+    /** Change a value.
+     *
+     * This is done in O(log n).
+     */
+    constexpr void set(size_type index, value_type const& value) noexcept
+    {
+        hi_axiom(index < size());
+        hilet delta = value - _values[index];
+        _values[index] = value;
+        for (auto i = index; i < _tree.size(); i |= i + 1) {
+            _tree[i] += delta;
+        }
+    }
+
+    /** Get the sum of the values before @a last.
+     *
+     * This is done in O(log n).
+     *
+     * @param last The index one beyond the last value to sum.
+     * @return The sum of the values in the range [0, last).
+     */
+    [[nodiscard]] constexpr value_type prefix_sum(size_type last) const noexcept
+    {
+        hi_axiom(last <= size());
+        auto r = value_type{};
+        for (auto i = last; i != 0; i &= i - 1) {
+            r += _tree[i - 1];
+        }
+        return r;
+    }
+
+    /** Get the sum of a range of values.
+     *
+     * This is done in O(log n).
+     *
+     * @param first The index of the first value to sum.
+     * @param last The index one beyond the last value to sum.
+     * @return The sum of the values in the range [first, last).
+     */
+    [[nodiscard]] constexpr value_type sum(size_type first, size_type last) const noexcept
+    {
+        hi_axiom(first <= last);
+        return prefix_sum(last) - prefix_sum(first);
+    }
+
+    /** Get the sum of all values.
+     */
+    [[nodiscard]] constexpr value_type sum() const noexcept
+    {
+        return prefix_sum(size());
+    }
+
+    /** Find the value that contains the given offset.
+     *
+     * When the values are the sizes of consecutive items, this finds the item
+     * at a position. This is done in O(log n).
+     *
+     * @pre All values must be non-negative.
+     * @param offset The offset from the start of the first value.
+     * @return The index of the first value where `prefix_sum(index + 1) > offset`, or `size()` if not found.
+     */
+    [[nodiscard]] constexpr size_type find(value_type offset) const noexcept
+    {
+        auto index = 0_uz;
+        for (auto step = std::bit_floor(_tree.size()); step != 0; step >>= 1) {
+            if (hilet next = index + step; next <= _tree.size() and not(offset < _tree[next - 1])) {
+                index = next;
+                offset -= _tree[next - 1];
+            }
+        }
+        return index;
+    }
+
+private:
+    /** The values, used to calculate the difference in `set()`.
+     */
+    std::vector<value_type> _values;
+
+    /** Each node holds the sum of a power-of-two sized range of values ending at the node.
+     */
+    std::vector<value_type> _tree;
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,63 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "fenwick_tree.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <numeric>
+
+using namespace hi;
+
+TEST(fenwick_tree, sum)
+{
+    auto values = std::vector<int>{3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+    auto tree = fenwick_tree<int>{std::span<int const>{values}};
+
+    ASSERT_EQ(tree.size(), values.size());
+    for (auto first = 0_uz; first <= values.size(); ++first) {
+        for (auto last = first; last <= values.size(); ++last) {
+            ASSERT_EQ(tree.sum(first, last), std::accumulate(values.begin() + first, values.begin() + last, 0));
+        }
+    }
+}
+
+TEST(fenwick_tree, set)
+{
+    auto values = std::vector<int>(37, 1);
+    auto tree = fenwick_tree<int>{values.size()};
+    ASSERT_EQ(tree.sum(), 0);
+
+    for (auto i = 0_uz; i != values.size(); ++i) {
+        tree.set(i, 1);
+    }
+    ASSERT_EQ(tree.sum(), 37);
+
+    values[5] = 10;
+    tree.set(5, 10);
+    values[36] = -2;
+    tree.set(36, -2);
+    ASSERT_EQ(tree[5], 10);
+
+    for (auto last = 0_uz; last <= values.size(); ++last) {
+        ASSERT_EQ(tree.prefix_sum(last), std::accumulate(values.begin(), values.begin() + last, 0));
+    }
+}
+
+TEST(fenwick_tree, find)
+{
+    auto values = std::vector<int>{10, 20, 0, 30, 40};
+    auto tree = fenwick_tree<int>{std::span<int const>{values}};
+
+    ASSERT_EQ(tree.find(0), 0);
+    ASSERT_EQ(tree.find(9), 0);
+    ASSERT_EQ(tree.find(10), 1);
+    ASSERT_EQ(tree.find(29), 1);
+    // Empty values are skipped.
+    ASSERT_EQ(tree.find(30), 3);
+    ASSERT_EQ(tree.find(59), 3);
+    ASSERT_EQ(tree.find(60), 4);
+    ASSERT_EQ(tree.find(99), 4);
+    ASSERT_EQ(tree.find(100), 5);
+}
@@ -0,0 +1,179 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "../utility/utility.hpp"
+#include "../concurrency/concurrency.hpp"
+#include "../macros.hpp"
+#include <mutex>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <concepts>
+
+hi_export_module(hikogui.container.lru_cache);
+
+hi_export namespace hi::inline v1 {
+
+/** A bounded, thread-safe, least-recently-used cache.
+ *
+ * Values are stored as shared immutable objects, so that a value returned
+ * from the cache stays valid even after it was evicted.
+ *
+ * @tparam Key The type of the key used to look up values.
+ * @tparam T The type of the values stored in the cache.
+ * @tparam Hash The hash function used on the key.
+ * @tparam KeyEqual The equality function used on the key.
+ */
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class lru_cache {
+public:
+    using key_type = Key;
+    using value_type = T;
+    using pointer = std::shared_ptr<value_type const>;
+    using size_type = size_t;
+
+    ~lru_cache() = default;
+    lru_cache(lru_cache const&) = delete;
+    lru_cache(lru_cache&&) = delete;
+    lru_cache& operator=(lru_cache const&) = delete;
+    lru_cache& operator=(lru_cache&&) = delete;
+
+    /** Construct a cache.
+     *
+     * @param capacity The maximum number of values retained in the cache.
+     */
+    explicit lru_cache(size_type capacity) noexcept : _capacity(capacity)
+    {
+        hi_assert(capacity > 0);
+    }
+
+    [[nodiscard]] size_type capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        hilet lock = std::scoped_lock(_mutex);
+        return _map.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    /** Remove all values from the cache.
+     */
+    void clear() noexcept
+    {
+        hilet lock = std::scoped_lock(_mutex);
+        _list.clear();
+        _map.clear();
+    }
+
+    /** Find a value in the cache.
+     *
+     * A found value is marked as the most recently used.
+     *
+     * @param key The key to search for.
+     * @return A shared pointer to the value, or nullptr if not found.
+     */
+    [[nodiscard]] pointer find(key_type const& key) noexcept
+    {
+        hilet lock = std::scoped_lock(_mutex);
+        return find_locked(key);
+    }
+
+    /** Insert a value into the cache.
+     *
+     * If an equal key is already in the cache, the value in the cache is kept.
+     * The least recently used values are evicted when the cache is over capacity.
+     *
+     * @param key The key of the value.
+     * @param value The value to insert.
+     * @return A shared pointer to the value in the cache for the key.
+     */
+    pointer insert(key_type key, pointer value) noexcept
+    {
+        hi_assert_not_null(value);
+
+        hilet lock = std::scoped_lock(_mutex);
+        if (auto r = find_locked(key)) {
+            return r;
+        }
+
+        _list.push_front(item_type{nullptr, value});
+        hilet[map_it, inserted] = _map.emplace(std::move(key), _list.begin());
+        hi_axiom(inserted);
+        _list.front().key = std::addressof(map_it->first);
+
+        while (_map.size() > _capacity) {
+            hilet oldest_it = _map.find(*_list.back().key);
+            hi_axiom(oldest_it != _map.end());
+            _map.erase(oldest_it);
+            _list.pop_back();
+        }
+        return value;
+    }
+
+    /** Get a value from the cache, or create it.
+     *
+     * The function to create the value is called without holding the lock
+     * of the cache, so that other threads are not blocked while the value
+     * is calculated. When two threads race on the same key, both will calculate
+     * the value but only the first one is retained.
+     *
+     * @param key The key to search for.
+     * @param func A function returning a `value_type` when the key is not in the cache.
+     * @return A shared pointer to the value in the cache for the key.
+     */
+    template<std::invocable Func>
+    [[nodiscard]] pointer get_or_emplace(key_type const& key, Func&& func)
+    {
+        if (auto r = find(key)) {
+            return r;
+        }
+
+        return insert(key, std::make_shared<value_type const>(std::forward<Func>(func)()));
+    }
+
+private:
+    struct item_type {
+        key_type const *key;
+        pointer value;
+    };
+
+    using list_type = std::list<item_type>;
+    using map_type = std::unordered_map<key_type, typename list_type::iterator, Hash, KeyEqual>;
+
+    size_type _capacity;
+
+    /** Items from most recently used to least recently used.
+     *
+     * The key pointers refer to the keys owned by `_map`.
+     */
+    list_type _list;
+    map_type _map;
+    mutable unfair_mutex _mutex;
+
+    [[nodiscard]] pointer find_locked(key_type const& key) noexcept
+    {
+        hi_axiom(_mutex.is_locked());
+
+        hilet it = _map.find(key);
+        if (it == _map.end()) {
+            return nullptr;
+        }
+
+        // Move to the front to mark as the most recently used.
+        _list.splice(_list.begin(), _list, it->second);
+        return it->second->value;
+    }
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,75 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "lru_cache.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace std;
+using namespace hi;
+
+TEST(lru_cache, get_or_emplace)
+{
+    auto cache = lru_cache<int, std::string>{4};
+    auto count = 0;
+
+    hilet a = cache.get_or_emplace(1, [&] {
+        ++count;
+        return std::string{"one"};
+    });
+    ASSERT_EQ(*a, "one");
+    ASSERT_EQ(count, 1);
+
+    hilet b = cache.get_or_emplace(1, [&] {
+        ++count;
+        return std::string{"uno"};
+    });
+    ASSERT_EQ(*b, "one");
+    ASSERT_EQ(count, 1);
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(cache.size(), 1);
+}
+
+TEST(lru_cache, evict_least_recently_used)
+{
+    auto cache = lru_cache<int, int>{3};
+
+    cache.insert(1, std::make_shared<int const>(10));
+    cache.insert(2, std::make_shared<int const>(20));
+    cache.insert(3, std::make_shared<int const>(30));
+    ASSERT_EQ(cache.size(), 3);
+
+    // Touch 1, so that 2 becomes the least recently used.
+    ASSERT_EQ(*cache.find(1), 10);
+
+    hilet four = cache.insert(4, std::make_shared<int const>(40));
+    ASSERT_EQ(*four, 40);
+    ASSERT_EQ(cache.size(), 3);
+
+    ASSERT_EQ(cache.find(2), nullptr);
+    ASSERT_EQ(*cache.find(1), 10);
+    ASSERT_EQ(*cache.find(3), 30);
+    ASSERT_EQ(*cache.find(4), 40);
+}
+
+TEST(lru_cache, evicted_value_stays_valid)
+{
+    auto cache = lru_cache<int, std::string>{1};
+
+    hilet a = cache.get_or_emplace(1, [] {
+        return std::string{"one"};
+    });
+    hilet b = cache.get_or_emplace(2, [] {
+        return std::string{"two"};
+    });
+
+    ASSERT_EQ(cache.find(1), nullptr);
+    ASSERT_EQ(*a, "one");
+    ASSERT_EQ(*b, "two");
+
+    cache.clear();
+    ASSERT_TRUE(cache.empty());
+    ASSERT_EQ(*b, "two");
+}
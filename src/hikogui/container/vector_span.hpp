@@ -191,6 +191,11 @@ public:
         return std::distance(_begin, _end);
     }
 
+    [[nodiscard]] std::size_t capacity() const noexcept
+    {
+        return std::distance(_begin, _max);
+    }
+
     [[nodiscard]] value_type &operator[](std::size_t i) noexcept
     {
         hi_assert_bounds(i, *this);
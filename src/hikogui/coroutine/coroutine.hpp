@@ -3,7 +3,10 @@
 #pragma once
 
 #include "awaitable.hpp" // export
+#include "coroutine_frame_pool.hpp" // export
 #include "generator.hpp" // export
+#include "lazy_task.hpp" // export
 #include "task.hpp" // export
+#include "when_all.hpp" // export
 
 hi_export_module(hikogui.coroutine);
@@ -0,0 +1,164 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file coroutine/coroutine_frame_pool.hpp Recycling of coroutine frames.
+ */
+
+#pragma once
+
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+hi_export_module(hikogui.coroutine.coroutine_frame_pool);
+
+hi_export namespace hi::inline v1 {
+namespace detail {
+
+/** A per-thread pool of coroutine frames.
+ *
+ * Short lived coroutines, such as generators that iterate over the children
+ * of a widget, are created and destroyed many times per frame. Freed frames
+ * are kept in a free-list per size-class, so that the next coroutine of
+ * about the same size reuses the frame instead of calling `operator new`.
+ */
+class coroutine_frame_pool {
+public:
+    /** The size-classes are multiples of this size.
+     */
+    constexpr static std::size_t granularity = 64;
+
+    /** Frames larger than this are not pooled.
+     */
+    constexpr static std::size_t maximum_size = 2048;
+
+    /** The maximum number of free frames kept for each size-class.
+     */
+    constexpr static std::size_t maximum_free = 64;
+
+    constexpr coroutine_frame_pool() noexcept = default;
+    coroutine_frame_pool(coroutine_frame_pool const&) = delete;
+    coroutine_frame_pool(coroutine_frame_pool&&) = delete;
+    coroutine_frame_pool& operator=(coroutine_frame_pool const&) = delete;
+    coroutine_frame_pool& operator=(coroutine_frame_pool&&) = delete;
+
+    ~coroutine_frame_pool()
+    {
+        for (auto& list : _free_lists) {
+            while (list.head != nullptr) {
+                ::operator delete(std::exchange(list.head, list.head->next));
+            }
+        }
+    }
+
+    [[nodiscard]] void *allocate(std::size_t size)
+    {
+        if (size > maximum_size) {
+            return ::operator new(size);
+        }
+
+        auto& list = _free_lists[size_class(size)];
+        if (list.head != nullptr) {
+            --list.count;
+            return std::exchange(list.head, list.head->next);
+        }
+        return ::operator new((size_class(size) + 1) * granularity);
+    }
+
+    void deallocate(void *ptr, std::size_t size) noexcept
+    {
+        if (size > maximum_size) {
+            return ::operator delete(ptr);
+        }
+
+        auto& list = _free_lists[size_class(size)];
+        if (list.count == maximum_free) {
+            return ::operator delete(ptr);
+        }
+
+        ++list.count;
+        list.head = new (ptr) free_frame{list.head};
+    }
+
+private:
+    struct free_frame {
+        free_frame *next;
+    };
+
+    struct free_list {
+        free_frame *head = nullptr;
+        std::size_t count = 0;
+    };
+
+    std::array<free_list, maximum_size / granularity> _free_lists = {};
+
+    [[nodiscard]] constexpr static std::size_t size_class(std::size_t size) noexcept
+    {
+        hi_axiom(size != 0 and size <= maximum_size);
+        return (size - 1) / granularity;
+    }
+};
+
+/** Set when the pool of coroutine frames of the current thread is destroyed.
+ *
+ * Other thread-local objects may still allocate or free frames during thread
+ * teardown, after the pool was destroyed. This flag is trivially destructible
+ * so that it can still be read at that time.
+ */
+hi_inline thread_local bool coroutine_frame_pool_local_destroyed = false;
+
+class coroutine_frame_pool_local_type : public coroutine_frame_pool {
+public:
+    constexpr coroutine_frame_pool_local_type() noexcept = default;
+
+    ~coroutine_frame_pool_local_type()
+    {
+        coroutine_frame_pool_local_destroyed = true;
+    }
+};
+
+/** The pool of coroutine frames of the current thread.
+ *
+ * Frames may be freed on another thread than where they were allocated,
+ * a frame is then simply moved to the pool of the other thread.
+ */
+hi_inline thread_local coroutine_frame_pool_local_type coroutine_frame_pool_local;
+
+} // namespace detail
+
+/** Allocate a coroutine frame.
+ *
+ * Used by the `operator new` of a coroutine's promise type.
+ *
+ * @param size The size of the frame in bytes.
+ * @return A pointer to the frame.
+ */
+[[nodiscard]] hi_inline void *allocate_coroutine_frame(std::size_t size)
+{
+    if (detail::coroutine_frame_pool_local_destroyed) {
+        [[unlikely]] return ::operator new(size);
+    }
+    return detail::coroutine_frame_pool_local.allocate(size);
+}
+
+/** Deallocate a coroutine frame.
+ *
+ * Used by the `operator delete` of a coroutine's promise type.
+ *
+ * @param ptr The pointer to the frame.
+ * @param size The size of the frame in bytes, as passed to `allocate_coroutine_frame()`.
+ */
+hi_inline void deallocate_coroutine_frame(void *ptr, std::size_t size) noexcept
+{
+    if (detail::coroutine_frame_pool_local_destroyed) {
+        // Don't touch the destroyed pool; all frames are allocated with `::operator new()`.
+        [[unlikely]] return ::operator delete(ptr);
+    }
+    detail::coroutine_frame_pool_local.deallocate(ptr, size);
+}
+
+} // namespace hi::inline v1
@@ -0,0 +1,70 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "coroutine_frame_pool.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace hi;
+
+TEST(coroutine_frame_pool, recycle)
+{
+    auto pool = detail::coroutine_frame_pool{};
+
+    auto *a = pool.allocate(100);
+    pool.deallocate(a, 100);
+
+    // A frame of the same size-class is reused.
+    auto *b = pool.allocate(120);
+    ASSERT_EQ(a, b);
+
+    // A frame of another size-class is not.
+    auto *c = pool.allocate(200);
+    ASSERT_NE(b, c);
+
+    pool.deallocate(b, 120);
+    pool.deallocate(c, 200);
+}
+
+TEST(coroutine_frame_pool, large)
+{
+    auto pool = detail::coroutine_frame_pool{};
+
+    auto *a = pool.allocate(detail::coroutine_frame_pool::maximum_size + 1);
+    pool.deallocate(a, detail::coroutine_frame_pool::maximum_size + 1);
+
+    auto *b = pool.allocate(detail::coroutine_frame_pool::maximum_size);
+    auto *c = pool.allocate(detail::coroutine_frame_pool::maximum_size);
+    ASSERT_NE(b, c);
+
+    pool.deallocate(b, detail::coroutine_frame_pool::maximum_size);
+    pool.deallocate(c, detail::coroutine_frame_pool::maximum_size);
+}
+
+TEST(coroutine_frame_pool, thread_teardown)
+{
+    auto destroyed = false;
+
+    std::thread([&destroyed] {
+        struct holder_type {
+            bool *destroyed = nullptr;
+            void *frame = nullptr;
+
+            ~holder_type()
+            {
+                // The pool of this thread was destroyed before this object.
+                *destroyed = detail::coroutine_frame_pool_local_destroyed;
+                deallocate_coroutine_frame(frame, 100);
+            }
+        };
+
+        // Construct the holder before the pool, so that it is destroyed after the pool.
+        thread_local auto holder = holder_type{};
+        holder.destroyed = &destroyed;
+        holder.frame = allocate_coroutine_frame(100);
+    }).join();
+
+    ASSERT_TRUE(destroyed);
+}
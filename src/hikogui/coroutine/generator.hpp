@@ -10,6 +10,7 @@
 #include <memory>
 #include <memory_resource>
 #include <type_traits>
+#include "coroutine_frame_pool.hpp"
 #include "../utility/utility.hpp"
 #include "../macros.hpp"
 
@@ -42,6 +43,18 @@ public:
             return generator{handle_type::from_promise(*this)};
         }
 
+        /** Allocate the coroutine frame from the pool of recycled frames.
+         */
+        [[nodiscard]] static void *operator new(std::size_t size)
+        {
+            return allocate_coroutine_frame(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept
+        {
+            deallocate_coroutine_frame(ptr, size);
+        }
+
         value_type const& value() const noexcept
         {
             hi_axiom(_value);
@@ -240,6 +253,18 @@ public:
             return generator{handle_type::from_promise(*this)};
         }
 
+        /** Allocate the coroutine frame from the pool of recycled frames.
+         */
+        [[nodiscard]] static void *operator new(std::size_t size)
+        {
+            return allocate_coroutine_frame(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept
+        {
+            deallocate_coroutine_frame(ptr, size);
+        }
+
         value_type value() const noexcept
         {
             hi_axiom(_value != nullptr);
@@ -0,0 +1,376 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file coroutine/lazy_task.hpp Defines lazy_task and resume_on.
+ */
+
+#pragma once
+
+#include "coroutine_frame_pool.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <coroutine>
+#include <type_traits>
+#include <exception>
+#include <future>
+#include <utility>
+#include <variant>
+
+hi_export_module(hikogui.coroutine.lazy_task);
+
+hi_export namespace hi::inline v1 {
+
+/** An executor on which a co-routine can be resumed.
+ *
+ * Both `hi::loop` and `hi::thread_pool` are executors.
+ */
+template<typename T>
+concept executor = requires(T& e) { e.post_function([] {}); };
+
+template<typename T>
+class lazy_task;
+
+namespace detail {
+
+/** Awaiter that resumes the awaiting co-routine when a lazy_task completes.
+ */
+struct lazy_task_final_awaiter {
+    [[nodiscard]] constexpr bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template<typename Promise>
+    [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        // Symmetric transfer to the awaiting co-routine, this does not grow the stack.
+        if (auto continuation = handle.promise().continuation) {
+            return continuation;
+        } else {
+            return std::noop_coroutine();
+        }
+    }
+
+    constexpr void await_resume() const noexcept {}
+};
+
+template<typename T>
+struct lazy_task_promise_base {
+    std::coroutine_handle<> continuation = {};
+    std::variant<std::monostate, T, std::exception_ptr> result = {};
+
+    void return_value(std::convertible_to<T> auto&& value) noexcept
+    {
+        result.template emplace<1>(hi_forward(value));
+    }
+
+    [[nodiscard]] T value()
+    {
+        if (hilet exception = std::get_if<2>(&result)) {
+            std::rethrow_exception(*exception);
+        }
+        hi_axiom(result.index() == 1, "The task was not completed.");
+        return std::move(std::get<1>(result));
+    }
+};
+
+template<>
+struct lazy_task_promise_base<void> {
+    std::coroutine_handle<> continuation = {};
+    std::variant<std::monostate, std::monostate, std::exception_ptr> result = {};
+
+    void return_void() noexcept
+    {
+        result.emplace<1>();
+    }
+
+    void value()
+    {
+        if (hilet exception = std::get_if<2>(&result)) {
+            std::rethrow_exception(*exception);
+        }
+        hi_axiom(result.index() == 1, "The task was not completed.");
+    }
+};
+
+template<typename T>
+struct lazy_task_promise : lazy_task_promise_base<T> {
+    using value_type = T;
+    using handle_type = std::coroutine_handle<lazy_task_promise<value_type>>;
+    using task_type = lazy_task<value_type>;
+
+    void unhandled_exception() noexcept
+    {
+        this->result.template emplace<2>(std::current_exception());
+    }
+
+    task_type get_return_object() noexcept
+    {
+        return task_type{handle_type::from_promise(*this)};
+    }
+
+    /** The task is lazy, it is started when it is awaited on.
+     */
+    static std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    static lazy_task_final_awaiter final_suspend() noexcept
+    {
+        return {};
+    }
+
+    [[nodiscard]] static void *operator new(std::size_t size)
+    {
+        return allocate_coroutine_frame(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept
+    {
+        deallocate_coroutine_frame(ptr, size);
+    }
+};
+
+/** A co-routine which is destroyed when it completes.
+ *
+ * Used to start a lazy_task from outside of a co-routine.
+ */
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() noexcept
+        {
+            return {};
+        }
+
+        static std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        static std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        static void return_void() noexcept {}
+
+        static void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+
+        [[nodiscard]] static void *operator new(std::size_t size)
+        {
+            return allocate_coroutine_frame(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept
+        {
+            deallocate_coroutine_frame(ptr, size);
+        }
+    };
+};
+
+} // namespace detail
+
+/** Resume the current co-routine on an executor.
+ *
+ * ```cpp
+ * lazy_task<image> decode(std::filesystem::path path)
+ * {
+ *     // Continue decoding on one of the threads of the thread pool.
+ *     co_await resume_on(loop::pool());
+ *     ...
+ * }
+ * ```
+ *
+ * @param executor A loop or thread pool.
+ * @return An awaitable which posts the resumption of the co-routine to the executor.
+ */
+template<executor Executor>
+[[nodiscard]] auto resume_on(Executor& executor) noexcept
+{
+    struct awaiter_type {
+        Executor *executor;
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) const noexcept
+        {
+            executor->post_function([handle] {
+                handle.resume();
+            });
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+    return awaiter_type{std::addressof(executor)};
+}
+
+/** Lazy co-routine task.
+ *
+ * Unlike `task`, which runs its co-routine immediately and cannot be awaited
+ * on, this task is lazy; the co-routine is started when the task is awaited on,
+ * or when `start()` or `detach()` is called. When the co-routine completes
+ * the awaiting co-routine is resumed directly using symmetric transfer.
+ *
+ * A task that is destroyed before it is started never runs; therefore the
+ * task is `[[nodiscard]]`.
+ *
+ * Co-routine frames are allocated from the per-thread `coroutine_frame_pool`.
+ *
+ * @tparam T The type returned by co_return.
+ */
+template<typename T = void>
+class [[nodiscard]] lazy_task {
+public:
+    using value_type = T;
+    using promise_type = detail::lazy_task_promise<value_type>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit lazy_task(handle_type coroutine) noexcept : _coroutine(coroutine) {}
+
+    lazy_task() noexcept = default;
+
+    ~lazy_task()
+    {
+        if (_coroutine) {
+            _coroutine.destroy();
+        }
+    }
+
+    lazy_task(lazy_task const&) = delete;
+    lazy_task& operator=(lazy_task const&) = delete;
+
+    lazy_task(lazy_task&& other) noexcept : _coroutine(std::exchange(other._coroutine, {})) {}
+
+    lazy_task& operator=(lazy_task&& other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            if (_coroutine) {
+                _coroutine.destroy();
+            }
+            _coroutine = std::exchange(other._coroutine, {});
+        }
+        return *this;
+    }
+
+    /** Check if the co-routine has completed.
+     */
+    [[nodiscard]] bool done() const noexcept
+    {
+        hi_assert_not_null(_coroutine);
+        return _coroutine.done();
+    }
+
+    /** Await on the task.
+     *
+     * This starts the co-routine of the task, and resumes the awaiting
+     * co-routine when it has completed.
+     *
+     * @return The value passed to co_return.
+     * @throws The exception thrown by the co-routine.
+     */
+    [[nodiscard]] auto operator co_await() const noexcept
+    {
+        struct awaiter_type {
+            handle_type coroutine;
+
+            [[nodiscard]] bool await_ready() const noexcept
+            {
+                return coroutine.done();
+            }
+
+            [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept
+            {
+                coroutine.promise().continuation = continuation;
+                // Symmetric transfer to the task's co-routine.
+                return coroutine;
+            }
+
+            value_type await_resume() const
+            {
+                return coroutine.promise().value();
+            }
+        };
+
+        hi_assert_not_null(_coroutine);
+        return awaiter_type{_coroutine};
+    }
+
+    /** Start the task from outside of a co-routine.
+     *
+     * The co-routine is run on the current thread until it is first suspended.
+     *
+     * @return A future for the value passed to co_return.
+     */
+    [[nodiscard]] std::future<value_type> start() && noexcept
+    {
+        auto promise = std::promise<value_type>{};
+        auto future = promise.get_future();
+        run(std::move(*this), std::move(promise));
+        return future;
+    }
+
+    /** Start the task on an executor.
+     *
+     * @param executor A loop or thread pool on which the co-routine is started.
+     * @return A future for the value passed to co_return.
+     */
+    template<executor Executor>
+    [[nodiscard]] std::future<value_type> start(Executor& executor) && noexcept
+    {
+        auto promise = std::promise<value_type>{};
+        auto future = promise.get_future();
+        run(std::move(*this), std::move(promise), std::addressof(executor));
+        return future;
+    }
+
+    /** Start the task and let it run independently.
+     *
+     * The co-routine is run on the current thread until it is first suspended,
+     * and is destroyed when it completes. This is used for top-level tasks,
+     * such as a task that combines the results of other tasks.
+     *
+     * @note The application is terminated when the co-routine throws an exception.
+     */
+    void detach() && noexcept
+    {
+        run_detached(std::move(*this));
+    }
+
+private:
+    handle_type _coroutine = {};
+
+    static detail::detached_task run_detached(lazy_task self)
+    {
+        co_await self;
+    }
+
+    template<typename Executor = void>
+    static detail::detached_task run(lazy_task self, std::promise<value_type> promise, Executor *executor = nullptr)
+    {
+        if constexpr (not std::is_same_v<Executor, void>) {
+            co_await resume_on(*executor);
+        }
+
+        try {
+            if constexpr (std::is_same_v<value_type, void>) {
+                co_await self;
+                promise.set_value();
+            } else {
+                promise.set_value(co_await self);
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,131 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "lazy_task.hpp"
+#include "when_all.hpp"
+#include "../dispatch/thread_pool.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace hi;
+
+namespace lazy_task_tests {
+
+lazy_task<int> value(int x)
+{
+    co_return x;
+}
+
+lazy_task<int> add(int a, int b)
+{
+    co_return co_await value(a) + co_await value(b);
+}
+
+lazy_task<int> depth(int n)
+{
+    if (n == 0) {
+        co_return 0;
+    }
+    co_return co_await depth(n - 1) + 1;
+}
+
+lazy_task<void> fail()
+{
+    throw std::runtime_error("fail");
+    co_return;
+}
+
+lazy_task<int> twice_on_pool(thread_pool& pool, int x)
+{
+    co_await resume_on(pool);
+    co_return pool.on_thread() ? x * 2 : -1;
+}
+
+lazy_task<int> sum_of_tuple(thread_pool& pool)
+{
+    auto [a, b, c] = co_await when_all(twice_on_pool(pool, 1), twice_on_pool(pool, 2), value(3));
+    co_return a + b + c;
+}
+
+lazy_task<int> sum_of_vector(thread_pool& pool)
+{
+    auto tasks = std::vector<lazy_task<int>>{};
+    for (auto i = 0; i != 100; ++i) {
+        tasks.push_back(twice_on_pool(pool, i));
+    }
+
+    auto r = 0;
+    for (auto x : co_await when_all(std::move(tasks))) {
+        r += x;
+    }
+    co_return r;
+}
+
+lazy_task<void> fail_on_pool(thread_pool& pool)
+{
+    auto tasks = std::vector<lazy_task<void>>{};
+    tasks.push_back(fail());
+    tasks.push_back([](thread_pool& pool) -> lazy_task<void> {
+        co_await resume_on(pool);
+    }(pool));
+    co_await when_all(std::move(tasks));
+}
+
+lazy_task<void> set_flag(bool& flag)
+{
+    flag = true;
+    co_return;
+}
+
+} // namespace lazy_task_tests
+
+TEST(lazy_task, co_await)
+{
+    ASSERT_EQ(lazy_task_tests::add(1, 2).start().get(), 3);
+}
+
+TEST(lazy_task, lazy)
+{
+    auto flag = false;
+
+    // The co-routine does not run until the task is started.
+    {
+        auto t = lazy_task_tests::set_flag(flag);
+        ASSERT_FALSE(flag);
+    }
+    ASSERT_FALSE(flag);
+
+    lazy_task_tests::set_flag(flag).detach();
+    ASSERT_TRUE(flag);
+}
+
+TEST(lazy_task, symmetric_transfer)
+{
+    ASSERT_EQ(lazy_task_tests::depth(1000).start().get(), 1000);
+}
+
+TEST(lazy_task, exception)
+{
+    ASSERT_THROW(lazy_task_tests::fail().start().get(), std::runtime_error);
+}
+
+TEST(lazy_task, when_all_tuple)
+{
+    auto pool = thread_pool{4};
+    ASSERT_EQ(lazy_task_tests::sum_of_tuple(pool).start().get(), 9);
+}
+
+TEST(lazy_task, when_all_vector)
+{
+    auto pool = thread_pool{4};
+    ASSERT_EQ(lazy_task_tests::sum_of_vector(pool).start(pool).get(), 9900);
+}
+
+TEST(lazy_task, when_all_exception)
+{
+    auto pool = thread_pool{4};
+    ASSERT_THROW(lazy_task_tests::fail_on_pool(pool).start().get(), std::runtime_error);
+}
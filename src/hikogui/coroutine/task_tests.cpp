@@ -0,0 +1,27 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "task.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+
+using namespace hi;
+
+namespace task_tests {
+
+task<> set_flag(bool& flag)
+{
+    flag = true;
+    co_return;
+}
+
+} // namespace task_tests
+
+TEST(task, eager)
+{
+    // A task is started when it is called, even when the task is discarded.
+    auto flag = false;
+    task_tests::set_flag(flag);
+    ASSERT_TRUE(flag);
+}
@@ -0,0 +1,291 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file coroutine/when_all.hpp Defines when_all.
+ */
+
+#pragma once
+
+#include "lazy_task.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+hi_export_module(hikogui.coroutine.when_all);
+
+hi_export namespace hi::inline v1 {
+namespace detail {
+
+/** Counts the tasks of `when_all` that have not yet completed.
+ *
+ * The counter starts at the number of tasks plus one for the awaiting
+ * co-routine itself; so that the tasks that complete before the awaiting
+ * co-routine is suspended do not resume it.
+ */
+class when_all_counter {
+public:
+    explicit when_all_counter(std::size_t num_tasks) noexcept : _count(num_tasks + 1) {}
+
+    /** Set the co-routine to resume when all tasks have completed.
+     */
+    void set_continuation(std::coroutine_handle<> continuation) noexcept
+    {
+        _continuation = continuation;
+    }
+
+    /** Called by the awaiting co-routine after it started all tasks.
+     *
+     * @retval true The awaiting co-routine should suspend.
+     * @retval false All tasks have already completed.
+     */
+    [[nodiscard]] bool suspend() noexcept
+    {
+        return _count.fetch_sub(1, std::memory_order::acq_rel) != 1;
+    }
+
+    /** Called by a task when it completes.
+     *
+     * @return The co-routine to resume.
+     */
+    [[nodiscard]] std::coroutine_handle<> complete() noexcept
+    {
+        if (_count.fetch_sub(1, std::memory_order::acq_rel) == 1) {
+            return _continuation;
+        } else {
+            return std::noop_coroutine();
+        }
+    }
+
+private:
+    std::atomic<std::size_t> _count;
+    std::coroutine_handle<> _continuation = {};
+};
+
+/** The result of one of the tasks of `when_all`.
+ */
+template<typename T>
+struct when_all_result {
+    std::optional<variant_decay_t<T>> value = {};
+    std::exception_ptr exception = nullptr;
+
+    variant_decay_t<T> get()
+    {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        hi_axiom(value.has_value());
+        return std::move(*value);
+    }
+};
+
+/** A co-routine which awaits a single task of `when_all`.
+ *
+ * The co-routine is suspended at the start, and at the end so that the
+ * frame can be destroyed by `when_all` after the counter has reached zero.
+ */
+class when_all_child {
+public:
+    struct promise_type {
+        when_all_counter *counter = nullptr;
+
+        when_all_child get_return_object() noexcept
+        {
+            return when_all_child{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        static std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        [[nodiscard]] auto final_suspend() noexcept
+        {
+            struct awaiter_type {
+                [[nodiscard]] constexpr bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                {
+                    // After the last task completes the frame may be destroyed by another thread,
+                    // so the frame must not be accessed after calling `complete()`.
+                    return handle.promise().counter->complete();
+                }
+
+                constexpr void await_resume() const noexcept {}
+            };
+
+            return awaiter_type{};
+        }
+
+        static void return_void() noexcept {}
+
+        static void unhandled_exception() noexcept
+        {
+            // The exception is caught and stored by `make_when_all_child()`.
+            std::terminate();
+        }
+
+        [[nodiscard]] static void *operator new(std::size_t size)
+        {
+            return allocate_coroutine_frame(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept
+        {
+            deallocate_coroutine_frame(ptr, size);
+        }
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    ~when_all_child()
+    {
+        if (_coroutine) {
+            _coroutine.destroy();
+        }
+    }
+
+    when_all_child(when_all_child const&) = delete;
+    when_all_child& operator=(when_all_child const&) = delete;
+    when_all_child& operator=(when_all_child&&) = delete;
+    when_all_child(when_all_child&& other) noexcept : _coroutine(std::exchange(other._coroutine, {})) {}
+
+    void start(when_all_counter& counter) noexcept
+    {
+        _coroutine.promise().counter = std::addressof(counter);
+        _coroutine.resume();
+    }
+
+private:
+    handle_type _coroutine;
+
+    explicit when_all_child(handle_type coroutine) noexcept : _coroutine(coroutine) {}
+};
+
+template<typename T>
+[[nodiscard]] when_all_child make_when_all_child(lazy_task<T>& child_task, when_all_result<T>& result)
+{
+    try {
+        if constexpr (std::is_same_v<T, void>) {
+            co_await child_task;
+            result.value.emplace();
+        } else {
+            result.value.emplace(co_await child_task);
+        }
+    } catch (...) {
+        result.exception = std::current_exception();
+    }
+}
+
+/** Start all children and suspend until all of them have completed.
+ */
+template<typename Children>
+[[nodiscard]] auto when_all_await(Children& children) noexcept
+{
+    struct awaiter_type {
+        Children *children;
+        when_all_counter counter;
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            // The continuation must be set before any child is started, as a child may
+            // complete on another thread.
+            counter.set_continuation(handle);
+            for (auto& child : *children) {
+                child.start(counter);
+            }
+            return counter.suspend();
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+    return awaiter_type{std::addressof(children), when_all_counter{children.size()}};
+}
+
+} // namespace detail
+
+/** Await on multiple tasks.
+ *
+ * The tasks are started in order on the current thread; a task that resumes
+ * itself on a thread pool using `resume_on()` will run in parallel with the
+ * other tasks. The returned task completes after all tasks have completed.
+ *
+ * ```cpp
+ * auto [a, b] = co_await when_all(decode(path_a), decode(path_b));
+ * ```
+ *
+ * @param tasks The tasks to await on.
+ * @return A task with a `std::tuple` of the results of each task. A task that
+ *         returns `void` results in a `std::monostate`.
+ * @throws The exception thrown by the first task that failed, after all tasks have completed.
+ */
+template<typename... Ts>
+[[nodiscard]] lazy_task<std::tuple<variant_decay_t<Ts>...>> when_all(lazy_task<Ts>... tasks)
+{
+    auto results = std::tuple<detail::when_all_result<Ts>...>{};
+    auto children = [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<detail::when_all_child, sizeof...(Ts)>{detail::make_when_all_child(tasks, std::get<I>(results))...};
+    }(std::index_sequence_for<Ts...>{});
+
+    co_await detail::when_all_await(children);
+
+    co_return std::apply(
+        [](auto&...result) {
+            return std::tuple<variant_decay_t<Ts>...>{result.get()...};
+        },
+        results);
+}
+
+/** Await on a list of tasks.
+ *
+ * @see when_all(lazy_task<Ts>...)
+ * @param tasks The tasks to await on.
+ * @return A task with a `std::vector` of the results of each task, or `void`
+ *         when the tasks return `void`.
+ * @throws The exception thrown by the first task that failed, after all tasks have completed.
+ */
+template<typename T>
+[[nodiscard]] lazy_task<std::conditional_t<std::is_same_v<T, void>, void, std::vector<T>>> when_all(std::vector<lazy_task<T>> tasks)
+{
+    auto results = std::vector<detail::when_all_result<T>>(tasks.size());
+    auto children = std::vector<detail::when_all_child>{};
+    children.reserve(tasks.size());
+    for (auto i = 0_uz; i != tasks.size(); ++i) {
+        children.push_back(detail::make_when_all_child(tasks[i], results[i]));
+    }
+
+    co_await detail::when_all_await(children);
+
+    if constexpr (std::is_same_v<T, void>) {
+        for (auto& result : results) {
+            result.get();
+        }
+
+    } else {
+        auto r = std::vector<T>{};
+        r.reserve(results.size());
+        for (auto& result : results) {
+            r.push_back(result.get());
+        }
+        co_return r;
+    }
+}
+
+} // namespace hi::inline v1
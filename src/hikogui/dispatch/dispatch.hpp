@@ -9,10 +9,17 @@
 #include "awaitable_timer_impl.hpp" // export
 #include "function_timer.hpp" // export
 #include "loop_intf.hpp" // export
+#if HI_OPERATING_SYSTEM == HI_OS_WINDOWS
 #include "loop_win32_impl.hpp" // export
+#elif HI_OPERATING_SYSTEM == HI_OS_LINUX
+#include "loop_linux_impl.hpp" // export
+#else
+#error "Not implemented."
+#endif
 #include "notifier.hpp" // export
 #include "scoped_task.hpp" // export
 #include "socket_event.hpp" // export
+#include "thread_pool.hpp" // export
 #include "when_any.hpp" // export
 
 hi_export_module(hikogui.dispatch);
@@ -9,23 +9,67 @@
 #include "../concurrency/concurrency.hpp"
 #include "../macros.hpp"
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <chrono>
 #include <functional>
+#include <bit>
+#include <limits>
 
 hi_export_module(hikogui.dispatch.function_timer);
 
 hi_export namespace hi::inline v1 {
 
 /** A timer that calls functions.
+ *
+ * The functions are stored in a hierarchical timing wheel; adding a function
+ * is constant time, and a function is cancelled by destroying the callback
+ * token that was returned. Cancelled functions are removed lazily, when
+ * their slot in the wheel is handled.
+ *
+ * Time is divided in ticks of the length of the slack. Functions whose
+ * time points fall in the same tick are called together, at most the slack
+ * after their time point and never before.
+ *
+ * The first level of the wheel has a slot for each of the next 64 ticks,
+ * each next level has slots that span 64 slots of the previous level.
+ * When the current tick reaches a slot of a higher level, its functions are
+ * moved to the lower levels.
  */
 class function_timer {
 public:
+    /** The number of slots on each level of the wheel.
+     */
+    constexpr static std::size_t num_slots = 64;
+
+    /** The number of levels of the wheel.
+     *
+     * With a slack of 1 ms the levels span more than two years,
+     * functions further in the future are kept in an overflow slot.
+     */
+    constexpr static std::size_t num_levels = 6;
+
     constexpr function_timer() noexcept = default;
 
+    /** Create a timer.
+     *
+     * @param slack The maximum time a function is called after its time point.
+     */
+    constexpr explicit function_timer(std::chrono::nanoseconds slack) noexcept : _slack(slack)
+    {
+        hi_axiom(slack > std::chrono::nanoseconds::zero());
+    }
+
+    /** The maximum time a function is called after its time point.
+     */
+    [[nodiscard]] constexpr std::chrono::nanoseconds slack() const noexcept
+    {
+        return _slack;
+    }
+
     [[nodiscard]] constexpr bool empty() const noexcept
     {
-        return _functions.empty();
+        return _size == 0;
     }
 
     /** Add a function to be called at a certain time.
@@ -37,14 +81,8 @@ public:
     template<forward_of<void()> Func>
     [[nodiscard]] std::pair<callback<void()>, bool> delay_function(utc_nanoseconds time_point, Func &&func) noexcept
     {
-        hilet it = std::lower_bound(_functions.begin(), _functions.end(), time_point, [](hilet& x, hilet& time_point) {
-            return x.time_point > time_point;
-        });
-
-        hilet next_to_call = it == _functions.end();
-
         auto token = callback<void()>{std::forward<Func>(func)};
-        _functions.emplace(it, time_point, std::chrono::nanoseconds::max(), token);
+        hilet next_to_call = insert(time_point, std::chrono::nanoseconds::max(), token);
         return {std::move(token), next_to_call};
     }
 
@@ -61,13 +99,9 @@ public:
         utc_nanoseconds time_point,
         Func &&func) noexcept
     {
-        auto it = std::lower_bound(_functions.begin(), _functions.end(), time_point, [](hilet& x, hilet& time_point) {
-            return x.time_point > time_point;
-        });
-
         auto token = callback<void()>{std::forward<Func>(func)};
-        it = _functions.emplace(it, time_point, period, token);
-        return {std::move(token), it + 1 == _functions.end()};
+        hilet next_to_call = insert(time_point, period, token);
+        return {std::move(token), next_to_call};
     }
 
     /** Add a function to be called repeatedly.
@@ -83,111 +117,282 @@ public:
     }
 
     /** Get the deadline of the next function to call.
+     *
+     * The deadline may also be the time when functions need to be moved to a
+     * lower level of the wheel; in that case `run_all()` will not call any function.
      *
      * @return The deadline of the next function to call, or far/max into the future.
      */
     [[nodiscard]] utc_nanoseconds current_deadline() const noexcept
     {
-        if (_functions.empty()) {
+        hilet tick = next_tick();
+        if (tick == std::numeric_limits<uint64_t>::max()) {
             return utc_nanoseconds::max();
         } else {
-            return _functions.back().time_point;
+            return from_tick(tick);
         }
     }
 
     /** Run all the function that should have run by the current_time.
      *
      * @param current_time The current time.
-     * @param args The arguments to pass to the function.
      */
-    void run_all(utc_nanoseconds current_time, auto const&...args) noexcept
+    void run_all(utc_nanoseconds current_time) noexcept
     {
-        while (current_deadline() <= current_time) {
-            run_one(current_time, args...);
+        hilet current_tick = to_tick_floor(current_time);
+        for (auto tick = next_tick(); tick <= current_tick; tick = next_tick()) {
+            run_tick(tick, current_time);
         }
     }
 
 private:
+    constexpr static std::size_t slot_bits = std::countr_zero(num_slots);
+    constexpr static std::size_t overflow_slot = num_levels * num_slots;
+    constexpr static uint32_t nil = std::numeric_limits<uint32_t>::max();
+
     struct timer_type {
         utc_nanoseconds time_point;
         std::chrono::nanoseconds period;
         weak_callback<void()> callback;
 
-        timer_type() noexcept = default;
-        timer_type(timer_type const&) noexcept = default;
-        timer_type(timer_type&&) noexcept = default;
-        timer_type& operator=(timer_type const&) noexcept = default;
-        timer_type& operator=(timer_type&&) noexcept = default;
+        /** The next timer in the same slot, or in the free-list.
+         */
+        uint32_t next = nil;
 
-        timer_type(utc_nanoseconds time_point, std::chrono::nanoseconds period, weak_callback<void()> callback) noexcept :
-            time_point(time_point), period(period), callback(std::move(callback))
+        [[nodiscard]] constexpr bool repeats() const noexcept
         {
+            return period != std::chrono::nanoseconds::max();
         }
+    };
 
-        timer_type(utc_nanoseconds time_point, weak_callback<void()> callback) noexcept :
-            timer_type(time_point, std::chrono::nanoseconds::max(), std::move(callback))
-        {
+    std::chrono::nanoseconds _slack = std::chrono::milliseconds(1);
+
+    /** All the timers; unused timers are linked in the free-list.
+     */
+    std::vector<timer_type> _timers;
+
+    /** The first timer of each slot, for each level, followed by the overflow slot.
+     */
+    std::array<uint32_t, overflow_slot + 1> _slots = make_empty_slots();
+
+    /** For each level a bit for each slot that has a timer.
+     */
+    std::array<uint64_t, num_levels> _occupied = {};
+
+    uint32_t _free = nil;
+
+    /** The number of timers in the wheel.
+     */
+    std::size_t _size = 0;
+
+    /** The tick that is handled next, all earlier ticks have been handled.
+     */
+    uint64_t _current_tick = 0;
+
+    [[nodiscard]] constexpr static std::array<uint32_t, overflow_slot + 1> make_empty_slots() noexcept
+    {
+        auto r = std::array<uint32_t, overflow_slot + 1>{};
+        std::fill(r.begin(), r.end(), nil);
+        return r;
+    }
+
+    [[nodiscard]] uint64_t to_tick_floor(utc_nanoseconds time_point) const noexcept
+    {
+        hilet count = time_point.time_since_epoch().count();
+        return count <= 0 ? 0 : narrow_cast<uint64_t>(count / _slack.count());
+    }
+
+    /** The tick of a function; rounded up so that functions are never called early.
+     */
+    [[nodiscard]] uint64_t to_tick_ceil(utc_nanoseconds time_point) const noexcept
+    {
+        if (time_point == utc_nanoseconds::max()) {
+            return std::numeric_limits<uint64_t>::max() - 1;
         }
+        hilet count = time_point.time_since_epoch().count();
+        return count <= 0 ? 0 : narrow_cast<uint64_t>((count - 1) / _slack.count() + 1);
+    }
 
-        timer_type(std::chrono::nanoseconds period, weak_callback<void()> callback) noexcept :
-            timer_type(std::chrono::utc_clock::now(), period, std::move(callback))
-        {
+    [[nodiscard]] utc_nanoseconds from_tick(uint64_t tick) const noexcept
+    {
+        if (tick > narrow_cast<uint64_t>(utc_nanoseconds::max().time_since_epoch().count() / _slack.count())) {
+            return utc_nanoseconds::max();
         }
+        return utc_nanoseconds{narrow_cast<int64_t>(tick) * _slack};
+    }
 
-        [[nodiscard]] constexpr bool repeats() const noexcept
-        {
-            return period != std::chrono::nanoseconds::max();
+    /** The tick when something needs to be done; call functions or move functions to a lower level.
+     */
+    [[nodiscard]] uint64_t next_tick() const noexcept
+    {
+        // The occupied slots of a level are all after the current tick's slot on
+        // that level, and within the same slot of the level above.
+        for (auto level = 0_uz; level != num_levels; ++level) {
+            if (hilet occupied = _occupied[level]) {
+                hilet shift = level * slot_bits;
+                hilet block = (_current_tick >> (shift + slot_bits)) << (shift + slot_bits);
+                return block | (narrow_cast<uint64_t>(std::countr_zero(occupied)) << shift);
+            }
         }
-    };
 
-    void remove_or_reinsert(utc_nanoseconds current_time) noexcept
+        if (_slots[overflow_slot] != nil) {
+            constexpr auto shift = num_levels * slot_bits;
+            return ((_current_tick >> shift) + 1) << shift;
+        }
+
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    [[nodiscard]] uint32_t allocate() noexcept
     {
-        hi_assert(not _functions.empty());
+        if (_free != nil) {
+            return std::exchange(_free, _timers[_free].next);
+        } else {
+            _timers.emplace_back();
+            return narrow_cast<uint32_t>(_timers.size() - 1);
+        }
+    }
 
-        if (_functions.back().repeats() and not _functions.back().callback.expired()) {
-            // When the function is repeating, calculate the new.
-            auto item = std::move(_functions.back());
-            _functions.pop_back();
+    void deallocate(uint32_t index) noexcept
+    {
+        auto& timer = _timers[index];
+        timer.callback.reset();
+        timer.next = std::exchange(_free, index);
+        --_size;
+    }
 
-            // Delay the function to be called on the next period.
-            // However if the current_time already is passed the deadline, delay it even further.
-            item.time_point += item.period;
-            if (item.time_point > current_time) {
-                item.time_point = current_time + item.period;
-            }
+    /** Link a timer in the slot of its tick.
+     */
+    void link(uint32_t index) noexcept
+    {
+        hilet tick = std::max(to_tick_ceil(_timers[index].time_point), _current_tick);
 
-            // Reinsert the function in the sorted list of functions.
-            hilet it = std::lower_bound(_functions.begin(), _functions.end(), item.time_point, [](hilet& x, hilet& time_point) {
-                return x.time_point > time_point;
-            });
+        // The level is selected by the highest slot that differs from the current tick.
+        hilet difference = tick ^ _current_tick;
+        hilet level = difference == 0 ? 0_uz : narrow_cast<std::size_t>(std::bit_width(difference) - 1) / slot_bits;
 
-            _functions.insert(it, std::move(item));
+        auto slot = overflow_slot;
+        if (level < num_levels) {
+            hilet slot_index = narrow_cast<std::size_t>((tick >> (level * slot_bits)) & (num_slots - 1));
+            _occupied[level] |= uint64_t{1} << slot_index;
+            slot = level * num_slots + slot_index;
+        }
 
-        } else {
-            _functions.pop_back();
+        _timers[index].next = std::exchange(_slots[slot], index);
+    }
+
+    /** Add a timer.
+     *
+     * @return True if the timer is the next to call.
+     */
+    [[nodiscard]] bool insert(utc_nanoseconds time_point, std::chrono::nanoseconds period, weak_callback<void()> callback) noexcept
+    {
+        if (_size == 0) {
+            // Restart the wheel at the current time; so that timers are placed on the lowest levels.
+            _current_tick = to_tick_floor(std::chrono::utc_clock::now());
         }
+
+        hilet previous_tick = next_tick();
+
+        hilet index = allocate();
+        auto& timer = _timers[index];
+        timer.time_point = time_point;
+        timer.period = period;
+        timer.callback = std::move(callback);
+        ++_size;
+        link(index);
+
+        return next_tick() < previous_tick;
     }
 
-    /** Call the next function on the list.
+    /** Remove all the timers from a slot.
      *
-     * @note it is undefined behavior to call this function if the current_deadline() has not passed.
-     * @param current_time The current time, this is used when reinserting periodic function to handle starvation issues.
+     * @return The first timer of the list of timers that were in the slot.
      */
-    void run_one(utc_nanoseconds current_time)
+    [[nodiscard]] uint32_t unlink_slot(std::size_t level, std::size_t slot_index) noexcept
     {
-        hi_assert(not _functions.empty());
+        _occupied[level] &= ~(uint64_t{1} << slot_index);
+        return std::exchange(_slots[level * num_slots + slot_index], nil);
+    }
+
+    /** Move the timers of a slot to the lower levels, and remove cancelled timers.
+     */
+    void cascade(uint32_t index) noexcept
+    {
+        while (index != nil) {
+            hilet next = _timers[index].next;
+            if (_timers[index].callback.expired()) {
+                deallocate(index);
+            } else {
+                link(index);
+            }
+            index = next;
+        }
+    }
+
+    /** Move the current tick forward.
+     *
+     * The timers of the slots that the current tick enters on the higher levels are moved down.
+     */
+    void advance(uint64_t tick) noexcept
+    {
+        hilet previous_tick = std::exchange(_current_tick, tick);
+
+        constexpr auto overflow_shift = num_levels * slot_bits;
+        if ((previous_tick >> overflow_shift) != (tick >> overflow_shift)) {
+            cascade(std::exchange(_slots[overflow_slot], nil));
+        }
 
-        auto &callback = _functions.back().callback;
-        if (callback.lock()) {
-            callback();
-            callback.unlock();
+        for (auto level = num_levels - 1; level != 0; --level) {
+            hilet shift = level * slot_bits;
+            if ((previous_tick >> shift) != (tick >> shift)) {
+                cascade(unlink_slot(level, narrow_cast<std::size_t>((tick >> shift) & (num_slots - 1))));
+            }
         }
-        remove_or_reinsert(current_time);
     }
 
-    /** Functions, sorted by descending time.
+    /** Handle a tick.
+     *
+     * @param tick The tick to handle, the result of next_tick().
+     * @param current_time The current time, this is used when reinserting periodic function to handle starvation issues.
      */
-    std::vector<timer_type> _functions;
+    void run_tick(uint64_t tick, utc_nanoseconds current_time) noexcept
+    {
+        hi_axiom(tick >= _current_tick);
+        advance(tick);
+
+        // The timers in the slot of the first level are called. Advance the current
+        // tick first, so that timers added by the functions are linked in a later slot.
+        auto index = unlink_slot(0, narrow_cast<std::size_t>(tick & (num_slots - 1)));
+        advance(tick + 1);
+
+        while (index != nil) {
+            hilet next = _timers[index].next;
+
+            // The function may add timers, which may reallocate _timers.
+            auto callback = std::move(_timers[index].callback);
+            if (callback.lock()) {
+                callback();
+                callback.unlock();
+            }
+
+            auto& timer = _timers[index];
+            if (timer.repeats() and not callback.expired()) {
+                // Delay the function to be called on the next period.
+                // However if the current_time already is passed the deadline, delay it even further.
+                timer.time_point += timer.period;
+                if (timer.time_point <= current_time) {
+                    timer.time_point = current_time + timer.period;
+                }
+                timer.callback = std::move(callback);
+                link(index);
+            } else {
+                deallocate(index);
+            }
+
+            index = next;
+        }
+    }
 };
 
 } // namespace hi::inline v1
@@ -0,0 +1,115 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "function_timer.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+using namespace hi;
+using namespace std::chrono_literals;
+
+TEST(function_timer, delay)
+{
+    auto timer = function_timer{1ms};
+    hilet start = std::chrono::utc_clock::now();
+
+    auto calls = std::vector<int>{};
+    auto [a, a_first] = timer.delay_function(start + 10ms, [&] {
+        calls.push_back(1);
+    });
+    ASSERT_TRUE(a_first);
+    auto [b, b_first] = timer.delay_function(start + 5ms, [&] {
+        calls.push_back(2);
+    });
+    ASSERT_TRUE(b_first);
+    auto [c, c_first] = timer.delay_function(start + 5s, [&] {
+        calls.push_back(3);
+    });
+    ASSERT_FALSE(c_first);
+
+    // Functions are never called early.
+    ASSERT_GE(timer.current_deadline(), start + 5ms);
+    timer.run_all(start + 4ms);
+    ASSERT_TRUE(calls.empty());
+
+    // And at most the slack late.
+    timer.run_all(start + 6ms);
+    ASSERT_EQ(calls, std::vector<int>({2}));
+
+    timer.run_all(start + 1s);
+    ASSERT_EQ(calls, std::vector<int>({2, 1}));
+    ASSERT_FALSE(timer.empty());
+
+    // Move the function from the higher levels of the wheel down.
+    timer.run_all(start + 5s + 1ms);
+    ASSERT_EQ(calls, std::vector<int>({2, 1, 3}));
+    ASSERT_TRUE(timer.empty());
+    ASSERT_EQ(timer.current_deadline(), utc_nanoseconds::max());
+}
+
+TEST(function_timer, cancel)
+{
+    auto timer = function_timer{1ms};
+    hilet start = std::chrono::utc_clock::now();
+
+    auto count = 0;
+    auto [a, a_first] = timer.delay_function(start + 10ms, [&] {
+        ++count;
+    });
+    auto [b, b_first] = timer.delay_function(start + 1h, [&] {
+        ++count;
+    });
+
+    // Destroying the token cancels the function.
+    a = {};
+    b = {};
+    timer.run_all(start + 2h);
+    ASSERT_EQ(count, 0);
+    ASSERT_TRUE(timer.empty());
+}
+
+TEST(function_timer, repeat)
+{
+    auto timer = function_timer{1ms};
+    hilet start = std::chrono::utc_clock::now();
+
+    auto count = 0;
+    auto [a, a_first] = timer.repeat_function(10ms, start, [&] {
+        ++count;
+    });
+
+    for (auto t = start; t <= start + 1s; t += 1ms) {
+        timer.run_all(t);
+    }
+    ASSERT_GE(count, 99);
+    ASSERT_LE(count, 101);
+
+    a = {};
+    timer.run_all(start + 2s);
+    ASSERT_TRUE(timer.empty());
+}
+
+TEST(function_timer, many)
+{
+    auto timer = function_timer{1ms};
+    hilet start = std::chrono::utc_clock::now();
+
+    auto count = 0;
+    auto tokens = std::vector<callback<void()>>{};
+    for (auto i = 0; i != 10'000; ++i) {
+        auto [token, first] = timer.delay_function(start + i * 997us, [&] {
+            ++count;
+        });
+        tokens.push_back(std::move(token));
+    }
+
+    auto t = start;
+    while (not timer.empty()) {
+        t = std::max(t + 1ms, timer.current_deadline());
+        timer.run_all(t);
+    }
+    ASSERT_EQ(count, 10'000);
+}
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "function_timer.hpp"
+#include "thread_pool.hpp"
 #include "socket_event.hpp"
 #include "notifier.hpp"
 #include "../container/container.hpp"
@@ -173,6 +174,19 @@ public:
         return *start_subsystem_or_terminate(_timer, nullptr, timer_init, timer_deinit);
     }
 
+    /** Get or create the thread pool.
+     *
+     * The thread pool is used for CPU heavy work that can be run in parallel,
+     * like decoding images and shaping text.
+     *
+     * @note The first time this is called the worker threads are started,
+     *       one for each CPU.
+     */
+    [[nodiscard]] hi_no_inline static thread_pool& pool() noexcept
+    {
+        return *start_subsystem_or_terminate(_pool, nullptr, pool_init, pool_deinit);
+    }
+
     /** Set maximum frame rate.
      *
      * A frame rate above 30.0 may will cause the vsync thread to block on
@@ -290,6 +304,11 @@ public:
      * - error | write: Unblock when there is buffer space available for write.
      * - error | read | write: Unblock when there is data available for read of when there is buffer space available for write.
      *
+     * The callback is called when an event happens, not while the socket is in
+     * a state. After a read event the callback should read until the socket
+     * would block; a write event is only reported again after a write would
+     * have blocked.
+     *
      * @note Only one callback can be associated with a socket.
      * @param fd File descriptor of the socket.
      * @param event_mask The socket events to wait for.
@@ -382,6 +401,17 @@ private:
         }
     }
 
+    static thread_pool *pool_init() noexcept
+    {
+        return new thread_pool{};
+    }
+
+    static void pool_deinit() noexcept
+    {
+        // Destroying the thread pool finishes the functions that are still queued.
+        delete _pool.exchange(nullptr, std::memory_order::acquire);
+    }
+
     /** Pointer to the main-loop.
      */
     inline static std::atomic<loop *> _main;
@@ -392,6 +422,10 @@ private:
 
     inline static std::jthread _timer_thread;
 
+    /** Pointer to the thread pool.
+     */
+    inline static std::atomic<thread_pool *> _pool;
+
     std::unique_ptr<impl_type> _pimpl;
 };
 
@@ -430,4 +464,11 @@ void notifier<R(Args...)>::loop_timer_post_function(Func&& func) const noexcept
     return loop::timer().post_function(std::forward<Func>(func));
 }
 
+template<typename R, typename... Args>
+template<forward_of<void()> Func>
+void notifier<R(Args...)>::loop_pool_post_function(Func&& func) const noexcept
+{
+    return loop::pool().post_function(std::forward<Func>(func));
+}
+
 } // namespace hi::inline v1
@@ -0,0 +1,393 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file loop_linux_impl.hpp
+ *
+ * This is the Linux implementation of the loop.
+ *
+ * It works as follows:
+ *
+ * The loop blocks on `epoll_wait()` which waits on a set of file descriptors:
+ *
+ * - An eventfd which is written to by `notify_has_send()` when a function is
+ *   posted on the function-fifo, or when a new timer becomes the first to call.
+ * - A timerfd which is armed with the deadline of the first function of the
+ *   function-timer. It is re-armed before blocking when the deadline changed.
+ * - A timerfd which is armed periodically at the maximum frame rate while
+ *   there are render functions, Linux has no vertical-blank event to wait on.
+ * - The file descriptor of each socket added with `add_socket()`. Sockets are
+ *   edge-triggered, so that a socket that stays writable does not wake up the
+ *   loop on every iteration; the same as `FD_WRITE` of `WSAEventSelect()` on win32.
+ *
+ * After every wake-up the elapsed timers are called, and then the function-fifo
+ * is drained completely; this includes functions that were posted wait-free
+ * without waking up the loop.
+ */
+
+#pragma once
+
+#include "loop_intf.hpp"
+#include "socket_event.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include <utility>
+#include <stop_token>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <array>
+#include <format>
+
+hi_export_module(hikogui.dispatch : loop_impl);
+
+hi_export namespace hi::inline v1 {
+
+class loop_impl_linux final : public loop::impl_type {
+public:
+    loop_impl_linux() : loop::impl_type()
+    {
+        if ((_epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+            hi_log_fatal("Could not create an epoll file descriptor. {}", get_last_error_message());
+        }
+
+        if ((_function_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) == -1) {
+            hi_log_fatal("Could not create an async-event file descriptor. {}", get_last_error_message());
+        }
+        epoll_add(_function_fd, EPOLLIN);
+
+        if ((_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+            hi_log_fatal("Could not create a timer file descriptor. {}", get_last_error_message());
+        }
+        epoll_add(_timer_fd, EPOLLIN);
+
+        if ((_render_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+            hi_log_fatal("Could not create a render-timer file descriptor. {}", get_last_error_message());
+        }
+        epoll_add(_render_fd, EPOLLIN);
+    }
+
+    ~loop_impl_linux()
+    {
+        for (hilet fd : {_render_fd, _timer_fd, _function_fd, _epoll_fd}) {
+            if (::close(fd) != 0) {
+                hi_log_error("Could not close file descriptor {}. {}", fd, get_last_error_message());
+            }
+        }
+    }
+
+    void set_maximum_frame_rate(double frame_rate) noexcept override
+    {
+        hi_axiom(on_thread());
+        hi_axiom(frame_rate > 0.0);
+
+        _maximum_frame_rate = frame_rate;
+        _minimum_frame_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>{1.0 / frame_rate});
+        if (not _render_functions.empty()) {
+            arm_render_timer();
+        }
+    }
+
+    void set_vsync_monitor_id(uintptr_t id) noexcept override
+    {
+        // Frames are paced by a timer, not by the vertical-blank of a monitor.
+    }
+
+    void subscribe_render(weak_callback<void(utc_nanoseconds)> callback) noexcept override
+    {
+        hi_axiom(on_thread());
+        _render_functions.push_back(std::move(callback));
+
+        // Start the frame timer once there is a window.
+        if (_render_functions.size() == 1) {
+            arm_render_timer();
+        }
+    }
+
+    void add_socket(int fd, socket_event event_mask, std::function<void(int, socket_events const&)> f) override
+    {
+        hi_axiom(on_thread());
+
+        hilet [it, inserted] = _sockets.try_emplace(fd, socket_type{event_mask, std::move(f)});
+        if (not inserted) {
+            throw io_error(std::format("Socket {} was already added to the loop.", fd));
+        }
+
+        // Edge-triggered; a level-triggered EPOLLOUT would fire continuously while
+        // the send buffer has space, and spin the loop.
+        auto event = epoll_event{};
+        event.events = socket_event_to_epoll(event_mask) | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            _sockets.erase(it);
+            throw io_error(std::format("Could not add socket {} to the loop. {}", fd, get_last_error_message()));
+        }
+    }
+
+    void remove_socket(int fd) override
+    {
+        hi_axiom(on_thread());
+
+        if (_sockets.erase(fd) == 0) {
+            return;
+        }
+
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr) != 0) {
+            // The socket may already have been closed, which removes it from the epoll set.
+            hi_log_info("Could not remove socket {} from the loop. {}", fd, get_last_error_message());
+        }
+    }
+
+    int resume(std::stop_token stop_token) noexcept override
+    {
+        // Wake up the loop when a stop is requested from another thread.
+        hilet stop_cb = std::stop_callback(stop_token, [this] {
+            notify_has_send();
+        });
+
+        _exit_code = {};
+        while (not _exit_code) {
+            if (stop_token.stop_possible()) {
+                if (stop_token.stop_requested()) {
+                    // Stop immediately when stop is requested.
+                    _exit_code = 0;
+                    break;
+                }
+            } else {
+                if (_render_functions.empty() and _function_fifo.empty() and _function_timer.empty() and _sockets.empty()) {
+                    // If there is not stop token, then exit when there are no more resources to wait on.
+                    _exit_code = 0;
+                    break;
+                }
+            }
+
+            resume_once(true);
+        }
+
+        return *_exit_code;
+    }
+
+    void resume_once(bool block) noexcept override
+    {
+        hi_axiom(on_thread());
+
+        arm_timer();
+
+        // Functions that were posted wait-free, before the loop was resumed, did not trigger the async-event.
+        hilet timeout = block and _function_fifo.empty() ? -1 : 0;
+
+        hilet num_events = epoll_wait(_epoll_fd, _events.data(), narrow_cast<int>(_events.size()), timeout);
+        if (num_events == -1) {
+            if (errno != EINTR) {
+                hi_log_fatal("Failed on epoll_wait(), {}", get_last_error_message());
+            }
+        }
+
+        for (auto i = 0; i < num_events; ++i) {
+            hilet& event = _events[i];
+
+            if (event.data.fd == _function_fd) {
+                // handle_functions() is called after every wake-up of epoll_wait().
+                read_counter(_function_fd);
+
+            } else if (event.data.fd == _timer_fd) {
+                // handle_timers() is called after every wake-up of epoll_wait().
+                read_counter(_timer_fd);
+                _armed_deadline = utc_nanoseconds::max();
+
+            } else if (event.data.fd == _render_fd) {
+                read_counter(_render_fd);
+                handle_render();
+
+            } else {
+                handle_socket(event.data.fd, event.events);
+            }
+        }
+
+        // Make sure timers are handled first, possibly they are time critical.
+        handle_timers();
+
+        // When functions are added wait-free, the function-event is never triggered.
+        // So handle messages after any kind of wake up.
+        handle_functions();
+    }
+
+private:
+    struct socket_type {
+        socket_event mode;
+        std::function<void(int, socket_events const&)> callback;
+    };
+
+    /** The maximum number of events handled on each wake-up.
+     */
+    constexpr static size_t _max_num_events = 64;
+
+    int _epoll_fd = -1;
+
+    /** eventfd, written to when a function is posted.
+     */
+    int _function_fd = -1;
+
+    /** timerfd, armed for the deadline of the function-timer.
+     */
+    int _timer_fd = -1;
+
+    /** timerfd, periodically armed for rendering.
+     */
+    int _render_fd = -1;
+
+    /** The deadline of the function-timer for which the _timer_fd is armed.
+     */
+    utc_nanoseconds _armed_deadline = utc_nanoseconds::max();
+
+    std::unordered_map<int, socket_type> _sockets;
+
+    std::array<epoll_event, _max_num_events> _events;
+
+    void epoll_add(int fd, uint32_t events) noexcept
+    {
+        auto event = epoll_event{};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            hi_log_fatal("Could not add file descriptor {} to epoll. {}", fd, get_last_error_message());
+        }
+    }
+
+    /** Reset the counter of an eventfd or timerfd.
+     */
+    static void read_counter(int fd) noexcept
+    {
+        uint64_t counter;
+        if (::read(fd, &counter, sizeof(counter)) == -1 and errno != EAGAIN) {
+            hi_log_error("Could not read file descriptor {}. {}", fd, get_last_error_message());
+        }
+    }
+
+    [[nodiscard]] static itimerspec make_itimerspec(std::chrono::nanoseconds value, std::chrono::nanoseconds interval) noexcept
+    {
+        hilet to_timespec = [](std::chrono::nanoseconds rhs) {
+            auto r = timespec{};
+            r.tv_sec = narrow_cast<time_t>(rhs.count() / 1'000'000'000);
+            r.tv_nsec = narrow_cast<long>(rhs.count() % 1'000'000'000);
+            return r;
+        };
+
+        auto r = itimerspec{};
+        r.it_value = to_timespec(value);
+        r.it_interval = to_timespec(interval);
+        return r;
+    }
+
+    static void set_timer(int fd, std::chrono::nanoseconds value, std::chrono::nanoseconds interval = {}) noexcept
+    {
+        hilet spec = make_itimerspec(value, interval);
+        if (timerfd_settime(fd, 0, &spec, nullptr) != 0) {
+            hi_log_error("Could not set timer {}. {}", fd, get_last_error_message());
+        }
+    }
+
+    /** Arm the timer for the first function of the function-timer.
+     *
+     * This is cheap when the deadline did not change.
+     */
+    void arm_timer() noexcept
+    {
+        hilet deadline = _function_timer.current_deadline();
+        if (deadline == _armed_deadline) {
+            return;
+        }
+        _armed_deadline = deadline;
+
+        if (deadline == utc_nanoseconds::max()) {
+            // Disarm.
+            set_timer(_timer_fd, std::chrono::nanoseconds{0});
+        } else {
+            // A zero value disarms the timer, so a deadline that has passed fires after a nanosecond.
+            hilet timeout = std::max(deadline - std::chrono::utc_clock::now(), std::chrono::nanoseconds{1});
+            set_timer(_timer_fd, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+        }
+    }
+
+    void arm_render_timer() noexcept
+    {
+        set_timer(_render_fd, _minimum_frame_time, _minimum_frame_time);
+    }
+
+    void notify_has_send() noexcept override
+    {
+        uint64_t counter = 1;
+        if (::write(_function_fd, &counter, sizeof(counter)) == -1 and errno != EAGAIN) {
+            hi_log_error("Could not trigger async-event. {}", get_last_error_message());
+        }
+    }
+
+    void handle_render() noexcept
+    {
+        hilet display_time = std::chrono::utc_clock::now() + _minimum_frame_time;
+
+        for (auto& render_function : _render_functions) {
+            if (render_function.lock()) {
+                render_function(display_time);
+                render_function.unlock();
+            }
+        }
+
+        std::erase_if(_render_functions, [](auto& render_function) {
+            return render_function.expired();
+        });
+
+        if (_render_functions.empty()) {
+            // Stop the frame timer when there are no more windows.
+            set_timer(_render_fd, std::chrono::nanoseconds{0});
+        }
+    }
+
+    void handle_socket(int fd, uint32_t events) noexcept
+    {
+        hilet it = _sockets.find(fd);
+        if (it == _sockets.end()) {
+            // The socket was removed by a callback during this wake-up.
+            return;
+        }
+
+        auto error = 0;
+        if (events & EPOLLERR) {
+            auto error_size = narrow_cast<socklen_t>(sizeof(error));
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_size) != 0) {
+                error = errno;
+            }
+        }
+
+        hilet socket_events = socket_events_from_epoll(events, it->second.mode, error);
+        if (socket_events.events != socket_event::none) {
+            // Copy the callback, as it may remove the socket.
+            auto callback = it->second.callback;
+            callback(fd, socket_events);
+        }
+    }
+
+    /** Handle all function calls.
+     */
+    void handle_functions() noexcept
+    {
+        _function_fifo.run_all();
+    }
+
+    void handle_timers() noexcept
+    {
+        _function_timer.run_all(std::chrono::utc_clock::now());
+    }
+};
+
+hi_inline loop::loop() : _pimpl(std::make_unique<loop_impl_linux>()) {}
+
+} // namespace hi::inline v1
@@ -0,0 +1,228 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "loop_intf.hpp"
+#if HI_OPERATING_SYSTEM == HI_OS_WINDOWS
+#include "loop_win32_impl.hpp"
+#elif HI_OPERATING_SYSTEM == HI_OS_LINUX
+#include "loop_linux_impl.hpp"
+#endif
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if HI_OPERATING_SYSTEM == HI_OS_LINUX
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace hi;
+using namespace std::chrono_literals;
+
+TEST(loop, post_function)
+{
+    auto l = loop{};
+
+    auto calls = std::vector<int>{};
+    l.post_function([&] {
+        calls.push_back(1);
+    });
+    l.post_function([&] {
+        calls.push_back(2);
+    });
+    ASSERT_TRUE(calls.empty());
+
+    l.resume_once();
+    ASSERT_EQ(calls, std::vector<int>({1, 2}));
+}
+
+TEST(loop, post_function_from_other_thread)
+{
+    auto l = loop{};
+
+    auto count = 0;
+    auto thread = std::jthread{[&] {
+        for (auto i = 0; i != 100; ++i) {
+            l.post_function([&] {
+                ++count;
+            });
+        }
+    }};
+    thread.join();
+
+    // Posting from another thread wakes up a blocking loop.
+    while (count != 100) {
+        l.resume_once(true);
+    }
+    ASSERT_EQ(count, 100);
+}
+
+TEST(loop, async_function)
+{
+    auto l = loop{};
+
+    auto future = l.async_function([] {
+        return 42;
+    });
+
+    l.resume_once();
+    ASSERT_EQ(future.get(), 42);
+}
+
+TEST(loop, delay_function)
+{
+    auto l = loop{};
+
+    hilet start = std::chrono::utc_clock::now();
+    auto called_at = utc_nanoseconds{};
+    auto cb = l.delay_function(start + 20ms, [&] {
+        called_at = std::chrono::utc_clock::now();
+    });
+
+    // The timer wakes up the blocking loop.
+    while (called_at == utc_nanoseconds{}) {
+        l.resume_once(true);
+    }
+    ASSERT_GE(called_at, start + 20ms);
+}
+
+TEST(loop, delay_function_cancel)
+{
+    auto l = loop{};
+
+    auto called = false;
+    auto cb = l.delay_function(std::chrono::utc_clock::now() + 10ms, [&] {
+        called = true;
+    });
+    cb = {};
+
+    std::this_thread::sleep_for(20ms);
+    l.resume_once();
+    ASSERT_FALSE(called);
+}
+
+TEST(loop, repeat_function)
+{
+    auto l = loop{};
+
+    auto count = 0;
+    auto cb = l.repeat_function(5ms, [&] {
+        ++count;
+    });
+
+    while (count != 3) {
+        l.resume_once(true);
+    }
+    ASSERT_EQ(count, 3);
+}
+
+#if HI_OPERATING_SYSTEM == HI_OS_LINUX
+TEST(loop, socket_read)
+{
+    auto l = loop{};
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    auto num_reads = 0;
+    l.add_socket(fds[0], socket_event::read, [&](int fd, socket_events const& events) {
+        ASSERT_EQ(fd, fds[0]);
+        ASSERT_TRUE(to_bool(events.events & socket_event::read));
+        ASSERT_EQ(events.errors[bit(socket_event::read)], socket_error::success);
+
+        // Drain the socket.
+        char buffer[16];
+        while (::read(fd, buffer, sizeof(buffer)) > 0) {}
+        ++num_reads;
+    });
+
+    // Nothing to read.
+    l.resume_once();
+    ASSERT_EQ(num_reads, 0);
+
+    ASSERT_EQ(::write(fds[1], "hello", 5), 5);
+    while (num_reads == 0) {
+        l.resume_once(true);
+    }
+    ASSERT_EQ(num_reads, 1);
+
+    // The data was drained, so the socket is not reported again.
+    l.resume_once();
+    ASSERT_EQ(num_reads, 1);
+
+    ASSERT_EQ(::write(fds[1], "world", 5), 5);
+    l.resume_once(true);
+    ASSERT_EQ(num_reads, 2);
+
+    l.remove_socket(fds[0]);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(loop, socket_write_does_not_spin)
+{
+    auto l = loop{};
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    auto num_writes = 0;
+    l.add_socket(fds[0], socket_event::write, [&](int fd, socket_events const& events) {
+        ASSERT_TRUE(to_bool(events.events & socket_event::write));
+        ++num_writes;
+    });
+
+    // The socket becomes writable once.
+    l.resume_once();
+    ASSERT_EQ(num_writes, 1);
+
+    // The socket stays writable, but this is not reported on every iteration.
+    for (auto i = 0; i != 10; ++i) {
+        l.resume_once();
+    }
+    ASSERT_EQ(num_writes, 1);
+
+    l.remove_socket(fds[0]);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(loop, socket_close)
+{
+    auto l = loop{};
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    auto closed = false;
+    l.add_socket(fds[0], socket_event::close, [&](int fd, socket_events const& events) {
+        ASSERT_TRUE(to_bool(events.events & socket_event::close));
+        closed = true;
+        l.remove_socket(fd);
+    });
+
+    ::close(fds[1]);
+    while (not closed) {
+        l.resume_once(true);
+    }
+
+    ::close(fds[0]);
+}
+
+TEST(loop, socket_added_twice)
+{
+    auto l = loop{};
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    l.add_socket(fds[0], socket_event::read, [](int, socket_events const&) {});
+    ASSERT_THROW(l.add_socket(fds[0], socket_event::read, [](int, socket_events const&) {}), io_error);
+
+    l.remove_socket(fds[0]);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
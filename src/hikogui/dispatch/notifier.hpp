@@ -11,6 +11,7 @@
 #include <tuple>
 #include <functional>
 #include <coroutine>
+#include <concepts>
 #include <mutex>
 
 hi_export_module(hikogui.dispatch : notifier);
@@ -156,8 +157,9 @@ public:
     [[nodiscard]] callback_type subscribe(Func&& func, callback_flags flags = callback_flags::synchronous) noexcept
     {
         auto callback = callback_type{std::forward<Func>(func)};
-        hilet lock = std::scoped_lock(_mutex);
-        _callbacks.emplace_back(callback, flags);
+        update([&](callbacks_type& callbacks) {
+            callbacks.emplace_back(callback, flags);
+        });
         return callback;
     }
 
@@ -167,89 +169,159 @@ public:
     void loop_main_post_function(F&&) const noexcept;
     template<forward_of<void()> F>
     void loop_timer_post_function(F&&) const noexcept;
+    template<forward_of<void()> F>
+    void loop_pool_post_function(F&&) const noexcept;
 
     /** Call the subscribed callbacks with the given arguments.
      *
-     * @note This function is not reentrant.
+     * The callbacks are called from a snapshot of the list of subscribed
+     * callbacks, without taking a lock. It is therefore allowed for a callback
+     * to subscribe to, or to trigger the same notifier.
+     *
+     * @note This function is wait-free, except for callbacks with `callback_flags::once`.
      * @param args The arguments to pass with the invocation of the callback
      */
     void operator()(Args... args) const noexcept
     {
-        hilet lock = std::scoped_lock(_mutex);
-
-        for (auto& [callback, flags] : _callbacks) {
-            if (is_synchronous(flags)) {
-                if (callback.lock()) {
-                    callback(std::forward<Args>(args)...);
-                    callback.unlock();
+        auto has_expired = false;
+
+        _callbacks.lock();
+        if (hilet *const callbacks = _callbacks.get()) {
+            for (auto const& [callback, flags] : *callbacks) {
+                if (callback.expired()) {
+                    has_expired = true;
+                    continue;
                 }
 
-            } else if (is_local(flags)) {
-                loop_local_post_function([=] {
-                    // The callback object here is captured by-copy, so that
-                    // the loop can check if it was expired.
-                    if (callback.lock()) {
-                        // The captured arguments are now plain copies so we do
-                        // not forward them in the call.
-                        callback(args...);
-                        callback.unlock();
-                    }
-                });
-
-            } else if (is_main(flags)) {
-                loop_main_post_function([=] {
-                    // The callback object here is captured by-copy, so that
-                    // the loop can check if it was expired.
-                    if (callback.lock()) {
-                        // The captured arguments are now plain copies so we do
-                        // not forward them in the call.
-                        callback(args...);
-                        callback.unlock();
-                    }
-                });
+                // If the callback should only be triggered once, like inside an awaitable.
+                // Then remove it from the list first; when another thread has already
+                // removed it, that thread will do the call.
+                if (is_once(flags) and not claim_once(callback)) {
+                    continue;
+                }
 
-            } else if (is_timer(flags)) {
-                loop_timer_post_function([=] {
-                    // The callback object here is captured by-copy, so that
-                    // the loop can check if it was expired.
+                if (is_synchronous(flags)) {
                     if (callback.lock()) {
-                        // The captured arguments are now plain copies so we do
-                        // not forward them in the call.
-                        callback(args...);
+                        callback(std::forward<Args>(args)...);
                         callback.unlock();
                     }
-                });
 
-            } else {
-                hi_no_default();
+                } else if (is_local(flags)) {
+                    loop_local_post_function([=] {
+                        // The callback object here is captured by-copy, so that
+                        // the loop can check if it was expired.
+                        if (callback.lock()) {
+                            // The captured arguments are now plain copies so we do
+                            // not forward them in the call.
+                            callback(args...);
+                            callback.unlock();
+                        }
+                    });
+
+                } else if (is_main(flags)) {
+                    loop_main_post_function([=] {
+                        // The callback object here is captured by-copy, so that
+                        // the loop can check if it was expired.
+                        if (callback.lock()) {
+                            // The captured arguments are now plain copies so we do
+                            // not forward them in the call.
+                            callback(args...);
+                            callback.unlock();
+                        }
+                    });
+
+                } else if (is_timer(flags)) {
+                    loop_timer_post_function([=] {
+                        // The callback object here is captured by-copy, so that
+                        // the loop can check if it was expired.
+                        if (callback.lock()) {
+                            // The captured arguments are now plain copies so we do
+                            // not forward them in the call.
+                            callback(args...);
+                            callback.unlock();
+                        }
+                    });
+
+                } else if (is_pool(flags)) {
+                    loop_pool_post_function([=] {
+                        // The callback object here is captured by-copy, so that
+                        // the pool can check if it was expired.
+                        if (callback.lock()) {
+                            // The captured arguments are now plain copies so we do
+                            // not forward them in the call.
+                            callback(args...);
+                            callback.unlock();
+                        }
+                    });
+
+                } else {
+                    hi_no_default();
+                }
             }
+        }
+        _callbacks.unlock();
 
-            // If the callback should only be triggered once, like inside an awaitable.
-            // Then reset the weak_ptr in _callbacks so that it will be cleaned up.
-            // In the lambda above the weak_ptr is copied first so that it callback will get executed
-            // as long as the shared_ptr's use count does not go to zero.
-            if (is_once(flags)) {
-                callback.reset();
-            }
+        // Expired callbacks are removed after the notification, so that
+        // the notification itself does not need to copy the list.
+        if (has_expired) {
+            update([](callbacks_type&) {});
         }
-        clean_up();
     }
 
 private:
+    using callbacks_type = std::vector<std::pair<weak_callback_type, callback_flags>>;
+
+    /** Serializes the changes to the list of callbacks.
+     */
     mutable unfair_mutex _mutex;
 
     /** A list of callbacks and it's associated token.
+     *
+     * The list is immutable, changes are made to a copy of the list which
+     * then replaces the list. The old lists are destroyed when there are
+     * no more notifications in flight.
      */
-    mutable std::vector<std::pair<weak_callback_type, callback_flags>> _callbacks;
+    mutable rcu<callbacks_type> _callbacks;
 
-    void clean_up() const noexcept
+    /** Replace the list of callbacks with a modified copy.
+     *
+     * Callbacks that have expired are not copied.
+     *
+     * @param func A function which modifies the copy of the list of callbacks.
+     */
+    void update(std::invocable<callbacks_type&> auto&& func) const noexcept
     {
-        hi_axiom(_mutex.is_locked());
+        hilet lock = std::scoped_lock(_mutex);
+
+        auto callbacks = callbacks_type{};
+        // Only the thread holding _mutex replaces the list, so it can be read without an rcu-lock.
+        if (hilet *const old_callbacks = _callbacks.get()) {
+            callbacks.reserve(old_callbacks->size() + 1);
+            for (hilet& item : *old_callbacks) {
+                if (not item.first.expired()) {
+                    callbacks.push_back(item);
+                }
+            }
+        }
+
+        func(callbacks);
+        _callbacks.emplace(std::move(callbacks));
+    }
 
-        // Cleanup all callbacks that have expired, or when they may only be triggered once.
-        std::erase_if(_callbacks, [](hilet& item) {
-            return item.first.expired();
+    /** Remove a callback that may only be called once.
+     *
+     * @retval true The callback was removed and may be called.
+     * @retval false The callback was already removed by another notification.
+     */
+    [[nodiscard]] bool claim_once(weak_callback_type const& callback) const noexcept
+    {
+        auto found = false;
+        update([&](callbacks_type& callbacks) {
+            found = std::erase_if(callbacks, [&](hilet& item) {
+                return item.first == callback;
+            }) != 0;
         });
+        return found;
     }
 
 #ifndef NDEBUG
@@ -114,3 +114,55 @@ TEST(notifier, local_coroutine)
     ASSERT_EQ(b, 1);
     ASSERT_TRUE(cr.done());
 }
+
+TEST(notifier, synchronous_reentrant)
+{
+    auto a = 0;
+    auto b = 0;
+
+    auto n = notifier<void(int)>{};
+
+    // Subscribe and notify from within a callback of the same notifier.
+    auto b_cbt = notifier<void(int)>::callback_type{};
+    auto a_cbt = n.subscribe([&](int x) {
+        a += x;
+        if (x == 1) {
+            b_cbt = n.subscribe([&](int y) {
+                b += y;
+            });
+            n(10);
+        }
+    });
+
+    n(1);
+    ASSERT_EQ(a, 11);
+    ASSERT_EQ(b, 10);
+
+    n(100);
+    ASSERT_EQ(a, 111);
+    ASSERT_EQ(b, 110);
+
+    a_cbt = {};
+    n(1000);
+    ASSERT_EQ(a, 111);
+    ASSERT_EQ(b, 1110);
+}
+
+TEST(notifier, synchronous_once)
+{
+    auto a = 0;
+
+    auto n = notifier{};
+
+    // The callback is called only once, even when the notifier is triggered from within the callback.
+    auto a_cbt = n.subscribe(
+        [&] {
+            ++a;
+            n();
+        },
+        callback_flags::synchronous | callback_flags::once);
+
+    n();
+    n();
+    ASSERT_EQ(a, 1);
+}
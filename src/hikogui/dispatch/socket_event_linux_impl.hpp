@@ -0,0 +1,82 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "socket_event_intf.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <sys/epoll.h>
+#include <cerrno>
+#include <cstdint>
+
+hi_export_module(hikogui.dispatch.socket_event : impl);
+
+hi_export namespace hi::inline v1 {
+
+/** Get the epoll events to wait for.
+ *
+ * Events that do not exist on Linux, such as quality-of-service and
+ * routing changes, are not waited for.
+ */
+[[nodiscard]] constexpr uint32_t socket_event_to_epoll(socket_event rhs) noexcept
+{
+    auto r = uint32_t{0};
+
+    r |= to_bool(rhs & (socket_event::read | socket_event::accept)) ? uint32_t{EPOLLIN} : 0;
+    r |= to_bool(rhs & (socket_event::write | socket_event::connect)) ? uint32_t{EPOLLOUT} : 0;
+    r |= to_bool(rhs & socket_event::close) ? uint32_t{EPOLLRDHUP} : 0;
+    r |= to_bool(rhs & socket_event::out_of_band) ? uint32_t{EPOLLPRI} : 0;
+
+    return r;
+}
+
+[[nodiscard]] constexpr socket_error socket_error_from_errno(int rhs) noexcept
+{
+    switch (rhs) {
+    case 0: return socket_error::success;
+    case EAFNOSUPPORT: return socket_error::af_not_supported;
+    case ECONNREFUSED: return socket_error::connection_refused;
+    case ENETUNREACH: return socket_error::network_unreachable;
+    case ENOBUFS: return socket_error::no_buffers;
+    case ETIMEDOUT: return socket_error::timeout;
+    case ENETDOWN: return socket_error::network_down;
+    case ECONNRESET: return socket_error::connection_reset;
+    case ECONNABORTED: return socket_error::connection_aborted;
+    default: return socket_error::connection_aborted; // Any other error also ends the connection.
+    }
+}
+
+/** Convert the events returned by `epoll_wait()`.
+ *
+ * @param rhs The events returned by `epoll_wait()` for the socket.
+ * @param mask The socket events that were waited for.
+ * @param error The pending error of the socket, from `SO_ERROR`.
+ * @return The socket events that happened, limited to @a mask.
+ */
+[[nodiscard]] constexpr socket_events socket_events_from_epoll(uint32_t rhs, socket_event mask, int error) noexcept
+{
+    auto events = socket_event::none;
+    events |= (rhs & EPOLLIN) ? socket_event::read | socket_event::accept : socket_event::none;
+    events |= (rhs & EPOLLOUT) ? socket_event::write | socket_event::connect : socket_event::none;
+    events |= (rhs & (EPOLLRDHUP | EPOLLHUP)) ? socket_event::close : socket_event::none;
+    events |= (rhs & EPOLLPRI) ? socket_event::out_of_band : socket_event::none;
+    if (rhs & EPOLLERR) {
+        // An error is reported on every event that was waited for, like a failed connect.
+        events |= mask;
+    }
+
+    auto r = socket_events{};
+    r.events = events & mask;
+
+    hilet e = socket_error_from_errno(error);
+    for (auto i = 0_uz; i != socket_event_max; ++i) {
+        if (to_bool(r.events & static_cast<socket_event>(1 << i))) {
+            r.errors[i] = e;
+        }
+    }
+    return r;
+}
+
+} // namespace hi::inline v1
@@ -0,0 +1,298 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file dispatch/thread_pool.hpp Defines thread_pool.
+ * @ingroup dispatch
+ */
+
+#pragma once
+
+#include "../container/container.hpp"
+#include "../concurrency/concurrency.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <atomic>
+#include <deque>
+#include <format>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+hi_export_module(hikogui.dispatch : thread_pool);
+
+hi_export namespace hi::inline v1 {
+class thread_pool;
+
+namespace detail {
+
+/** The pool and worker index of the current thread.
+ *
+ * Set only on the threads of a thread_pool, so that functions posted by a
+ * worker are pushed on that worker's own deque.
+ */
+struct thread_pool_worker_type {
+    thread_pool *pool = nullptr;
+    std::size_t index = 0;
+};
+
+hi_inline thread_local thread_pool_worker_type thread_pool_worker;
+
+} // namespace detail
+
+/** A work-stealing pool of worker threads.
+ *
+ * Each worker has its own deque of functions. A worker pushes and pops
+ * functions at the back of its own deque, so that recently posted work is
+ * run while its data is still in the cache. An idle worker steals from the
+ * front of the deque of other workers.
+ *
+ * Functions posted from outside the pool are inserted wait-free on a shared
+ * injection fifo, which idle workers take from one at a time.
+ *
+ * @ingroup dispatch
+ */
+class thread_pool {
+public:
+    using function_type = std::unique_ptr<function<void()>>;
+
+    ~thread_pool()
+    {
+        for (auto& worker : _workers) {
+            worker->thread.request_stop();
+        }
+        _epoch.fetch_add(1, std::memory_order::seq_cst);
+        _epoch.notify_all();
+
+        // Workers finish the functions that are still queued before they exit.
+        // All workers must have exited before any deque is destroyed, as they steal from each other.
+        for (auto& worker : _workers) {
+            worker->thread.join();
+        }
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+    /** Start a thread pool.
+     *
+     * @param num_threads The number of worker threads, by default one for each CPU.
+     */
+    explicit thread_pool(std::size_t num_threads = std::thread::hardware_concurrency())
+    {
+        num_threads = std::max(num_threads, 1_uz);
+
+        // First create all the deques, as workers will steal from each other as soon as they start.
+        _workers.reserve(num_threads);
+        for (auto i = 0_uz; i != num_threads; ++i) {
+            _workers.push_back(std::make_unique<worker_type>());
+        }
+
+        for (auto i = 0_uz; i != num_threads; ++i) {
+            _workers[i]->thread = std::jthread{[this, i](std::stop_token stop_token) {
+                set_thread_name(std::format("pool {}", i));
+                run_worker(i, stop_token);
+            }};
+        }
+    }
+
+    /** The number of worker threads.
+     */
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return _workers.size();
+    }
+
+    /** Check if the current thread is one of the worker threads of this pool.
+     */
+    [[nodiscard]] bool on_thread() const noexcept
+    {
+        return detail::thread_pool_worker.pool == this;
+    }
+
+    /** Post a function to be called from one of the worker threads.
+     *
+     * @note It is safe to call this function from any thread.
+     * @note When called from a worker thread the function is pushed on the
+     *       worker's own deque, otherwise it is inserted on the injection fifo.
+     * @param func The function to call. The function must not take any arguments and return void.
+     */
+    template<forward_of<void()> Func>
+    void post_function(Func&& func) noexcept
+    {
+        post(std::make_unique<detail::function_impl<std::decay_t<Func>, void()>>(std::forward<Func>(func)));
+    }
+
+    /** Call a function from one of the worker threads.
+     *
+     * @note It is safe to call this function from any thread.
+     * @param func The function to call. The function must not take any arguments, but may return a value.
+     * @return A `std::future` for the return value.
+     */
+    template<typename Func>
+    [[nodiscard]] auto async_function(Func&& func) noexcept
+    {
+        auto ptr = std::make_unique<detail::async_function_impl<std::decay_t<Func>, void()>>(std::forward<Func>(func));
+        auto future = ptr->get_future();
+        post(std::move(ptr));
+        return future;
+    }
+
+private:
+    struct worker_type {
+        /** Functions of this worker, protected by `mutex`.
+         *
+         * The owner pushes and pops at the back, thieves pop from the front.
+         */
+        std::deque<function_type> functions;
+        unfair_mutex mutex;
+
+        std::jthread thread;
+    };
+
+    /** A slot on the injection fifo; a slot is a full cache-line to reduce false sharing between producers.
+     */
+    wfree_fifo<function_type, 64> _inject_fifo;
+
+    /** Only a single worker at a time may take from the injection fifo.
+     */
+    unfair_mutex _inject_mutex;
+
+    std::vector<std::unique_ptr<worker_type>> _workers;
+
+    /** Incremented each time a function is posted, so that sleeping workers can wait on it.
+     */
+    std::atomic<uint32_t> _epoch = 0;
+    std::atomic<std::size_t> _num_sleeping = 0;
+
+    void post(function_type func) noexcept
+    {
+        hilet& worker = detail::thread_pool_worker;
+        if (worker.pool == this) {
+            auto& self = *_workers[worker.index];
+            hilet lock = std::scoped_lock(self.mutex);
+            self.functions.push_back(std::move(func));
+        } else {
+            _inject_fifo.insert(std::move(func));
+        }
+
+        // The function must be visible before the epoch changes, see `run_worker()`.
+        _epoch.fetch_add(1, std::memory_order::seq_cst);
+        if (_num_sleeping.load(std::memory_order::seq_cst) != 0) {
+            _epoch.notify_one();
+        }
+    }
+
+    /** Pop a function from the back of the worker's own deque.
+     */
+    [[nodiscard]] function_type pop_local(std::size_t index) noexcept
+    {
+        auto& self = *_workers[index];
+        hilet lock = std::scoped_lock(self.mutex);
+        if (self.functions.empty()) {
+            return nullptr;
+        }
+        auto r = std::move(self.functions.back());
+        self.functions.pop_back();
+        return r;
+    }
+
+    /** Take a function from the injection fifo.
+     *
+     * @param block Wait for another worker that is taking from the fifo.
+     */
+    [[nodiscard]] function_type pop_inject(bool block) noexcept
+    {
+        // If another worker is taking from the fifo, then steal from the other workers instead.
+        auto lock = std::unique_lock(_inject_mutex, std::defer_lock);
+        if (block) {
+            lock.lock();
+        } else if (not lock.try_lock()) {
+            return nullptr;
+        }
+
+        auto r = function_type{};
+        _inject_fifo.take_one([&r](function_type& item) {
+            r = std::move(item);
+        });
+        return r;
+    }
+
+    /** Steal a function from the front of the deque of another worker.
+     *
+     * @param block Wait for a worker that is busy with its own deque.
+     */
+    [[nodiscard]] function_type steal(std::size_t index, bool block) noexcept
+    {
+        for (auto i = 1_uz; i != _workers.size(); ++i) {
+            auto& victim = *_workers[(index + i) % _workers.size()];
+
+            auto lock = std::unique_lock(victim.mutex, std::defer_lock);
+            if (block) {
+                lock.lock();
+            } else if (not lock.try_lock()) {
+                continue;
+            }
+
+            if (not victim.functions.empty()) {
+                auto r = std::move(victim.functions.front());
+                victim.functions.pop_front();
+                return r;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Find a function to run.
+     *
+     * @param index The index of the worker.
+     * @param block Wait on contended locks, so that no function is missed before going to sleep.
+     */
+    [[nodiscard]] function_type find_function(std::size_t index, bool block) noexcept
+    {
+        if (auto r = pop_local(index)) {
+            return r;
+        } else if (auto r = pop_inject(block)) {
+            return r;
+        } else {
+            return steal(index, block);
+        }
+    }
+
+    void run_worker(std::size_t index, std::stop_token const& stop_token) noexcept
+    {
+        detail::thread_pool_worker = {this, index};
+
+        while (true) {
+            if (auto func = find_function(index, false)) {
+                (*func)();
+                continue;
+            }
+
+            // Read the epoch before checking the queues once more; a function
+            // posted after this point changes the epoch, so that the wait below
+            // returns immediately instead of missing the function.
+            hilet epoch = _epoch.load(std::memory_order::seq_cst);
+            if (auto func = find_function(index, true)) {
+                (*func)();
+                continue;
+            }
+
+            if (stop_token.stop_requested()) {
+                break;
+            }
+
+            _num_sleeping.fetch_add(1, std::memory_order::seq_cst);
+            _epoch.wait(epoch, std::memory_order::seq_cst);
+            _num_sleeping.fetch_sub(1, std::memory_order::seq_cst);
+        }
+
+        detail::thread_pool_worker = {};
+    }
+};
+
+} // namespace hi::inline v1
@@ -0,0 +1,66 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "thread_pool.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <vector>
+
+using namespace hi;
+
+TEST(thread_pool, async_function)
+{
+    auto pool = thread_pool{4};
+    ASSERT_EQ(pool.size(), 4);
+    ASSERT_FALSE(pool.on_thread());
+
+    auto futures = std::vector<std::future<int>>{};
+    for (auto i = 0; i != 1000; ++i) {
+        futures.push_back(pool.async_function([i] {
+            return i * 2;
+        }));
+    }
+
+    for (auto i = 0; i != 1000; ++i) {
+        ASSERT_EQ(futures[i].get(), i * 2);
+    }
+}
+
+TEST(thread_pool, post_from_worker)
+{
+    auto count = std::atomic<int>{0};
+
+    {
+        auto pool = thread_pool{4};
+
+        // Each function posts more functions from the worker thread onto its own deque,
+        // which are stolen by the other workers.
+        for (auto i = 0; i != 10; ++i) {
+            pool.post_function([&] {
+                for (auto j = 0; j != 100; ++j) {
+                    pool.post_function([&] {
+                        ++count;
+                    });
+                }
+                ++count;
+            });
+        }
+
+        // The destructor waits until all functions are run.
+    }
+
+    ASSERT_EQ(count.load(), 1010);
+}
+
+TEST(thread_pool, on_thread)
+{
+    auto pool = thread_pool{2};
+
+    auto future = pool.async_function([&] {
+        return pool.on_thread();
+    });
+    ASSERT_TRUE(future.get());
+}
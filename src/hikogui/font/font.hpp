@@ -7,13 +7,16 @@
 #include "elusive_icon.hpp" // export
 #include "font_font.hpp" // export
 #include "font_book.hpp" // export
+#include "font_coverage.hpp" // export
 #include "font_family_id.hpp" // export
+#include "font_index.hpp" // export
 #include "font_metrics.hpp" // export
 #include "font_variant.hpp" // export
 #include "font_weight.hpp" // export
 #include "glyph_atlas_info.hpp" // export
 #include "glyph_id.hpp" // export
 #include "glyph_metrics.hpp" // export
+#include "glyph_sdf_tile.hpp" // export
 #include "hikogui_icon.hpp" // export
 #include "true_type_font.hpp" // export
 
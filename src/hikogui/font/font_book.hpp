@@ -7,6 +7,8 @@
 #include "font_font.hpp"
 #include "font_family_id.hpp"
 #include "true_type_font.hpp"
+#include "font_index.hpp"
+#include "font_coverage.hpp"
 #include "elusive_icon.hpp"
 #include "hikogui_icon.hpp"
 #include "../unicode/unicode.hpp"
@@ -19,10 +21,20 @@
 #include <new>
 #include <atomic>
 #include <filesystem>
+#include <thread>
+#include <vector>
+#include <unordered_map>
 
 hi_export_module(hikogui.font.font_book);
 
 hi_export namespace hi::inline v1 {
+namespace detail {
+
+/** A counter to give each post-processed font-book a unique generation.
+ */
+hi_inline std::atomic<uint64_t> font_book_generation = 0;
+
+} // namespace detail
 
 /** font_book keeps track of multiple fonts.
  * The font_book is instantiated during application startup
@@ -101,52 +113,74 @@ public:
      *  - The weight, width, slant & design-size from the 'fdsc' table.
      *  - The character map 'cmap' table.
      *
+     * A font file that is registered explicitly is a font the application will
+     * use, such as an icon font. Therefor the metrics of all its glyphs are
+     * loaded at once, instead of one glyph at a time on first use.
+     *
      * @param path Location of font.
      * @param post_process Calculate font fallback
      */
     font& register_font_file(std::filesystem::path const& path, bool post_process = true)
     {
         auto font = std::make_unique<true_type_font>(path);
-        auto font_ptr = font.get();
-
-        hi_log_info("Parsed font {}: {}", path.string(), to_string(*font));
-
-        hilet font_family_id = register_family(font->family_name);
-        _font_variants[*font_family_id][font->font_variant()] = font_ptr;
-
-        _fonts.emplace_back(std::move(font));
-        _font_ptrs.push_back(font_ptr);
+        font->load_metrics();
+        auto& r = register_font(std::move(font));
 
         if (post_process) {
             this->post_process();
         }
 
-        return *font_ptr;
+        return r;
     }
 
     /** Register all fonts found in a directory.
+     *
+     * Fonts that are found in the font index are registered without opening
+     * the font file, the rest of the fonts are parsed in parallel and added
+     * to the font index.
      *
      * @see register_font()
      */
     void register_font_directory(std::filesystem::path const& path, bool post_process = true)
     {
         hilet font_directory_glob = path / "**" / "*.ttf";
-        for (hilet& font_path : glob(font_directory_glob)) {
-            hilet t = trace<"font_scan">{};
 
-            try {
-                register_font_file(font_path, false);
+        auto font_paths = std::vector<std::filesystem::path>{};
+        for (hilet& font_path : glob(font_directory_glob)) {
+            font_paths.push_back(font_path);
+        }
 
-            } catch (std::exception const& e) {
-                hi_log_error("Failed parsing font at {}: \"{}\"", font_path.string(), e.what());
+        // Register in the order of the glob, so that the font-book does not
+        // depend on the order in which the fonts were parsed.
+        for (auto& font : load_font_files(font_paths)) {
+            if (font) {
+                register_font(std::move(font));
             }
         }
 
+        if (not _font_index_path.empty() and _font_index.modified()) {
+            _font_index.save(_font_index_path);
+        }
+
         if (post_process) {
             this->post_process();
         }
     }
 
+    /** Use an on-disk index of the properties of font files.
+     *
+     * Fonts registered with `register_font_directory()` are looked up in
+     * this index by path, modification time and size, so that unchanged font
+     * files do not need to be opened and parsed.
+     *
+     * @param path The path to the font index file.
+     */
+    void use_font_index(std::filesystem::path const& path) noexcept
+    {
+        _font_index_path = path;
+        _font_index = font_index::load(path);
+    }
+
     /** Post process font_book
      * Should be called after a set of register_font() calls
      * This calculates font fallbacks.
@@ -197,6 +231,26 @@ public:
 
             font->fallback_chain = std::move(fallback_chain);
         }
+
+        // Build the coverage index and translate the fallback chains to font-indices into the coverage.
+        _coverage = font_coverage{_font_ptrs};
+
+        auto font_indices = std::unordered_map<hi::font const *, uint16_t>{};
+        for (auto i = 0_uz; i != _font_ptrs.size(); ++i) {
+            font_indices[_font_ptrs[i]] = narrow_cast<uint16_t>(i);
+        }
+
+        _fallback_indices.clear();
+        for (hilet& font : _font_ptrs) {
+            auto& indices = _fallback_indices[font];
+            indices.reserve(font->fallback_chain.size());
+            for (hilet& fallback : font->fallback_chain) {
+                indices.push_back(font_indices.at(fallback));
+            }
+        }
+
+        // Invalidate the per-thread caches of missed code-points.
+        _generation = ++detail::font_book_generation;
     }
 
     /** Find font family id.
@@ -286,10 +340,33 @@ public:
         }
 
         // Scan fonts which are fallback to this.
-        for (hilet fallback : font.fallback_chain) {
-            hi_axiom_not_null(fallback);
-            if (hilet glyph_ids = fallback->find_glyph(grapheme); not glyph_ids.empty()) {
-                return {*fallback, std::move(glyph_ids)};
+        if (hilet it = _fallback_indices.find(&font); it != _fallback_indices.end()) {
+            // A font can only match the grapheme when it covers the first code-point
+            // of either the composed or decomposed form.
+            hilet composed = grapheme.composed();
+            hilet decomposed = grapheme.decomposed();
+            hilet composed_cp = composed.empty() ? U'\0' : composed.front();
+            hilet decomposed_cp = decomposed.empty() ? U'\0' : decomposed.front();
+
+            for (hilet fallback_index : it->second) {
+                if (not _coverage.maybe_contains(fallback_index, composed_cp) and
+                    not _coverage.maybe_contains(fallback_index, decomposed_cp)) {
+                    continue;
+                }
+
+                hilet fallback = _font_ptrs[fallback_index];
+                if (hilet glyph_ids = fallback->find_glyph(grapheme); not glyph_ids.empty()) {
+                    return {*fallback, std::move(glyph_ids)};
+                }
+            }
+
+        } else {
+            // The font-book was not post-processed since this font was registered.
+            for (hilet fallback : font.fallback_chain) {
+                hi_axiom_not_null(fallback);
+                if (hilet glyph_ids = fallback->find_glyph(grapheme); not glyph_ids.empty()) {
+                    return {*fallback, std::move(glyph_ids)};
+                }
             }
         }
 
@@ -312,16 +389,25 @@ public:
             return {font, glyph_id};
         }
 
-        // Scan fonts which are fallback to this.
-        for (hilet fallback : font.fallback_chain) {
-            hi_axiom_not_null(fallback);
-            if (hilet glyph_id = fallback->find_glyph(code_point)) {
-                return {*fallback, glyph_id};
-            }
+        // Code-points that are missing from the selected font are often looked up
+        // repeatedly, remember the result of the fallback search per thread.
+        struct missed_type {
+            uint64_t generation = 0;
+            hi::font const *font = nullptr;
+            char32_t code_point = 0;
+            font_glyph_type result = {};
+        };
+
+        thread_local auto missed_cache = std::array<missed_type, 64>{};
+
+        auto& missed = missed_cache[hash_mix(&font, code_point) % missed_cache.size()];
+        if (missed.generation == _generation and missed.font == &font and missed.code_point == code_point) {
+            return missed.result;
         }
 
-        // If all everything has failed, use the tofu block of the original font.
-        return {font, glyph_id{0}};
+        hilet r = find_fallback_glyph(font, code_point);
+        missed = missed_type{_generation, &font, code_point, r};
+        return r;
     }
 
 private:
@@ -336,6 +422,142 @@ private:
     std::vector<std::unique_ptr<font>> _fonts;
     std::vector<hi::font *> _font_ptrs;
 
+    /** Code-point coverage of the fonts in `_font_ptrs`.
+     */
+    font_coverage _coverage;
+
+    /** The fallback chain of each font, as indices into `_font_ptrs`.
+     */
+    std::unordered_map<hi::font const *, std::vector<uint16_t>> _fallback_indices;
+
+    /** The generation of the post-processed font-book.
+     *
+     * Used to invalidate the per-thread cache of missed code-points.
+     */
+    uint64_t _generation = 0;
+
+    /** The cached properties of font files.
+     */
+    font_index _font_index;
+    std::filesystem::path _font_index_path;
+
+    [[nodiscard]] font_glyph_type find_fallback_glyph(font const& font, char32_t code_point) const noexcept
+    {
+        if (hilet it = _fallback_indices.find(&font); it != _fallback_indices.end()) {
+            for (hilet fallback_index : it->second) {
+                // Skip fonts that have no code-points in the same page as the code-point.
+                if (not _coverage.maybe_contains(fallback_index, code_point)) {
+                    continue;
+                }
+
+                hilet fallback = _font_ptrs[fallback_index];
+                if (hilet glyph_id = fallback->find_glyph(code_point)) {
+                    return {*fallback, glyph_id};
+                }
+            }
+
+        } else {
+            // The font-book was not post-processed since this font was registered.
+            for (hilet fallback : font.fallback_chain) {
+                hi_axiom_not_null(fallback);
+                if (hilet glyph_id = fallback->find_glyph(code_point)) {
+                    return {*fallback, glyph_id};
+                }
+            }
+        }
+
+        // If all everything has failed, use the tofu block of the original font.
+        return {font, glyph_id{0}};
+    }
+
+    font& register_font(std::unique_ptr<true_type_font> font)
+    {
+        hi_assert_not_null(font);
+        auto font_ptr = font.get();
+
+        hi_log_info("Registered font {}: {}", font->path().string(), to_string(*font));
+
+        hilet font_family_id = register_family(font->family_name);
+        _font_variants[*font_family_id][font->font_variant()] = font_ptr;
+
+        _fonts.emplace_back(std::move(font));
+        _font_ptrs.push_back(font_ptr);
+        return *font_ptr;
+    }
+
+    /** Load a set of font files.
+     *
+     * Fonts found in the font index are constructed directly from the index.
+     * The other fonts are parsed in parallel on a set of worker threads.
+     *
+     * @param paths The paths to the font files.
+     * @return A font for each path, or nullptr if the font could not be parsed.
+     */
+    [[nodiscard]] std::vector<std::unique_ptr<true_type_font>> load_font_files(std::vector<std::filesystem::path> const& paths)
+    {
+        struct file_stat_type {
+            int64_t modification_time = 0;
+            uint64_t file_size = 0;
+        };
+
+        auto r = std::vector<std::unique_ptr<true_type_font>>(paths.size());
+        auto stats = std::vector<file_stat_type>(paths.size());
+        auto todo = std::vector<size_t>{};
+
+        for (auto i = 0_uz; i != paths.size(); ++i) {
+            auto ec = std::error_code{};
+            hilet modification_time = std::filesystem::last_write_time(paths[i], ec);
+            hilet file_size = std::filesystem::file_size(paths[i], ec);
+            if (not ec) {
+                stats[i].modification_time = static_cast<int64_t>(modification_time.time_since_epoch().count());
+                stats[i].file_size = static_cast<uint64_t>(file_size);
+            }
+
+            if (hilet entry = _font_index.find(paths[i], stats[i].modification_time, stats[i].file_size)) {
+                r[i] = std::make_unique<true_type_font>(*entry);
+            } else {
+                todo.push_back(i);
+            }
+        }
+
+        auto next = std::atomic<size_t>{0};
+        auto worker = [&] {
+            for (auto j = next.fetch_add(1, std::memory_order::relaxed); j < todo.size();
+                 j = next.fetch_add(1, std::memory_order::relaxed)) {
+                hilet i = todo[j];
+                hilet t = trace<"font_scan">{};
+
+                try {
+                    r[i] = std::make_unique<true_type_font>(paths[i]);
+
+                } catch (std::exception const& e) {
+                    hi_log_error("Failed parsing font at {}: \"{}\"", paths[i].string(), e.what());
+                }
+            }
+        };
+
+        {
+            hilet num_threads = std::min(todo.size(), wide_cast<size_t>(std::max(1U, std::thread::hardware_concurrency())));
+            auto threads = std::vector<std::jthread>{};
+            for (auto k = 1_uz; k < num_threads; ++k) {
+                threads.emplace_back(worker);
+            }
+            worker();
+            // The threads are joined when leaving this scope.
+        }
+
+        for (hilet i : todo) {
+            if (r[i]) {
+                auto entry = r[i]->make_index_entry();
+                entry.modification_time = stats[i].modification_time;
+                entry.file_size = stats[i].file_size;
+                _font_index.insert(std::move(entry));
+            }
+        }
+
+        return r;
+    }
+
     [[nodiscard]] std::vector<hi::font *> make_fallback_chain(font_weight weight, font_style style) noexcept
     {
         auto r = _font_ptrs;
@@ -365,6 +587,7 @@ hi_inline font_book& font_book::global() noexcept
 {
     if (not detail::font_book_global) {
         detail::font_book_global = std::make_unique<font_book>();
+        detail::font_book_global->use_font_index(data_dir() / "font_index.bin");
     }
     return *detail::font_book_global;
 }
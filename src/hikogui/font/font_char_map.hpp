@@ -10,6 +10,7 @@
 
 #include "glyph_id.hpp"
 #include "../algorithm/algorithm.hpp"
+#include "../SIMD/SIMD.hpp"
 #include "../utility/utility.hpp"
 #include "../macros.hpp"
 #include <bitset>
@@ -18,6 +19,8 @@
 #include <tuple>
 #include <algorithm>
 #include <string>
+#include <span>
+#include <bit>
 
 hi_export_module(hikogui.font.font_char_map);
 
@@ -79,6 +82,21 @@ public:
         return r;
     }
 
+    /** Get the ranges of code-points of the character map.
+     *
+     * @return A list of ranges of code-points, the end code-point is inclusive,
+     *         with the glyph of the starting code-point of each range.
+     */
+    [[nodiscard]] std::vector<std::tuple<char32_t, char32_t, uint16_t>> ranges() const noexcept
+    {
+        auto r = std::vector<std::tuple<char32_t, char32_t, uint16_t>>{};
+        r.reserve(_map.size());
+        for (hilet& entry : _map) {
+            r.emplace_back(entry.start_code_point(), entry.end_code_point, entry.start_glyph);
+        }
+        return r;
+    }
+
     /** Add a range of code points.
      *
      * @param start_code_point The starting code-point of the range.
@@ -151,7 +169,12 @@ public:
             prev_it = it++;
         }
 
-        _map.shrink_to_fit();
+        // Reorder the entries in Eytzinger (breadth-first) order, this makes
+        // the search cache friendly as the first levels of the tree are
+        // located next to each other.
+        auto tree = std::vector<entry_type>(_map.size());
+        make_eytzinger(_map, tree, 0, 1);
+        _map = std::move(tree);
 
 #ifndef NDEBUG
         _prepared = true;
@@ -169,19 +192,69 @@ public:
         hi_assert(_prepared);
 #endif
 
-        if (hilet item_ptr = fast_lower_bound(std::span{_map}, char_cast<uint32_t>(code_point))) {
+        if (hilet item_ptr = find_entry(code_point)) {
             return item_ptr->get(code_point);
         }
         return {};
     }
 
+    /** Find the glyphs for a run of code-points.
+     *
+     * Consecutive code-points in a text are often located in the same range
+     * of the character map. The range that was found for the previous
+     * code-point is checked first, for four code-points at a time.
+     *
+     * @param code_points The code-points to find in the character map.
+     * @param[out] glyphs The corresponding glyph for each code-point, or an empty glyph if not found.
+     */
+    void find(std::span<char32_t const> code_points, std::span<glyph_id> glyphs) const noexcept
+    {
+#ifndef NDEBUG
+        hi_assert(_prepared);
+#endif
+        hi_assert(code_points.size() == glyphs.size());
+
+        entry_type const *item_ptr = nullptr;
+
+        auto i = 0_uz;
+        while (i + 4 <= code_points.size()) {
+            if (item_ptr != nullptr) {
+                hilet cp = i32x4::load(reinterpret_cast<std::byte const *>(code_points.data() + i));
+                hilet start_cp = i32x4::broadcast(char_cast<int32_t>(item_ptr->start_code_point()));
+                hilet end_cp = i32x4::broadcast(char_cast<int32_t>(item_ptr->end_code_point));
+
+                if (((cp >= start_cp) & (cp <= end_cp)).mask() == 0b1111) {
+                    hilet glyph = cp - start_cp + i32x4::broadcast(item_ptr->start_glyph);
+                    for (auto j = 0_uz; j != 4; ++j) {
+                        glyphs[i + j] = glyph_id{glyph[j]};
+                    }
+                    i += 4;
+                    continue;
+                }
+            }
+
+            item_ptr = find_entry(code_points[i]);
+            glyphs[i] = item_ptr ? item_ptr->get(code_points[i]) : glyph_id{};
+            ++i;
+        }
+
+        for (; i != code_points.size(); ++i) {
+            if (item_ptr == nullptr or not item_ptr->contains(code_points[i])) {
+                item_ptr = find_entry(code_points[i]);
+            }
+            glyphs[i] = item_ptr ? item_ptr->get(code_points[i]) : glyph_id{};
+        }
+    }
+
 private:
     struct entry_type {
         constexpr static size_t max_count = 0x1'0000;
 
-        char32_t end_code_point;
-        uint16_t start_glyph;
-        uint16_t _count;
+        char32_t end_code_point = 0;
+        uint16_t start_glyph = 0;
+        uint16_t _count = 0;
+
+        constexpr entry_type() noexcept = default;
 
         constexpr entry_type(char32_t start_code_point, char32_t end_code_point, uint16_t start_glyph) noexcept :
             end_code_point(end_code_point),
@@ -218,6 +291,11 @@ private:
             return lhs.end_code_point + 1 == rhs.start_code_point() and lhs.end_glyph() + 1 == rhs.start_glyph;
         }
 
+        [[nodiscard]] constexpr bool contains(char32_t code_point) const noexcept
+        {
+            return code_point >= start_code_point() and code_point <= end_code_point;
+        }
+
         [[nodiscard]] constexpr glyph_id get(char32_t code_point) const noexcept
         {
             auto diff = wide_cast<ptrdiff_t>(code_point) - wide_cast<ptrdiff_t>(end_code_point);
@@ -233,6 +311,10 @@ private:
         }
     };
 
+    /** The entries in Eytzinger order after `prepare()`.
+     *
+     * The entry at index `k - 1` has children at `2k - 1` and `2k`.
+     */
     std::vector<entry_type> _map = {};
 
     /** Total number of code-points added.
@@ -242,6 +324,43 @@ private:
 #ifndef NDEBUG
     bool _prepared = false;
 #endif
+
+    /** Find the first entry with an end-code-point larger or equal to the code-point.
+     *
+     * @return A pointer to the entry, or nullptr if the code-point is beyond the last entry.
+     */
+    [[nodiscard]] constexpr entry_type const *find_entry(char32_t code_point) const noexcept
+    {
+        hilet size = _map.size();
+
+        // Walk down the tree, going right when the entry is below the code-point.
+        auto k = 1_uz;
+        while (k <= size) {
+            k = 2 * k + wide_cast<size_t>(_map[k - 1].end_code_point < code_point);
+        }
+
+        // Undo the trailing right-turns and the last left-turn, to find the lower bound.
+        k >>= std::countr_one(k) + 1;
+        return k == 0 ? nullptr : &_map[k - 1];
+    }
+
+    /** Copy sorted entries into a tree in Eytzinger order.
+     *
+     * @param sorted The entries sorted by end-code-point.
+     * @param tree The tree with the same size as @a sorted.
+     * @param i The index of the next entry in @a sorted to place.
+     * @param k The one-based index of the node in the tree.
+     * @return The index of the next entry in @a sorted to place.
+     */
+    constexpr static size_t make_eytzinger(std::vector<entry_type> const& sorted, std::vector<entry_type>& tree, size_t i, size_t k) noexcept
+    {
+        if (k <= sorted.size()) {
+            i = make_eytzinger(sorted, tree, i, 2 * k);
+            tree[k - 1] = sorted[i++];
+            i = make_eytzinger(sorted, tree, i, 2 * k + 1);
+        }
+        return i;
+    }
 };
 
 }} // namespace hi::v1
@@ -5,6 +5,9 @@
 #include "font_char_map.hpp"
 #include "../macros.hpp"
 #include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <span>
 
 TEST(font_char_map, add_and_search)
 {
@@ -33,3 +36,69 @@ TEST(font_char_map, add_and_search)
     ASSERT_EQ(cm.find(U'8'), 208);
     ASSERT_EQ(cm.find(U'9'), 209);
 }
+
+TEST(font_char_map, ranges)
+{
+    auto cm = hi::font_char_map{};
+
+    cm.add(U'a', U'z', 100);
+    cm.add(U'0', U'3', 200);
+    cm.add(U'4', U'4', 204);
+    cm.prepare();
+
+    // '0'-'3' and '4' are merged during prepare().
+    hilet ranges = cm.ranges();
+    ASSERT_EQ(ranges.size(), 2);
+
+    auto copy = hi::font_char_map{};
+    for (hilet [start_code_point, end_code_point, start_glyph] : ranges) {
+        copy.add(start_code_point, end_code_point, start_glyph);
+    }
+    copy.prepare();
+
+    ASSERT_EQ(copy.count(), cm.count());
+    ASSERT_EQ(copy.find(U'a'), 100);
+    ASSERT_EQ(copy.find(U'z'), 125);
+    ASSERT_EQ(copy.find(U'0'), 200);
+    ASSERT_EQ(copy.find(U'4'), 204);
+    ASSERT_EQ(copy.find(U'5'), 0xffff);
+}
+
+TEST(font_char_map, search_many_ranges)
+{
+    auto cm = hi::font_char_map{};
+
+    // Every other code-point is missing, so that the ranges can not be merged.
+    for (char32_t c = 0; c != 2000; c += 2) {
+        cm.add(c, c, hi::narrow_cast<uint16_t>(c / 2));
+    }
+    cm.prepare();
+    ASSERT_EQ(cm.count(), 1000);
+
+    for (char32_t c = 0; c != 2000; ++c) {
+        if (c % 2 == 0) {
+            ASSERT_EQ(cm.find(c), static_cast<int>(c / 2));
+        } else {
+            ASSERT_EQ(cm.find(c), 0xffff);
+        }
+    }
+    ASSERT_EQ(cm.find(U'\U00010000'), 0xffff);
+}
+
+TEST(font_char_map, batch_search)
+{
+    auto cm = hi::font_char_map{};
+
+    cm.add(U'a', U'z', 100);
+    cm.add(U'A', U'Z', 200);
+    cm.add(U'0', U'9', 300);
+    cm.prepare();
+
+    auto const text = std::u32string{U"hello world 42 HikoGUI text"};
+    auto glyphs = std::vector<hi::glyph_id>(text.size());
+    cm.find(std::span{text}, std::span{glyphs});
+
+    for (size_t i = 0; i != text.size(); ++i) {
+        ASSERT_EQ(glyphs[i], cm.find(text[i]));
+    }
+}
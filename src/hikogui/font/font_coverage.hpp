@@ -0,0 +1,121 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file font/font_coverage.hpp Defines the font_coverage type.
+ * @ingroup font
+ */
+
+#pragma once
+
+#include "font_font.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <cstdint>
+#include <bit>
+
+hi_export_module(hikogui.font.font_coverage);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** Code-point coverage of a set of fonts.
+ *
+ * This is a bitmap which records for each page of 256 code-points, which
+ * fonts have at least one code-point in that page. The bits of all fonts
+ * for a single page are stored next to each other, so that walking a
+ * fallback chain for a code-point touches only a few cache lines.
+ *
+ * The coverage is conservative: when a font does not cover the page, the
+ * font does not contain the code-point; otherwise the character map of the
+ * font must still be searched.
+ *
+ * @ingroup font
+ */
+hi_export class font_coverage {
+public:
+    constexpr static size_t page_size = 256;
+    constexpr static size_t num_pages = 0x11'0000 / page_size;
+
+    constexpr font_coverage() noexcept = default;
+    font_coverage(font_coverage const&) = default;
+    font_coverage(font_coverage&&) noexcept = default;
+    font_coverage& operator=(font_coverage const&) = default;
+    font_coverage& operator=(font_coverage&&) noexcept = default;
+
+    /** Build the coverage of a list of fonts.
+     *
+     * @param fonts The fonts, the index in this list is used as the font-index.
+     */
+    explicit font_coverage(std::vector<font *> const& fonts) :
+        _num_fonts(fonts.size()), _num_words((fonts.size() + 63) / 64), _bits(num_pages * _num_words, 0)
+    {
+        for (auto font_index = 0_uz; font_index != fonts.size(); ++font_index) {
+            hi_axiom_not_null(fonts[font_index]);
+
+            for (hilet [start_code_point, end_code_point, start_glyph] : fonts[font_index]->char_map.ranges()) {
+                hilet first_page = char_cast<size_t>(start_code_point) / page_size;
+                hilet last_page = char_cast<size_t>(end_code_point) / page_size;
+                for (auto page = first_page; page <= last_page; ++page) {
+                    set(page, font_index);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr size_t size() const noexcept
+    {
+        return _num_fonts;
+    }
+
+    /** Check if a font may contain a code-point.
+     *
+     * @param font_index The index of the font in the list passed to the constructor.
+     * @param code_point The code-point to check.
+     * @return false if the font definitely does not contain the code-point.
+     */
+    [[nodiscard]] bool maybe_contains(size_t font_index, char32_t code_point) const noexcept
+    {
+        hi_axiom(font_index < _num_fonts);
+        hilet page = char_cast<size_t>(code_point) / page_size;
+        if (page >= num_pages) {
+            return false;
+        }
+
+        hilet word = _bits[page * _num_words + font_index / 64];
+        return to_bool((word >> (font_index % 64)) & 1);
+    }
+
+    /** Count the number of fonts that have code-points in the page of a code-point.
+     */
+    [[nodiscard]] size_t count(char32_t code_point) const noexcept
+    {
+        hilet page = char_cast<size_t>(code_point) / page_size;
+        if (page >= num_pages) {
+            return 0;
+        }
+
+        auto r = 0_uz;
+        for (auto i = 0_uz; i != _num_words; ++i) {
+            r += std::popcount(_bits[page * _num_words + i]);
+        }
+        return r;
+    }
+
+private:
+    size_t _num_fonts = 0;
+    size_t _num_words = 0;
+
+    /** Page-major bitmap of fonts.
+     */
+    std::vector<uint64_t> _bits = {};
+
+    void set(size_t page, size_t font_index) noexcept
+    {
+        hi_axiom(page < num_pages);
+        hi_axiom(font_index < _num_fonts);
+        _bits[page * _num_words + font_index / 64] |= uint64_t{1} << (font_index % 64);
+    }
+};
+
+}} // namespace hi::v1
@@ -0,0 +1,102 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "font_coverage.hpp"
+#include "true_type_font.hpp"
+#include "../path/path.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace hi;
+
+namespace {
+
+/** The icon fonts shipped with the library.
+ *
+ * hikogui_icons.ttf contains U+F301 to U+F306 and U+F316 to U+F318.
+ * elusiveicons-webfont.ttf contains U+F101 to U+F230.
+ */
+class font_coverage_tests : public ::testing::Test {
+protected:
+    true_type_font icons{library_source_dir() / "resources" / "hikogui_icons.ttf"};
+    true_type_font elusive{library_source_dir() / "resources" / "elusiveicons-webfont.ttf"};
+};
+
+} // namespace
+
+TEST_F(font_coverage_tests, covered)
+{
+    hilet coverage = font_coverage{std::vector<font *>{&icons, &elusive}};
+    ASSERT_EQ(coverage.size(), 2);
+
+    ASSERT_TRUE(coverage.maybe_contains(0, char32_t{0xf301}));
+    ASSERT_TRUE(coverage.maybe_contains(0, char32_t{0xf318}));
+    ASSERT_TRUE(coverage.maybe_contains(1, char32_t{0xf101}));
+    ASSERT_TRUE(coverage.maybe_contains(1, char32_t{0xf230}));
+
+    ASSERT_EQ(coverage.count(char32_t{0xf301}), 1);
+    ASSERT_EQ(coverage.count(char32_t{0xf101}), 1);
+}
+
+TEST_F(font_coverage_tests, uncovered)
+{
+    hilet coverage = font_coverage{std::vector<font *>{&icons, &elusive}};
+
+    // The fonts do not contain the code-points of each other.
+    ASSERT_FALSE(coverage.maybe_contains(0, char32_t{0xf101}));
+    ASSERT_FALSE(coverage.maybe_contains(1, char32_t{0xf301}));
+
+    // Neither font contains latin letters.
+    ASSERT_FALSE(coverage.maybe_contains(0, U'A'));
+    ASSERT_FALSE(coverage.maybe_contains(1, U'A'));
+    ASSERT_EQ(coverage.count(U'A'), 0);
+
+    // Beyond the last code-point of unicode.
+    ASSERT_FALSE(coverage.maybe_contains(0, char32_t{0x11'0000}));
+    ASSERT_EQ(coverage.count(char32_t{0x11'0000}), 0);
+}
+
+TEST_F(font_coverage_tests, conservative)
+{
+    hilet coverage = font_coverage{std::vector<font *>{&icons, &elusive}};
+
+    // U+F3FF is in the same page as the icons, but not in the font; the character map must still be searched.
+    ASSERT_TRUE(coverage.maybe_contains(0, char32_t{0xf3ff}));
+    ASSERT_EQ(icons.char_map.find(char32_t{0xf3ff}), 0xffff);
+}
+
+TEST_F(font_coverage_tests, ranges)
+{
+    // The two ranges of the icons are not merged, as their glyphs are not consecutive.
+    ASSERT_EQ(icons.char_map.ranges().size(), 2);
+    ASSERT_EQ(elusive.char_map.ranges().size(), 1);
+
+    hilet coverage = font_coverage{std::vector<font *>{&icons, &elusive}};
+
+    // The single range of elusive spans two pages.
+    ASSERT_TRUE(coverage.maybe_contains(1, char32_t{0xf100}));
+    ASSERT_TRUE(coverage.maybe_contains(1, char32_t{0xf2ff}));
+    ASSERT_FALSE(coverage.maybe_contains(1, char32_t{0xf000}));
+    ASSERT_FALSE(coverage.maybe_contains(1, char32_t{0xf300}));
+}
+
+TEST_F(font_coverage_tests, many_fonts)
+{
+    // More fonts than fit in a single word of the bitmap.
+    auto fonts = std::vector<font *>{};
+    for (auto i = 0; i != 70; ++i) {
+        fonts.push_back(i % 2 == 0 ? static_cast<font *>(&icons) : static_cast<font *>(&elusive));
+    }
+
+    hilet coverage = font_coverage{fonts};
+    ASSERT_EQ(coverage.size(), 70);
+    ASSERT_EQ(coverage.count(char32_t{0xf301}), 35);
+    ASSERT_EQ(coverage.count(char32_t{0xf101}), 35);
+
+    for (auto i = 0_uz; i != 70; ++i) {
+        ASSERT_EQ(coverage.maybe_contains(i, char32_t{0xf301}), i % 2 == 0);
+        ASSERT_EQ(coverage.maybe_contains(i, char32_t{0xf101}), i % 2 == 1);
+    }
+}
@@ -19,6 +19,7 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <memory>
 
 hi_export_module(hikogui.font.font);
 
@@ -227,8 +228,10 @@ public:
      * @param script The script of this run of graphemes.
      * @param run The run of graphemes.
      * @return The glyphs and coordinates to display, and coordinates of grapheme for interaction.
+     *         The result is immutable and may be shared with other callers shaping the same run.
      */
-    [[nodiscard]] virtual shape_run_result_type shape_run(iso_639 language, iso_15924 script, gstring run) const = 0;
+    [[nodiscard]] virtual std::shared_ptr<shape_run_result_type const>
+    shape_run(iso_639 language, iso_15924 script, gstring run) const = 0;
 
     glyph_atlas_info& atlas_info(glyph_id glyph) const
     {
@@ -0,0 +1,365 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file font/font_index.hpp Defines the font_index type.
+ * @ingroup font
+ */
+
+#pragma once
+
+#include "font_char_map.hpp"
+#include "font_metrics.hpp"
+#include "font_style.hpp"
+#include "font_weight.hpp"
+#include "../file/file.hpp"
+#include "../file/file_view.hpp"
+#include "../container/container.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <filesystem>
+#include <unordered_map>
+#include <string>
+#include <cstdint>
+#include <bit>
+
+hi_export_module(hikogui.font.font_index);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** The cached properties of a font file.
+ *
+ * This holds every property that is needed to select a font and to
+ * calculate the font fallback chains, so that a font can be registered
+ * without opening the font file.
+ *
+ * @ingroup font
+ */
+hi_export struct font_index_entry {
+    /** The path to the font file.
+     */
+    std::filesystem::path path;
+
+    /** The last modification time of the font file, in file-clock ticks.
+     */
+    int64_t modification_time = 0;
+
+    /** The size of the font file in bytes.
+     */
+    uint64_t file_size = 0;
+
+    std::string family_name;
+    std::string sub_family_name;
+    std::string features;
+
+    font_weight weight = font_weight::regular;
+    font_style style = font_style::normal;
+    bool monospace = false;
+    bool serif = false;
+    bool condensed = false;
+
+    font_metrics metrics;
+    font_char_map char_map;
+
+    /** True-type specific properties, needed to read glyphs after the font file is mapped.
+     */
+    float em_scale = 0.0f;
+    uint16_t num_horizontal_metrics = 0;
+    uint16_t num_glyphs = 0;
+    bool loca_is_offset32 = false;
+
+    /** Check if this entry describes the current version of the font file.
+     */
+    [[nodiscard]] bool matches(int64_t other_modification_time, uint64_t other_file_size) const noexcept
+    {
+        return modification_time == other_modification_time and file_size == other_file_size;
+    }
+};
+
+/** An on-disk index of parsed font files.
+ *
+ * The index maps the path of a font file to the properties of that font,
+ * keyed by the modification time and size of the file. On later start-ups
+ * unchanged fonts are registered directly from the index.
+ *
+ * @ingroup font
+ */
+hi_export class font_index {
+public:
+    ~font_index() = default;
+    font_index(font_index const&) = delete;
+    font_index(font_index&&) noexcept = default;
+    font_index& operator=(font_index const&) = delete;
+    font_index& operator=(font_index&&) noexcept = default;
+    font_index() noexcept = default;
+
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return _entries.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return _entries.empty();
+    }
+
+    /** Check if entries where added since the index was loaded or saved.
+     */
+    [[nodiscard]] bool modified() const noexcept
+    {
+        return _modified;
+    }
+
+    /** Find an entry for a font file.
+     *
+     * @param path The path to the font file.
+     * @param modification_time The current modification time of the font file.
+     * @param file_size The current size of the font file.
+     * @return The entry, or nullptr if the font file is not in the index or was changed.
+     */
+    [[nodiscard]] font_index_entry const *
+    find(std::filesystem::path const& path, int64_t modification_time, uint64_t file_size) const noexcept
+    {
+        hilet it = _entries.find(path.generic_string());
+        if (it == _entries.end() or not it->second.matches(modification_time, file_size)) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    /** Add or replace the entry for a font file.
+     */
+    void insert(font_index_entry entry) noexcept
+    {
+        auto key = entry.path.generic_string();
+        _entries.insert_or_assign(std::move(key), std::move(entry));
+        _modified = true;
+    }
+
+    /** Load a font index from a file.
+     *
+     * @param path The path to the font index file.
+     * @return The loaded index, or an empty index if the file does not exist or is corrupt.
+     */
+    [[nodiscard]] static font_index load(std::filesystem::path const& path) noexcept
+    {
+        auto r = font_index{};
+
+        if (not std::filesystem::exists(path)) {
+            return r;
+        }
+
+        try {
+            hilet view = file_view{path};
+            hilet bytes = as_span<std::byte const>(view);
+
+            auto offset = 0_uz;
+            hilet& header = implicit_cast<header_type>(offset, bytes);
+            if (*header.magic != magic or *header.version != version) {
+                hi_log_info("Ignoring font index {} with a different format version.", path.string());
+                return r;
+            }
+
+            for (auto i = 0_uz; i != *header.num_entries; ++i) {
+                r.insert(parse_entry(offset, bytes));
+            }
+
+        } catch (std::exception const& e) {
+            hi_log_error("Could not read font index {}: \"{}\"", path.string(), e.what());
+            return font_index{};
+        }
+
+        r._modified = false;
+        return r;
+    }
+
+    /** Save the font index to a file.
+     *
+     * The index is written to a temporary file first, which then replaces
+     * the index file. Errors are logged, since the index is only a cache.
+     *
+     * @param path The path to the font index file.
+     */
+    void save(std::filesystem::path const& path) noexcept
+    {
+        try {
+            auto bytes = bstring{};
+
+            append<uint32_t>(bytes, magic);
+            append<uint32_t>(bytes, version);
+            append<uint32_t>(bytes, narrow_cast<uint32_t>(_entries.size()));
+            for (hilet& [key, entry] : _entries) {
+                append_entry(bytes, entry);
+            }
+
+            auto tmp_path = path;
+            tmp_path += ".tmp";
+
+            auto file = hi::file(tmp_path, access_mode::truncate_or_create_for_write | access_mode::rename);
+            file.write(bytes);
+            file.flush();
+            file.rename(path, true);
+            _modified = false;
+
+        } catch (std::exception const& e) {
+            hi_log_error("Could not save font index to {}: \"{}\"", path.string(), e.what());
+        }
+    }
+
+private:
+    /** 'HiFI' */
+    constexpr static uint32_t magic = 0x49466948;
+    constexpr static uint32_t version = 1;
+
+    struct header_type {
+        little_uint32_buf_t magic;
+        little_uint32_buf_t version;
+        little_uint32_buf_t num_entries;
+    };
+
+    struct char_map_range_type {
+        little_uint32_buf_t start_code_point;
+        little_uint32_buf_t end_code_point;
+        little_uint16_buf_t start_glyph;
+    };
+
+    std::unordered_map<std::string, font_index_entry> _entries;
+    bool _modified = false;
+
+    template<std::integral T>
+    static void append(bstring& bytes, T value) noexcept
+    {
+        if constexpr (sizeof(T) == 1) {
+            bytes.push_back(static_cast<std::byte>(value));
+        } else {
+            auto buf = endian_buf_t<T, std::endian::little, 1>{};
+            buf = value;
+            bytes.append(buf._value, sizeof(T));
+        }
+    }
+
+    static void append(bstring& bytes, float value) noexcept
+    {
+        append(bytes, std::bit_cast<uint32_t>(value));
+    }
+
+    static void append(bstring& bytes, std::string_view str) noexcept
+    {
+        append(bytes, narrow_cast<uint16_t>(str.size()));
+        bytes.append(reinterpret_cast<std::byte const *>(str.data()), str.size());
+    }
+
+    template<std::integral T>
+    [[nodiscard]] static T parse(size_t& offset, std::span<std::byte const> bytes)
+    {
+        if constexpr (sizeof(T) == 1) {
+            return static_cast<T>(implicit_cast<std::byte>(offset, bytes));
+        } else {
+            return *implicit_cast<endian_buf_t<T, std::endian::little, 1>>(offset, bytes);
+        }
+    }
+
+    [[nodiscard]] static float parse_float(size_t& offset, std::span<std::byte const> bytes)
+    {
+        return std::bit_cast<float>(parse<uint32_t>(offset, bytes));
+    }
+
+    [[nodiscard]] static std::string parse_string(size_t& offset, std::span<std::byte const> bytes)
+    {
+        hilet size = parse<uint16_t>(offset, bytes);
+        hilet chars = implicit_cast<char>(offset, bytes, size);
+        return std::string{chars.begin(), chars.end()};
+    }
+
+    static void append_entry(bstring& bytes, font_index_entry const& entry) noexcept
+    {
+        append(bytes, entry.path.generic_string());
+        append(bytes, entry.modification_time);
+        append(bytes, entry.file_size);
+
+        append(bytes, entry.family_name);
+        append(bytes, entry.sub_family_name);
+        append(bytes, entry.features);
+
+        append(bytes, narrow_cast<uint8_t>(std::to_underlying(entry.weight)));
+        append(bytes, narrow_cast<uint8_t>(std::to_underlying(entry.style)));
+        append(bytes, narrow_cast<uint8_t>(
+            (entry.monospace ? 1 : 0) | (entry.serif ? 2 : 0) | (entry.condensed ? 4 : 0) | (entry.loca_is_offset32 ? 8 : 0)));
+
+        append(bytes, entry.metrics.ascender);
+        append(bytes, entry.metrics.descender);
+        append(bytes, entry.metrics.line_gap);
+        append(bytes, entry.metrics.cap_height);
+        append(bytes, entry.metrics.x_height);
+        append(bytes, entry.metrics.digit_advance);
+
+        append(bytes, entry.em_scale);
+        append(bytes, entry.num_horizontal_metrics);
+        append(bytes, entry.num_glyphs);
+
+        // The character map is stored as the ranges of the already merged map.
+        hilet ranges = entry.char_map.ranges();
+        append(bytes, narrow_cast<uint32_t>(ranges.size()));
+        for (hilet [start_code_point, end_code_point, start_glyph] : ranges) {
+            append(bytes, char_cast<uint32_t>(start_code_point));
+            append(bytes, char_cast<uint32_t>(end_code_point));
+            append(bytes, start_glyph);
+        }
+    }
+
+    [[nodiscard]] static font_index_entry parse_entry(size_t& offset, std::span<std::byte const> bytes)
+    {
+        auto r = font_index_entry{};
+
+        r.path = std::filesystem::path{parse_string(offset, bytes)};
+        r.modification_time = parse<int64_t>(offset, bytes);
+        r.file_size = parse<uint64_t>(offset, bytes);
+
+        r.family_name = parse_string(offset, bytes);
+        r.sub_family_name = parse_string(offset, bytes);
+        r.features = parse_string(offset, bytes);
+
+        hilet weight = parse<uint8_t>(offset, bytes);
+        hi_check(weight <= std::to_underlying(font_weight::extra_black), "Invalid font weight in font index.");
+        r.weight = static_cast<font_weight>(weight);
+
+        hilet style = parse<uint8_t>(offset, bytes);
+        hi_check(style <= std::to_underlying(font_style::italic), "Invalid font style in font index.");
+        r.style = static_cast<font_style>(style);
+
+        hilet flags = parse<uint8_t>(offset, bytes);
+        r.monospace = to_bool(flags & 1);
+        r.serif = to_bool(flags & 2);
+        r.condensed = to_bool(flags & 4);
+        r.loca_is_offset32 = to_bool(flags & 8);
+
+        r.metrics.ascender = parse_float(offset, bytes);
+        r.metrics.descender = parse_float(offset, bytes);
+        r.metrics.line_gap = parse_float(offset, bytes);
+        r.metrics.cap_height = parse_float(offset, bytes);
+        r.metrics.x_height = parse_float(offset, bytes);
+        r.metrics.digit_advance = parse_float(offset, bytes);
+
+        r.em_scale = parse_float(offset, bytes);
+        r.num_horizontal_metrics = parse<uint16_t>(offset, bytes);
+        r.num_glyphs = parse<uint16_t>(offset, bytes);
+
+        hilet num_ranges = parse<uint32_t>(offset, bytes);
+        hilet ranges = implicit_cast<char_map_range_type>(offset, bytes, num_ranges);
+        r.char_map.reserve(ranges.size());
+        for (hilet& range : ranges) {
+            hilet start_code_point = *range.start_code_point;
+            hilet end_code_point = *range.end_code_point;
+            hi_check(start_code_point <= end_code_point, "Invalid character range in font index.");
+            hi_check(end_code_point <= 0x10'ffff, "Invalid code-point in font index.");
+            hi_check(*range.start_glyph + (end_code_point - start_code_point) < 0xfffe, "Invalid glyph in font index.");
+            r.char_map.add(char_cast<char32_t>(start_code_point), char_cast<char32_t>(end_code_point), *range.start_glyph);
+        }
+        r.char_map.prepare();
+
+        return r;
+    }
+};
+
+}} // namespace hi::v1
@@ -0,0 +1,154 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "font_index.hpp"
+#include "font_book.hpp"
+#include "true_type_font.hpp"
+#include "../path/path.hpp"
+#include "../telemetry/telemetry.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+using namespace hi;
+
+namespace {
+
+/** A temporary directory which is removed after each test.
+ */
+class font_index_tests : public ::testing::Test {
+protected:
+    std::filesystem::path dir;
+    std::filesystem::path index_path;
+    std::filesystem::path font_path;
+
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "hikogui_font_index_tests";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+
+        index_path = dir / "font_index.bin";
+        font_path = dir / "hikogui_icons.ttf";
+        std::filesystem::copy_file(library_source_dir() / "resources" / "hikogui_icons.ttf", font_path);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    /** Register the font directory with a new font-book using the index.
+     *
+     * @return The number of times a font file was opened.
+     */
+    [[nodiscard]] uint64_t register_font_directory() const
+    {
+        hilet num_opened = static_cast<uint64_t>(global_counter<"ttf:map">);
+
+        auto book = font_book{};
+        book.use_font_index(index_path);
+        book.register_font_directory(dir);
+        return global_counter<"ttf:map"> - num_opened;
+    }
+};
+
+} // namespace
+
+TEST_F(font_index_tests, save_load)
+{
+    hilet font = true_type_font{font_path};
+    auto expected = font.make_index_entry();
+    expected.modification_time = 1234;
+    expected.file_size = 5678;
+
+    auto index = font_index{};
+    index.insert(expected);
+    ASSERT_TRUE(index.modified());
+    index.save(index_path);
+    ASSERT_FALSE(index.modified());
+
+    hilet loaded = font_index::load(index_path);
+    ASSERT_EQ(loaded.size(), 1);
+    ASSERT_FALSE(loaded.modified());
+
+    hilet entry = loaded.find(font_path, 1234, 5678);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->path, expected.path);
+    ASSERT_EQ(entry->family_name, expected.family_name);
+    ASSERT_EQ(entry->sub_family_name, expected.sub_family_name);
+    ASSERT_EQ(entry->features, expected.features);
+    ASSERT_EQ(entry->weight, expected.weight);
+    ASSERT_EQ(entry->style, expected.style);
+    ASSERT_EQ(entry->monospace, expected.monospace);
+    ASSERT_EQ(entry->serif, expected.serif);
+    ASSERT_EQ(entry->condensed, expected.condensed);
+    ASSERT_EQ(entry->metrics, expected.metrics);
+    ASSERT_EQ(entry->char_map.ranges(), expected.char_map.ranges());
+    ASSERT_EQ(entry->em_scale, expected.em_scale);
+    ASSERT_EQ(entry->num_horizontal_metrics, expected.num_horizontal_metrics);
+    ASSERT_EQ(entry->num_glyphs, expected.num_glyphs);
+    ASSERT_EQ(entry->loca_is_offset32, expected.loca_is_offset32);
+
+    // A font constructed from the index finds the same glyphs as the parsed font.
+    hilet indexed_font = true_type_font{*entry};
+    hilet glyph = font.find_glyph(char32_t{0xf301});
+    ASSERT_EQ(indexed_font.find_glyph(char32_t{0xf301}), glyph);
+    ASSERT_EQ(indexed_font.get_metrics(glyph).advance, font.get_metrics(glyph).advance);
+}
+
+TEST_F(font_index_tests, stale_entry)
+{
+    auto entry = true_type_font{font_path}.make_index_entry();
+    entry.modification_time = 1234;
+    entry.file_size = 5678;
+
+    auto index = font_index{};
+    index.insert(entry);
+    index.save(index_path);
+
+    hilet loaded = font_index::load(index_path);
+    ASSERT_NE(loaded.find(font_path, 1234, 5678), nullptr);
+
+    // The font file was modified, or has a different size.
+    ASSERT_EQ(loaded.find(font_path, 1235, 5678), nullptr);
+    ASSERT_EQ(loaded.find(font_path, 1234, 5679), nullptr);
+
+    // A font file that is not in the index.
+    ASSERT_EQ(loaded.find(dir / "other.ttf", 1234, 5678), nullptr);
+}
+
+TEST_F(font_index_tests, corrupt_file)
+{
+    {
+        auto file = hi::file(index_path, access_mode::truncate_or_create_for_write);
+        file.write(std::string_view{"not a font index"});
+    }
+
+    hilet loaded = font_index::load(index_path);
+    ASSERT_TRUE(loaded.empty());
+
+    // A missing file is an empty index.
+    ASSERT_TRUE(font_index::load(dir / "missing.bin").empty());
+}
+
+TEST_F(font_index_tests, rescan_stale_entry)
+{
+    // The first time the font is parsed and added to the index.
+    ASSERT_EQ(register_font_directory(), 1);
+    ASSERT_EQ(font_index::load(index_path).size(), 1);
+
+    // The second time the font is registered from the index.
+    ASSERT_EQ(register_font_directory(), 0);
+
+    // When the font file is modified, the stale entry is ignored and the font is parsed again.
+    std::filesystem::last_write_time(font_path, std::filesystem::last_write_time(font_path) + std::chrono::seconds(10));
+    ASSERT_EQ(register_font_directory(), 1);
+
+    // The index was updated with the new modification time.
+    ASSERT_EQ(register_font_directory(), 0);
+    ASSERT_EQ(font_index::load(index_path).size(), 1);
+}
@@ -36,6 +36,12 @@ public:
      */
     aarectangle texture_coordinates;
 
+    /** The identifier of the allocation in the atlas.
+     *
+     * Used to record when the glyph was last drawn, so that unused glyphs can be evicted.
+     */
+    uint32_t allocation_id = 0;
+
     [[nodiscard]] constexpr bool empty() const noexcept
     {
         return size == extent2{};
@@ -0,0 +1,211 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file font/glyph_sdf_tile.hpp Defines the glyph_sdf_tile type and the glyph rasterizer.
+ * @ingroup font
+ */
+
+#pragma once
+
+#include "font_font.hpp"
+#include "glyph_id.hpp"
+#include "../graphic_path/graphic_path.hpp"
+#include "../image/image.hpp"
+#include "../geometry/geometry.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <concepts>
+
+hi_export_module(hikogui.font.glyph_sdf_tile);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** The type of distance field a glyph is rasterized into.
+ *
+ * @ingroup font
+ */
+hi_export enum class glyph_mode : uint8_t {
+    /** A single-channel signed distance field.
+     */
+    sdf,
+
+    /** A multi-channel signed distance field.
+     *
+     * The corners of the glyph remain sharp when magnified, so that glyphs
+     * can be rasterized at a smaller size for the same visual quality.
+     */
+    msdf
+};
+
+/** A rasterized glyph, ready to be uploaded into a glyph atlas.
+ *
+ * @ingroup font
+ */
+hi_export struct glyph_sdf_tile {
+    /** The font of the glyph.
+     */
+    hi::font const *font = nullptr;
+
+    /** The glyph in the font.
+     */
+    hi::glyph_id glyph = {};
+
+    /** The size of the glyph in the tile, including the border, in pixels.
+     */
+    extent2 size = {};
+
+    /** The amount to scale a quad of the glyph's bounding box to include the border.
+     */
+    scale2 border_scale = {};
+
+    /** The type of distance field of the glyph.
+     */
+    glyph_mode mode = glyph_mode::sdf;
+
+    /** The signed distance field of the glyph, including the border.
+     *
+     * Only used when mode is `glyph_mode::sdf`.
+     */
+    pixmap<sdf_r8> pixels = {};
+
+    /** The multi-channel signed distance field of the glyph, including the border.
+     *
+     * Only used when mode is `glyph_mode::msdf`.
+     */
+    pixmap<sdf_rgba8> msdf_pixels = {};
+
+    /** Get the pixels of the distance field of the glyph.
+     *
+     * @tparam PixelType `sdf_r8` for `glyph_mode::sdf` or `sdf_rgba8` for `glyph_mode::msdf`.
+     */
+    template<typename PixelType>
+    [[nodiscard]] pixmap<PixelType> const& get_pixels() const noexcept
+    {
+        if constexpr (std::same_as<PixelType, sdf_rgba8>) {
+            hi_axiom(mode == glyph_mode::msdf);
+            return msdf_pixels;
+        } else {
+            static_assert(std::same_as<PixelType, sdf_r8>);
+            hi_axiom(mode == glyph_mode::sdf);
+            return pixels;
+        }
+    }
+};
+
+/** Rasterize a glyph into a signed distance field.
+ *
+ * The glyph is drawn at a fixed size with a border around it, so that the
+ * signed distance field can be bi-linearly interpolated near its edges.
+ *
+ *  +---------------------+
+ *  |     draw border     |
+ *  |  +---------------+  |
+ *  |  |     glyph     |  |
+ *  |  |    bounding   |  |
+ *  |  |      box      |  |
+ *  |  +---------------+  |
+ *  |                     |
+ *  O---------------------+
+ *
+ * This function is thread-safe, so that many glyphs can be rasterized in parallel.
+ *
+ * @ingroup font
+ * @param font The font of the glyph.
+ * @param glyph The glyph in the font.
+ * @param font_size The size of the em-square in pixels.
+ * @param border The size of the border around the bounding box of the glyph in pixels.
+ * @param mode The type of distance field to rasterize.
+ * @return The rasterized glyph.
+ */
+[[nodiscard]] hi_inline glyph_sdf_tile
+rasterize_glyph(hi::font const& font, glyph_id glyph, float font_size, float border, glyph_mode mode = glyph_mode::sdf) noexcept
+{
+    hilet glyph_metrics = font.get_metrics(glyph);
+    hilet glyph_path = font.get_path(glyph);
+    hilet glyph_bounding_box = glyph_metrics.bounding_rectangle;
+
+    hilet draw_scale = scale2{font_size, font_size};
+    hilet draw_bounding_box = draw_scale * glyph_bounding_box;
+
+    // Determine the size of the image, this is the bounding box sized to the
+    // fixed font size and a border.
+    hilet draw_offset = point2{border, border} - get<0>(draw_bounding_box);
+    hilet draw_extent = draw_bounding_box.size() + 2.0f * border;
+    hilet image_size = ceil(draw_extent);
+
+    // Transform the path to the scale of the fixed font size and draw the bounding box inside the image.
+    hilet draw_path = (translate2{draw_offset} * draw_scale) * glyph_path;
+
+    auto r = glyph_sdf_tile{};
+    r.font = std::addressof(font);
+    r.glyph = glyph;
+    r.size = image_size;
+    r.border_scale = image_size / draw_bounding_box.size();
+    r.mode = mode;
+
+    hilet width = ceil_cast<size_t>(image_size.width());
+    hilet height = ceil_cast<size_t>(image_size.height());
+    if (mode == glyph_mode::msdf) {
+        r.msdf_pixels = pixmap<sdf_rgba8>{width, height};
+        fill(pixmap_span<sdf_rgba8>{r.msdf_pixels}, draw_path);
+    } else {
+        r.pixels = pixmap<sdf_r8>{width, height};
+        fill(pixmap_span<sdf_r8>{r.pixels}, draw_path);
+    }
+    return r;
+}
+
+/** Rasterize a set of glyphs in parallel.
+ *
+ * This is used to pre-warm a glyph atlas, for example with the glyphs for
+ * a language at application start-up, without stalling the render thread.
+ *
+ * @ingroup font
+ * @param glyphs The font and glyph pairs to rasterize.
+ * @param font_size The size of the em-square in pixels.
+ * @param border The size of the border around the bounding box of each glyph in pixels.
+ * @param mode The type of distance field to rasterize.
+ * @param num_threads The maximum number of worker threads to use.
+ * @return The rasterized glyphs, in the same order as @a glyphs.
+ */
+[[nodiscard]] hi_inline std::vector<glyph_sdf_tile> rasterize_glyphs(
+    std::span<std::pair<hi::font const *, glyph_id> const> glyphs,
+    float font_size,
+    float border,
+    glyph_mode mode = glyph_mode::sdf,
+    size_t num_threads = std::thread::hardware_concurrency()) noexcept
+{
+    auto r = std::vector<glyph_sdf_tile>(glyphs.size());
+
+    auto next_index = std::atomic<size_t>{0};
+    hilet worker = [&] {
+        for (auto i = next_index.fetch_add(1, std::memory_order::relaxed); i < glyphs.size();
+             i = next_index.fetch_add(1, std::memory_order::relaxed)) {
+            hilet[font, glyph] = glyphs[i];
+            hi_assert_not_null(font);
+            r[i] = rasterize_glyph(*font, glyph, font_size, border, mode);
+        }
+    };
+
+    // The calling thread takes part in rasterizing the glyphs.
+    hilet num_workers = std::min(std::max(num_threads, 1_uz), glyphs.size());
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto i = 1_uz; i < num_workers; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+
+    return r;
+}
+
+}} // namespace hi::v1
@@ -0,0 +1,200 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "glyph_sdf_tile.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace hi;
+
+namespace {
+
+/** A font with rectangular glyphs at known positions.
+ *
+ * - glyph 0: a rectangle from (0.1, 0.2) to (0.6, 0.9) em.
+ * - glyph 1: a rectangle from (0.0, 0.0) to (0.51, 0.5) em, not a whole number of pixels wide.
+ * - glyph 2: a rectangle from (0.0, 0.0) to (0.25, 0.75) em.
+ */
+class glyph_sdf_tile_test_font final : public font {
+public:
+    [[nodiscard]] bool loaded() const noexcept override
+    {
+        return true;
+    }
+
+    [[nodiscard]] graphic_path get_path(hi::glyph_id glyph_id) const override
+    {
+        hilet rectangle = bounding_rectangle(glyph_id);
+
+        // Clock-wise, like the outer contour of a TrueType glyph.
+        auto r = graphic_path{};
+        r.moveTo(get<0>(rectangle));
+        r.lineTo(get<2>(rectangle));
+        r.lineTo(get<3>(rectangle));
+        r.lineTo(get<1>(rectangle));
+        r.closeContour();
+        return r;
+    }
+
+    [[nodiscard]] float get_advance(hi::glyph_id glyph_id) const override
+    {
+        return bounding_rectangle(glyph_id).right();
+    }
+
+    [[nodiscard]] glyph_metrics get_metrics(hi::glyph_id glyph_id) const override
+    {
+        auto r = glyph_metrics{};
+        r.bounding_rectangle = bounding_rectangle(glyph_id);
+        r.advance = get_advance(glyph_id);
+        return r;
+    }
+
+    [[nodiscard]] std::shared_ptr<shape_run_result_type const>
+    shape_run(iso_639 language, iso_15924 script, gstring run) const override
+    {
+        return std::make_shared<shape_run_result_type>();
+    }
+
+private:
+    [[nodiscard]] static aarectangle bounding_rectangle(hi::glyph_id glyph_id) noexcept
+    {
+        switch (*glyph_id) {
+        case 0:
+            return aarectangle{point2{0.1f, 0.2f}, point2{0.6f, 0.9f}};
+        case 1:
+            return aarectangle{point2{0.0f, 0.0f}, point2{0.51f, 0.5f}};
+        default:
+            return aarectangle{point2{0.0f, 0.0f}, point2{0.25f, 0.75f}};
+        }
+    }
+};
+
+/** Get the signed distance at a pixel of the tile.
+ */
+[[nodiscard]] float distance(glyph_sdf_tile const& tile, size_t x, size_t y) noexcept
+{
+    return static_cast<float>(tile.get_pixels<sdf_r8>()[y][x]);
+}
+
+/** The precision of a distance stored in a sdf_r8 pixel.
+ */
+constexpr float epsilon = 2.0f * sdf_r8::max_distance / 127.0f;
+
+} // namespace
+
+TEST(glyph_sdf_tile, size)
+{
+    auto font = glyph_sdf_tile_test_font{};
+
+    // At 20 pixels per em the glyph is 10 x 14 pixels, with a border of 2 pixels on each side.
+    hilet tile = rasterize_glyph(font, glyph_id{0}, 20.0f, 2.0f);
+    ASSERT_EQ(tile.font, &font);
+    ASSERT_EQ(tile.glyph, glyph_id{0});
+    ASSERT_EQ(tile.mode, glyph_mode::sdf);
+    ASSERT_EQ(tile.size, (extent2{14.0f, 18.0f}));
+    ASSERT_EQ(tile.pixels.width(), 14);
+    ASSERT_EQ(tile.pixels.height(), 18);
+
+    // The bounding box of the glyph, scaled by the border-scale, covers the whole tile.
+    ASSERT_FLOAT_EQ(tile.border_scale.x(), 14.0f / 10.0f);
+    ASSERT_FLOAT_EQ(tile.border_scale.y(), 18.0f / 14.0f);
+}
+
+TEST(glyph_sdf_tile, placement)
+{
+    auto font = glyph_sdf_tile_test_font{};
+    hilet tile = rasterize_glyph(font, glyph_id{0}, 20.0f, 2.0f);
+
+    // The glyph is placed inside the border, from (2, 2) to (12, 16).
+    ASSERT_NEAR(distance(tile, 2, 9), 0.0f, epsilon);
+    ASSERT_NEAR(distance(tile, 12, 9), 0.0f, epsilon);
+    ASSERT_NEAR(distance(tile, 7, 2), 0.0f, epsilon);
+    ASSERT_NEAR(distance(tile, 7, 16), 0.0f, epsilon);
+
+    // The inside and outside of the glyph have opposite signs.
+    hilet inside = distance(tile, 7, 9);
+    ASSERT_NEAR(std::abs(inside), sdf_r8::max_distance, epsilon);
+    ASSERT_NEAR(distance(tile, 3, 9), std::copysign(1.0f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 1, 9), std::copysign(-1.0f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 0, 9), std::copysign(-2.0f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 13, 9), std::copysign(-1.0f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 7, 17), std::copysign(-1.0f, inside), epsilon);
+}
+
+TEST(glyph_sdf_tile, tile_boundary)
+{
+    auto font = glyph_sdf_tile_test_font{};
+
+    // At 20 pixels per em the glyph is 10.2 x 10 pixels; the tile is rounded up to whole pixels.
+    hilet tile = rasterize_glyph(font, glyph_id{1}, 20.0f, 2.0f);
+    ASSERT_EQ(tile.size, (extent2{15.0f, 14.0f}));
+    ASSERT_EQ(tile.pixels.width(), 15);
+    ASSERT_EQ(tile.pixels.height(), 14);
+    ASSERT_FLOAT_EQ(tile.border_scale.x(), 15.0f / 10.2f);
+    ASSERT_FLOAT_EQ(tile.border_scale.y(), 14.0f / 10.0f);
+
+    // The right edge of the glyph is in the middle of pixel 12.
+    hilet inside = distance(tile, 7, 7);
+    ASSERT_NEAR(distance(tile, 12, 7), std::copysign(0.2f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 13, 7), std::copysign(-0.8f, inside), epsilon);
+
+    // The extra pixel from rounding up is added to the border, so that the
+    // glyph never touches the edge of the tile.
+    ASSERT_NEAR(distance(tile, 14, 7), std::copysign(-1.8f, inside), epsilon);
+    ASSERT_NEAR(distance(tile, 7, 13), std::copysign(-1.0f, inside), epsilon);
+    for (auto y = 0_uz; y != tile.pixels.height(); ++y) {
+        for (auto x = 0_uz; x != tile.pixels.width(); ++x) {
+            if (x == 0 or y == 0 or x == tile.pixels.width() - 1 or y == tile.pixels.height() - 1) {
+                ASSERT_LE(distance(tile, x, y) * std::copysign(1.0f, inside), -1.0f + epsilon) << "x=" << x << " y=" << y;
+            }
+        }
+    }
+}
+
+TEST(glyph_sdf_tile, msdf)
+{
+    auto font = glyph_sdf_tile_test_font{};
+    hilet tile = rasterize_glyph(font, glyph_id{0}, 20.0f, 2.0f, glyph_mode::msdf);
+    ASSERT_EQ(tile.mode, glyph_mode::msdf);
+    ASSERT_EQ(tile.size, (extent2{14.0f, 18.0f}));
+
+    // Only the multi-channel pixels are used.
+    ASSERT_EQ(tile.pixels.width(), 0);
+    ASSERT_EQ(tile.get_pixels<sdf_rgba8>().width(), 14);
+    ASSERT_EQ(tile.get_pixels<sdf_rgba8>().height(), 18);
+}
+
+TEST(glyph_sdf_tile, rasterize_glyphs)
+{
+    auto font = glyph_sdf_tile_test_font{};
+
+    auto glyphs = std::vector<std::pair<hi::font const *, glyph_id>>{};
+    for (auto i = 0; i != 20; ++i) {
+        glyphs.emplace_back(&font, glyph_id{i % 3});
+    }
+
+    // The tiles are rasterized in parallel and returned in the same order as the glyphs.
+    hilet tiles = rasterize_glyphs(glyphs, 20.0f, 2.0f, glyph_mode::sdf, 4);
+    ASSERT_EQ(tiles.size(), glyphs.size());
+    for (auto i = 0_uz; i != glyphs.size(); ++i) {
+        hilet expected = rasterize_glyph(font, glyphs[i].second, 20.0f, 2.0f);
+        ASSERT_EQ(tiles[i].glyph, expected.glyph);
+        ASSERT_EQ(tiles[i].size, expected.size);
+        ASSERT_EQ(tiles[i].pixels.width(), expected.pixels.width());
+        ASSERT_EQ(tiles[i].pixels.height(), expected.pixels.height());
+        for (auto y = 0_uz; y != expected.pixels.height(); ++y) {
+            for (auto x = 0_uz; x != expected.pixels.width(); ++x) {
+                ASSERT_EQ(tiles[i].pixels[y][x].value, expected.pixels[y][x].value);
+            }
+        }
+    }
+
+    // No glyphs and no worker threads.
+    ASSERT_TRUE(rasterize_glyphs({}, 20.0f, 2.0f).empty());
+    ASSERT_EQ(rasterize_glyphs(glyphs, 20.0f, 2.0f, glyph_mode::sdf, 0).size(), glyphs.size());
+}
@@ -9,23 +9,33 @@
 #include "../macros.hpp"
 #include <span>
 #include <cstddef>
+#include <vector>
+#include <algorithm>
 
 hi_export_module(hikogui.font.otype_htmx);
 
 hi_export namespace hi { inline namespace v1 {
+namespace detail {
 
-[[nodiscard]] hi_inline auto
+struct otype_hmtx_entry {
+    otype_fuword_buf_t advance_width;
+    otype_fword_buf_t left_side_bearing;
+};
+
+} // namespace detail
+
+/** The horizontal metrics of a glyph.
+ */
+struct otype_hmtx_metrics {
+    float advance_width;
+    float left_side_bearing;
+};
+
+[[nodiscard]] hi_inline otype_hmtx_metrics
 otype_hmtx_get(std::span<std::byte const> bytes, hi::glyph_id glyph_id, uint16_t num_horizontal_metrics, float em_scale)
 {
-    struct entry_type {
-        otype_fuword_buf_t advance_width;
-        otype_fword_buf_t left_side_bearing;
-    };
-
-    struct return_type {
-        float advance_width;
-        float left_side_bearing;
-    };
+    using entry_type = detail::otype_hmtx_entry;
+    using return_type = otype_hmtx_metrics;
 
     hi_axiom(num_horizontal_metrics >= 1);
 
@@ -49,4 +59,36 @@ otype_hmtx_get(std::span<std::byte const> bytes, hi::glyph_id glyph_id, uint16_t
     return return_type{advance_width, left_side_bearing};
 }
 
+/** Get the horizontal metrics of all glyphs in a single pass over the table.
+ *
+ * @param bytes The bytes of the 'hmtx' table.
+ * @param num_glyphs The number of glyphs in the font.
+ * @param num_horizontal_metrics The number of entries with an advance-width.
+ * @param em_scale The scale to convert font-units to em.
+ * @return The horizontal metrics of each glyph, indexed by glyph-id.
+ */
+[[nodiscard]] hi_inline std::vector<otype_hmtx_metrics>
+otype_hmtx_get_all(std::span<std::byte const> bytes, size_t num_glyphs, uint16_t num_horizontal_metrics, float em_scale)
+{
+    hi_axiom(num_horizontal_metrics >= 1);
+
+    auto offset = 0_uz;
+    hilet horizontal_metrics = implicit_cast<detail::otype_hmtx_entry>(offset, bytes, num_horizontal_metrics);
+
+    auto r = std::vector<otype_hmtx_metrics>{};
+    r.reserve(num_glyphs);
+    for (hilet& entry : horizontal_metrics.first(std::min(num_glyphs, horizontal_metrics.size()))) {
+        r.push_back({entry.advance_width * em_scale, entry.left_side_bearing * em_scale});
+    }
+
+    if (r.size() < num_glyphs) {
+        hilet advance_width = horizontal_metrics.back().advance_width * em_scale;
+        hilet left_side_bearings = implicit_cast<otype_fword_buf_t>(offset, bytes, num_glyphs - r.size());
+        for (hilet& left_side_bearing : left_side_bearings) {
+            r.push_back({advance_width, left_side_bearing * em_scale});
+        }
+    }
+    return r;
+}
+
 }} // namespace hi::v1
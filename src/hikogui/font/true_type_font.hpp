@@ -18,16 +18,55 @@
 #include "otype_name.hpp"
 #include "otype_os2.hpp"
 #include "font_char_map.hpp"
+#include "font_index.hpp"
 #include "../file/file_view.hpp"
 #include "../graphic_path/graphic_path.hpp"
 #include "../telemetry/telemetry.hpp"
+#include "../container/container.hpp"
+#include "../concurrency/concurrency.hpp"
 #include "../utility/utility.hpp"
 #include <memory>
 #include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <tuple>
 
 hi_export_module(hikogui.font.true_type_font);
 
 hi_export namespace hi::inline v1 {
+namespace detail {
+
+/** The key into the shape-run cache.
+ */
+struct shape_run_key {
+    hi::font const *font;
+    iso_639 language;
+    iso_15924 script;
+    gstring run;
+
+    [[nodiscard]] friend bool operator==(shape_run_key const&, shape_run_key const&) noexcept = default;
+};
+
+struct shape_run_key_hash {
+    [[nodiscard]] size_t operator()(shape_run_key const& rhs) const noexcept
+    {
+        auto r = hash_mix(rhs.font, rhs.language, rhs.script);
+        for (hilet& g : rhs.run) {
+            r = hash_mix_two(r, std::hash<grapheme>{}(g));
+        }
+        return r;
+    }
+};
+
+/** A cache of shaped runs shared by all fonts.
+ *
+ * UI labels are re-shaped on every layout pass, and mostly consist of the
+ * same short strings.
+ */
+hi_inline auto shape_run_cache = lru_cache<shape_run_key, font::shape_run_result_type, shape_run_key_hash>{4096};
+
+} // namespace detail
 
 hi_export class true_type_font final : public font {
 public:
@@ -48,16 +87,78 @@ public:
         }
     }
 
+    /** Construct a font from the properties cached in a font index.
+     *
+     * The font file is not opened until the glyphs of the font are needed.
+     *
+     * @param entry The properties of the font file.
+     */
+    true_type_font(font_index_entry const& entry) : _path(entry.path)
+    {
+        family_name = entry.family_name;
+        sub_family_name = entry.sub_family_name;
+        features = entry.features;
+        weight = entry.weight;
+        style = entry.style;
+        monospace = entry.monospace;
+        serif = entry.serif;
+        condensed = entry.condensed;
+        metrics = entry.metrics;
+        char_map = entry.char_map;
+
+        _em_scale = entry.em_scale;
+        _num_horizontal_metrics = entry.num_horizontal_metrics;
+        num_glyphs = entry.num_glyphs;
+        _loca_is_offset32 = entry.loca_is_offset32;
+    }
+
     true_type_font() = delete;
     true_type_font(true_type_font const& other) = delete;
     true_type_font& operator=(true_type_font const& other) = delete;
     true_type_font(true_type_font&& other) = delete;
     true_type_font& operator=(true_type_font&& other) = delete;
-    ~true_type_font() = default;
+
+    ~true_type_font()
+    {
+        delete[] _metrics_cache.load(std::memory_order::relaxed);
+    }
 
     [[nodiscard]] bool loaded() const noexcept override
     {
-        return to_bool(_view);
+        return _view_loaded.load(std::memory_order::acquire);
+    }
+
+    /** The path to the font file.
+     */
+    [[nodiscard]] std::filesystem::path const& path() const noexcept
+    {
+        return _path;
+    }
+
+    /** Get the properties of this font to store in the font index.
+     *
+     * @note The caller is responsible for setting the modification time and file size.
+     */
+    [[nodiscard]] font_index_entry make_index_entry() const noexcept
+    {
+        auto r = font_index_entry{};
+        r.path = _path;
+        r.family_name = family_name;
+        r.sub_family_name = sub_family_name;
+        r.features = features;
+        r.weight = weight;
+        r.style = style;
+        r.monospace = monospace;
+        r.serif = serif;
+        r.condensed = condensed;
+        r.metrics = metrics;
+        r.char_map = char_map;
+
+        r.em_scale = _em_scale;
+        r.num_horizontal_metrics = _num_horizontal_metrics;
+        r.num_glyphs = narrow_cast<uint16_t>(num_glyphs);
+        r.loca_is_offset32 = _loca_is_offset32;
+        return r;
     }
 
     [[nodiscard]] graphic_path get_path(hi::glyph_id glyph_id) const override
@@ -94,59 +195,65 @@ public:
 
     [[nodiscard]] float get_advance(hi::glyph_id glyph_id) const override
     {
-        load_view();
-
-        hi_check(*glyph_id < num_glyphs, "glyph_id is not valid in this font.");
-        hilet[advance_width, left_side_bearing] = otype_hmtx_get(_hmtx_table_bytes, glyph_id, _num_horizontal_metrics, _em_scale);
-        return advance_width;
+        return get_metrics(glyph_id).advance;
     }
 
     [[nodiscard]] glyph_metrics get_metrics(hi::glyph_id glyph_id) const override
     {
-        load_view();
-
         hi_check(*glyph_id < num_glyphs, "glyph_id is not valid in this font.");
 
-        hilet glyph_bytes = otype_loca_get(_loca_table_bytes, _glyf_table_bytes, glyph_id, _loca_is_offset32);
-
-        if (otype_glyf_is_compound(glyph_bytes)) {
-            for (hilet& component : otype_glyf_get_compound(glyph_bytes, _em_scale)) {
-                if (component.use_for_metrics) {
-                    return get_metrics(component.glyph_id);
-                }
-            }
+        auto& entry = metrics_cache()[*glyph_id];
+        if (entry.state.load(std::memory_order::acquire) == metrics_state::ready) [[likely]] {
+            return entry.metrics;
         }
 
-        auto r = glyph_metrics{};
-        r.bounding_rectangle = otype_glyf_get_bounding_box(glyph_bytes, _em_scale);
-        hilet[advance_width, left_side_bearing] = otype_hmtx_get(_hmtx_table_bytes, glyph_id, _num_horizontal_metrics, _em_scale);
-
-        r.advance = advance_width;
-        r.left_side_bearing = left_side_bearing;
-        r.right_side_bearing = advance_width - (left_side_bearing + r.bounding_rectangle.width());
+        load_view();
+        hilet r = parse_metrics(glyph_id);
+        store_metrics(entry, r);
         return r;
     }
 
-    [[nodiscard]] shape_run_result_type shape_run(iso_639 language, iso_15924 script, gstring run) const override
+    /** Load the metrics of all glyphs into the metrics cache.
+     *
+     * The 'hmtx' table is decoded once for all glyphs, and the 'loca' and
+     * 'glyf' tables are read in glyph order. This is cheaper than decoding
+     * the metrics of each glyph on first use, when it is known that many of
+     * the glyphs of this font will be used.
+     *
+     * @throws std::exception If there was an error while parsing the tables.
+     */
+    void load_metrics() const
     {
-        auto r = shape_run_basic(run);
+        load_view();
 
-        // Glyphs should be morphed only once.
-        // auto morphed = false;
-        // Glyphs should be positioned only once.
-        auto positioned = false;
+        hilet horizontal_metrics = otype_hmtx_get_all(_hmtx_table_bytes, num_glyphs, _num_horizontal_metrics, _em_scale);
+        hilet cache = metrics_cache();
 
-        if (not positioned and not _kern_table_bytes.empty()) {
-            try {
-                shape_run_kern(r);
-                positioned = true;
-            } catch (std::exception const& e) {
-                hi_log_error("Turning off invalid 'kern' table in font '{} {}': {}", family_name, sub_family_name, e.what());
-                _kern_table_bytes = {};
+        auto compound_glyphs = std::vector<hi::glyph_id>{};
+        for (auto i = 0; i != num_glyphs; ++i) {
+            hilet glyph_id = hi::glyph_id{i};
+            hilet glyph_bytes = otype_loca_get(_loca_table_bytes, _glyf_table_bytes, glyph_id, _loca_is_offset32);
+
+            if (otype_glyf_is_compound(glyph_bytes)) {
+                compound_glyphs.push_back(glyph_id);
+            } else {
+                store_metrics(cache[i], make_metrics(glyph_bytes, horizontal_metrics[i]));
             }
         }
 
-        return r;
+        // Compound glyphs may use the metrics of one of their components, which are now cached.
+        for (hilet glyph_id : compound_glyphs) {
+            std::ignore = get_metrics(glyph_id);
+        }
+    }
+
+    [[nodiscard]] std::shared_ptr<shape_run_result_type const>
+    shape_run(iso_639 language, iso_15924 script, gstring run) const override
+    {
+        auto key = detail::shape_run_key{this, language, script, std::move(run)};
+        return detail::shape_run_cache.get_or_emplace(key, [&] {
+            return shape_run_uncached(key.run);
+        });
     }
 
 private:
@@ -160,21 +267,105 @@ private:
      */
     mutable file_view _view;
 
+    /** Set when `_view` and the table spans are valid.
+     */
+    mutable std::atomic<bool> _view_loaded = false;
+    mutable unfair_mutex _view_mutex;
+
     float OS2_x_height = 0;
     float OS2_cap_height = 0;
 
-    float _em_scale;
+    float _em_scale = 0.0f;
 
-    uint16_t _num_horizontal_metrics;
+    uint16_t _num_horizontal_metrics = 0;
 
-    int num_glyphs;
+    int num_glyphs = 0;
     mutable std::span<std::byte const> _bytes;
     mutable std::span<std::byte const> _loca_table_bytes;
     mutable std::span<std::byte const> _glyf_table_bytes;
     mutable std::span<std::byte const> _hmtx_table_bytes;
     mutable std::span<std::byte const> _kern_table_bytes;
     mutable std::span<std::byte const> _GSUB_table_bytes;
-    bool _loca_is_offset32;
+    bool _loca_is_offset32 = false;
+
+    enum class metrics_state : uint8_t { empty, busy, ready };
+
+    struct metrics_cache_entry {
+        glyph_metrics metrics;
+        std::atomic<metrics_state> state = metrics_state::empty;
+    };
+
+    /** Dense cache of the metrics of each glyph, indexed by glyph_id.
+     *
+     * The table is allocated on first use, since most registered fonts are
+     * never used to display text.
+     */
+    mutable std::atomic<metrics_cache_entry *> _metrics_cache = nullptr;
+
+    [[nodiscard]] metrics_cache_entry *metrics_cache() const noexcept
+    {
+        if (auto ptr = _metrics_cache.load(std::memory_order::acquire)) [[likely]] {
+            return ptr;
+        }
+
+        auto *new_ptr = new metrics_cache_entry[num_glyphs];
+        metrics_cache_entry *expected = nullptr;
+        if (_metrics_cache.compare_exchange_strong(expected, new_ptr, std::memory_order::acq_rel)) {
+            return new_ptr;
+        } else {
+            // An other thread allocated the table first.
+            delete[] new_ptr;
+            return expected;
+        }
+    }
+
+    /** Parse the metrics of a glyph from the font tables.
+     *
+     * @note The view must be loaded.
+     */
+    [[nodiscard]] glyph_metrics parse_metrics(hi::glyph_id glyph_id) const
+    {
+        hilet glyph_bytes = otype_loca_get(_loca_table_bytes, _glyf_table_bytes, glyph_id, _loca_is_offset32);
+
+        if (otype_glyf_is_compound(glyph_bytes)) {
+            for (hilet& component : otype_glyf_get_compound(glyph_bytes, _em_scale)) {
+                if (component.use_for_metrics) {
+                    return get_metrics(component.glyph_id);
+                }
+            }
+        }
+
+        return make_metrics(glyph_bytes, otype_hmtx_get(_hmtx_table_bytes, glyph_id, _num_horizontal_metrics, _em_scale));
+    }
+
+    /** Make the metrics of a simple glyph.
+     *
+     * @param glyph_bytes The bytes of the glyph in the 'glyf' table.
+     * @param horizontal_metrics The metrics of the glyph from the 'hmtx' table.
+     */
+    [[nodiscard]] glyph_metrics make_metrics(std::span<std::byte const> glyph_bytes, otype_hmtx_metrics horizontal_metrics) const
+    {
+        auto r = glyph_metrics{};
+        r.bounding_rectangle = otype_glyf_get_bounding_box(glyph_bytes, _em_scale);
+        r.advance = horizontal_metrics.advance_width;
+        r.left_side_bearing = horizontal_metrics.left_side_bearing;
+        r.right_side_bearing = r.advance - (r.left_side_bearing + r.bounding_rectangle.width());
+        return r;
+    }
+
+    /** Store the metrics of a glyph in its cache entry.
+     *
+     * Only a single thread may write the entry; other threads that race
+     * on the same glyph simply return the metrics they parsed themselves.
+     */
+    static void store_metrics(metrics_cache_entry& entry, glyph_metrics const& metrics) noexcept
+    {
+        auto expected = metrics_state::empty;
+        if (entry.state.compare_exchange_strong(expected, metrics_state::busy, std::memory_order::acquire)) {
+            entry.metrics = metrics;
+            entry.state.store(metrics_state::ready, std::memory_order::release);
+        }
+    }
 
     void cache_tables(std::span<std::byte const> bytes) const
     {
@@ -187,16 +378,28 @@ private:
         _GSUB_table_bytes = otype_sfnt_search<"GSUB">(bytes);
     }
 
+    /** Map the font file.
+     *
+     * Glyphs may be read from multiple threads at once, for example when
+     * glyphs are rasterized in parallel. Therefor the file is mapped only once
+     * under a lock.
+     */
     void load_view() const noexcept
     {
-        if (_view) {
+        if (_view_loaded.load(std::memory_order::acquire)) {
             [[likely]] return;
         }
 
+        hilet lock = std::scoped_lock(_view_mutex);
+        if (_view_loaded.load(std::memory_order::relaxed)) {
+            return;
+        }
+
         _view = file_view{_path};
         _bytes = as_span<std::byte const>(_view);
         ++global_counter<"ttf:map">;
         cache_tables(_bytes);
+        _view_loaded.store(true, std::memory_order::release);
     }
 
     /** Parses the directory table of the font file.
@@ -341,9 +544,33 @@ private:
         }
     }
 
+    /** Shape a run of graphemes without consulting the shape-run cache.
+     */
+    [[nodiscard]] font::shape_run_result_type shape_run_uncached(gstring const& run) const
+    {
+        auto r = shape_run_basic(run);
+
+        // Glyphs should be morphed only once.
+        // auto morphed = false;
+        // Glyphs should be positioned only once.
+        auto positioned = false;
+
+        if (not positioned and not _kern_table_bytes.empty()) {
+            try {
+                shape_run_kern(r);
+                positioned = true;
+            } catch (std::exception const& e) {
+                hi_log_error("Turning off invalid 'kern' table in font '{} {}': {}", family_name, sub_family_name, e.what());
+                _kern_table_bytes = {};
+            }
+        }
+
+        return r;
+    }
+
     /** Shape the given text with very basic rules.
      */
-    [[nodiscard]] font::shape_run_result_type shape_run_basic(gstring run) const
+    [[nodiscard]] font::shape_run_result_type shape_run_basic(gstring const& run) const
     {
         auto r = font::shape_run_result_type{};
         r.reserve(run.size());
@@ -0,0 +1,56 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "true_type_font.hpp"
+#include "../path/path.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+using namespace hi;
+
+namespace {
+
+/** Check that loading the metrics of all glyphs at once gives the same metrics as loading them one at a time.
+ */
+void check_load_metrics(std::filesystem::path const& path)
+{
+    auto lazy = true_type_font{path};
+    auto bulk = true_type_font{path};
+    bulk.load_metrics();
+
+    hilet num_glyphs = bulk.make_index_entry().num_glyphs;
+    ASSERT_GT(num_glyphs, 0);
+    for (auto i = 0; i != num_glyphs; ++i) {
+        hilet expected = lazy.get_metrics(glyph_id{i});
+        hilet metrics = bulk.get_metrics(glyph_id{i});
+        ASSERT_EQ(metrics.bounding_rectangle, expected.bounding_rectangle) << "glyph=" << i;
+        ASSERT_EQ(metrics.advance, expected.advance) << "glyph=" << i;
+        ASSERT_EQ(metrics.left_side_bearing, expected.left_side_bearing) << "glyph=" << i;
+        ASSERT_EQ(metrics.right_side_bearing, expected.right_side_bearing) << "glyph=" << i;
+    }
+}
+
+} // namespace
+
+TEST(true_type_font, load_metrics)
+{
+    check_load_metrics(library_source_dir() / "resources" / "hikogui_icons.ttf");
+    check_load_metrics(library_source_dir() / "resources" / "elusiveicons-webfont.ttf");
+}
+
+TEST(true_type_font, load_metrics_from_index)
+{
+    // A font constructed from the font index loads its tables when the metrics are loaded.
+    hilet path = library_source_dir() / "resources" / "hikogui_icons.ttf";
+    auto lazy = true_type_font{path};
+    auto bulk = true_type_font{lazy.make_index_entry()};
+    ASSERT_FALSE(bulk.loaded());
+
+    bulk.load_metrics();
+    ASSERT_TRUE(bulk.loaded());
+
+    hilet glyph = lazy.find_glyph(char32_t{0xf301});
+    ASSERT_EQ(bulk.get_metrics(glyph).advance, lazy.get_metrics(glyph).advance);
+}
@@ -0,0 +1,244 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file geometry/damage_region.hpp Defines the damage_region type.
+ */
+
+#pragma once
+
+#include "aarectangle.hpp"
+#include "extent2.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <array>
+#include <cstddef>
+#include <limits>
+
+hi_export_module(hikogui.geometry : damage_region);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** The parts of a window that need to be redrawn.
+ *
+ * The region is a small set of disjoint rectangles. A rectangle that is
+ * added is merged with each rectangle of the set that it overlaps, or when
+ * their bounding rectangle is not larger than the two rectangles together,
+ * so that adjacent rectangles become one. When the set is full the two
+ * rectangles whose bounding rectangle adds the least area are merged.
+ *
+ * The rectangles are disjoint, so that a window redrawn with a scissor
+ * rectangle for each rectangle of the region blends each pixel only once.
+ *
+ * Two small changes in opposite corners of a window therefore remain two
+ * small rectangles, instead of becoming a rectangle covering the window.
+ */
+class damage_region {
+public:
+    using value_type = aarectangle;
+    using const_iterator = aarectangle const *;
+
+    /** The maximum number of rectangles in the region.
+     */
+    constexpr static std::size_t capacity = 8;
+
+    constexpr damage_region() noexcept = default;
+    constexpr damage_region(damage_region const&) noexcept = default;
+    constexpr damage_region(damage_region&&) noexcept = default;
+    constexpr damage_region& operator=(damage_region const&) noexcept = default;
+    constexpr damage_region& operator=(damage_region&&) noexcept = default;
+
+    constexpr damage_region(aarectangle const& rectangle) noexcept
+    {
+        add(rectangle);
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return not empty();
+    }
+
+    [[nodiscard]] constexpr const_iterator begin() const noexcept
+    {
+        return _rectangles.data();
+    }
+
+    [[nodiscard]] constexpr const_iterator end() const noexcept
+    {
+        return _rectangles.data() + _size;
+    }
+
+    [[nodiscard]] constexpr aarectangle const& operator[](std::size_t index) const noexcept
+    {
+        hi_axiom(index < _size);
+        return _rectangles[index];
+    }
+
+    constexpr void clear() noexcept
+    {
+        _size = 0;
+    }
+
+    /** Add a rectangle to the region.
+     */
+    constexpr void add(aarectangle rectangle) noexcept
+    {
+        if (not rectangle) {
+            return;
+        }
+
+        // Merge with each rectangle that overlaps, or for which this is cheaper than keeping both.
+        for (auto i = 0_uz; i != _size;) {
+            hilet merged = _rectangles[i] | rectangle;
+            if (overlaps_area(_rectangles[i], rectangle) or area(merged) <= area(_rectangles[i]) + area(rectangle)) {
+                rectangle = merged;
+                remove(i);
+                // The larger rectangle may now also merge with the rectangles that were checked.
+                i = 0;
+            } else {
+                ++i;
+            }
+        }
+
+        if (_size != capacity) {
+            _rectangles[_size++] = rectangle;
+            return;
+        }
+
+        // The region is full; merge the pair that wastes the least area.
+        auto best_cost = std::numeric_limits<float>::max();
+        auto best_i = 0_uz;
+        auto best_j = capacity;
+        for (auto i = 0_uz; i != _size; ++i) {
+            if (hilet cost = merge_cost(_rectangles[i], rectangle); cost < best_cost) {
+                best_cost = cost;
+                best_i = i;
+                best_j = capacity;
+            }
+            for (auto j = i + 1; j != _size; ++j) {
+                if (hilet cost = merge_cost(_rectangles[i], _rectangles[j]); cost < best_cost) {
+                    best_cost = cost;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+
+        if (best_j == capacity) {
+            rectangle = _rectangles[best_i] | rectangle;
+            remove(best_i);
+            add(rectangle);
+        } else {
+            hilet merged = _rectangles[best_i] | _rectangles[best_j];
+            // Remove the highest index first, so that the other index remains valid.
+            remove(best_j);
+            remove(best_i);
+            add(merged);
+            add(rectangle);
+        }
+    }
+
+    constexpr damage_region& operator|=(aarectangle const& rhs) noexcept
+    {
+        add(rhs);
+        return *this;
+    }
+
+    constexpr damage_region& operator|=(damage_region const& rhs) noexcept
+    {
+        for (hilet& rectangle : rhs) {
+            add(rectangle);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] friend constexpr damage_region operator|(damage_region lhs, damage_region const& rhs) noexcept
+    {
+        return lhs |= rhs;
+    }
+
+    /** The rectangle that encloses all rectangles of the region.
+     */
+    [[nodiscard]] friend constexpr aarectangle bounding_rectangle(damage_region const& rhs) noexcept
+    {
+        auto r = aarectangle{};
+        for (hilet& rectangle : rhs) {
+            r = r | rectangle;
+        }
+        return r;
+    }
+
+    /** Check if a rectangle overlaps with any rectangle of the region.
+     */
+    [[nodiscard]] friend constexpr bool overlaps(damage_region const& lhs, aarectangle const& rhs) noexcept
+    {
+        for (hilet& rectangle : lhs) {
+            if (overlaps(rectangle, rhs)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Check if a rectangle is completely inside a single rectangle of the region.
+     */
+    [[nodiscard]] constexpr bool contains(aarectangle const& rhs) const noexcept
+    {
+        for (hilet& rectangle : *this) {
+            if (intersect(rectangle, rhs) == rhs) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Expand each rectangle of the region to a granularity.
+     */
+    [[nodiscard]] friend constexpr damage_region ceil(damage_region const& lhs, extent2 const& rhs) noexcept
+    {
+        auto r = damage_region{};
+        for (hilet& rectangle : lhs) {
+            r.add(ceil(rectangle, rhs));
+        }
+        return r;
+    }
+
+private:
+    std::array<aarectangle, capacity> _rectangles = {};
+    std::size_t _size = 0;
+
+    [[nodiscard]] constexpr static float area(aarectangle const& rectangle) noexcept
+    {
+        return rectangle.width() * rectangle.height();
+    }
+
+    /** Check if two rectangles share an area, not just an edge.
+     */
+    [[nodiscard]] constexpr static bool overlaps_area(aarectangle const& lhs, aarectangle const& rhs) noexcept
+    {
+        return lhs.left() < rhs.right() and rhs.left() < lhs.right() and lhs.bottom() < rhs.top() and rhs.bottom() < lhs.top();
+    }
+
+    [[nodiscard]] constexpr static float merge_cost(aarectangle const& lhs, aarectangle const& rhs) noexcept
+    {
+        return area(lhs | rhs) - area(lhs) - area(rhs);
+    }
+
+    constexpr void remove(std::size_t index) noexcept
+    {
+        hi_axiom(index < _size);
+        _rectangles[index] = _rectangles[--_size];
+    }
+};
+
+}} // namespace hi::v1
@@ -0,0 +1,82 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "damage_region.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+
+using namespace hi;
+
+TEST(damage_region, opposite_corners)
+{
+    auto region = damage_region{};
+    ASSERT_TRUE(region.empty());
+
+    region |= aarectangle{0.0f, 0.0f, 10.0f, 10.0f};
+    region |= aarectangle{990.0f, 790.0f, 10.0f, 10.0f};
+    ASSERT_EQ(region.size(), 2);
+
+    ASSERT_TRUE(overlaps(region, aarectangle{5.0f, 5.0f, 1.0f, 1.0f}));
+    ASSERT_FALSE(overlaps(region, aarectangle{500.0f, 400.0f, 10.0f, 10.0f}));
+    ASSERT_EQ(bounding_rectangle(region), (aarectangle{0.0f, 0.0f, 1000.0f, 800.0f}));
+}
+
+TEST(damage_region, merge)
+{
+    auto region = damage_region{};
+
+    // Contained rectangles are absorbed.
+    region |= aarectangle{0.0f, 0.0f, 100.0f, 100.0f};
+    region |= aarectangle{10.0f, 10.0f, 10.0f, 10.0f};
+    ASSERT_EQ(region.size(), 1);
+    ASSERT_EQ(region[0], (aarectangle{0.0f, 0.0f, 100.0f, 100.0f}));
+
+    // Adjacent rectangles become one.
+    region |= aarectangle{100.0f, 0.0f, 50.0f, 100.0f};
+    ASSERT_EQ(region.size(), 1);
+    ASSERT_EQ(region[0], (aarectangle{0.0f, 0.0f, 150.0f, 100.0f}));
+
+    ASSERT_TRUE(region.contains(aarectangle{50.0f, 10.0f, 100.0f, 10.0f}));
+    ASSERT_FALSE(region.contains(aarectangle{50.0f, 10.0f, 101.0f, 10.0f}));
+}
+
+TEST(damage_region, full)
+{
+    auto region = damage_region{};
+    for (auto i = 0; i != 20; ++i) {
+        region |= aarectangle{i * 100.0f, 0.0f, 10.0f, 10.0f};
+    }
+    ASSERT_EQ(region.size(), damage_region::capacity);
+
+    // All rectangles that were added are still covered.
+    for (auto i = 0; i != 20; ++i) {
+        ASSERT_TRUE(region.contains(aarectangle{i * 100.0f, 0.0f, 10.0f, 10.0f}));
+    }
+}
+
+TEST(damage_region, disjoint)
+{
+    auto region = damage_region{};
+
+    // Crossing bars would be cheaper to keep as two rectangles, but they overlap in the middle.
+    region |= aarectangle{0.0f, 45.0f, 100.0f, 10.0f};
+    region |= aarectangle{45.0f, 0.0f, 10.0f, 100.0f};
+    ASSERT_EQ(region.size(), 1);
+    ASSERT_EQ(region[0], (aarectangle{0.0f, 0.0f, 100.0f, 100.0f}));
+
+    // Many overlapping rectangles, the rectangles of the region never overlap.
+    region.clear();
+    for (auto i = 0; i != 40; ++i) {
+        hilet x = static_cast<float>((i * 37) % 500);
+        hilet y = static_cast<float>((i * 91) % 400);
+        region |= i % 2 == 0 ? aarectangle{x, y, 200.0f, 5.0f} : aarectangle{x, y, 5.0f, 200.0f};
+
+        for (auto j = 0_uz; j != region.size(); ++j) {
+            for (auto k = j + 1; k != region.size(); ++k) {
+                hilet overlap = intersect(region[j], region[k]);
+                ASSERT_TRUE(overlap.width() <= 0.0f or overlap.height() <= 0.0f) << "i=" << i << " j=" << j << " k=" << k;
+            }
+        }
+    }
+}
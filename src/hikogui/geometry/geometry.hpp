@@ -9,6 +9,7 @@
 #include "aarectangle.hpp" // export
 #include "circle.hpp" // export
 #include "corner_radii.hpp" // export
+#include "damage_region.hpp" // export
 #include "extent2.hpp" // export
 #include "extent3.hpp" // export
 #include "line_end_cap.hpp" // export
@@ -27,6 +28,7 @@
 #include "rotate3.hpp" // export
 #include "scale2.hpp" // export
 #include "scale3.hpp" // export
+#include "spatial_grid.hpp" // export
 #include "transform.hpp" // export
 #include "translate2.hpp" // export
 #include "translate3.hpp" // export
@@ -0,0 +1,173 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file geometry/spatial_grid.hpp Defines the spatial_grid type.
+ */
+
+#pragma once
+
+#include "aarectangle.hpp"
+#include "point2.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+hi_export_module(hikogui.geometry : spatial_grid);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** A spatial index of rectangles.
+ *
+ * The bounding rectangle of all the rectangles is divided into a uniform grid
+ * of buckets. Each bucket holds the index of each rectangle that overlaps it,
+ * which makes finding the rectangles that may contain a point a constant time
+ * operation when the rectangles are evenly distributed, like the cells of a
+ * grid or the rows of a list.
+ */
+class spatial_grid {
+public:
+    spatial_grid() noexcept = default;
+    spatial_grid(spatial_grid const&) = default;
+    spatial_grid(spatial_grid&&) noexcept = default;
+    spatial_grid& operator=(spatial_grid const&) = default;
+    spatial_grid& operator=(spatial_grid&&) noexcept = default;
+
+    /** Build the index.
+     *
+     * @param rectangles The rectangles to index; the index of a rectangle in this list is
+     *                   returned by `find()`. Empty rectangles are not indexed.
+     */
+    void build(std::span<aarectangle const> rectangles) noexcept
+    {
+        _buckets.clear();
+        _offsets.clear();
+        _bounds = {};
+
+        auto num_items = 0_uz;
+        auto total_width = 0.0f;
+        auto total_height = 0.0f;
+        for (hilet& rectangle : rectangles) {
+            if (rectangle) {
+                _bounds |= rectangle;
+                total_width += rectangle.width();
+                total_height += rectangle.height();
+                ++num_items;
+            }
+        }
+        if (num_items == 0) {
+            _num_columns = 0;
+            _num_rows = 0;
+            return;
+        }
+
+        // Make the buckets about the average size of the rectangles, but limit
+        // the number of buckets to a small multiple of the number of rectangles.
+        hilet num_items_ = static_cast<float>(num_items);
+        hilet bucket_width = std::max(total_width / num_items_, 1.0f);
+        hilet bucket_height = std::max(total_height / num_items_, 1.0f);
+        auto num_columns = std::max(std::ceil(_bounds.width() / bucket_width), 1.0f);
+        auto num_rows = std::max(std::ceil(_bounds.height() / bucket_height), 1.0f);
+        if (hilet num_buckets = num_columns * num_rows; num_buckets > num_items_ * 4.0f) {
+            hilet shrink = std::sqrt(num_items_ * 4.0f / num_buckets);
+            num_columns = std::max(std::floor(num_columns * shrink), 1.0f);
+            num_rows = std::max(std::floor(num_rows * shrink), 1.0f);
+        }
+        _num_columns = static_cast<size_t>(num_columns);
+        _num_rows = static_cast<size_t>(num_rows);
+        _column_scale = _bounds.width() > 0.0f ? static_cast<float>(_num_columns) / _bounds.width() : 0.0f;
+        _row_scale = _bounds.height() > 0.0f ? static_cast<float>(_num_rows) / _bounds.height() : 0.0f;
+
+        // Count the number of rectangles in each bucket, then place them, so that
+        // all buckets share a single allocation.
+        _offsets.resize(_num_columns * _num_rows + 1, 0);
+        for_each_bucket(rectangles, [&](size_t bucket_nr, size_t) {
+            ++_offsets[bucket_nr + 1];
+        });
+        for (auto i = 1_uz; i != _offsets.size(); ++i) {
+            _offsets[i] += _offsets[i - 1];
+        }
+
+        _buckets.resize(_offsets.back());
+        auto fill = std::vector<uint32_t>(_offsets.begin(), _offsets.end() - 1);
+        for_each_bucket(rectangles, [&](size_t bucket_nr, size_t index) {
+            _buckets[fill[bucket_nr]++] = narrow_cast<uint32_t>(index);
+        });
+    }
+
+    /** Find the rectangles that may contain a point.
+     *
+     * @param point The point to look up.
+     * @return The indices, in ascending order, of the rectangles that overlap the bucket
+     *         containing the point. The caller must check if the point is inside the rectangle.
+     */
+    [[nodiscard]] std::span<uint32_t const> find(point2 point) const noexcept
+    {
+        if (_offsets.empty() or not contains(point)) {
+            return {};
+        }
+
+        hilet bucket_nr = row(point.y()) * _num_columns + column(point.x());
+        return std::span{_buckets}.subspan(_offsets[bucket_nr], _offsets[bucket_nr + 1] - _offsets[bucket_nr]);
+    }
+
+private:
+    aarectangle _bounds = {};
+    size_t _num_columns = 0;
+    size_t _num_rows = 0;
+    float _column_scale = 0.0f;
+    float _row_scale = 0.0f;
+
+    /** For each bucket the offset into `_buckets`, with a sentinel at the end.
+     */
+    std::vector<uint32_t> _offsets;
+
+    /** The index of each rectangle in each bucket.
+     */
+    std::vector<uint32_t> _buckets;
+
+    [[nodiscard]] bool contains(point2 point) const noexcept
+    {
+        return point.x() >= _bounds.left() and point.x() <= _bounds.right() and point.y() >= _bounds.bottom() and
+            point.y() <= _bounds.top();
+    }
+
+    [[nodiscard]] size_t column(float x) const noexcept
+    {
+        hilet i = static_cast<size_t>(std::max(0.0f, (x - _bounds.left()) * _column_scale));
+        return std::min(i, _num_columns - 1);
+    }
+
+    [[nodiscard]] size_t row(float y) const noexcept
+    {
+        hilet i = static_cast<size_t>(std::max(0.0f, (y - _bounds.bottom()) * _row_scale));
+        return std::min(i, _num_rows - 1);
+    }
+
+    template<typename Func>
+    void for_each_bucket(std::span<aarectangle const> rectangles, Func const& func) const noexcept
+    {
+        for (auto index = 0_uz; index != rectangles.size(); ++index) {
+            hilet& rectangle = rectangles[index];
+            if (not rectangle) {
+                continue;
+            }
+
+            hilet first_column = column(rectangle.left());
+            hilet last_column = column(rectangle.right());
+            hilet first_row = row(rectangle.bottom());
+            hilet last_row = row(rectangle.top());
+            for (auto r = first_row; r <= last_row; ++r) {
+                for (auto c = first_column; c <= last_column; ++c) {
+                    func(r * _num_columns + c, index);
+                }
+            }
+        }
+    }
+};
+
+}} // namespace hi::v1
@@ -0,0 +1,68 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "spatial_grid.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace hi;
+
+TEST(spatial_grid, empty)
+{
+    auto grid = spatial_grid{};
+    ASSERT_TRUE(grid.find(point2{1.0f, 1.0f}).empty());
+
+    auto rectangles = std::vector<aarectangle>{aarectangle{}};
+    grid.build(rectangles);
+    ASSERT_TRUE(grid.find(point2{0.0f, 0.0f}).empty());
+}
+
+TEST(spatial_grid, list)
+{
+    // A list of 100 rows, each 10 high.
+    auto rectangles = std::vector<aarectangle>{};
+    for (auto i = 0; i != 100; ++i) {
+        rectangles.push_back(aarectangle{0.0f, i * 10.0f, 200.0f, 10.0f});
+    }
+
+    auto grid = spatial_grid{};
+    grid.build(rectangles);
+
+    for (auto i = 0; i != 100; ++i) {
+        hilet candidates = grid.find(point2{50.0f, i * 10.0f + 5.0f});
+        ASSERT_TRUE(std::ranges::find(candidates, i) != candidates.end());
+        ASSERT_LE(candidates.size(), 3);
+    }
+
+    ASSERT_TRUE(grid.find(point2{250.0f, 5.0f}).empty());
+    ASSERT_TRUE(grid.find(point2{50.0f, -5.0f}).empty());
+}
+
+TEST(spatial_grid, overlapping)
+{
+    // A small grid of cells, and a large overlay covering all cells.
+    auto rectangles = std::vector<aarectangle>{};
+    for (auto y = 0; y != 10; ++y) {
+        for (auto x = 0; x != 10; ++x) {
+            rectangles.push_back(aarectangle{x * 10.0f, y * 10.0f, 10.0f, 10.0f});
+        }
+    }
+    rectangles.push_back(aarectangle{}); // Not indexed.
+    rectangles.push_back(aarectangle{0.0f, 0.0f, 100.0f, 100.0f});
+
+    auto grid = spatial_grid{};
+    grid.build(rectangles);
+
+    for (auto y = 0; y != 10; ++y) {
+        for (auto x = 0; x != 10; ++x) {
+            hilet candidates = grid.find(point2{x * 10.0f + 5.0f, y * 10.0f + 5.0f});
+            ASSERT_TRUE(std::ranges::is_sorted(candidates));
+            ASSERT_TRUE(std::ranges::find(candidates, y * 10 + x) != candidates.end());
+            ASSERT_TRUE(std::ranges::find(candidates, 100) == candidates.end());
+            ASSERT_TRUE(std::ranges::find(candidates, 101) != candidates.end());
+        }
+    }
+}
@@ -11,6 +11,7 @@
 #include "../utility/utility.hpp"
 #include "bezier.hpp"
 #include "bezier_point.hpp"
+#include "coverage_rasterizer.hpp"
 #include "../macros.hpp"
 #include <tuple>
 #include <limits>
@@ -18,6 +19,7 @@
 #include <vector>
 #include <cmath>
 #include <span>
+#include <array>
 
 hi_export_module(hikogui.graphic_path.bezier_curve);
 
@@ -29,7 +31,13 @@ hi_export namespace hi { inline namespace v1 {
 hi_export struct bezier_curve {
     enum class Type : uint8_t { None, Linear, Quadratic, Cubic };
 
+    /** The color of an edge, for multi-channel signed distance fields.
+     * Each bit selects a channel: red, green and blue.
+     */
+    enum class Color : uint8_t { Black = 0, Red = 1, Green = 2, Yellow = 3, Blue = 4, Magenta = 5, Cyan = 6, White = 7 };
+
     Type type;
+    Color color = Color::White; //!< Channels of a multi-channel signed distance field this curve contributes to.
     point2 P1; //!< First point
     point2 C1; //!< Control point
     point2 C2; //!< Control point
@@ -180,6 +188,28 @@ hi_export struct bezier_curve {
             return orthogonality() < 0.0 ? d : -d;
         }
 
+        /** The signed pseudo-distance.
+         *
+         * When the nearest point is an end-point of the curve, and the point P lies
+         * beyond that end-point, the distance to the curve's tangent-line at that
+         * end-point is used instead. This keeps the corners of a multi-channel
+         * signed distance field sharp.
+         */
+        [[nodiscard]] hi_force_inline float signed_pseudo_distance() const noexcept
+        {
+            if (t == 0.0f or t == 1.0f) {
+                hilet tangent = normalize(curve->tangentAt(t));
+                hilet along = dot(tangent, PN);
+                if ((t == 0.0f and along < 0.0f) or (t == 1.0f and along > 0.0f)) {
+                    hilet pseudo_distance = -cross(tangent, PN);
+                    if (std::abs(pseudo_distance) <= distance()) {
+                        return pseudo_distance;
+                    }
+                }
+            }
+            return signed_distance();
+        }
+
         [[nodiscard]] hi_force_inline constexpr bool operator<(sdf_distance_result const& rhs) const noexcept
         {
             if (abs(sq_distance - rhs.sq_distance) < 0.01f) {
@@ -218,6 +248,63 @@ hi_export struct bezier_curve {
         return nearest;
     }
 
+    /** Return the bounding rectangle of the curve.
+     *
+     * The rectangle encloses all the control points, which means that the
+     * rectangle also encloses the curve itself.
+     */
+    [[nodiscard]] aarectangle bounding_rectangle() const noexcept
+    {
+        auto r = aarectangle{P1, P1} | P2;
+        if (type == Type::Quadratic or type == Type::Cubic) {
+            r = r | C1;
+        }
+        if (type == Type::Cubic) {
+            r = r | C2;
+        }
+        return r;
+    }
+
+    /** Approximate the curve with line segments.
+     *
+     * The number of segments is based on the maximum of the second derivative of the curve.
+     *
+     * @param tolerance The maximum distance between the curve and the line segments.
+     * @param func A function `void(point2, point2)` called with the end-points of each line segment.
+     */
+    template<typename Func>
+    void flatten(float tolerance, Func&& func) const noexcept
+    {
+        hi_axiom(tolerance > 0.0f);
+
+        // The deviation of a line segment spanning h of t is at most: max(|B''(t)|) * h^2 / 8.
+        auto max_second_derivative = 0.0f;
+        switch (type) {
+        case Type::Linear:
+            func(P1, P2);
+            return;
+        case Type::Quadratic:
+            max_second_derivative = 2.0f * hypot((P1 - C1) + (P2 - C1));
+            break;
+        case Type::Cubic:
+            max_second_derivative = 6.0f * std::max(hypot((P1 - C1) + (C2 - C1)), hypot((C1 - C2) + (P2 - C2)));
+            break;
+        default:
+            hi_no_default();
+        }
+
+        hilet num_segments = std::clamp(std::ceil(std::sqrt(max_second_derivative / (8.0f * tolerance))), 1.0f, 256.0f);
+        hilet n = static_cast<size_t>(num_segments);
+
+        auto p0 = P1;
+        for (auto i = 1_uz; i < n; ++i) {
+            hilet p1 = pointAt(static_cast<float>(i) / num_segments);
+            func(p0, p1);
+            p0 = p1;
+        }
+        func(p0, P2);
+    }
+
     /*! Split a cubic bezier-curve into two cubic bezier-curve.
      * \param t a relative distance between 0.0 (point P1) and 1.0 (point P2)
      *        where to split the curve.
@@ -368,155 +455,392 @@ hi_export struct bezier_curve {
 
 namespace detail {
 
-[[nodiscard]] constexpr std::vector<float> solveCurvesXByY(std::vector<bezier_curve> const& v, float y) noexcept
+[[nodiscard]] constexpr float generate_sdf_r8_pixel(point2 point, std::vector<bezier_curve> const& curves) noexcept
 {
-    std::vector<float> r;
-    r.reserve(v.size());
+    if (curves.empty()) {
+        return -std::numeric_limits<float>::max();
+    }
+
+    auto it = curves.cbegin();
+    auto nearest = (it++)->sdf_distance(point);
 
-    for (hilet& curve : v) {
-        hilet xValues = curve.solveXByY(y);
-        for (hilet x : xValues) {
-            r.push_back(x);
+    for (; it != curves.cend(); ++it) {
+        hilet distance = it->sdf_distance(point);
+
+        if (distance < nearest) {
+            nearest = distance;
         }
     }
-    return r;
+
+    return nearest.signed_distance();
 }
 
-[[nodiscard]] constexpr std::optional<std::vector<std::pair<float, float>>>
-getFillSpansAtY(std::vector<bezier_curve> const& v, float y) noexcept
-{
-    auto xValues = solveCurvesXByY(v, y);
+/** A grid of candidate curves to accelerate the generation of a signed-distance-field.
+ *
+ * The image is divided into square cells, for each cell a list is made of
+ * the curves that could be the nearest curve to any pixel inside that cell.
+ *
+ * The distance from a pixel to a curve is never larger than the distance
+ * to one of the end-points of the curve. Therefor the distance from a pixel
+ * in a cell to its nearest curve is at most the smallest distance between
+ * the farthest corner of the cell and any end-point. Curves whose bounding
+ * rectangle is further away from the cell than this are culled.
+ */
+class sdf_curve_grid {
+public:
+    /** The width and height of a cell in pixels.
+     */
+    constexpr static size_t cell_size = 8;
 
-    // Sort x values, each pair is a span.
-    std::sort(xValues.begin(), xValues.end());
+    /** The tolerance of the squared distance when two curves are equally near.
+     *
+     * @see bezier_curve::sdf_distance_result::operator<()
+     */
+    constexpr static float tie_margin = 0.01f;
 
-    // End-to-end connected curves will yield duplicate values.
-    hilet uniqueEnd = std::unique(xValues.begin(), xValues.end());
+    /** Create a grid of candidate curves.
+     *
+     * @param curves All curves of a path.
+     * @param width The width of the image in pixels.
+     * @param height The height of the image in pixels.
+     */
+    sdf_curve_grid(std::vector<bezier_curve> const& curves, size_t width, size_t height) noexcept :
+        _num_columns((width + cell_size - 1) / cell_size), _num_rows((height + cell_size - 1) / cell_size)
+    {
+        _bounds.reserve(curves.size());
+        for (hilet& curve : curves) {
+            _bounds.push_back(curve.bounding_rectangle());
+        }
 
-    // After removing duplicates, we should end up with pairs of x values.
-    std::size_t const uniqueValueCount = (uniqueEnd - xValues.begin());
+        _offsets.reserve(_num_columns * _num_rows + 1);
+        _offsets.push_back(0);
+
+        auto lower_bounds = std::vector<float>(curves.size());
+        for (auto row_nr = 0_uz; row_nr != _num_rows; ++row_nr) {
+            for (auto column_nr = 0_uz; column_nr != _num_columns; ++column_nr) {
+                hilet cell = aarectangle{
+                    point2{static_cast<float>(column_nr * cell_size), static_cast<float>(row_nr * cell_size)},
+                    point2{
+                        static_cast<float>(std::min((column_nr + 1) * cell_size, width) - 1),
+                        static_cast<float>(std::min((row_nr + 1) * cell_size, height) - 1)}};
+
+                auto upper_bound = std::numeric_limits<float>::max();
+                for (auto i = 0_uz; i != curves.size(); ++i) {
+                    hilet& curve = curves[i];
+
+                    lower_bounds[i] = squared_distance(cell, _bounds[i]);
+
+                    // A linear curve without length has no distance at all.
+                    if (curve.type != bezier_curve::Type::Linear or curve.P1 != curve.P2) {
+                        inplace_min(upper_bound, squared_farthest_distance(cell, curve.P1));
+                        inplace_min(upper_bound, squared_farthest_distance(cell, curve.P2));
+                    }
+                }
+
+                for (auto i = 0_uz; i != curves.size(); ++i) {
+                    if (lower_bounds[i] <= upper_bound + tie_margin) {
+                        _indices.push_back(narrow_cast<uint32_t>(i));
+                    }
+                }
+                _offsets.push_back(narrow_cast<uint32_t>(_indices.size()));
+            }
+        }
+    }
 
-    if (uniqueValueCount % 2 != 0) {
-        // Something is wrong in solving the curves. Probably numeric instability.
-        // In any case, just ignore this sample.
-        return {};
+    /** Get the indices of the curves that may be nearest to a pixel.
+     *
+     * @param x The column of the pixel.
+     * @param y The row of the pixel.
+     * @return The indices of the candidate curves, in the original order.
+     */
+    [[nodiscard]] std::span<uint32_t const> candidates(size_t x, size_t y) const noexcept
+    {
+        hilet cell_nr = (y / cell_size) * _num_columns + x / cell_size;
+        hi_axiom(cell_nr + 1 < _offsets.size());
+        return std::span{_indices}.subspan(_offsets[cell_nr], _offsets[cell_nr + 1] - _offsets[cell_nr]);
     }
 
-    // Create pairs of values.
-    auto r = std::vector<std::pair<float, float>>{};
-    r.reserve(uniqueValueCount / 2);
-    for (std::size_t i = 0; i < uniqueValueCount; i += 2) {
-        r.emplace_back(xValues[i], xValues[i + 1]);
+    /** Get the bounding rectangle of a curve.
+     */
+    [[nodiscard]] aarectangle const& bounds(size_t curve_nr) const noexcept
+    {
+        hi_axiom(curve_nr < _bounds.size());
+        return _bounds[curve_nr];
     }
-    return r;
-}
 
-constexpr void fillPartialPixels(std::span<uint8_t> row, ssize_t const i, float const startX, float const endX) noexcept
-{
-    hilet pixelCoverage = std::clamp(endX, i + 0.0f, i + 1.0f) - std::clamp(startX, i + 0.0f, i + 1.0f);
+private:
+    size_t _num_columns;
+    size_t _num_rows;
 
-    auto& pixel = row[i];
-    pixel = static_cast<uint8_t>(std::min(pixelCoverage * 51.0f + pixel, 255.0f));
-}
+    /** The bounding rectangle of each curve.
+     */
+    std::vector<aarectangle> _bounds;
+
+    /** The offset into `_indices` for each cell, with an extra offset past the last cell.
+     */
+    std::vector<uint32_t> _offsets;
+
+    /** The indices of candidate curves for all cells.
+     */
+    std::vector<uint32_t> _indices;
+
+    /** The squared distance between the nearest points of two rectangles.
+     */
+    [[nodiscard]] static float squared_distance(aarectangle const& lhs, aarectangle const& rhs) noexcept
+    {
+        hilet dx = std::max({rhs.left() - lhs.right(), lhs.left() - rhs.right(), 0.0f});
+        hilet dy = std::max({rhs.bottom() - lhs.top(), lhs.bottom() - rhs.top(), 0.0f});
+        return dx * dx + dy * dy;
+    }
+
+    /** The squared distance between a point and the farthest corner of a rectangle.
+     */
+    [[nodiscard]] static float squared_farthest_distance(aarectangle const& lhs, point2 rhs) noexcept
+    {
+        hilet dx = std::max(rhs.x() - lhs.left(), lhs.right() - rhs.x());
+        hilet dy = std::max(rhs.y() - lhs.bottom(), lhs.top() - rhs.y());
+        return dx * dx + dy * dy;
+    }
+};
 
-constexpr void fillFullPixels(std::span<uint8_t> row, ssize_t const start, ssize_t const size) noexcept
+/** Calculate the signed distance of four horizontally adjacent pixels.
+ *
+ * The distance to the bounding rectangle of a curve is calculated for the
+ * four pixels at once; the curve is skipped when it can not be nearer than
+ * the nearest curve found so far for any of the pixels. The distance to a
+ * linear curve is calculated for the four pixels at once as well.
+ *
+ * @param point The left-most pixel.
+ * @param candidates The indices of the curves that may be nearest to the pixels.
+ * @param curves All curves of the path.
+ * @param grid The grid with the bounding rectangles of the curves.
+ * @return The signed distance of each of the four pixels.
+ */
+[[nodiscard]] hi_inline std::array<float, 4> generate_sdf_r8_pixels(
+    point2 point,
+    std::span<uint32_t const> candidates,
+    std::vector<bezier_curve> const& curves,
+    sdf_curve_grid const& grid) noexcept
 {
-    if (size < 16) {
-        hilet end = start + size;
-        for (ssize_t i = start; i < end; i++) {
-            row[i] += 0x33;
+    hilet px = f32x4{point.x(), point.x() + 1.0f, point.x() + 2.0f, point.x() + 3.0f};
+    hilet py = f32x4::broadcast(point.y());
+    hilet zero = f32x4{};
+    hilet one = f32x4::broadcast(1.0f);
+
+    auto nearest = std::array<bezier_curve::sdf_distance_result, 4>{};
+    auto nearest_sq_distance = f32x4::broadcast(std::numeric_limits<float>::max());
+
+    hilet update = [&](size_t i, bezier_curve::sdf_distance_result const& distance) {
+        if (nearest[i].curve == nullptr or distance < nearest[i]) {
+            nearest[i] = distance;
+            nearest_sq_distance[i] = distance.sq_distance;
         }
-    } else {
-        auto u8p = &row[start];
-        hilet u8end = u8p + size;
+    };
 
-        // First add 51 to all pixels up to the alignment.
-        hilet alignedStart = hi::ceil(u8p, sizeof(uint64_t));
-        while (u8p < alignedStart) {
-            *(u8p++) += 0x33;
-        }
+    for (hilet curve_nr : candidates) {
+        hilet& curve = curves[curve_nr];
+        hilet& bounds = grid.bounds(curve_nr);
 
-        // add 51 for each pixel, 8 pixels at a time.
-        auto u64p = reinterpret_cast<uint64_t *>(u8p);
-        auto const *const u64end = reinterpret_cast<uint64_t const *>(hi::floor(u8end, sizeof(uint64_t)));
-        while (u64p < u64end) {
-            *(u64p++) += 0x3333333333333333ULL;
+        // The distance to the bounding rectangle is the lower bound of the distance to the curve.
+        hilet bx = max(max(f32x4::broadcast(bounds.left()) - px, px - f32x4::broadcast(bounds.right())), zero);
+        hilet by = max(max(f32x4::broadcast(bounds.bottom()) - py, py - f32x4::broadcast(bounds.top())), zero);
+        hilet mask = (bx * bx + by * by <= nearest_sq_distance + sdf_curve_grid::tie_margin).mask();
+        if (mask == 0) {
+            continue;
         }
 
-        // Add 51 to the last pixels.
-        u8p = reinterpret_cast<uint8_t *>(u64p);
-        while (u8p < u8end) {
-            *(u8p++) += 0x33;
+        hilet P1P2 = curve.P2 - curve.P1;
+        hilet length_sq = dot(P1P2, P1P2);
+        if (curve.type == bezier_curve::Type::Linear and length_sq != 0.0f) {
+            hilet p1x = f32x4::broadcast(curve.P1.x());
+            hilet p1y = f32x4::broadcast(curve.P1.y());
+            hilet vx = f32x4::broadcast(P1P2.x());
+            hilet vy = f32x4::broadcast(P1P2.y());
+
+            hilet t = clamp(((px - p1x) * vx + (py - p1y) * vy) / f32x4::broadcast(length_sq), zero, one);
+            hilet pnx = px - (vx * t + p1x);
+            hilet pny = py - (vy * t + p1y);
+            hilet sq_distance = pnx * pnx + pny * pny;
+
+            for (auto i = 0_uz; i != 4; ++i) {
+                if (to_bool(mask & (1_uz << i))) {
+                    auto distance = bezier_curve::sdf_distance_result{&curve};
+                    distance.PN = vector2{pnx[i], pny[i]};
+                    distance.t = t[i];
+                    distance.sq_distance = sq_distance[i];
+                    update(i, distance);
+                }
+            }
+
+        } else {
+            for (auto i = 0_uz; i != 4; ++i) {
+                if (to_bool(mask & (1_uz << i))) {
+                    update(i, curve.sdf_distance(point2{px[i], py[i]}));
+                }
+            }
         }
     }
+
+    auto r = std::array<float, 4>{};
+    for (auto i = 0_uz; i != 4; ++i) {
+        r[i] = nearest[i].curve == nullptr ? -std::numeric_limits<float>::max() : nearest[i].signed_distance();
+    }
+    return r;
 }
 
-/*! Render pixels in a row between two x values.
- * Fully covered sub-pixel will have the value 51.
+/** Check if two sets of multi-channel distances of neighboring pixels clash.
+ *
+ * A clash happens when two of the channels change by a large amount between
+ * neighboring pixels, so that bi-linear interpolation of the median creates
+ * artifacts. Only the pixel which is furthest from the edge is flagged.
+ *
+ * @param a The red, green and blue distances of the pixel to check.
+ * @param b The red, green and blue distances of a neighboring pixel.
+ * @param threshold The minimum change in distance between the pixels to cause a clash.
+ * @return True if pixel @a a clashes with pixel @a b.
  */
-constexpr void fillRowSpan(std::span<uint8_t> row, float const startX, float const endX) noexcept
+[[nodiscard]] hi_inline bool msdf_clash(f32x4 a, f32x4 b, float threshold) noexcept
 {
-    if (startX >= row.size() || endX < 0.0f) {
-        return;
+    // Sort the channels from the largest to smallest difference between the pixels.
+    auto a0 = a.x(), a1 = a.y(), a2 = a.z();
+    auto b0 = b.x(), b1 = b.y(), b2 = b.z();
+    if (std::abs(b0 - a0) < std::abs(b1 - a1)) {
+        std::swap(a0, a1);
+        std::swap(b0, b1);
     }
-
-    hilet startX_int = floor_cast<std::size_t>(startX);
-    hilet endXplusOne = endX + 1.0f;
-    hilet endX_int = floor_cast<std::size_t>(endXplusOne);
-    hilet startColumn = std::max(startX_int, std::size_t{0});
-    hilet endColumn = std::min(endX_int, row.size());
-    hilet nrColumns = endColumn - startColumn;
-
-    if (nrColumns == 1) {
-        fillPartialPixels(row, startColumn, startX, endX);
-    } else {
-        fillPartialPixels(row, startColumn, startX, endX);
-        fillFullPixels(row, startColumn + 1, nrColumns - 2);
-        fillPartialPixels(row, endColumn - 1, startX, endX);
+    if (std::abs(b1 - a1) < std::abs(b2 - a2)) {
+        std::swap(a1, a2);
+        std::swap(b1, b2);
+        if (std::abs(b0 - a0) < std::abs(b1 - a1)) {
+            std::swap(a0, a1);
+            std::swap(b0, b1);
+        }
     }
+
+    return std::abs(b1 - a1) >= threshold and not(b0 == b1 and b0 == b2) and std::abs(a2) >= std::abs(b2);
 }
 
-constexpr void fillRow(std::span<uint8_t> row, std::size_t rowY, std::vector<bezier_curve> const& curves) noexcept
+/** Remove artifacts from a multi-channel signed distance field.
+ *
+ * Pixels that clash with a neighbor are replaced with the median of
+ * their channels, which turns them into a single-channel distance.
+ *
+ * @param image The red, green, blue and alpha distances of each pixel.
+ * @param threshold The minimum change in distance between neighboring pixels to cause a clash.
+ */
+hi_inline void correct_msdf_errors(pixmap_span<f32x4> image, float threshold) noexcept
 {
-    // 5 times super sampling.
-    for (float y = rowY + 0.1f; y < (rowY + 1); y += 0.2f) {
-        auto optionalSpans = getFillSpansAtY(curves, y);
-        if (!optionalSpans) {
-            // try again, with a slight offset.
-            optionalSpans = getFillSpansAtY(curves, y + 0.01f);
-        }
-
-        if (optionalSpans) {
-            hilet& spans = optionalSpans.value();
-
-            for (hilet& span : spans) {
-                fillRowSpan(row, span.first, span.second);
+    auto clashes = std::vector<std::pair<size_t, size_t>>{};
+
+    for (auto y = 0_uz; y != image.height(); ++y) {
+        for (auto x = 0_uz; x != image.width(); ++x) {
+            hilet p = image[y][x];
+            if ((x > 0 and msdf_clash(p, image[y][x - 1], threshold)) or
+                (x + 1 < image.width() and msdf_clash(p, image[y][x + 1], threshold)) or
+                (y > 0 and msdf_clash(p, image[y - 1][x], threshold)) or
+                (y + 1 < image.height() and msdf_clash(p, image[y + 1][x], threshold))) {
+                clashes.emplace_back(x, y);
             }
         }
     }
+
+    for (hilet[x, y] : clashes) {
+        auto& p = image[y][x];
+        hilet median = std::max(std::min(p.x(), p.y()), std::min(std::max(p.x(), p.y()), p.z()));
+        p = f32x4{median, median, median, p.w()};
+    }
 }
 
-[[nodiscard]] constexpr float generate_sdf_r8_pixel(point2 point, std::vector<bezier_curve> const& curves) noexcept
+} // namespace detail
+
+/** Assign colors to the edges of a contour, for multi-channel signed distance fields.
+ *
+ * The contour is divided at its corners, the edges between two corners
+ * get the same color. The colors are chosen so that at each corner two
+ * channels change, which means that the median of the channels will
+ * preserve the corner. Edges of smooth contours are colored white.
+ *
+ * @param contour The curves of a single closed contour, in order.
+ * @param corner_angle The minimum angle in radians between the tangents of two curves to form a corner.
+ */
+hi_inline void color_contour_edges(std::vector<bezier_curve>& contour, float corner_angle = 3.0f) noexcept
 {
-    if (curves.empty()) {
-        return -std::numeric_limits<float>::max();
-    }
+    using enum bezier_curve::Color;
 
-    auto it = curves.cbegin();
-    auto nearest = (it++)->sdf_distance(point);
+    if (contour.empty()) {
+        return;
+    }
 
-    for (; it != curves.cend(); ++it) {
-        hilet distance = it->sdf_distance(point);
+    hilet cross_threshold = std::sin(corner_angle);
 
-        if (distance < nearest) {
-            nearest = distance;
+    auto corners = std::vector<size_t>{};
+    for (auto i = 0_uz; i != contour.size(); ++i) {
+        hilet& prev = contour[i == 0 ? contour.size() - 1 : i - 1];
+        hilet a = normalize(prev.tangentAt(1.0f));
+        hilet b = normalize(contour[i].tangentAt(0.0f));
+        if (dot(a, b) <= 0.0f or std::abs(cross(a, b)) > cross_threshold) {
+            corners.push_back(i);
         }
     }
 
-    return nearest.signed_distance();
-}
+    if (corners.empty()) {
+        for (auto& curve : contour) {
+            curve.color = White;
+        }
 
-} // namespace detail
+    } else if (corners.size() == 1) {
+        // A tear-drop shape; split the contour into three parts, so that the corner is preserved.
+        if (contour.size() < 3) {
+            auto split_contour = std::vector<bezier_curve>{};
+            for (hilet& curve : contour) {
+                hilet[a, bc] = curve.split(1.0f / 3.0f);
+                hilet[b, c] = bc.split(0.5f);
+                split_contour.push_back(a);
+                split_contour.push_back(b);
+                split_contour.push_back(c);
+            }
+            hilet corner = corners.front() * 3;
+            std::rotate(split_contour.begin(), split_contour.begin() + corner, split_contour.end());
+            contour = std::move(split_contour);
+            corners.front() = 0;
+        }
+
+        constexpr auto colors = std::array{Magenta, White, Yellow};
+        hilet n = contour.size();
+        for (auto i = 0_uz; i != n; ++i) {
+            // Divide the edges in three parts that are symmetrical around the corner.
+            hilet part = static_cast<int>(3.0f + 2.875f * static_cast<float>(i) / static_cast<float>(n - 1) - 1.4375f + 0.5f) - 3;
+            contour[(corners.front() + i) % n].color = colors[part + 1];
+        }
+
+    } else {
+        // Switch color at each corner, two channels change at every switch.
+        // The color of the last part must also differ from the color of the first part.
+        hilet switch_color = [](bezier_curve::Color color, bezier_curve::Color banned) {
+            hilet combined = std::to_underlying(color) & std::to_underlying(banned);
+            if (combined == std::to_underlying(Red) or combined == std::to_underlying(Green) or
+                combined == std::to_underlying(Blue)) {
+                return static_cast<bezier_curve::Color>(combined ^ std::to_underlying(White));
+            }
+            hilet shifted = std::to_underlying(color) << 1;
+            return static_cast<bezier_curve::Color>((shifted | (shifted >> 3)) & std::to_underlying(White));
+        };
+
+        hilet n = contour.size();
+        hilet start = corners.front();
+        hilet initial_color = Cyan;
+        auto color = initial_color;
+        auto part = 0_uz;
+        for (auto i = 0_uz; i != n; ++i) {
+            hilet index = (start + i) % n;
+            if (part + 1 < corners.size() and corners[part + 1] == index) {
+                ++part;
+                color = switch_color(color, part == corners.size() - 1 ? initial_color : Black);
+            }
+            contour[index].color = color;
+        }
+    }
+}
 
 /** Make a contour of Bezier curves from a list of points.
  * The contour is also colorized to be used for creating multichannel-signed-distance-fields.
@@ -666,28 +990,109 @@ makeContourFromPoints(std::vector<bezier_point>::const_iterator begin, std::vect
 }
 
 /** Fill a linear gray scale image by filling a curve with anti-aliasing.
+ *
+ * The curves are flattened into lines, after which the exact area covered
+ * for each pixel is calculated by the coverage_rasterizer.
+ *
  * @param image An alpha-channel image to make opaque where pixel is inside the contours
  * @param curves All curves of path, in no particular order.
+ * @param rule The rule to determine which parts of the path are filled.
  */
-constexpr void fill(pixmap_span<uint8_t> image, std::vector<bezier_curve> const& curves) noexcept
+hi_inline void fill(pixmap_span<uint8_t> image, std::vector<bezier_curve> const& curves, fill_rule rule = fill_rule::even_odd) noexcept
 {
-    for (auto y = 0_uz; y < image.height(); y++) {
-        detail::fillRow(image[y], y, curves);
+    // The maximum distance in pixels between a curve and its line segments.
+    constexpr auto tolerance = 0.1f;
+
+    auto rasterizer = coverage_rasterizer{image.width(), image.height()};
+    for (hilet& curve : curves) {
+        curve.flatten(tolerance, [&](point2 p0, point2 p1) {
+            rasterizer.add_line(p0, p1);
+        });
     }
+    rasterizer.fill(image, rule);
 }
 
 /** Fill a signed distance field image from the given contour.
+ *
+ * The curves are first culled using a grid, then the pixels are
+ * calculated four at a time.
+ *
  * @param image An signed-distance-field which show distance toward the closest curve
  * @param curves All curves of path, in no particular order.
  */
-constexpr void fill(pixmap_span<sdf_r8> image, std::vector<bezier_curve> const& curves) noexcept
+hi_inline void fill(pixmap_span<sdf_r8> image, std::vector<bezier_curve> const& curves) noexcept
 {
+    // Four adjacent pixels must share the same cell of the grid.
+    static_assert(detail::sdf_curve_grid::cell_size % 4 == 0);
+
+    hilet grid = detail::sdf_curve_grid{curves, image.width(), image.height()};
+
     for (auto row_nr = 0_uz; row_nr != image.height(); ++row_nr) {
         hilet row = image[row_nr];
         hilet y = static_cast<float>(row_nr);
-        for (auto column_nr = 0_uz; column_nr != image.width(); ++column_nr) {
+        for (auto column_nr = 0_uz; column_nr < image.width(); column_nr += 4) {
             hilet x = static_cast<float>(column_nr);
-            row[column_nr] = detail::generate_sdf_r8_pixel(point2(x, y), curves);
+            hilet distances = detail::generate_sdf_r8_pixels(point2(x, y), grid.candidates(column_nr, row_nr), curves, grid);
+
+            hilet num_pixels = std::min(image.width() - column_nr, 4_uz);
+            for (auto i = 0_uz; i != num_pixels; ++i) {
+                row[column_nr + i] = distances[i];
+            }
+        }
+    }
+}
+
+/** Fill a multi-channel signed distance field image from the given curves.
+ *
+ * The colors of the curves should have been assigned with `color_contour_edges()`.
+ * The red, green and blue channels contain the pseudo-distance to the nearest
+ * curve of that color; the alpha channel contains the true signed distance.
+ *
+ * @param image A multi-channel signed-distance-field which shows the distance toward the closest curves.
+ * @param curves All curves of path, in no particular order.
+ */
+hi_inline void fill(pixmap_span<sdf_rgba8> image, std::vector<bezier_curve> const& curves) noexcept
+{
+    // A clash is a change in distance of more than about a pixel between neighbors.
+    constexpr auto clash_threshold = 1.001f;
+
+    auto distances = pixmap<f32x4>{image.width(), image.height()};
+    for (auto row_nr = 0_uz; row_nr != image.height(); ++row_nr) {
+        hilet y = static_cast<float>(row_nr);
+        for (auto column_nr = 0_uz; column_nr != image.width(); ++column_nr) {
+            hilet point = point2{static_cast<float>(column_nr), y};
+
+            auto nearest = std::array<bezier_curve::sdf_distance_result, 4>{};
+            for (hilet& curve : curves) {
+                hilet distance = curve.sdf_distance(point);
+                for (auto i = 0_uz; i != 3; ++i) {
+                    if (to_bool(std::to_underlying(curve.color) & (1 << i)) and distance < nearest[i]) {
+                        nearest[i] = distance;
+                    }
+                }
+                if (distance < nearest[3]) {
+                    nearest[3] = distance;
+                }
+            }
+
+            auto pixel = f32x4::broadcast(-std::numeric_limits<float>::max());
+            for (auto i = 0_uz; i != 3; ++i) {
+                if (nearest[i].curve != nullptr) {
+                    pixel[i] = nearest[i].signed_pseudo_distance();
+                }
+            }
+            if (nearest[3].curve != nullptr) {
+                pixel[3] = nearest[3].signed_distance();
+            }
+            distances[row_nr][column_nr] = pixel;
+        }
+    }
+
+    detail::correct_msdf_errors(pixmap_span<f32x4>{distances}, clash_threshold);
+
+    for (auto row_nr = 0_uz; row_nr != image.height(); ++row_nr) {
+        for (auto column_nr = 0_uz; column_nr != image.width(); ++column_nr) {
+            image[row_nr][column_nr] = distances[row_nr][column_nr];
         }
     }
 }
@@ -7,6 +7,9 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <utility>
+#include <bit>
 
 using namespace std;
 using namespace hi;
@@ -80,3 +83,87 @@ TEST(bezier_cruve, solve_x_by_y)
     ASSERT_RESULTS(bezier_curve(point2(2.0f, 2.0f), point2(1.5f, 2.0f), point2(1.0f, 2.0f)).solveXByY(1.5f), make_lean_vector<double>());
     ASSERT_RESULTS(bezier_curve(point2(1.0f, 2.0f), point2(1.0f, 1.5f), point2(1.0f, 1.0f)).solveXByY(1.5f), make_lean_vector<double>(1.0f));
 }
+
+TEST(bezier_curve, fill_sdf)
+{
+    // An outer contour with a curved top and a square hole.
+    auto curves = std::vector<bezier_curve>{};
+    curves.emplace_back(point2(3.0f, 3.0f), point2(33.0f, 3.0f));
+    curves.emplace_back(point2(33.0f, 3.0f), point2(33.0f, 18.0f));
+    curves.emplace_back(point2(33.0f, 18.0f), point2(18.0f, 30.0f), point2(3.0f, 18.0f));
+    curves.emplace_back(point2(3.0f, 18.0f), point2(3.0f, 3.0f));
+    curves.emplace_back(point2(12.0f, 8.0f), point2(12.0f, 14.0f));
+    curves.emplace_back(point2(12.0f, 14.0f), point2(24.0f, 14.0f));
+    curves.emplace_back(point2(24.0f, 14.0f), point2(24.0f, 8.0f));
+    curves.emplace_back(point2(24.0f, 8.0f), point2(12.0f, 8.0f));
+
+    // A size that is not a multiple of the grid cells or of the SIMD width.
+    auto image = pixmap<sdf_r8>{37, 29};
+    fill(pixmap_span<sdf_r8>{image}, curves);
+
+    for (auto y = 0_uz; y != image.height(); ++y) {
+        for (auto x = 0_uz; x != image.width(); ++x) {
+            hilet expected = sdf_r8{detail::generate_sdf_r8_pixel(point2(static_cast<float>(x), static_cast<float>(y)), curves)};
+            ASSERT_NEAR(static_cast<float>(image[y][x]), static_cast<float>(expected), 0.05f);
+        }
+    }
+}
+
+TEST(bezier_curve, color_contour_edges)
+{
+    // A square has four corners, at each corner the color must change.
+    auto square = std::vector<bezier_curve>{};
+    square.emplace_back(point2(0.0f, 0.0f), point2(10.0f, 0.0f));
+    square.emplace_back(point2(10.0f, 0.0f), point2(10.0f, 10.0f));
+    square.emplace_back(point2(10.0f, 10.0f), point2(0.0f, 10.0f));
+    square.emplace_back(point2(0.0f, 10.0f), point2(0.0f, 0.0f));
+    color_contour_edges(square);
+
+    for (auto i = 0_uz; i != square.size(); ++i) {
+        hilet color = std::to_underlying(square[i].color);
+        hilet next_color = std::to_underlying(square[(i + 1) % square.size()].color);
+        ASSERT_NE(color, next_color);
+        // Two channels must be set, so that the median follows both edges at a corner.
+        ASSERT_EQ(std::popcount(color), 2);
+    }
+
+    // A circle has no corners.
+    auto circle = std::vector<bezier_curve>{};
+    circle.emplace_back(point2(1.0f, 0.0f), point2(1.0f, 1.0f), point2(0.0f, 1.0f));
+    circle.emplace_back(point2(0.0f, 1.0f), point2(-1.0f, 1.0f), point2(-1.0f, 0.0f));
+    circle.emplace_back(point2(-1.0f, 0.0f), point2(-1.0f, -1.0f), point2(0.0f, -1.0f));
+    circle.emplace_back(point2(0.0f, -1.0f), point2(1.0f, -1.0f), point2(1.0f, 0.0f));
+    color_contour_edges(circle);
+
+    for (hilet& curve : circle) {
+        ASSERT_EQ(curve.color, bezier_curve::Color::White);
+    }
+}
+
+TEST(bezier_curve, fill_msdf)
+{
+    auto curves = std::vector<bezier_curve>{};
+    curves.emplace_back(point2(4.0f, 4.0f), point2(16.0f, 4.0f));
+    curves.emplace_back(point2(16.0f, 4.0f), point2(16.0f, 16.0f));
+    curves.emplace_back(point2(16.0f, 16.0f), point2(4.0f, 16.0f));
+    curves.emplace_back(point2(4.0f, 16.0f), point2(4.0f, 4.0f));
+    color_contour_edges(curves);
+
+    auto image = pixmap<sdf_rgba8>{21, 19};
+    fill(pixmap_span<sdf_rgba8>{image}, curves);
+
+    for (auto y = 0_uz; y != image.height(); ++y) {
+        for (auto x = 0_uz; x != image.width(); ++x) {
+            hilet expected = detail::generate_sdf_r8_pixel(point2(static_cast<float>(x), static_cast<float>(y)), curves);
+            hilet expected_clamped = std::clamp(expected, -sdf_rgba8::max_distance, sdf_rgba8::max_distance);
+
+            // The alpha channel holds the true distance.
+            ASSERT_NEAR(static_cast<f32x4>(image[y][x]).w(), expected_clamped, 0.05f);
+
+            // The median of the color channels must be on the same side of the edge.
+            if (std::abs(expected) > 0.5f) {
+                ASSERT_EQ(image[y][x].median() > 0.0f, expected > 0.0f);
+            }
+        }
+    }
+}
@@ -0,0 +1,288 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file graphic_path/coverage_rasterizer.hpp Defines the coverage_rasterizer type.
+ */
+
+#pragma once
+
+#include "../image/image.hpp"
+#include "../geometry/geometry.hpp"
+#include "../SIMD/SIMD.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+hi_export_module(hikogui.graphic_path.coverage_rasterizer);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** The rule to determine if a point is inside a path.
+ */
+hi_export enum class fill_rule : uint8_t {
+    /** A point is inside when the winding number is not zero.
+     */
+    non_zero,
+
+    /** A point is inside when the winding number is odd.
+     */
+    even_odd
+};
+
+/** Rasterizer of the anti-aliased coverage of polygons.
+ *
+ * Lines are added as edges in an edge table. During rasterization the
+ * edges that cross a row of pixels are kept in an active edge list. Each
+ * active edge adds the exact area it covers to a row accumulator, after
+ * which a prefix sum of the accumulator yields the signed coverage of each
+ * pixel. Only the part of a row between the left-most and right-most
+ * edge is resolved.
+ *
+ * Lines are clipped against the left and right side of the image; the
+ * parts outside of the image are moved onto the side which does not change
+ * the coverage of the pixels inside the image.
+ */
+hi_export class coverage_rasterizer {
+public:
+    coverage_rasterizer(coverage_rasterizer const&) = default;
+    coverage_rasterizer(coverage_rasterizer&&) noexcept = default;
+    coverage_rasterizer& operator=(coverage_rasterizer const&) = default;
+    coverage_rasterizer& operator=(coverage_rasterizer&&) noexcept = default;
+
+    /** Create a rasterizer for an image.
+     *
+     * @param width The width of the image in pixels.
+     * @param height The height of the image in pixels.
+     */
+    coverage_rasterizer(size_t width, size_t height) noexcept : _width(width), _height(height) {}
+
+    /** Remove all edges.
+     */
+    void clear() noexcept
+    {
+        _edges.clear();
+    }
+
+    /** Add a line of a closed polygon.
+     *
+     * @param p0 The start of the line.
+     * @param p1 The end of the line.
+     */
+    void add_line(point2 p0, point2 p1) noexcept
+    {
+        hilet width = static_cast<float>(_width);
+
+        // Split the line where it crosses the left or right side of the image.
+        for (hilet side : {0.0f, width}) {
+            if ((p0.x() < side and p1.x() > side) or (p0.x() > side and p1.x() < side)) {
+                hilet y = p0.y() + (side - p0.x()) * (p1.y() - p0.y()) / (p1.x() - p0.x());
+                hilet mid = point2{side, y};
+                add_line(p0, mid);
+                add_line(mid, p1);
+                return;
+            }
+        }
+
+        add_edge(std::clamp(p0.x(), 0.0f, width), p0.y(), std::clamp(p1.x(), 0.0f, width), p1.y());
+    }
+
+    /** Rasterize the coverage of the polygons into an image.
+     *
+     * The coverage is added to the pixels of the image; saturating at 255.
+     *
+     * @param image The image to draw into, the size must match the rasterizer.
+     * @param rule The rule to determine which parts of the polygons are filled.
+     */
+    void fill(pixmap_span<uint8_t> image, fill_rule rule) const noexcept
+    {
+        hi_assert(image.width() == _width);
+        hi_assert(image.height() == _height);
+
+        auto edges = _edges;
+        std::sort(edges.begin(), edges.end(), [](hilet& lhs, hilet& rhs) {
+            return lhs.y0 < rhs.y0;
+        });
+
+        // The accumulator has room for edges on the right side of the image, and is padded for SIMD.
+        auto accumulator = std::vector<float>(ceil(_width + 2, 4_uz), 0.0f);
+        auto active = std::vector<edge_type const *>{};
+
+        auto next_edge = edges.cbegin();
+        for (auto row_nr = 0_uz; row_nr != _height; ++row_nr) {
+            hilet top = static_cast<float>(row_nr);
+            hilet bottom = top + 1.0f;
+
+            std::erase_if(active, [top](edge_type const *edge) {
+                return edge->y1 <= top;
+            });
+            for (; next_edge != edges.cend() and next_edge->y0 < bottom; ++next_edge) {
+                if (next_edge->y1 > top) {
+                    active.push_back(std::addressof(*next_edge));
+                }
+            }
+
+            if (active.empty()) {
+                continue;
+            }
+
+            auto first = std::numeric_limits<size_t>::max();
+            auto last = 0_uz;
+            for (hilet edge : active) {
+                accumulate(accumulator, *edge, top, first, last);
+            }
+
+            if (first <= last) {
+                resolve(image[row_nr], accumulator, first, last, rule);
+            }
+        }
+    }
+
+private:
+    /** An edge, directed from top to bottom.
+     */
+    struct edge_type {
+        float x0;
+        float y0;
+        float x1;
+        float y1;
+
+        /** 1.0 if the original line went downward, -1.0 if upward.
+         */
+        float direction;
+    };
+
+    size_t _width;
+    size_t _height;
+    std::vector<edge_type> _edges;
+
+    void add_edge(float x0, float y0, float x1, float y1) noexcept
+    {
+        if (y0 == y1) {
+            // Horizontal lines do not contribute to the coverage.
+            return;
+        }
+
+        auto edge = y0 < y1 ? edge_type{x0, y0, x1, y1, 1.0f} : edge_type{x1, y1, x0, y0, -1.0f};
+        if (edge.y1 <= 0.0f or edge.y0 >= static_cast<float>(_height)) {
+            return;
+        }
+        _edges.push_back(edge);
+    }
+
+    /** Add the area covered by an edge in a row of pixels to the accumulator.
+     *
+     * The accumulator holds the change in coverage from one pixel to the
+     * next, so that the prefix sum is the coverage of each pixel.
+     *
+     * @param accumulator The accumulator of the current row.
+     * @param edge The edge crossing the row.
+     * @param top The y-coordinate of the top of the row.
+     * @param[in,out] first The first index in the accumulator that was modified.
+     * @param[in,out] last The last index in the accumulator that was modified.
+     */
+    static void accumulate(std::vector<float>& accumulator, edge_type const& edge, float top, size_t& first, size_t& last) noexcept
+    {
+        hilet y0 = std::max(edge.y0, top);
+        hilet y1 = std::min(edge.y1, top + 1.0f);
+        hilet dy = y1 - y0;
+        if (dy <= 0.0f) {
+            return;
+        }
+
+        hilet dxdy = (edge.x1 - edge.x0) / (edge.y1 - edge.y0);
+        hilet xa = edge.x0 + (y0 - edge.y0) * dxdy;
+        hilet xb = edge.x0 + (y1 - edge.y0) * dxdy;
+        hilet d = dy * edge.direction;
+
+        hilet x0 = std::min(xa, xb);
+        hilet x1 = std::max(xa, xb);
+        hilet x0_floor = std::floor(x0);
+        hilet x1_ceil = std::ceil(x1);
+        hilet x0i = static_cast<size_t>(x0_floor);
+        hilet x1i = static_cast<size_t>(x1_ceil);
+
+        if (x1i <= x0i + 1) {
+            // The edge is within a single column; split the coverage by the mid-point.
+            hilet xm = 0.5f * (xa + xb) - x0_floor;
+            accumulator[x0i] += d - d * xm;
+            accumulator[x0i + 1] += d * xm;
+            inplace_min(first, x0i);
+            inplace_max(last, x0i + 1);
+
+        } else {
+            // The edge spans multiple columns; the coverage changes linearly between the end-points.
+            hilet s = 1.0f / (x1 - x0);
+            hilet x0f = x0 - x0_floor;
+            hilet a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+            hilet x1f = x1 - x1_ceil + 1.0f;
+            hilet am = 0.5f * s * x1f * x1f;
+
+            accumulator[x0i] += d * a0;
+            if (x1i == x0i + 2) {
+                accumulator[x0i + 1] += d * (1.0f - a0 - am);
+            } else {
+                hilet a1 = s * (1.5f - x0f);
+                accumulator[x0i + 1] += d * (a1 - a0);
+                for (auto xi = x0i + 2; xi < x1i - 1; ++xi) {
+                    accumulator[xi] += d * s;
+                }
+                hilet a2 = a1 + static_cast<float>(x1i - x0i - 3) * s;
+                accumulator[x1i - 1] += d * (1.0f - a2 - am);
+            }
+            accumulator[x1i] += d * am;
+            inplace_min(first, x0i);
+            inplace_max(last, x1i);
+        }
+    }
+
+    /** Resolve the accumulator into coverage and add it to the pixels of a row.
+     *
+     * The prefix sum is calculated four pixels at a time. The accumulator
+     * is cleared for the next row.
+     */
+    void resolve(std::span<uint8_t> row, std::vector<float>& accumulator, size_t first, size_t last, fill_rule rule) const noexcept
+    {
+        // The prefix sum beyond the last modified index is zero, for closed polygons.
+        hilet start = floor(first, 4_uz);
+        hilet end = std::min(ceil(last + 1, 4_uz), ceil(_width, 4_uz));
+
+        hilet zero = f32x4{};
+        hilet one = f32x4::broadcast(1.0f);
+        hilet two = f32x4::broadcast(2.0f);
+
+        auto carry = f32x4{};
+        for (auto x = start; x < end; x += 4) {
+            auto coverage = f32x4::load(accumulator.data() + x);
+            coverage += coverage._0xyz();
+            coverage += coverage._00xy();
+            coverage += carry;
+            carry = coverage.wwww();
+
+            coverage = abs(coverage);
+            if (rule == fill_rule::non_zero) {
+                coverage = min(coverage, one);
+            } else {
+                // Fold the winding number so that odd windings are covered.
+                coverage = coverage - two * floor(coverage * 0.5f);
+                coverage = min(coverage, two - coverage);
+            }
+            coverage = coverage * 255.0f;
+
+            hilet num_pixels = std::min(_width - x, 4_uz);
+            for (auto i = 0_uz; i != num_pixels; ++i) {
+                auto& pixel = row[x + i];
+                pixel = static_cast<uint8_t>(std::min(pixel + coverage[i] + 0.5f, 255.0f));
+            }
+        }
+
+        std::fill(accumulator.begin() + start, accumulator.begin() + std::max(end, last + 1), 0.0f);
+    }
+};
+
+}} // namespace hi::v1
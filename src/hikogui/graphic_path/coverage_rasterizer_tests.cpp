@@ -0,0 +1,86 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "coverage_rasterizer.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+
+using namespace hi;
+
+namespace coverage_rasterizer_tests {
+
+static void add_rectangle(coverage_rasterizer& rasterizer, float x0, float y0, float x1, float y1)
+{
+    rasterizer.add_line(point2{x0, y0}, point2{x1, y0});
+    rasterizer.add_line(point2{x1, y0}, point2{x1, y1});
+    rasterizer.add_line(point2{x1, y1}, point2{x0, y1});
+    rasterizer.add_line(point2{x0, y1}, point2{x0, y0});
+}
+
+} // namespace coverage_rasterizer_tests
+
+TEST(coverage_rasterizer, full_pixels)
+{
+    auto image = pixmap<uint8_t>{6, 5};
+
+    auto rasterizer = coverage_rasterizer{6, 5};
+    coverage_rasterizer_tests::add_rectangle(rasterizer, 1.0f, 1.0f, 4.0f, 3.0f);
+    rasterizer.fill(pixmap_span<uint8_t>{image}, fill_rule::non_zero);
+
+    for (auto y = 0_uz; y != image.height(); ++y) {
+        for (auto x = 0_uz; x != image.width(); ++x) {
+            hilet inside = x >= 1 and x < 4 and y >= 1 and y < 3;
+            ASSERT_EQ(image[y][x], inside ? 255 : 0);
+        }
+    }
+}
+
+TEST(coverage_rasterizer, partial_pixels)
+{
+    auto image = pixmap<uint8_t>{4, 2};
+
+    auto rasterizer = coverage_rasterizer{4, 2};
+    coverage_rasterizer_tests::add_rectangle(rasterizer, 0.5f, 0.0f, 2.0f, 1.0f);
+    rasterizer.fill(pixmap_span<uint8_t>{image}, fill_rule::non_zero);
+
+    ASSERT_NEAR(image[0][0], 128, 1);
+    ASSERT_EQ(image[0][1], 255);
+    ASSERT_EQ(image[0][2], 0);
+    ASSERT_EQ(image[1][0], 0);
+}
+
+TEST(coverage_rasterizer, clipped)
+{
+    auto image = pixmap<uint8_t>{4, 4};
+
+    // The rectangle extends beyond every side of the image.
+    auto rasterizer = coverage_rasterizer{4, 4};
+    coverage_rasterizer_tests::add_rectangle(rasterizer, -2.0f, -2.0f, 6.0f, 6.0f);
+    rasterizer.fill(pixmap_span<uint8_t>{image}, fill_rule::non_zero);
+
+    for (auto y = 0_uz; y != image.height(); ++y) {
+        for (auto x = 0_uz; x != image.width(); ++x) {
+            ASSERT_EQ(image[y][x], 255);
+        }
+    }
+}
+
+TEST(coverage_rasterizer, fill_rule)
+{
+    auto even_odd = pixmap<uint8_t>{8, 4};
+    auto non_zero = pixmap<uint8_t>{8, 4};
+
+    // Two overlapping rectangles with the same winding direction.
+    auto rasterizer = coverage_rasterizer{8, 4};
+    coverage_rasterizer_tests::add_rectangle(rasterizer, 0.0f, 0.0f, 5.0f, 4.0f);
+    coverage_rasterizer_tests::add_rectangle(rasterizer, 3.0f, 0.0f, 8.0f, 4.0f);
+    rasterizer.fill(pixmap_span<uint8_t>{even_odd}, fill_rule::even_odd);
+    rasterizer.fill(pixmap_span<uint8_t>{non_zero}, fill_rule::non_zero);
+
+    for (auto x = 0_uz; x != 8; ++x) {
+        hilet overlap = x >= 3 and x < 5;
+        ASSERT_EQ(even_odd[1][x], overlap ? 0 : 255);
+        ASSERT_EQ(non_zero[1][x], 255);
+    }
+}
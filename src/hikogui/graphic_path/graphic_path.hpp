@@ -5,6 +5,7 @@
 #pragma once
 
 #include "bezier_point.hpp" // export
+#include "coverage_rasterizer.hpp" // export
 #include "bezier_curve.hpp" // export
 #include "bezier.hpp" // export
 #include "../utility/utility.hpp"
@@ -706,4 +707,23 @@ hi_export hi_inline void fill(pixmap_span<sdf_r8> dst, graphic_path const& path)
     fill(dst, path.getBeziers());
 }
 
+/** Fill a multi-channel signed distance field image from the given path.
+ * The edges of each contour are colored before the distances are calculated.
+ *
+ * @param dst An multi-channel signed-distance-field which show distance toward the closest curves
+ * @param path A path.
+ */
+hi_export hi_inline void fill(pixmap_span<sdf_rgba8> dst, graphic_path const& path) noexcept
+{
+    hi_assert(not path.hasLayers());
+
+    auto curves = std::vector<bezier_curve>{};
+    for (auto contour_nr = 0; contour_nr < path.numberOfContours(); ++contour_nr) {
+        auto contour = path.getBeziersOfContour(contour_nr);
+        color_contour_edges(contour);
+        curves.insert(curves.end(), contour.begin(), contour.end());
+    }
+    fill(dst, curves);
+}
+
 }} // namespace hi::v1
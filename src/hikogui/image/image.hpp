@@ -7,6 +7,7 @@
 #include "pixmap.hpp" // export
 #include "pixmap_span.hpp" // export
 #include "sdf_r8.hpp" // export
+#include "sdf_rgba8.hpp" // export
 #include "sfloat_rg32.hpp" // export
 #include "sfloat_rgb32.hpp" // export
 #include "sfloat_rgba16.hpp" // export
@@ -43,6 +44,7 @@ Pixel formats
  | `srgb_abgr8_pack`    | `VK_FORMAT_A8B8G8R8_SRGB_PACK32`     |                                  |
  | `unorm_a2bgr10_pack` | `VK_FORMAT_A2R10G10B10_UNORM_PACK32` |                                  |
  | `sdf_r8`             | `VK_FORMAT_R8_SNORM`                 | To store signed-distance-field.  |
+ | `sdf_rgba8`          | `VK_FORMAT_R8G8B8A8_SNORM`           | To store multi-channel SDF.      |
 
 Naming
 ------
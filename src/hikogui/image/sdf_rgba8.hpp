@@ -0,0 +1,86 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file image/sdf_rgba8.hpp Defines the multi-channel signed distance field pixel type sdf_rgba8.
+ * @ingroup image
+ */
+
+#pragma once
+
+#include "sdf_r8.hpp"
+#include "snorm_r8.hpp"
+#include "../SIMD/SIMD.hpp"
+#include "../utility/utility.hpp"
+#include "../macros.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+hi_export_module(hikogui.image.sdf_rgba8);
+
+hi_export namespace hi::inline v1 {
+
+/** A pixel of a multi-channel signed distance field.
+ * https://github.com/Chlumsky/msdfgen
+ *
+ * The red, green and blue channels hold the distances to the edges of the
+ * same color, the median of these three channels reconstructs the sharp
+ * corners of a shape. The alpha channel holds the true signed distance,
+ * which is used for effects that need distances far away from the edge.
+ *
+ * @ingroup image
+ */
+struct sdf_rgba8 {
+    /** Max distance in pixels represented by the signed distance field.
+     */
+    constexpr static float max_distance = sdf_r8::max_distance;
+    constexpr static float one_over_max_distance = 1.0f / max_distance;
+
+    std::array<int8_t, 4> v;
+
+    sdf_rgba8() noexcept = default;
+    sdf_rgba8(sdf_rgba8 const& other) noexcept = default;
+    sdf_rgba8(sdf_rgba8&& other) noexcept = default;
+    sdf_rgba8& operator=(sdf_rgba8 const& other) noexcept = default;
+    sdf_rgba8& operator=(sdf_rgba8&& other) noexcept = default;
+    ~sdf_rgba8() = default;
+
+    /** Set the distances in pixels.
+     *
+     * @param rhs The red, green, blue and alpha distances in pixels.
+     */
+    sdf_rgba8(f32x4 rhs) noexcept
+    {
+        hilet tmp = static_cast<std::array<float, 4>>(rhs * one_over_max_distance);
+        for (auto i = 0_uz; i != 4; ++i) {
+            v[i] = make_snorm_r8_value(tmp[i]);
+        }
+    }
+
+    sdf_rgba8& operator=(f32x4 rhs) noexcept
+    {
+        return *this = sdf_rgba8{rhs};
+    }
+
+    /** Get the red, green, blue and alpha distances in pixels.
+     */
+    operator f32x4() const noexcept
+    {
+        return f32x4{
+                   narrow_cast<float>(v[0]), narrow_cast<float>(v[1]), narrow_cast<float>(v[2]), narrow_cast<float>(v[3])} *
+            (max_distance / 127.0f);
+    }
+
+    /** The distance in pixels reconstructed from the red, green and blue channels.
+     */
+    [[nodiscard]] float median() const noexcept
+    {
+        hilet tmp = static_cast<f32x4>(*this);
+        return std::max(std::min(tmp.x(), tmp.y()), std::min(std::max(tmp.x(), tmp.y()), tmp.z()));
+    }
+
+    [[nodiscard]] friend bool operator==(sdf_rgba8 const& lhs, sdf_rgba8 const& rhs) noexcept = default;
+};
+
+} // namespace hi::inline v1
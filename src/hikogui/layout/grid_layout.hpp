@@ -7,6 +7,7 @@
 #include "box_constraints.hpp"
 #include "box_shape.hpp"
 #include "spreadsheet_address.hpp"
+#include "../container/container.hpp"
 #include "../geometry/geometry.hpp"
 #include "../utility/utility.hpp"
 #include "../macros.hpp"
@@ -16,10 +17,17 @@
 #include <algorithm>
 #include <utility>
 #include <cmath>
+#include <tuple>
+#include <optional>
+#include <span>
+#include <memory>
 
 hi_export_module(hikogui.layout.grid_layout);
 
 hi_export namespace hi { inline namespace v1 {
+template<typename T>
+class grid_layout;
+
 namespace detail {
 
 template<typename T>
@@ -58,11 +66,6 @@ struct grid_layout_cell {
         hi_assert(first_row < last_row);
     }
 
-    constexpr void set_constraints(box_constraints const& constraints) noexcept
-    {
-        _constraints = constraints;
-    }
-
     template<hi::axis Axis>
     [[nodiscard]] constexpr size_t first() const noexcept
     {
@@ -224,6 +227,13 @@ struct grid_layout_cell {
 
 private:
     box_constraints _constraints;
+
+    /** The cell is in the list of modified cells of the grid.
+     */
+    mutable bool _modified = false;
+
+    template<typename>
+    friend class hi::grid_layout;
 };
 
 template<hi::axis Axis, typename T>
@@ -315,17 +325,149 @@ public:
      *                False if the axis is used from right-to-left or top-to-bottom.
      */
     constexpr grid_layout_axis_constraints(cell_vector const& cells, size_t num, bool forward) noexcept :
-        _constraints(num), _forward(forward)
+        _constraints(num), _base(num), _is_changed(num, false), _is_changed_span(cells.size(), false), _forward(forward)
     {
+        // For each row/column make a list of the cells that overlap it.
+        _cell_offsets.resize(num + 1, 0);
         for (hilet& cell : cells) {
-            construct_simple_cell(cell);
+            for (auto i = cell.template first<axis>(); i != cell.template last<axis>(); ++i) {
+                ++_cell_offsets[i + 1];
+            }
+        }
+        for (auto i = 1_uz; i != _cell_offsets.size(); ++i) {
+            _cell_offsets[i] += _cell_offsets[i - 1];
+        }
+        _cell_indices.resize(_cell_offsets.back());
+        auto fill = std::vector<size_t>(_cell_offsets.begin(), _cell_offsets.end() - 1);
+        for (auto j = 0_uz; j != cells.size(); ++j) {
+            hilet& cell = cells[j];
+            for (auto i = cell.template first<axis>(); i != cell.template last<axis>(); ++i) {
+                _cell_indices[fill[i]++] = j;
+            }
+            if (cell.template span<axis>() > 1) {
+                _span_cells.push_back(j);
+            }
         }
-        construct_fixup();
 
-        for (hilet& cell : cells) {
-            construct_span_cell(cell);
+        for (auto i = 0_uz; i != num; ++i) {
+            construct_base(cells, i);
+        }
+        for (auto i = 0_uz; i != num; ++i) {
+            construct_simple(i);
+        }
+        for (hilet j : _span_cells) {
+            construct_span_cell(cells[j]);
+        }
+        for (auto& constraint : _constraints) {
+            construct_fixup(constraint);
+        }
+
+        construct_sums();
+    }
+
+    /** Update the constraints after the constraints of some of the cells have changed.
+     *
+     * Only the rows/columns that overlap the modified cells, and their neighbours
+     * for the margins, are recalculated. The cells that span multiple rows/columns
+     * that overlap these rows/columns are distributed again; which in turn
+     * recalculates the rows/columns they span.
+     *
+     * The layout is kept when none of the recalculated rows/columns changed.
+     *
+     * @param cells The cells, the same as passed to the constructor.
+     * @param modified The indices of the cells that were modified.
+     */
+    constexpr void update(cell_vector const& cells, std::span<size_t const> modified) noexcept
+    {
+        if (modified.empty()) {
+            return;
+        }
+
+        hilet mark = [&](size_t i) {
+            if (not _is_changed[i]) {
+                _is_changed[i] = true;
+                _changed.push_back(i);
+            }
+        };
+
+        for (hilet j : modified) {
+            hilet& cell = cells[j];
+            for (auto i = cell.template first<axis>(); i != cell.template last<axis>(); ++i) {
+                mark(i);
+            }
+        }
+
+        for (hilet i : _changed) {
+            construct_base(cells, i);
+        }
+
+        // The margins are shared with the neighbours.
+        hilet num_modified = _changed.size();
+        for (auto k = 0_uz; k != num_modified; ++k) {
+            hilet i = _changed[k];
+            if (i != 0) {
+                mark(i - 1);
+            }
+            if (i + 1 != size()) {
+                mark(i + 1);
+            }
+        }
+
+        // The span-cells that overlap a changed row/column are distributed again,
+        // which changes all the rows/columns they span; these may overlap other span-cells.
+        for (auto k = 0_uz; k != _changed.size(); ++k) {
+            hilet i = _changed[k];
+            for (auto l = _cell_offsets[i]; l != _cell_offsets[i + 1]; ++l) {
+                hilet j = _cell_indices[l];
+                hilet& cell = cells[j];
+                if (cell.template span<axis>() > 1 and not _is_changed_span[j]) {
+                    _is_changed_span[j] = true;
+                    _changed_spans.push_back(j);
+                    for (auto r = cell.template first<axis>(); r != cell.template last<axis>(); ++r) {
+                        mark(r);
+                    }
+                }
+            }
+        }
+
+        // Each span-cell depends on the span-cells before it, so they are distributed in the original order.
+        std::sort(_changed_spans.begin(), _changed_spans.end());
+
+        for (hilet i : _changed) {
+            _previous.push_back(_constraints[i]);
+            construct_simple(i);
+        }
+        for (hilet j : _changed_spans) {
+            construct_span_cell(cells[j]);
+        }
+
+        auto layout_changed = false;
+        for (auto k = 0_uz; k != _changed.size(); ++k) {
+            hilet i = _changed[k];
+            auto& constraint = _constraints[i];
+            hilet& previous = _previous[k];
+
+            construct_fixup(constraint);
+            layout_changed |= not same_constraints(constraint, previous);
+            update_sums(i);
+
+            // Keep the result of the previous layout, in case the layout is not recalculated.
+            constraint.position = previous.position;
+            constraint.extent = previous.extent;
+            constraint.guideline = previous.guideline;
+
+            _is_changed[i] = false;
+        }
+        for (hilet j : _changed_spans) {
+            _is_changed_span[j] = false;
+        }
+        _changed.clear();
+        _changed_spans.clear();
+        _previous.clear();
+
+        if (layout_changed) {
+            _layout_arguments = std::nullopt;
         }
-        construct_fixup();
     }
 
     [[nodiscard]] constexpr float margin_before() const noexcept
@@ -350,7 +492,7 @@ public:
 
     [[nodiscard]] constexpr std::tuple<float, float, float> update_constraints() const noexcept
     {
-        return constraints(begin(), end());
+        return constraints(0, size());
     }
 
     /** Get the minimum, preferred, maximum size of the span.
@@ -408,6 +550,13 @@ public:
      */
     constexpr void layout(float new_position, float new_extent, std::optional<float> external_guideline, float guideline_width) noexcept
     {
+        // The layout is only calculated when the constraints or the arguments have changed.
+        hilet arguments = layout_arguments_type{new_position, new_extent, external_guideline, guideline_width};
+        if (_layout_arguments == arguments) {
+            return;
+        }
+        _layout_arguments = arguments;
+
         // Start with the extent of each constraint equal to the preferred extent.
         for (auto& constraint : _constraints) {
             constraint.extent = constraint.preferred;
@@ -616,10 +765,70 @@ private:
      */
     constraint_vector _constraints = {};
 
+    /** The constraints of each row/column merged from the cells, before fix-up.
+     */
+    constraint_vector _base = {};
+
+    /** For each row/column the offset into `_cell_indices`, with a sentinel at the end.
+     */
+    std::vector<size_t> _cell_offsets = {};
+
+    /** The index of each cell that overlaps each row/column.
+     */
+    std::vector<size_t> _cell_indices = {};
+
+    /** The index of each cell that spans multiple rows/columns, in the order of the cells.
+     */
+    std::vector<size_t> _span_cells = {};
+
+    /** The rows/columns recalculated by `update()`.
+     *
+     * This and the following members are only used during `update()`, they
+     * are kept to reuse their allocations.
+     */
+    std::vector<size_t> _changed = {};
+
+    /** For each row/column, if it is in `_changed`.
+     */
+    std::vector<bool> _is_changed = {};
+
+    /** The span-cells distributed again by `update()`.
+     */
+    std::vector<size_t> _changed_spans = {};
+
+    /** For each cell, if it is in `_changed_spans`.
+     */
+    std::vector<bool> _is_changed_span = {};
+
+    /** The constraints of each row/column in `_changed` before `update()`.
+     */
+    constraint_vector _previous = {};
+
+    /** Prefix sums of the minimum, preferred and maximum sizes and the margin before each row/column.
+     *
+     * Sizes that are effectively unbounded are summed separately, so that
+     * subtracting prefix sums does not lose the precision of the other sizes.
+     */
+    fenwick_tree<double> _minimum_sums = {};
+    fenwick_tree<double> _preferred_sums = {};
+    fenwick_tree<double> _maximum_sums = {};
+    fenwick_tree<double> _unbounded_maximum_sums = {};
+    fenwick_tree<double> _margin_sums = {};
+
+    /** Maximum sizes above this value are summed in `_unbounded_maximum_sums`.
+     */
+    constexpr static double unbounded_maximum = 1e18;
+
     /** The constraints are defined in left-to-right, bottom-to-top order.
      */
     bool _forward = true;
 
+    using layout_arguments_type = std::tuple<float, float, std::optional<float>, float>;
+
+    /** The arguments of the previous `layout()`, or empty if the constraints have changed since.
+     */
+    std::optional<layout_arguments_type> _layout_arguments = std::nullopt;
+
     /** Shrink cells.
      *
      * This function is called in two different ways:
@@ -726,30 +935,60 @@ private:
         }
     }
 
-    /** Construct from a simple cell.
+    /** Merge the constraints of the cells overlapping a row/column.
      *
      * Calculate all the margins. And the minimum, preferred and maximum size
-     * for a cell that has a span of one in the direction of the axis.
+     * from the cells that have a span of one in the direction of the axis.
      *
-     * @param cell The cell to construct.
+     * @param cells The cells.
+     * @param i The index of the row/column.
      */
-    constexpr void construct_simple_cell(cell_type const& cell) noexcept
+    constexpr void construct_base(cell_vector const& cells, size_t i) noexcept
     {
-        inplace_max(_constraints[cell.template first<axis>()].margin_before, cell.template margin_before<axis>(_forward));
-        inplace_max(_constraints[cell.template last<axis>() - 1].margin_after, cell.template margin_after<axis>(_forward));
-        inplace_max(_constraints[cell.template first<axis>()].padding_before, cell.template padding_before<axis>(_forward));
-        inplace_max(_constraints[cell.template last<axis>() - 1].padding_after, cell.template padding_after<axis>(_forward));
+        auto& constraint = _base[i] = constraint_type{};
+
+        for (auto k = _cell_offsets[i]; k != _cell_offsets[i + 1]; ++k) {
+            hilet& cell = cells[_cell_indices[k]];
+
+            if (cell.template first<axis>() == i) {
+                inplace_max(constraint.margin_before, cell.template margin_before<axis>(_forward));
+                inplace_max(constraint.padding_before, cell.template padding_before<axis>(_forward));
+            }
+            if (cell.template last<axis>() - 1 == i) {
+                inplace_max(constraint.margin_after, cell.template margin_after<axis>(_forward));
+                inplace_max(constraint.padding_after, cell.template padding_after<axis>(_forward));
+            }
+
+            constraint.beyond_maximum |= cell.beyond_maximum;
 
-        for (auto i = cell.template first<axis>(); i != cell.template last<axis>(); ++i) {
-            _constraints[i].beyond_maximum |= cell.beyond_maximum;
+            if (cell.template span<axis>() == 1) {
+                inplace_max(constraint.alignment, cell.template alignment<axis>());
+                inplace_max(constraint.minimum, cell.template minimum<axis>());
+                inplace_max(constraint.preferred, cell.template preferred<axis>());
+                inplace_min(constraint.maximum, cell.template maximum<axis>());
+            }
         }
+    }
 
-        if (cell.template span<axis>() == 1) {
-            inplace_max(_constraints[cell.template first<axis>()].alignment, cell.template alignment<axis>());
-            inplace_max(_constraints[cell.template first<axis>()].minimum, cell.template minimum<axis>());
-            inplace_max(_constraints[cell.template first<axis>()].preferred, cell.template preferred<axis>());
-            inplace_min(_constraints[cell.template first<axis>()].maximum, cell.template maximum<axis>());
+    /** Construct the constraint of a row/column from the merged constraints.
+     *
+     * The margins between two rows/columns are made equal, and the sizes
+     * and padding are fixed-up.
+     *
+     * @param i The index of the row/column.
+     */
+    constexpr void construct_simple(size_t i) noexcept
+    {
+        auto& constraint = _constraints[i] = _base[i];
+
+        if (i != 0) {
+            inplace_max(constraint.margin_before, _base[i - 1].margin_after);
         }
+        if (i + 1 != size()) {
+            inplace_max(constraint.margin_after, _base[i + 1].margin_before);
+        }
+
+        construct_fixup(constraint);
     }
 
     /** Construct from a span-cell.
@@ -763,7 +1002,8 @@ private:
         auto num_cells = narrow_cast<float>(cell.template span<axis>());
 
         if (cell.template span<axis>() > 1) {
-            hilet[span_minimum, span_preferred, span_maximum] = constraints(cell);
+            hilet[span_minimum, span_preferred, span_maximum] =
+                span_constraints(cell.template first<axis>(), cell.template last<axis>());
             if (hilet extra = cell.template minimum<axis>() - span_minimum; extra > 0) {
                 hilet extra_per_cell = std::floor(extra / num_cells);
                 for (auto i = cell.template first<axis>(); i != cell.template last<axis>(); ++i) {
@@ -788,62 +1028,108 @@ private:
         }
     }
 
+    /** Check if the constraints of a row/column are the same, ignoring the layout.
+     */
+    [[nodiscard]] constexpr static bool same_constraints(constraint_type const& lhs, constraint_type const& rhs) noexcept
+    {
+        return lhs.minimum == rhs.minimum and lhs.preferred == rhs.preferred and lhs.maximum == rhs.maximum and
+            lhs.margin_before == rhs.margin_before and lhs.margin_after == rhs.margin_after and
+            lhs.padding_before == rhs.padding_before and lhs.padding_after == rhs.padding_after and
+            lhs.alignment == rhs.alignment and lhs.beyond_maximum == rhs.beyond_maximum;
+    }
+
     /** Construct fix-up.
      *
      * Fix-up minimum, preferred, maximum. And calculate the padding.
+     *
+     * @param constraint The constraint of a row/column.
      */
-    constexpr void construct_fixup() noexcept
+    constexpr static void construct_fixup(constraint_type& constraint) noexcept
+    {
+        // Fix the constraints so that minimum <= preferred <= maximum.
+        inplace_max(constraint.preferred, constraint.minimum);
+        inplace_max(constraint.maximum, constraint.preferred);
+
+        // Fix the padding, so that it doesn't overlap.
+        if (constraint.padding_before + constraint.padding_after > constraint.minimum) {
+            hilet padding_diff = constraint.padding_after - constraint.padding_before;
+            hilet middle = std::clamp(constraint.minimum / 2.0f + padding_diff, 0.0f, constraint.minimum);
+            constraint.padding_after = middle;
+            constraint.padding_before = constraint.minimum - middle;
+        }
+    }
+
+    /** Construct the prefix sums of the constraints.
+     */
+    constexpr void construct_sums() noexcept
     {
-        for (auto it = begin(); it != end(); ++it) {
-            // Fix the margins so that between two constraints they are equal.
-            if (it + 1 != end()) {
-                it->margin_after = (it + 1)->margin_before = std::max(it->margin_after, (it + 1)->margin_before);
+        auto values = std::vector<double>(size());
+        hilet make_sums = [&](auto const& func) {
+            for (auto i = 0_uz; i != size(); ++i) {
+                values[i] = func(_constraints[i]);
             }
+            return fenwick_tree<double>{std::span<double const>{values}};
+        };
 
-            // Fix the constraints so that minimum <= preferred <= maximum.
-            inplace_max(it->preferred, it->minimum);
-            inplace_max(it->maximum, it->preferred);
+        _minimum_sums = make_sums([](constraint_type const& constraint) -> double {
+            return constraint.minimum;
+        });
+        _preferred_sums = make_sums([](constraint_type const& constraint) -> double {
+            return constraint.preferred;
+        });
+        _maximum_sums = make_sums([](constraint_type const& constraint) -> double {
+            return constraint.maximum > unbounded_maximum ? 0.0 : constraint.maximum;
+        });
+        _unbounded_maximum_sums = make_sums([](constraint_type const& constraint) -> double {
+            return constraint.maximum > unbounded_maximum ? constraint.maximum : 0.0;
+        });
+        _margin_sums = make_sums([](constraint_type const& constraint) -> double {
+            return constraint.margin_before;
+        });
+        _layout_arguments = std::nullopt;
+    }
 
-            // Fix the padding, so that it doesn't overlap.
-            if (it->padding_before + it->padding_after > it->minimum) {
-                hilet padding_diff = it->padding_after - it->padding_before;
-                hilet middle = std::clamp(it->minimum / 2.0f + padding_diff, 0.0f, it->minimum);
-                it->padding_after = middle;
-                it->padding_before = it->minimum - middle;
-            }
-        }
+    /** Update the prefix sums after the constraint of a row/column has changed.
+     *
+     * @param i The index of the row/column.
+     */
+    constexpr void update_sums(size_t i) noexcept
+    {
+        hilet& constraint = _constraints[i];
+        hilet unbounded = constraint.maximum > unbounded_maximum;
+        _minimum_sums.set(i, constraint.minimum);
+        _preferred_sums.set(i, constraint.preferred);
+        _maximum_sums.set(i, unbounded ? 0.0 : constraint.maximum);
+        _unbounded_maximum_sums.set(i, unbounded ? constraint.maximum : 0.0);
+        _margin_sums.set(i, constraint.margin_before);
     }
 
     /** Get the minimum, preferred, maximum size of the span.
      *
      * The returned minimum, preferred and maximum include the internal margin within the span.
+     * This is done in O(log n) using the prefix sums.
      *
-     * @param first The iterator to the first cell.
-     * @param last The iterator beyond the last cell.
+     * @param first The index to the first cell.
+     * @param last The index beyond the last cell.
      * @return The minimum, preferred and maximum size.
      */
-    [[nodiscard]] constexpr std::tuple<float, float, float> constraints(const_iterator first, const_iterator last) const noexcept
+    [[nodiscard]] constexpr std::tuple<float, float, float> constraints(size_t first, size_t last) const noexcept
     {
-        auto r_minimum = 0.0f;
-        auto r_preferred = 0.0f;
-        auto r_maximum = 0.0f;
-        auto r_margin = 0.0f;
+        hi_axiom(first <= last);
+        hi_axiom(last <= size());
 
-        if (first != last) {
-            r_minimum = first->minimum;
-            r_preferred = first->preferred;
-            r_maximum = first->maximum;
-            for (auto it = first + 1; it != last; ++it) {
-                r_margin += it->margin_before;
-                r_minimum += it->minimum;
-                r_preferred += it->preferred;
-                r_maximum += it->maximum;
-            }
+        if (first == last) {
+            return {0.0f, 0.0f, 0.0f};
         }
-        return {r_minimum + r_margin, r_preferred + r_margin, r_maximum + r_margin};
+
+        hilet margin = _margin_sums.sum(first + 1, last);
+        return {
+            static_cast<float>(_minimum_sums.sum(first, last) + margin),
+            static_cast<float>(_preferred_sums.sum(first, last) + margin),
+            static_cast<float>(_unbounded_maximum_sums.sum(first, last) + _maximum_sums.sum(first, last) + margin)};
     }
 
-    /** Get the minimum, preferred, maximum size of the span.
+    /** Get the minimum, preferred, maximum size of the span while the constraints are being constructed.
      *
      * The returned minimum, preferred and maximum include the internal margin within the span.
      *
@@ -851,11 +1137,22 @@ private:
      * @param last The index beyond the last cell.
      * @return The minimum, preferred and maximum size.
      */
-    [[nodiscard]] constexpr std::tuple<float, float, float> constraints(size_t first, size_t last) const noexcept
+    [[nodiscard]] constexpr std::tuple<float, float, float> span_constraints(size_t first, size_t last) const noexcept
     {
-        hi_axiom(first <= last);
+        hi_axiom(first < last);
         hi_axiom(last <= size());
-        return constraints(begin() + first, begin() + last);
+
+        auto r_minimum = _constraints[first].minimum;
+        auto r_preferred = _constraints[first].preferred;
+        auto r_maximum = _constraints[first].maximum;
+        auto r_margin = 0.0f;
+        for (auto i = first + 1; i != last; ++i) {
+            r_margin += _constraints[i].margin_before;
+            r_minimum += _constraints[i].minimum;
+            r_preferred += _constraints[i].preferred;
+            r_maximum += _constraints[i].maximum;
+        }
+        return {r_minimum + r_margin, r_preferred + r_margin, r_maximum + r_margin};
     }
 
     /** Get the current layout position of a span.
@@ -1101,11 +1398,52 @@ public:
         update_after_insert_or_delete();
     }
 
+    /** Set the constraints of a cell.
+     *
+     * The grid only recalculates the rows and columns of the cells whose
+     * constraints have changed.
+     *
+     * @param cell A cell of this grid.
+     * @param constraints The constraints of the value in the cell.
+     */
+    constexpr void set_constraints(cell_type& cell, box_constraints const& constraints) noexcept
+    {
+        hi_axiom(std::addressof(cell) >= _cells.data() and std::addressof(cell) < _cells.data() + _cells.size());
+
+        if (cell._constraints != constraints) {
+            cell._constraints = constraints;
+            if (not std::exchange(cell._modified, true)) {
+                _modified_cells.push_back(static_cast<size_t>(std::addressof(cell) - _cells.data()));
+            }
+        }
+    }
+
+    /** Calculate the constraints of the grid.
+     *
+     * After the first call, only the rows and columns of the cells whose
+     * constraints were modified are recalculated.
+     *
+     * @param left_to_right True if the columns are laid out from left to right.
+     * @return The constraints of the grid.
+     */
     [[nodiscard]] constexpr box_constraints constraints(bool left_to_right) const noexcept
     {
-        // Rows in the grid are laid out from top to bottom which is reverse from the y-axis up.
-        _row_constraints = {_cells, num_rows(), false};
-        _column_constraints = {_cells, num_columns(), left_to_right};
+        if (_rebuild or _left_to_right != left_to_right) {
+            // Rows in the grid are laid out from top to bottom which is reverse from the y-axis up.
+            _row_constraints = {_cells, num_rows(), false};
+            _column_constraints = {_cells, num_columns(), left_to_right};
+            _left_to_right = left_to_right;
+            _rebuild = false;
+
+        } else {
+            _row_constraints.update(_cells, _modified_cells);
+            _column_constraints.update(_cells, _modified_cells);
+        }
+
+        for (hilet i : _modified_cells) {
+            _cells[i]._modified = false;
+        }
+        _modified_cells.clear();
 
         auto r = box_constraints{};
         std::tie(r.minimum.width(), r.preferred.width(), r.maximum.width()) = _column_constraints.update_constraints();
@@ -1165,6 +1503,18 @@ private:
     mutable detail::grid_layout_axis_constraints<axis::y, value_type> _row_constraints = {};
     mutable detail::grid_layout_axis_constraints<axis::x, value_type> _column_constraints = {};
 
+    /** The indices of the cells whose constraints were modified since the last call to `constraints()`.
+     */
+    mutable std::vector<size_t> _modified_cells = {};
+
+    /** The axis constraints need to be constructed from all the cells.
+     */
+    mutable bool _rebuild = true;
+
+    /** The direction of the columns when the axis constraints were constructed.
+     */
+    mutable bool _left_to_right = true;
+
     /** Sort the cells ordered by row then column.
      *
      * The ordering is the same as they keyboard focus chain order.
@@ -1185,6 +1535,13 @@ private:
     constexpr void update_after_insert_or_delete() noexcept
     {
         sort_cells();
+        _rebuild = true;
+
+        // The axis constraints are constructed from all cells, and the indices are no longer valid.
+        for (auto& cell : _cells) {
+            cell._modified = false;
+        }
+        _modified_cells.clear();
 
         _num_rows = 0;
         _num_columns = 0;
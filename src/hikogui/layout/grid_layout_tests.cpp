@@ -0,0 +1,185 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "grid_layout.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <tuple>
+
+using namespace hi;
+
+namespace grid_layout_tests {
+
+/** Build a grid with some cells spanning multiple rows and columns.
+ */
+static grid_layout<int> make_grid(std::vector<box_constraints> const& constraints)
+{
+    auto r = grid_layout<int>{};
+    r.add_cell(0, 0, 0);
+    r.add_cell(1, 0, 3, 1, 1);
+    r.add_cell(0, 1, 2);
+    r.add_cell(1, 1, 3);
+    r.add_cell(2, 1, 3, 3, 4);
+    r.add_cell(0, 2, 2, 3, 5);
+
+    for (auto& cell : r) {
+        r.set_constraints(cell, constraints[cell.value]);
+    }
+    return r;
+}
+
+static box_constraints make_constraints(float minimum, float preferred, float maximum, float margin)
+{
+    return box_constraints{
+        extent2{minimum, minimum}, extent2{preferred, preferred}, extent2{maximum, maximum}, hi::alignment{}, hi::margins{margin}};
+}
+
+struct random_cell {
+    size_t first_column;
+    size_t first_row;
+    size_t last_column;
+    size_t last_row;
+};
+
+/** Place random cells, some spanning multiple rows and columns, in a grid.
+ */
+static std::vector<random_cell> make_random_cells(std::mt19937& engine)
+{
+    auto position_dist = std::uniform_int_distribution<size_t>{0, 5};
+    auto span_dist = std::uniform_int_distribution<size_t>{1, 3};
+
+    auto r = std::vector<random_cell>{};
+    auto grid = grid_layout<int>{};
+    for (auto i = 0; i != 40; ++i) {
+        hilet first_column = position_dist(engine);
+        hilet first_row = position_dist(engine);
+        hilet last_column = std::min(first_column + span_dist(engine), 6_uz);
+        hilet last_row = std::min(first_row + span_dist(engine), 6_uz);
+        if (not grid.cell_in_use(first_column, first_row, last_column, last_row)) {
+            grid.add_cell(first_column, first_row, last_column, last_row, 0);
+            r.emplace_back(first_column, first_row, last_column, last_row);
+        }
+    }
+    return r;
+}
+
+/** Random constraints with integer values, so that the results are exact.
+ */
+static box_constraints make_random_constraints(std::mt19937& engine)
+{
+    auto size_dist = std::uniform_int_distribution<int>{0, 50};
+    auto margin_dist = std::uniform_int_distribution<int>{0, 5};
+
+    hilet minimum = narrow_cast<float>(size_dist(engine));
+    hilet preferred = minimum + narrow_cast<float>(size_dist(engine));
+    hilet maximum = preferred + narrow_cast<float>(size_dist(engine));
+    return make_constraints(minimum, preferred, maximum, narrow_cast<float>(margin_dist(engine)));
+}
+
+static grid_layout<int> make_grid(std::vector<random_cell> const& cells, std::vector<box_constraints> const& constraints)
+{
+    auto r = grid_layout<int>{};
+    for (auto i = 0_uz; i != cells.size(); ++i) {
+        hilet& cell = cells[i];
+        r.add_cell(cell.first_column, cell.first_row, cell.last_column, cell.last_row, narrow_cast<int>(i));
+    }
+
+    for (auto& cell : r) {
+        r.set_constraints(cell, constraints[cell.value]);
+    }
+    return r;
+}
+
+} // namespace grid_layout_tests
+
+TEST(grid_layout, incremental_update)
+{
+    auto constraints = std::vector<box_constraints>{};
+    for (auto i = 0; i != 6; ++i) {
+        constraints.push_back(grid_layout_tests::make_constraints(10.0f, 20.0f, 30.0f + i, 2.0f));
+    }
+
+    auto grid = grid_layout_tests::make_grid(constraints);
+    (void)grid.constraints(true);
+
+    // Change a simple cell, and a cell spanning multiple columns.
+    constraints[3] = grid_layout_tests::make_constraints(15.0f, 40.0f, 100.0f, 5.0f);
+    constraints[1] = grid_layout_tests::make_constraints(50.0f, 90.0f, 200.0f, 1.0f);
+    for (auto& cell : grid) {
+        grid.set_constraints(cell, constraints[cell.value]);
+    }
+
+    auto expected_grid = grid_layout_tests::make_grid(constraints);
+    hilet expected = expected_grid.constraints(true);
+    ASSERT_EQ(grid.constraints(true), expected);
+
+    hilet shape = box_shape{extent2{expected.preferred.width() + 7.0f, expected.preferred.height() - 3.0f}};
+    grid.set_layout(shape, 0.0f);
+    expected_grid.set_layout(shape, 0.0f);
+    for (auto i = 0_uz; i != grid.size(); ++i) {
+        ASSERT_EQ(grid[i].shape, expected_grid[i].shape);
+    }
+}
+
+TEST(grid_layout, unbounded_maximum)
+{
+    auto constraints = std::vector<box_constraints>{};
+    for (auto i = 0; i != 6; ++i) {
+        constraints.push_back(grid_layout_tests::make_constraints(10.0f, 20.0f, std::numeric_limits<float>::max(), 0.0f));
+    }
+
+    auto grid = grid_layout_tests::make_grid(constraints);
+    (void)grid.constraints(true);
+
+    // The small sizes must not be lost when the other cells are unbounded.
+    constraints[0] = grid_layout_tests::make_constraints(11.0f, 21.0f, 31.0f, 0.0f);
+    constraints[2] = grid_layout_tests::make_constraints(11.0f, 21.0f, 31.0f, 0.0f);
+    grid.set_constraints(grid[0], constraints[0]);
+    grid.set_constraints(grid[2], constraints[2]);
+
+    auto expected_grid = grid_layout_tests::make_grid(constraints);
+    ASSERT_EQ(grid.constraints(true), expected_grid.constraints(true));
+}
+
+TEST(grid_layout, random_incremental_update)
+{
+    auto engine = std::mt19937{42};
+
+    for (auto grid_nr = 0; grid_nr != 20; ++grid_nr) {
+        hilet cells = grid_layout_tests::make_random_cells(engine);
+
+        auto constraints = std::vector<box_constraints>{};
+        for (auto i = 0_uz; i != cells.size(); ++i) {
+            constraints.push_back(grid_layout_tests::make_random_constraints(engine));
+        }
+
+        auto grid = grid_layout_tests::make_grid(cells, constraints);
+        (void)grid.constraints(true);
+
+        auto cell_dist = std::uniform_int_distribution<size_t>{0, cells.size() - 1};
+        auto count_dist = std::uniform_int_distribution<int>{1, 3};
+        for (auto update_nr = 0; update_nr != 10; ++update_nr) {
+            // Modify a few cells, some of these updates do not change any of the rows or columns.
+            for (auto i = count_dist(engine); i != 0; --i) {
+                constraints[cell_dist(engine)] = grid_layout_tests::make_random_constraints(engine);
+            }
+            for (auto& cell : grid) {
+                grid.set_constraints(cell, constraints[cell.value]);
+            }
+
+            auto expected_grid = grid_layout_tests::make_grid(cells, constraints);
+            hilet expected = expected_grid.constraints(true);
+            ASSERT_EQ(grid.constraints(true), expected);
+
+            hilet shape = box_shape{expected.preferred};
+            grid.set_layout(shape, 0.0f);
+            expected_grid.set_layout(shape, 0.0f);
+            for (auto i = 0_uz; i != grid.size(); ++i) {
+                ASSERT_EQ(grid[i].shape, expected_grid[i].shape);
+            }
+        }
+    }
+}
@@ -123,6 +123,15 @@ public:
         return _grid.clear();
     }
 
+    /** Set the constraints of a cell.
+     *
+     * @see grid_layout::set_constraints()
+     */
+    void set_constraints(cell_type& cell, box_constraints const& constraints) noexcept
+    {
+        return _grid.set_constraints(cell, constraints);
+    }
+
     [[nodiscard]] box_constraints constraints(bool left_to_right) const noexcept
     {
         return _grid.constraints(left_to_right);
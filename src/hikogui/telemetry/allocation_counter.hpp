@@ -0,0 +1,64 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file telemetry/allocation_counter.hpp Count the number of memory allocations.
+ *
+ * The allocations are only counted when exactly one translation-unit of the
+ * executable defines `HI_COUNT_ALLOCATIONS` before including this file; this
+ * translation-unit will replace the global `operator new` and `operator delete`.
+ *
+ * ```cpp
+ * #define HI_COUNT_ALLOCATIONS
+ * #include "hikogui/telemetry/allocation_counter.hpp"
+ * ```
+ */
+
+#pragma once
+
+#include "../macros.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+hi_export_module(hikogui.telemetry : allocation_counter);
+
+hi_export namespace hi { inline namespace v1 {
+namespace detail {
+
+inline std::atomic<uint64_t> allocation_count = 0;
+
+}
+
+/** The number of calls to the global `operator new`.
+ *
+ * @return The number of allocations since the start of the program, or zero
+ *         when the allocations are not counted.
+ */
+[[nodiscard]] inline uint64_t allocation_count() noexcept
+{
+    return detail::allocation_count.load(std::memory_order::relaxed);
+}
+
+}} // namespace hi::v1
+
+#if defined(HI_COUNT_ALLOCATIONS)
+
+// The other forms of operator new and operator delete, except for the aligned forms,
+// are implemented by the standard library by calling these two functions.
+void *operator new(std::size_t size)
+{
+    hi::detail::allocation_count.fetch_add(1, std::memory_order::relaxed);
+    if (auto ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
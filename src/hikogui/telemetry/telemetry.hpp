@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include "allocation_counter.hpp" // export
 #include "counters.hpp" // export
 #include "delayed_format.hpp" // export
 #include "format_check.hpp" // export
@@ -229,16 +229,16 @@ private:
             run += (*it)->grapheme;
         }
 
-        auto result = font.shape_run(language, script, run);
-        result.scale_and_offset(char_it->scale);
-        hi_axiom(result.advances.size() == run.size());
-        hi_axiom(result.glyph_count.size() == run.size());
+        // The result is shared with the shape-run cache, so scale the advances while walking them.
+        hilet result = font.shape_run(language, script, run);
+        hi_axiom(result->advances.size() == run.size());
+        hi_axiom(result->glyph_count.size() == run.size());
 
         auto grapheme_index = 0_uz;
         for (auto it = first; it != last; ++it, ++grapheme_index) {
             (*it)->position = p;
 
-            p += vector2{result.advances[grapheme_index], 0.0f};
+            p += vector2{char_it->scale * result->advances[grapheme_index], 0.0f};
         }
     }
 
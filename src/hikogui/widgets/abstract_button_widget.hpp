@@ -98,9 +98,9 @@ public:
     [[nodiscard]] box_constraints update_constraints() noexcept override
     {
         _layout = {};
-        _on_label_constraints = _on_label_widget->update_constraints();
-        _off_label_constraints = _off_label_widget->update_constraints();
-        _other_label_constraints = _other_label_widget->update_constraints();
+        _on_label_constraints = _on_label_widget->update_constraints_retained();
+        _off_label_constraints = _off_label_widget->update_constraints_retained();
+        _other_label_constraints = _other_label_widget->update_constraints_retained();
         return max(_on_label_constraints, _off_label_constraints, _other_label_constraints);
     }
 
@@ -111,9 +111,9 @@ public:
         _off_label_widget->mode = state_ == button_state::off ? widget_mode::display : widget_mode::invisible;
         _other_label_widget->mode = state_ == button_state::other ? widget_mode::display : widget_mode::invisible;
 
-        _on_label_widget->set_layout(context.transform(_on_label_shape));
-        _off_label_widget->set_layout(context.transform(_off_label_shape));
-        _other_label_widget->set_layout(context.transform(_other_label_shape));
+        _on_label_widget->set_layout_retained(context.transform(_on_label_shape));
+        _off_label_widget->set_layout_retained(context.transform(_off_label_shape));
+        _other_label_widget->set_layout_retained(context.transform(_other_label_shape));
     }
 
     [[nodiscard]] generator<widget_intf&> children(bool include_invisible) noexcept override
@@ -251,9 +251,9 @@ protected:
 
     void draw_button(draw_context const& context) noexcept
     {
-        _on_label_widget->draw(context);
-        _off_label_widget->draw(context);
-        _other_label_widget->draw(context);
+        _on_label_widget->draw_retained(context);
+        _off_label_widget->draw_retained(context);
+        _other_label_widget->draw_retained(context);
     }
 };
 
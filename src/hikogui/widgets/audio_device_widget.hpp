@@ -59,7 +59,7 @@ public:
     [[nodiscard]] box_constraints update_constraints() noexcept override
     {
         _layout = {};
-        _grid_constraints = _grid_widget->update_constraints();
+        _grid_constraints = _grid_widget->update_constraints_retained();
         return _grid_constraints;
     }
 
@@ -70,13 +70,13 @@ public:
             _grid_shape = {_grid_constraints, grid_rectangle, theme().baseline_adjustment()};
         }
 
-        _grid_widget->set_layout(context.transform(_grid_shape, transform_command::level));
+        _grid_widget->set_layout_retained(context.transform(_grid_shape, transform_command::level));
     }
 
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible) {
-            _grid_widget->draw(context);
+            _grid_widget->draw_retained(context);
         }
     }
 
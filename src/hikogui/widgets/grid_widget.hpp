@@ -13,6 +13,7 @@
 #include "../coroutine/coroutine.hpp"
 #include "../macros.hpp"
 #include <memory>
+#include <vector>
 #include <coroutine>
 
 hi_export_module(hikogui.widgets.grid_widget);
@@ -74,6 +75,7 @@ public:
 
         auto& ref = *widget;
         _grid.add_cell(first_column, first_row, last_column, last_row, std::move(widget));
+        clear_hitbox_index();
         hi_log_info("grid_widget::insert({}, {}, {}, {})", first_column, first_row, last_column, last_row);
 
         ++global_counter<"grid_widget:insert:constrain">;
@@ -275,6 +277,7 @@ public:
     void clear() noexcept
     {
         _grid.clear();
+        clear_hitbox_index();
     }
 
     /// @privatesection
@@ -290,7 +293,7 @@ public:
         _layout = {};
 
         for (auto& cell : _grid) {
-            cell.set_constraints(cell.value->update_constraints());
+            _grid.set_constraints(cell, cell.value->update_constraints_retained());
         }
 
         return _grid.constraints(os_settings::left_to_right());
@@ -303,15 +306,16 @@ public:
         }
 
         for (hilet& cell : _grid) {
-            cell.value->set_layout(context.transform(cell.shape, transform_command::level));
+            cell.value->set_layout_retained(context.transform(cell.shape, transform_command::level));
         }
+        build_hitbox_index();
     }
 
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible) {
             for (hilet& cell : _grid) {
-                cell.value->draw(context);
+                cell.value->draw_retained(context);
             }
         }
     }
@@ -321,9 +325,15 @@ public:
         hi_axiom(loop::main().on_thread());
 
         if (*mode >= widget_mode::partial) {
+            if (_hitbox_generation != detail::widget_visibility_generation) {
+                // A cell was shown or hidden since the index was built.
+                build_hitbox_index();
+            }
+
+            // Only test the cells which may be hit; in the same order as the cells.
             auto r = hitbox{};
-            for (hilet& cell : _grid) {
-                r = cell.value->hitbox_test_from_parent(position, r);
+            for (hilet i : _hitbox_index.find(position)) {
+                r = _grid[i].value->hitbox_test_from_parent(position, r);
             }
             return r;
         } else {
@@ -333,6 +343,41 @@ public:
     /// @endprivatesection
 private:
     grid_layout<std::unique_ptr<widget>> _grid;
+
+    /** The area where the mouse may hit each cell, in the same order as `_grid`.
+     */
+    mutable std::vector<aarectangle> _hitbox_bounds;
+
+    /** Index for finding the cells under the mouse cursor, built after layout.
+     */
+    mutable spatial_grid _hitbox_index;
+
+    /** The value of `detail::widget_visibility_generation` when `_hitbox_index` was built.
+     */
+    mutable std::size_t _hitbox_generation = 0;
+
+    /** Build the index from the layout of the cells.
+     *
+     * Invisible cells get an empty area, so that they are never hit.
+     */
+    void build_hitbox_index() const noexcept
+    {
+        _hitbox_bounds.clear();
+        for (hilet& cell : _grid) {
+            _hitbox_bounds.push_back(
+                cell.value->visible() ? cell.value->layout().to_parent * hitbox_bounds(*cell.value) : aarectangle{});
+        }
+        _hitbox_index.build(_hitbox_bounds);
+        _hitbox_generation = detail::widget_visibility_generation;
+    }
+
+    /** Clear the index when the cells change; it will be rebuilt on the next layout.
+     */
+    void clear_hitbox_index() noexcept
+    {
+        _hitbox_bounds.clear();
+        _hitbox_index.build(_hitbox_bounds);
+    }
 };
 
 }} // namespace hi::v1
@@ -0,0 +1,151 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "grid_widget.hpp"
+#include "../GUI/gui_window_headless.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+
+using namespace hi;
+
+namespace {
+
+/** A cell which is hit anywhere inside its rectangle.
+ *
+ * The cell does not check its own mode, so that only the grid decides if an
+ * invisible cell can be hit.
+ */
+class cell_test_widget final : public widget {
+public:
+    cell_test_widget(not_null<widget_intf const *> parent) noexcept : widget(parent) {}
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        _layout = {};
+        hilet size = extent2{50.0f, 20.0f};
+        return {size, size, size};
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        _layout = context;
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+
+    [[nodiscard]] hitbox hitbox_test(point2 position) const noexcept override
+    {
+        if (layout().contains(position)) {
+            return hitbox{id, _layout.elevation};
+        } else {
+            return {};
+        }
+    }
+};
+
+/** A top-level widget with a grid of two cells, one above the other.
+ */
+class grid_test_widget final : public widget {
+public:
+    std::unique_ptr<grid_widget> grid;
+    cell_test_widget *top_cell = nullptr;
+    cell_test_widget *bottom_cell = nullptr;
+
+    grid_test_widget() noexcept : widget(nullptr)
+    {
+        grid = std::make_unique<grid_widget>(this);
+        top_cell = &grid->emplace_bottom<cell_test_widget>();
+        bottom_cell = &grid->emplace_bottom<cell_test_widget>();
+    }
+
+    [[nodiscard]] generator<widget_intf&> children(bool include_invisible) noexcept override
+    {
+        co_yield *grid;
+    }
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        _layout = {};
+        return grid->update_constraints_retained();
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        _layout = context;
+        grid->set_layout_retained(context.transform(box_shape{context.size()}, transform_command::level));
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+
+    [[nodiscard]] hitbox hitbox_test(point2 position) const noexcept override
+    {
+        return grid->hitbox_test_from_parent(position);
+    }
+
+    bool process_event(gui_event const& event) const noexcept override
+    {
+        discard_retained(event);
+        return _window ? _window->process_event(event) : true;
+    }
+
+    void set_window(gui_window_base *window) noexcept override
+    {
+        _window = window;
+    }
+
+    [[nodiscard]] gui_window_base *window() const noexcept override
+    {
+        return _window;
+    }
+
+    /** The center of a cell, in the coordinate system of this widget.
+     */
+    [[nodiscard]] point2 center(cell_test_widget const& cell) const noexcept
+    {
+        return grid->layout().to_parent * (cell.layout().to_parent * midpoint(cell.layout().rectangle()));
+    }
+
+private:
+    gui_window_base *_window = nullptr;
+};
+
+void render(gui_window_headless& window) noexcept
+{
+    std::ignore = window.render(std::chrono::utc_clock::now());
+}
+
+} // namespace
+
+TEST(grid_widget, hitbox_test)
+{
+    auto window = gui_window_headless{std::make_unique<grid_test_widget>(), extent2{50.0f, 40.0f}};
+    auto& w = window.widget<grid_test_widget>();
+    render(window);
+
+    hilet top_center = w.center(*w.top_cell);
+    hilet bottom_center = w.center(*w.bottom_cell);
+    ASSERT_EQ(w.hitbox_test(top_center).widget_id, w.top_cell->id);
+    ASSERT_EQ(w.hitbox_test(bottom_center).widget_id, w.bottom_cell->id);
+}
+
+TEST(grid_widget, hitbox_test_hidden_cell)
+{
+    auto window = gui_window_headless{std::make_unique<grid_test_widget>(), extent2{50.0f, 40.0f}};
+    auto& w = window.widget<grid_test_widget>();
+    render(window);
+
+    hilet top_center = w.center(*w.top_cell);
+    hilet bottom_center = w.center(*w.bottom_cell);
+
+    // A hidden cell is not hit, even before the grid is laid out again.
+    w.top_cell->mode = widget_mode::invisible;
+    ASSERT_EQ(w.hitbox_test(top_center).widget_id, widget_id{});
+    ASSERT_EQ(w.hitbox_test(bottom_center).widget_id, w.bottom_cell->id);
+
+    // And it is hit again when it is shown.
+    w.top_cell->mode = widget_mode::enabled;
+    ASSERT_EQ(w.hitbox_test(top_center).widget_id, w.top_cell->id);
+}
@@ -85,10 +85,12 @@ public:
                 _icon_size = extent2{narrow_cast<float>(pixmap->width()), narrow_cast<float>(pixmap->height())};
 
                 if (not(_pixmap_backing = gfx_pipeline_image::paged_image{surface(), *pixmap})) {
-                    // Could not get an image, retry.
-                    _icon_has_modified = true;
-                    ++global_counter<"icon_widget:no-backing-image:constrain">;
-                    process_event({gui_event_type::window_reconstrain});
+                    // Could not get an image, retry; except on a headless window which never has a device.
+                    if (hilet w = window(); w == nullptr or not w->headless()) {
+                        _icon_has_modified = true;
+                        ++global_counter<"icon_widget:no-backing-image:constrain">;
+                        process_event({gui_event_type::window_reconstrain});
+                    }
                 }
 
             } else if (hilet g1 = std::get_if<font_book::font_glyph_type>(&icon.read())) {
@@ -138,11 +138,13 @@ public:
             theme().large_icon_size() :
             theme().text_style(*text_style)->size * theme().scale;
 
+        // When the size changes the icon widget is marked to be constrained again,
+        // so this must be done before the children are constrained.
         _icon_widget->minimum = extent2{icon_size, icon_size};
         _icon_widget->maximum = extent2{icon_size, icon_size};
 
         for (auto& cell : _grid) {
-            cell.set_constraints(cell.value->update_constraints());
+            _grid.set_constraints(cell, cell.value->update_constraints_retained());
         }
 
         return _grid.constraints(os_settings::left_to_right());
@@ -154,14 +156,14 @@ public:
         }
 
         for (hilet& cell : _grid) {
-            cell.value->set_layout(context.transform(cell.shape, transform_command::level));
+            cell.value->set_layout_retained(context.transform(cell.shape, transform_command::level));
         }
     }
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible and overlaps(context, layout())) {
             for (hilet& cell : _grid) {
-                cell.value->draw(context);
+                cell.value->draw_retained(context);
             }
         }
     }
@@ -0,0 +1,147 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file widgets/list_delegate.hpp Defines list_delegate and some default list delegates.
+ * @ingroup widget_delegates
+ */
+
+#pragma once
+
+#include "widget.hpp"
+#include "../observer/observer.hpp"
+#include "../utility/utility.hpp"
+#include "../dispatch/dispatch.hpp"
+#include "../GUI/GUI.hpp"
+#include "../macros.hpp"
+#include <memory>
+#include <functional>
+#include <optional>
+
+hi_export_module(hikogui.widgets.list_delegate);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** A delegate that provides the rows of a list_widget.
+ *
+ * The list widget only asks for the widgets of the rows that are visible,
+ * the delegate makes a new widget for a row, or reuses a widget of a row
+ * that was scrolled out of view.
+ *
+ * @ingroup widget_delegates
+ */
+class list_delegate {
+public:
+    virtual ~list_delegate() = default;
+    virtual void init(widget_intf const& sender) noexcept {}
+    virtual void deinit(widget_intf const& sender) noexcept {}
+
+    /** The number of rows in the list.
+     */
+    [[nodiscard]] virtual size_t size(widget_intf const& sender) const noexcept
+    {
+        return 0;
+    }
+
+    /** Estimate the height of a row that has not been measured yet.
+     *
+     * @param sender The list widget.
+     * @param index The index of the row.
+     * @return The estimated height of the row, or std::nullopt to use the
+     *         average height of the rows that were measured.
+     */
+    [[nodiscard]] virtual std::optional<float> estimated_height(widget_intf const& sender, size_t index) const noexcept
+    {
+        return std::nullopt;
+    }
+
+    /** Make a widget to be displayed as a row in the list.
+     *
+     * @note It is undefined behavior if the index is beyond the end of the number of rows.
+     * @param sender The list widget that will become the owner.
+     * @param index The index of the row.
+     * @return The widget to be displayed.
+     */
+    [[nodiscard]] virtual std::unique_ptr<widget> make_row_widget(widget_intf const& sender, size_t index) noexcept = 0;
+
+    /** Reuse the widget of a row that is no longer visible for another row.
+     *
+     * @param sender The list widget that owns the widget.
+     * @param row_widget A widget that was made by `make_row_widget()`.
+     * @param index The index of the row to display with @a row_widget.
+     * @retval true The widget was changed to display the row.
+     * @retval false The widget can not be reused, a new widget will be made.
+     */
+    virtual bool recycle_row_widget(widget_intf const& sender, widget& row_widget, size_t index) noexcept
+    {
+        return false;
+    }
+
+    /** Subscribe a callback for notifying the widget that the rows have changed.
+     */
+    template<forward_of<void()> Func>
+    [[nodiscard]] callback<void()> subscribe(Func&& func, callback_flags flags = callback_flags::synchronous) noexcept
+    {
+        return _notifier.subscribe(std::forward<Func>(func), flags);
+    }
+
+protected:
+    notifier<void()> _notifier;
+};
+
+/** A delegate that provides the rows of a list_widget using a function.
+ *
+ * @ingroup widget_delegates
+ */
+class default_list_delegate : public list_delegate {
+public:
+    using make_row_widget_type = std::function<std::unique_ptr<widget>(widget_intf const&, size_t)>;
+    using recycle_row_widget_type = std::function<bool(widget&, size_t)>;
+
+    /** The number of rows in the list.
+     */
+    observer<size_t> num_rows;
+
+    /** Construct a default list delegate.
+     *
+     * @param num_rows The number of rows, or an observer of the number of rows.
+     * @param make_row_widget A function `std::unique_ptr<widget>(widget_intf const& parent, size_t index)`
+     *                        which makes the widget of a row.
+     * @param recycle_row_widget An optional function `bool(widget& row_widget, size_t index)`
+     *                           which changes a widget made earlier to display another row.
+     */
+    default_list_delegate(
+        forward_of<observer<size_t>> auto&& num_rows,
+        make_row_widget_type make_row_widget,
+        recycle_row_widget_type recycle_row_widget = {}) noexcept :
+        num_rows(hi_forward(num_rows)),
+        _make_row_widget(std::move(make_row_widget)),
+        _recycle_row_widget(std::move(recycle_row_widget))
+    {
+        _num_rows_cbt = this->num_rows.subscribe([&](auto...) {
+            this->_notifier();
+        });
+    }
+
+    [[nodiscard]] size_t size(widget_intf const& sender) const noexcept override
+    {
+        return *num_rows;
+    }
+
+    [[nodiscard]] std::unique_ptr<widget> make_row_widget(widget_intf const& sender, size_t index) noexcept override
+    {
+        return _make_row_widget(sender, index);
+    }
+
+    bool recycle_row_widget(widget_intf const& sender, widget& row_widget, size_t index) noexcept override
+    {
+        return _recycle_row_widget and _recycle_row_widget(row_widget, index);
+    }
+
+private:
+    make_row_widget_type _make_row_widget;
+    recycle_row_widget_type _recycle_row_widget;
+    callback<void(size_t)> _num_rows_cbt;
+};
+
+}} // namespace hi::v1
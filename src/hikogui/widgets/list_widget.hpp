@@ -0,0 +1,393 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+/** @file widgets/list_widget.hpp Defines list_widget.
+ * @ingroup widgets
+ */
+
+#pragma once
+
+#include "widget.hpp"
+#include "list_delegate.hpp"
+#include "../container/container.hpp"
+#include "../layout/layout.hpp"
+#include "../coroutine/coroutine.hpp"
+#include "../macros.hpp"
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <coroutine>
+
+hi_export_module(hikogui.widgets.list_widget);
+
+hi_export namespace hi { inline namespace v1 {
+
+/** A GUI widget that displays a very large list of rows.
+ * @ingroup widgets
+ *
+ * Only the rows that are visible, plus a few rows above and below them,
+ * have a widget. These widgets are made by the delegate when a row scrolls
+ * into view, and are reused for other rows when they scroll out of view.
+ *
+ * The height of each row is estimated until it has been visible; the total
+ * height of the list, which determines the extent of the scroll bars, is
+ * refined while rows are measured.
+ *
+ * The list widget is normally placed inside a `vertical_scroll_widget`:
+ *
+ * ```cpp
+ * auto& list = scroll.emplace<list_widget>(100'000, [](widget_intf const& parent, size_t index) {
+ *     return std::make_unique<label_widget>(&parent, txt(std::format("row {}", index)));
+ * });
+ * ```
+ */
+class list_widget : public widget {
+public:
+    using super = widget;
+    using delegate_type = list_delegate;
+
+    not_null<std::shared_ptr<delegate_type>> delegate;
+
+    /** The number of rows above and below the visible rows that also have a widget.
+     */
+    observer<size_t> overscan = 4;
+
+    template<typename... Args>
+    [[nodiscard]] static not_null<std::shared_ptr<delegate_type>> make_default_delegate(Args&&...args)
+        requires std::constructible_from<default_list_delegate, Args...>
+    {
+        return make_shared_not_null<default_list_delegate>(std::forward<Args>(args)...);
+    }
+
+    ~list_widget()
+    {
+        delegate->deinit(*this);
+    }
+
+    /** Construct a list widget with a delegate.
+     *
+     * @param parent The owner of the list widget.
+     * @param delegate The delegate which provides the rows of the list.
+     */
+    list_widget(not_null<widget_intf const *> parent, not_null<std::shared_ptr<delegate_type>> delegate) noexcept :
+        super(parent), delegate(std::move(delegate))
+    {
+        _delegate_cbt = this->delegate->subscribe(
+            [&] {
+                ++global_counter<"list_widget:delegate:constrain">;
+                _reset = true;
+                process_event({gui_event_type::window_reconstrain});
+            },
+            callback_flags::main);
+
+        _overscan_cbt = overscan.subscribe([&](auto...) {
+            ++global_counter<"list_widget:overscan:relayout">;
+            process_event({gui_event_type::window_relayout});
+        });
+
+        this->delegate->init(*this);
+    }
+
+    /** Construct a list widget with a default delegate.
+     *
+     * @param parent The owner of the list widget.
+     * @param args The number of rows, and the functions to make and reuse the widget of a row;
+     *             passed to the constructor of `default_list_delegate`.
+     */
+    template<typename... Args>
+    list_widget(not_null<widget_intf const *> parent, Args&&...args) noexcept
+        requires requires { make_default_delegate(std::forward<Args>(args)...); }
+        : list_widget(parent, make_default_delegate(std::forward<Args>(args)...))
+    {
+    }
+
+    /** The number of rows that currently have a widget.
+     */
+    [[nodiscard]] size_t num_row_widgets() const noexcept
+    {
+        return _rows.size();
+    }
+
+    /// @privatesection
+    [[nodiscard]] generator<widget_intf&> children(bool include_invisible) noexcept override
+    {
+        for (hilet& row : _rows) {
+            co_yield *row.child;
+        }
+    }
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        _layout = {};
+
+        if (std::exchange(_reset, false) or _heights.size() != delegate->size(*this)) {
+            reset();
+        }
+
+        measure_rows();
+        return _constraints = make_constraints();
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        _layout = context;
+
+        update_rows();
+
+        // Rows that were made in update_rows() need to be measured before they are positioned.
+        measure_rows();
+
+        hilet left = 0.0f;
+        hilet width = context.width();
+        for (auto& row : _rows) {
+            hilet top = context.height() - row_offset(row.index);
+            hilet height = row.constraints.preferred.height();
+            hilet row_width = std::max(width, row.constraints.minimum.width());
+            hilet shape = box_shape{row.constraints, aarectangle{left, top - height, row_width, height}, theme().baseline_adjustment()};
+            row.child->set_layout_retained(context.transform(shape, transform_command::level));
+        }
+
+        if (make_constraints() != _constraints) {
+            // The measured rows changed the height of the list, which changes the scroll bars;
+            // or the rows with the widest constraints were added or removed.
+            ++global_counter<"list_widget:measured:constrain">;
+            process_event({gui_event_type::window_reconstrain});
+        }
+    }
+
+    void draw(draw_context const& context) noexcept override
+    {
+        if (*mode > widget_mode::invisible) {
+            for (hilet& row : _rows) {
+                row.child->draw_retained(context);
+            }
+        }
+    }
+
+    [[nodiscard]] hitbox hitbox_test(point2 position) const noexcept override
+    {
+        hi_axiom(loop::main().on_thread());
+
+        if (*mode >= widget_mode::partial) {
+            auto r = hitbox{};
+            for (hilet& row : _rows) {
+                r = row.child->hitbox_test_from_parent(position, r);
+            }
+            return r;
+        } else {
+            return {};
+        }
+    }
+    /// @endprivatesection
+private:
+    struct row_type {
+        size_t index;
+        std::unique_ptr<widget> child;
+        box_constraints constraints = {};
+    };
+
+    /** The rows that have a widget, ordered by index.
+     */
+    std::vector<row_type> _rows;
+
+    /** Widgets of rows that scrolled out of view, to be reused.
+     */
+    std::vector<std::unique_ptr<widget>> _recycled;
+
+    /** The height of each row, measured or estimated, including the margin below the row.
+     */
+    fenwick_tree<double> _heights;
+
+    /** For each row if its height was measured.
+     */
+    std::vector<bool> _measured;
+
+    /** The sum and number of the heights of the measured rows, used for estimating the height of other rows.
+     */
+    double _measured_sum = 0.0;
+    size_t _measured_count = 0;
+
+    /** The constraints that were returned by update_constraints().
+     */
+    box_constraints _constraints = {};
+
+    /** The widths and margins of the list, from the constraints of the rows that have a widget.
+     */
+    float _minimum_width = 0.0f;
+    float _preferred_width = 0.0f;
+    hi::margins _margins = {};
+
+    /** The rows need to be made again, because the delegate has changed.
+     */
+    bool _reset = true;
+
+    callback<void()> _delegate_cbt;
+    callback<void(size_t)> _overscan_cbt;
+
+    /** The height of a row when neither the delegate nor any measured row can tell.
+     */
+    [[nodiscard]] float default_row_height() const noexcept
+    {
+        if (_measured_count != 0) {
+            return narrow_cast<float>(_measured_sum / narrow_cast<double>(_measured_count));
+        } else {
+            return theme().size() + theme().margin<float>();
+        }
+    }
+
+    [[nodiscard]] float total_height() const noexcept
+    {
+        return narrow_cast<float>(_heights.sum());
+    }
+
+    /** The distance from the top of the list to the top of a row.
+     */
+    [[nodiscard]] float row_offset(size_t index) const noexcept
+    {
+        return narrow_cast<float>(_heights.prefix_sum(index));
+    }
+
+    /** Remove all rows, and estimate the height of each row.
+     */
+    void reset() noexcept
+    {
+        for (auto& row : _rows) {
+            _recycled.push_back(std::move(row.child));
+        }
+        _rows.clear();
+
+        // The measurements of the previous rows do not tell anything about the new rows.
+        _measured_sum = 0.0;
+        _measured_count = 0;
+
+        hilet num_rows = delegate->size(*this);
+        hilet default_height = default_row_height();
+
+        auto heights = std::vector<double>{};
+        heights.reserve(num_rows);
+        for (auto i = 0_uz; i != num_rows; ++i) {
+            heights.push_back(delegate->estimated_height(*this, i).value_or(default_height));
+        }
+        _heights = fenwick_tree<double>{std::span<double const>{heights}};
+        _measured.assign(num_rows, false);
+    }
+
+    /** The constraints of the list, from the measured and estimated rows.
+     */
+    [[nodiscard]] box_constraints make_constraints() const noexcept
+    {
+        auto r = box_constraints{};
+        r.minimum = extent2{_minimum_width, 0.0f};
+        r.preferred = extent2{_preferred_width, total_height()};
+        r.maximum = extent2::large();
+        r.margins = _margins;
+        return r;
+    }
+
+    /** Measure the rows that have a widget.
+     *
+     * The widths and margins are recalculated from these rows, so that the
+     * list shrinks again when its widest rows scroll out of view.
+     */
+    void measure_rows() noexcept
+    {
+        _minimum_width = 0.0f;
+        _preferred_width = 0.0f;
+        _margins = {};
+
+        for (auto& row : _rows) {
+            measure(row);
+        }
+    }
+
+    /** Update the constraints of a row, and its height in the list.
+     */
+    void measure(row_type& row) noexcept
+    {
+        row.constraints = row.child->update_constraints_retained();
+
+        inplace_max(_minimum_width, row.constraints.minimum.width());
+        inplace_max(_preferred_width, row.constraints.preferred.width());
+        inplace_max(_margins.left(), row.constraints.margins.left());
+        inplace_max(_margins.right(), row.constraints.margins.right());
+
+        // Rows are separated by a single margin.
+        hilet height = row.constraints.preferred.height() + std::max(row.constraints.margins.bottom(), row.constraints.margins.top());
+        if (not _measured[row.index]) {
+            _measured[row.index] = true;
+            _measured_sum += height;
+            ++_measured_count;
+        }
+        if (_heights[row.index] != height) {
+            _heights.set(row.index, height);
+        }
+    }
+
+    /** Make or reuse the widgets of the rows that are visible, and remove the others.
+     */
+    void update_rows() noexcept
+    {
+        if (_heights.empty()) {
+            for (auto& row : _rows) {
+                _recycled.push_back(std::move(row.child));
+            }
+            _rows.clear();
+            return;
+        }
+
+        // The clipping rectangle is the visible part of the list; the rows are counted from the top.
+        hilet top_offset = std::max(0.0f, _layout.height() - _layout.clipping_rectangle.top());
+        hilet bottom_offset = std::max(0.0f, _layout.height() - _layout.clipping_rectangle.bottom());
+        hilet first_visible = std::min(_heights.find(top_offset), _heights.size() - 1);
+        hilet last_visible = std::min(_heights.find(bottom_offset) + 1, _heights.size());
+
+        hilet first = first_visible - std::min(first_visible, *overscan);
+        hilet last = std::min(last_visible + *overscan, _heights.size());
+
+        // Recycle the widgets of the rows that are no longer visible.
+        std::erase_if(_rows, [&](row_type& row) {
+            if (row.index >= first and row.index < last) {
+                return false;
+            }
+            _recycled.push_back(std::move(row.child));
+            return true;
+        });
+
+        auto new_rows = std::vector<row_type>{};
+        new_rows.reserve(last - first);
+        auto it = _rows.begin();
+        for (auto i = first; i != last; ++i) {
+            if (it != _rows.end() and it->index == i) {
+                new_rows.push_back(std::move(*it++));
+            } else {
+                new_rows.push_back(row_type{i, make_row_widget(i)});
+            }
+        }
+        _rows = std::move(new_rows);
+
+        // Keep no more widgets for reuse than are needed when scrolling a full page.
+        if (_recycled.size() > _rows.size()) {
+            _recycled.resize(_rows.size());
+        }
+    }
+
+    [[nodiscard]] std::unique_ptr<widget> make_row_widget(size_t index) noexcept
+    {
+        while (not _recycled.empty()) {
+            auto row_widget = std::move(_recycled.back());
+            _recycled.pop_back();
+
+            if (delegate->recycle_row_widget(*this, *row_widget, index)) {
+                ++global_counter<"list_widget:row:recycle">;
+                row_widget->discard_retained(gui_event_type::window_reconstrain);
+                return row_widget;
+            }
+        }
+
+        ++global_counter<"list_widget:row:make">;
+        return delegate->make_row_widget(*this, index);
+    }
+};
+
+}} // namespace hi::v1
@@ -0,0 +1,269 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "list_widget.hpp"
+#include "../GUI/gui_window_headless.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+using namespace hi;
+
+namespace {
+
+/** The widget of a row, the first row is wider than the other rows.
+ */
+class row_test_widget final : public widget {
+public:
+    size_t index;
+
+    row_test_widget(not_null<widget_intf const *> parent, size_t index) noexcept : widget(parent), index(index) {}
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        _layout = {};
+        hilet size = extent2{index == 0 ? 200.0f : 50.0f, 20.0f};
+        return {size, size, size};
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        _layout = context;
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+};
+
+/** A delegate which counts how often the widget of a row is made and reused.
+ */
+class test_list_delegate final : public list_delegate {
+public:
+    size_t num_rows;
+    std::optional<float> estimate;
+    int num_made = 0;
+    int num_recycled = 0;
+
+    test_list_delegate(size_t num_rows, std::optional<float> estimate) noexcept : num_rows(num_rows), estimate(estimate) {}
+
+    [[nodiscard]] size_t size(widget_intf const& sender) const noexcept override
+    {
+        return num_rows;
+    }
+
+    [[nodiscard]] std::optional<float> estimated_height(widget_intf const& sender, size_t index) const noexcept override
+    {
+        return estimate;
+    }
+
+    [[nodiscard]] std::unique_ptr<widget> make_row_widget(widget_intf const& sender, size_t index) noexcept override
+    {
+        ++num_made;
+        return std::make_unique<row_test_widget>(&sender, index);
+    }
+
+    bool recycle_row_widget(widget_intf const& sender, widget& row_widget, size_t index) noexcept override
+    {
+        ++num_recycled;
+        dynamic_cast<row_test_widget&>(row_widget).index = index;
+        return true;
+    }
+};
+
+/** A top-level widget which scrolls a list in a 100 x 110 window.
+ */
+class list_test_widget final : public widget {
+public:
+    /** The distance from the top of the list to the top of the window.
+     */
+    float scroll_offset = 0.0f;
+
+    /** The constraints returned by the list.
+     */
+    box_constraints list_constraints = {};
+
+    std::shared_ptr<test_list_delegate> delegate;
+    std::unique_ptr<list_widget> list;
+
+    list_test_widget(size_t num_rows, std::optional<float> estimate) noexcept : widget(nullptr)
+    {
+        delegate = std::make_shared<test_list_delegate>(num_rows, estimate);
+        list = std::make_unique<list_widget>(this, not_null<std::shared_ptr<list_delegate>>{delegate});
+    }
+
+    [[nodiscard]] generator<widget_intf&> children(bool include_invisible) noexcept override
+    {
+        co_yield *list;
+    }
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        _layout = {};
+        list_constraints = list->update_constraints_retained();
+
+        hilet size = extent2{100.0f, 110.0f};
+        return {size, size, size};
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        _layout = context;
+
+        hilet width = std::max(context.width(), list_constraints.minimum.width());
+        hilet height = list_constraints.preferred.height();
+        hilet rectangle = aarectangle{0.0f, context.height() - height + scroll_offset, width, height};
+        hilet shape = box_shape{list_constraints, rectangle, 0.0f};
+
+        // Only the part of the list inside the window is visible.
+        list->set_layout_retained(context.transform(shape, transform_command::level, context.rectangle()));
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+
+    bool process_event(gui_event const& event) const noexcept override
+    {
+        discard_retained(event);
+        return _window ? _window->process_event(event) : true;
+    }
+
+    void set_window(gui_window_base *window) noexcept override
+    {
+        _window = window;
+    }
+
+    [[nodiscard]] gui_window_base *window() const noexcept override
+    {
+        return _window;
+    }
+
+    /** Get the index of each row that has a widget.
+     */
+    [[nodiscard]] std::vector<size_t> row_indices() const noexcept
+    {
+        auto r = std::vector<size_t>{};
+        for (auto& child : list->children(false)) {
+            r.push_back(dynamic_cast<row_test_widget&>(child).index);
+        }
+        return r;
+    }
+
+private:
+    gui_window_base *_window = nullptr;
+};
+
+[[nodiscard]] std::vector<size_t> make_indices(size_t first, size_t last) noexcept
+{
+    auto r = std::vector<size_t>{};
+    for (auto i = first; i != last; ++i) {
+        r.push_back(i);
+    }
+    return r;
+}
+
+/** Render a few frames, so that the list can measure the rows that became visible.
+ */
+void render(gui_window_headless& window) noexcept
+{
+    for (auto i = 0; i != 3; ++i) {
+        std::ignore = window.render(std::chrono::utc_clock::now());
+    }
+}
+
+} // namespace
+
+TEST(list_widget, visible_rows)
+{
+    auto window = gui_window_headless{std::make_unique<list_test_widget>(1000, 20.0f), extent2{100.0f, 110.0f}};
+    auto& w = window.widget<list_test_widget>();
+    render(window);
+
+    // Rows 0 to 5 are visible, followed by 4 rows of overscan.
+    ASSERT_EQ(w.row_indices(), make_indices(0, 10));
+    ASSERT_EQ(w.list->num_row_widgets(), 10_uz);
+    ASSERT_EQ(w.delegate->num_made, 10);
+    ASSERT_EQ(w.delegate->num_recycled, 0);
+
+    // The estimated heights were correct.
+    ASSERT_EQ(w.list_constraints.preferred.height(), 1000.0f * 20.0f);
+}
+
+TEST(list_widget, recycle_rows)
+{
+    auto window = gui_window_headless{std::make_unique<list_test_widget>(1000, 20.0f), extent2{100.0f, 110.0f}};
+    auto& w = window.widget<list_test_widget>();
+    render(window);
+
+    // Rows 50 to 55 are visible, with 4 rows of overscan on both sides.
+    w.scroll_offset = 1000.0f;
+    ASSERT_TRUE(w.process_event({gui_event_type::window_relayout}));
+    render(window);
+    ASSERT_EQ(w.row_indices(), make_indices(46, 60));
+
+    // The widgets of the 10 rows that scrolled out of view are reused.
+    ASSERT_EQ(w.delegate->num_recycled, 10);
+    ASSERT_EQ(w.delegate->num_made, 14);
+
+    // Scrolling back only reuses widgets.
+    w.scroll_offset = 0.0f;
+    ASSERT_TRUE(w.process_event({gui_event_type::window_relayout}));
+    render(window);
+    ASSERT_EQ(w.row_indices(), make_indices(0, 10));
+    ASSERT_EQ(w.delegate->num_recycled, 20);
+    ASSERT_EQ(w.delegate->num_made, 14);
+}
+
+TEST(list_widget, width_of_visible_rows)
+{
+    auto window = gui_window_headless{std::make_unique<list_test_widget>(1000, 20.0f), extent2{100.0f, 110.0f}};
+    auto& w = window.widget<list_test_widget>();
+    render(window);
+    ASSERT_EQ(w.list_constraints.minimum.width(), 200.0f);
+
+    // The list becomes narrower when the wide first row scrolls out of view.
+    w.scroll_offset = 1000.0f;
+    ASSERT_TRUE(w.process_event({gui_event_type::window_relayout}));
+    render(window);
+    ASSERT_EQ(w.list_constraints.minimum.width(), 50.0f);
+
+    // And wider when it scrolls into view again.
+    w.scroll_offset = 0.0f;
+    ASSERT_TRUE(w.process_event({gui_event_type::window_relayout}));
+    render(window);
+    ASSERT_EQ(w.list_constraints.minimum.width(), 200.0f);
+}
+
+TEST(list_widget, estimated_height)
+{
+    auto window = gui_window_headless{std::make_unique<list_test_widget>(1000, 10.0f), extent2{100.0f, 110.0f}};
+    auto& w = window.widget<list_test_widget>();
+    render(window);
+
+    // In the first frame rows 0 to 11 were visible using the estimated height,
+    // followed by 4 rows of overscan. These 16 rows were measured.
+    ASSERT_EQ(w.list_constraints.preferred.height(), 16.0f * 20.0f + 984.0f * 10.0f);
+
+    // Only the rows that are visible using the measured height keep their widget.
+    ASSERT_EQ(w.row_indices(), make_indices(0, 10));
+}
+
+TEST(list_widget, reset)
+{
+    // The delegate does not estimate, so the list estimates from the measured rows.
+    auto window = gui_window_headless{std::make_unique<list_test_widget>(1000, std::nullopt), extent2{100.0f, 110.0f}};
+    auto& w = window.widget<list_test_widget>();
+    render(window);
+
+    // A list with new rows estimates the same as a new list.
+    w.delegate->num_rows = 500;
+    ASSERT_TRUE(w.list->process_event({gui_event_type::window_reconstrain}));
+    render(window);
+
+    auto expected_window = gui_window_headless{std::make_unique<list_test_widget>(500, std::nullopt), extent2{100.0f, 110.0f}};
+    auto& expected = expected_window.widget<list_test_widget>();
+    render(expected_window);
+
+    ASSERT_EQ(w.list_constraints, expected.list_constraints);
+    ASSERT_EQ(w.row_indices(), expected.row_indices());
+}
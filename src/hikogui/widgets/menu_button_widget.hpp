@@ -224,21 +224,21 @@ public:
 
         for (auto& cell : _grid) {
             if (cell.value == grid_cell_type::button) {
-                auto constraints = _button_widget->update_constraints();
+                auto constraints = _button_widget->update_constraints_retained();
                 inplace_max(constraints.minimum.width(), theme().size() * 2.0f);
                 inplace_max(constraints.preferred.width(), theme().size() * 2.0f);
                 inplace_max(constraints.maximum.width(), theme().size() * 2.0f);
-                cell.set_constraints(constraints);
+                _grid.set_constraints(cell, constraints);
 
             } else if (cell.value == grid_cell_type::label) {
-                cell.set_constraints(_label_widget->update_constraints());
+                _grid.set_constraints(cell, _label_widget->update_constraints_retained());
 
             } else if (cell.value == grid_cell_type::shortcut) {
-                auto constraints = _shortcut_widget->update_constraints();
+                auto constraints = _shortcut_widget->update_constraints_retained();
                 inplace_max(constraints.minimum.width(), theme().size() * 3.0f);
                 inplace_max(constraints.preferred.width(), theme().size() * 3.0f);
                 inplace_max(constraints.maximum.width(), theme().size() * 3.0f);
-                cell.set_constraints(constraints);
+                _grid.set_constraints(cell, constraints);
 
             } else {
                 hi_no_default();
@@ -263,13 +263,13 @@ public:
 
         for (hilet& cell : _grid) {
             if (cell.value == grid_cell_type::button) {
-                _button_widget->set_layout(context.transform(cell.shape, transform_command::level));
+                _button_widget->set_layout_retained(context.transform(cell.shape, transform_command::level));
 
             } else if (cell.value == grid_cell_type::label) {
-                _label_widget->set_layout(context.transform(cell.shape));
+                _label_widget->set_layout_retained(context.transform(cell.shape));
 
             } else if (cell.value == grid_cell_type::shortcut) {
-                _shortcut_widget->set_layout(context.transform(cell.shape));
+                _shortcut_widget->set_layout_retained(context.transform(cell.shape));
 
             } else {
                 hi_no_default();
@@ -286,13 +286,13 @@ public:
 
             for (hilet& cell : _grid) {
                 if (cell.value == grid_cell_type::button) {
-                    _button_widget->draw(context);
+                    _button_widget->draw_retained(context);
 
                 } else if (cell.value == grid_cell_type::label) {
-                    _label_widget->draw(context);
+                    _label_widget->draw_retained(context);
 
                 } else if (cell.value == grid_cell_type::shortcut) {
-                    _shortcut_widget->draw(context);
+                    _shortcut_widget->draw_retained(context);
 
                 } else {
                     hi_no_default();
@@ -91,7 +91,7 @@ public:
     [[nodiscard]] box_constraints update_constraints() noexcept override
     {
         _layout = {};
-        _content_constraints = _content->update_constraints();
+        _content_constraints = _content->update_constraints_retained();
         return _content_constraints;
     }
     void set_layout(widget_layout const& context) noexcept override
@@ -105,7 +105,7 @@ public:
         _content_shape = box_shape{_content_constraints, content_rectangle, theme().baseline_adjustment()};
 
         // The content should not draw in the border of the overlay, so give a tight clipping rectangle.
-        _content->set_layout(_layout.transform(_content_shape, context.rectangle()));
+        _content->set_layout_retained(_layout.transform(_content_shape, context.rectangle()));
     }
     void draw(draw_context const& context) noexcept override
     {
@@ -113,7 +113,7 @@ public:
             if (overlaps(context, layout())) {
                 draw_background(context);
             }
-            _content->draw(context);
+            _content->draw_retained(context);
         }
     }
     [[nodiscard]] color background_color() const noexcept override
@@ -100,7 +100,7 @@ public:
     [[nodiscard]] box_constraints update_constraints() noexcept override
     {
         _layout = {};
-        _content_constraints = _content->update_constraints();
+        _content_constraints = _content->update_constraints_retained();
 
         // The aperture can scroll so its minimum width and height are zero.
         auto aperture_constraints = _content_constraints;
@@ -143,13 +143,13 @@ public:
 
         // The content needs to be at a higher elevation, so that hitbox check
         // will work correctly for handling scrolling with mouse wheel.
-        _content->set_layout(context.transform(_content_shape, transform_command::level, context.rectangle()));
+        _content->set_layout_retained(context.transform(_content_shape, transform_command::level, context.rectangle()));
     }
 
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible) {
-            _content->draw(context);
+            _content->draw_retained(context);
         }
     }
 
@@ -108,14 +108,14 @@ public:
         }
     }
 
-    [[nodiscard]] bool visible() const noexcept
+    [[nodiscard]] bool scrollable() const noexcept
     {
         return *aperture < *content;
     }
 
     void draw(draw_context const& context) noexcept override
     {
-        if (*mode > widget_mode::invisible and overlaps(context, layout()) and visible()) {
+        if (*mode > widget_mode::invisible and overlaps(context, layout()) and scrollable()) {
             draw_rails(context);
             draw_slider(context);
         }
@@ -125,7 +125,7 @@ public:
     {
         hi_axiom(loop::main().on_thread());
 
-        if (*mode >= widget_mode::partial and layout().contains(position) and visible() and
+        if (*mode >= widget_mode::partial and layout().contains(position) and scrollable() and
             _slider_rectangle.contains(position)) {
             return {id, _layout.elevation, hitbox_type::scroll_bar};
         } else {
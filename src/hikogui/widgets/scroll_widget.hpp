@@ -121,7 +121,7 @@ public:
         _layout = {};
 
         for (auto& cell : _grid) {
-            cell.set_constraints(cell.value->update_constraints());
+            _grid.set_constraints(cell, cell.value->update_constraints_retained());
         }
         auto grid_constraints = _grid.constraints(os_settings::left_to_right());
         return grid_constraints.constrain(*minimum, *maximum);
@@ -140,15 +140,15 @@ public:
                 // This is the content. Move the content slightly when the scroll-bars aren't visible.
                 // The grid cells are always ordered in row-major.
                 // This the vertical scroll bar is _grid[1] and the horizontal scroll bar is _grid[2].
-                if (not _vertical_scroll_bar->visible()) {
+                if (not _vertical_scroll_bar->scrollable()) {
                     shape.rectangle = aarectangle{0, shape.y(), _layout.width(), shape.height()};
                 }
-                if (not _horizontal_scroll_bar->visible()) {
+                if (not _horizontal_scroll_bar->scrollable()) {
                     shape.rectangle = aarectangle{shape.x(), 0, shape.width(), _layout.height()};
                 }
             }
 
-            cell.value->set_layout(context.transform(shape, transform_command::level));
+            cell.value->set_layout_retained(context.transform(shape, transform_command::level));
         }
     }
 
@@ -156,7 +156,7 @@ public:
     {
         if (*mode > widget_mode::invisible) {
             for (hilet& cell : _grid) {
-                cell.value->draw(context);
+                cell.value->draw_retained(context);
             }
         }
     }
@@ -188,17 +188,19 @@ public:
         hi_assert_not_null(_overlay_widget);
 
         _layout = {};
-        _off_label_constraints = _off_label_widget->update_constraints();
-        _current_label_constraints = _current_label_widget->update_constraints();
-        _overlay_constraints = _overlay_widget->update_constraints();
+
+        // Make it so that the scroll widget can scroll vertically.
+        // This is set before the overlay is constrained, as it changes the constraints of the scroll widget.
+        _scroll_widget->minimum.copy()->height() = theme().size();
+
+        _off_label_constraints = _off_label_widget->update_constraints_retained();
+        _current_label_constraints = _current_label_widget->update_constraints_retained();
+        _overlay_constraints = _overlay_widget->update_constraints_retained();
 
         hilet extra_size = extent2{theme().size() + theme().margin<float>() * 2.0f, theme().margin<float>() * 2.0f};
 
         auto r = max(_off_label_constraints + extra_size, _current_label_constraints + extra_size);
 
-        // Make it so that the scroll widget can scroll vertically.
-        _scroll_widget->minimum.copy()->height() = theme().size();
-
         r.minimum.width() = std::max(r.minimum.width(), _overlay_constraints.minimum.width() + extra_size.width());
         r.preferred.width() = std::max(r.preferred.width(), _overlay_constraints.preferred.width() + extra_size.width());
         r.maximum.width() = std::max(r.maximum.width(), _overlay_constraints.maximum.width() + extra_size.width());
@@ -254,10 +256,10 @@ public:
         hilet overlay_rectangle_request = aarectangle{overlay_x, overlay_y, overlay_width, overlay_height};
         hilet overlay_rectangle = make_overlay_rectangle(overlay_rectangle_request);
         _overlay_shape = box_shape{_overlay_constraints, overlay_rectangle, theme().baseline_adjustment()};
-        _overlay_widget->set_layout(context.transform(_overlay_shape, transform_command::overlay));
+        _overlay_widget->set_layout_retained(context.transform(_overlay_shape, transform_command::overlay));
 
-        _off_label_widget->set_layout(context.transform(_off_label_shape));
-        _current_label_widget->set_layout(context.transform(_current_label_shape));
+        _off_label_widget->set_layout_retained(context.transform(_off_label_shape));
+        _current_label_widget->set_layout_retained(context.transform(_current_label_shape));
     }
 
     void draw(draw_context const& context) noexcept override
@@ -270,12 +272,12 @@ public:
                 draw_left_box(context);
                 draw_chevrons(context);
 
-                _off_label_widget->draw(context);
-                _current_label_widget->draw(context);
+                _off_label_widget->draw_retained(context);
+                _current_label_widget->draw_retained(context);
             }
 
             // Overlay is outside of the overlap of the selection widget.
-            _overlay_widget->draw(context);
+            _overlay_widget->draw_retained(context);
         }
     }
 
@@ -58,7 +58,7 @@ public:
         hi_assert_not_null(_icon_widget);
 
         _layout = {};
-        _icon_constraints = _icon_widget->update_constraints();
+        _icon_constraints = _icon_widget->update_constraints_retained();
 
         hilet size = extent2{theme().large_size(), theme().large_size()};
         return {size, size, size};
@@ -79,13 +79,13 @@ public:
                 context.height() - theme().margin<float>()};
         }
 
-        _icon_widget->set_layout(context.transform(_icon_shape));
+        _icon_widget->set_layout_retained(context.transform(_icon_shape));
     }
 
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible and overlaps(context, layout())) {
-            _icon_widget->draw(context);
+            _icon_widget->draw_retained(context);
         }
     }
 
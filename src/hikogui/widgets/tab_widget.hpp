@@ -129,7 +129,7 @@ public:
             child->mode = child.get() == &selected_child_ ? widget_mode::enabled : widget_mode::invisible;
         }
 
-        return selected_child_.update_constraints();
+        return selected_child_.update_constraints_retained();
     }
     void set_layout(widget_layout const& context) noexcept override
     {
@@ -137,7 +137,7 @@ public:
 
         for (hilet& child : _children) {
             if (*child->mode > widget_mode::invisible) {
-                child->set_layout(context);
+                child->set_layout_retained(context);
             }
         }
     }
@@ -145,7 +145,7 @@ public:
     {
         if (*mode > widget_mode::invisible) {
             for (hilet& child : _children) {
-                child->draw(context);
+                child->draw_retained(context);
             }
         }
     }
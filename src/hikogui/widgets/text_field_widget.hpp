@@ -170,7 +170,7 @@ public:
         }
 
         _layout = {};
-        _scroll_constraints = _scroll_widget->update_constraints();
+        _scroll_constraints = _scroll_widget->update_constraints_retained();
 
         hilet scroll_width = 100;
         hilet box_size = extent2{
@@ -181,11 +181,11 @@ public:
         auto margins = theme().margin();
         if (_error_label->empty()) {
             _error_label_widget->mode = widget_mode::invisible;
-            _error_label_constraints = _error_label_widget->update_constraints();
+            _error_label_constraints = _error_label_widget->update_constraints_retained();
 
         } else {
             _error_label_widget->mode = widget_mode::display;
-            _error_label_constraints = _error_label_widget->update_constraints();
+            _error_label_constraints = _error_label_widget->update_constraints_retained();
             inplace_max(size.width(), _error_label_constraints.preferred.width());
             size.height() += _error_label_constraints.margins.top() + _error_label_constraints.preferred.height();
             inplace_max(margins.left(), _error_label_constraints.margins.left());
@@ -217,17 +217,17 @@ public:
         }
 
         if (*_error_label_widget->mode > widget_mode::invisible) {
-            _error_label_widget->set_layout(context.transform(_error_label_shape));
+            _error_label_widget->set_layout_retained(context.transform(_error_label_shape));
         }
-        _scroll_widget->set_layout(context.transform(_scroll_shape));
+        _scroll_widget->set_layout_retained(context.transform(_scroll_shape));
     }
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible and overlaps(context, layout())) {
             draw_background_box(context);
 
-            _scroll_widget->draw(context);
-            _error_label_widget->draw(context);
+            _scroll_widget->draw_retained(context);
+            _error_label_widget->draw_retained(context);
         }
     }
     bool handle_event(gui_event const& event) noexcept override
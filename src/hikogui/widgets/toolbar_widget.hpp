@@ -85,7 +85,7 @@ public:
         _layout = {};
 
         for (auto& child : _children) {
-            child.set_constraints(child.value->update_constraints());
+            _children.set_constraints(child, child.value->update_constraints_retained());
         }
 
         auto r = _children.constraints(os_settings::left_to_right());
@@ -114,7 +114,7 @@ public:
             hilet child_clipping_rectangle =
                 aarectangle{child.shape.x() - overhang, 0, child.shape.width() + overhang * 2, context.height() + overhang * 2};
 
-            child.value->set_layout(context.transform(child.shape, transform_command::menu_item, child_clipping_rectangle));
+            child.value->set_layout_retained(context.transform(child.shape, transform_command::menu_item, child_clipping_rectangle));
         }
     }
     void draw(draw_context const& context) noexcept override
@@ -133,7 +133,7 @@ public:
 
             for (hilet& child : _children) {
                 hi_assert_not_null(child.value);
-                child.value->draw(context);
+                child.value->draw_retained(context);
             }
         }
     }
@@ -67,6 +67,19 @@ public:
 
         _mode_cbt = mode.subscribe([&](auto...) {
             ++global_counter<"widget:mode:constrain">;
+            visibility_changed();
+            process_event({gui_event_type::window_reconstrain});
+        });
+
+        // A parent may set the minimum and maximum while it is being constrained,
+        // the widget must then be constrained again instead of returning its retained constraints.
+        _minimum_cbt = minimum.subscribe([&](auto...) {
+            ++global_counter<"widget:minimum:constrain">;
+            process_event({gui_event_type::window_reconstrain});
+        });
+
+        _maximum_cbt = maximum.subscribe([&](auto...) {
+            ++global_counter<"widget:maximum:constrain">;
             process_event({gui_event_type::window_reconstrain});
         });
 
@@ -93,6 +106,16 @@ public:
         co_return;
     }
 
+    /** Check if the widget is visible.
+     *
+     * This is final, the visibility of a widget is only changed through its mode,
+     * so that `visibility_changed()` is called on each change.
+     */
+    [[nodiscard]] bool visible() const noexcept final
+    {
+        return *mode > widget_mode::invisible;
+    }
+
     /** Find the widget that is under the mouse cursor.
      * This function will recursively test with visual child widgets, when
      * widgets overlap on the screen the hitbox object with the highest elevation is returned.
@@ -159,6 +182,9 @@ public:
      */
     bool process_event(gui_event const& event) const noexcept override
     {
+        // The event bubbles up, so the parents discard what they retained as well.
+        discard_retained(event);
+
         if (parent != nullptr) {
             return parent->process_event(event);
         } else {
@@ -360,7 +386,7 @@ public:
         }
     }
 
-    void set_window(gui_window *window) noexcept override
+    void set_window(gui_window_base *window) noexcept override
     {
         if (parent) {
             return parent->set_window(window);
@@ -369,7 +395,7 @@ public:
         }
     }
 
-    [[nodiscard]] gui_window *window() const noexcept override
+    [[nodiscard]] gui_window_base *window() const noexcept override
     {
         if (parent) {
             return parent->window();
@@ -457,6 +483,8 @@ protected:
     widget_layout _layout;
 
     callback<void(widget_mode)> _mode_cbt;
+    callback<void(extent2)> _minimum_cbt;
+    callback<void(extent2)> _maximum_cbt;
     callback<void(bool)> _focus_cbt;
     callback<void(bool)> _hover_cbt;
 
@@ -0,0 +1,311 @@
+// Copyright Take Vos 2023.
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "widget.hpp"
+#include "scroll_bar_widget.hpp"
+#include "../GUI/gui_window_headless.hpp"
+#include "../macros.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <memory>
+
+using namespace hi;
+
+namespace {
+
+/** A widget which counts how often it is constrained and laid out.
+ */
+class counting_widget final : public widget {
+public:
+    int num_constrains = 0;
+    int num_layouts = 0;
+
+    counting_widget(not_null<widget_intf const *> parent) noexcept : widget(parent) {}
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        ++num_constrains;
+        return super::update_constraints();
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        ++num_layouts;
+        _layout = context;
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+
+private:
+    using super = widget;
+};
+
+/** A top-level widget with a single child.
+ *
+ * Like label_widget, this widget sets the minimum size of its child while it
+ * is being constrained.
+ */
+class container_widget final : public widget {
+public:
+    int num_constrains = 0;
+    int num_layouts = 0;
+
+    /** The minimum size to set on the child when constraining.
+     */
+    extent2 child_minimum = {};
+
+    /** The constraints returned by the child.
+     */
+    box_constraints child_constraints = {};
+
+    std::unique_ptr<counting_widget> child;
+
+    container_widget() noexcept : widget(nullptr)
+    {
+        child = std::make_unique<counting_widget>(this);
+    }
+
+    [[nodiscard]] generator<widget_intf&> children(bool include_invisible) noexcept override
+    {
+        co_yield *child;
+    }
+
+    [[nodiscard]] box_constraints update_constraints() noexcept override
+    {
+        ++num_constrains;
+        _layout = {};
+
+        child->minimum = child_minimum;
+        child_constraints = child->update_constraints_retained();
+        return child_constraints;
+    }
+
+    void set_layout(widget_layout const& context) noexcept override
+    {
+        ++num_layouts;
+        _layout = context;
+        child->set_layout_retained(context.transform(box_shape{context.size()}, transform_command::level));
+    }
+
+    void draw(draw_context const& context) noexcept override {}
+
+    bool process_event(gui_event const& event) const noexcept override
+    {
+        discard_retained(event);
+        return _window ? _window->process_event(event) : true;
+    }
+
+    void set_window(gui_window_base *window) noexcept override
+    {
+        _window = window;
+    }
+
+    [[nodiscard]] gui_window_base *window() const noexcept override
+    {
+        return _window;
+    }
+
+private:
+    gui_window_base *_window = nullptr;
+};
+
+void render(gui_window_headless& window) noexcept
+{
+    std::ignore = window.render(std::chrono::utc_clock::now());
+}
+
+} // namespace
+
+TEST(widget, retained_constraints)
+{
+    auto window = gui_window_headless{std::make_unique<container_widget>(), extent2{100.0f, 100.0f}};
+    auto& parent = window.widget<container_widget>();
+    auto& child = *parent.child;
+
+    render(window);
+    ASSERT_EQ(parent.num_constrains, 1);
+    ASSERT_EQ(child.num_constrains, 1);
+    ASSERT_EQ(parent.num_layouts, 1);
+    ASSERT_EQ(child.num_layouts, 1);
+
+    // Nothing changed, the retained constraints and layout are used.
+    render(window);
+    ASSERT_EQ(parent.num_constrains, 1);
+    ASSERT_EQ(child.num_constrains, 1);
+    ASSERT_EQ(parent.num_layouts, 1);
+    ASSERT_EQ(child.num_layouts, 1);
+    ASSERT_FALSE(parent.constraints_dirty());
+    ASSERT_FALSE(child.constraints_dirty());
+
+    // A reconstrain of the child bubbles up to the parent.
+    ASSERT_TRUE(child.process_event({gui_event_type::window_reconstrain}));
+    ASSERT_TRUE(child.constraints_dirty());
+    ASSERT_TRUE(parent.constraints_dirty());
+
+    render(window);
+    ASSERT_EQ(parent.num_constrains, 2);
+    ASSERT_EQ(child.num_constrains, 2);
+    ASSERT_FALSE(parent.constraints_dirty());
+    ASSERT_FALSE(child.constraints_dirty());
+}
+
+TEST(widget, retained_layout)
+{
+    auto window = gui_window_headless{std::make_unique<container_widget>(), extent2{100.0f, 100.0f}};
+    auto& parent = window.widget<container_widget>();
+    auto& child = *parent.child;
+    render(window);
+
+    // A relayout does not constrain.
+    ASSERT_TRUE(child.process_event({gui_event_type::window_relayout}));
+    ASSERT_FALSE(child.constraints_dirty());
+    ASSERT_TRUE(child.layout_dirty());
+    ASSERT_TRUE(parent.layout_dirty());
+
+    render(window);
+    ASSERT_EQ(parent.num_constrains, 1);
+    ASSERT_EQ(child.num_constrains, 1);
+    ASSERT_EQ(parent.num_layouts, 2);
+    ASSERT_EQ(child.num_layouts, 2);
+
+    // A new size of the window is a new layout for both widgets.
+    window.set_window_size(extent2{200.0f, 100.0f});
+    render(window);
+    ASSERT_EQ(parent.num_constrains, 1);
+    ASSERT_EQ(parent.num_layouts, 3);
+    ASSERT_EQ(child.num_layouts, 3);
+    ASSERT_EQ(child.layout().size(), (extent2{200.0f, 100.0f}));
+}
+
+TEST(widget, parent_sets_minimum_of_child)
+{
+    auto window = gui_window_headless{std::make_unique<container_widget>(), extent2{100.0f, 100.0f}};
+    auto& parent = window.widget<container_widget>();
+    auto& child = *parent.child;
+    render(window);
+    ASSERT_EQ(parent.child_constraints.minimum, (extent2{0.0f, 0.0f}));
+
+    // Only the parent is asked to reconstrain, the child's minimum is changed by the parent.
+    parent.child_minimum = extent2{50.0f, 40.0f};
+    ASSERT_TRUE(parent.process_event({gui_event_type::window_reconstrain}));
+    ASSERT_FALSE(child.constraints_dirty());
+
+    // The child is constrained again, instead of returning its retained constraints.
+    render(window);
+    ASSERT_EQ(child.num_constrains, 2);
+    ASSERT_EQ(parent.child_constraints.minimum, (extent2{50.0f, 40.0f}));
+
+    // Setting the same minimum does not constrain the child again.
+    render(window);
+    render(window);
+    ASSERT_EQ(child.num_constrains, 2);
+    ASSERT_FALSE(parent.constraints_dirty());
+    ASSERT_FALSE(child.constraints_dirty());
+}
+
+TEST(widget, maximum_reconstrains)
+{
+    auto window = gui_window_headless{std::make_unique<container_widget>(), extent2{100.0f, 100.0f}};
+    auto& parent = window.widget<container_widget>();
+    auto& child = *parent.child;
+    render(window);
+
+    // Setting the maximum from outside of the constrain pass.
+    child.maximum = extent2{80.0f, 80.0f};
+    ASSERT_TRUE(child.constraints_dirty());
+    ASSERT_TRUE(parent.constraints_dirty());
+
+    render(window);
+    ASSERT_EQ(child.num_constrains, 2);
+    ASSERT_EQ(parent.child_constraints.maximum, (extent2{80.0f, 80.0f}));
+
+    // The window is resized to fit the new maximum.
+    ASSERT_EQ(window.widget_size, (extent2{80.0f, 80.0f}));
+}
+
+TEST(widget, registry)
+{
+    auto top = container_widget{};
+    auto& child = *top.child;
+    ASSERT_EQ(child.top, &top);
+    ASSERT_EQ(top.top, &top);
+
+    ASSERT_EQ(get_if(&top, top.id, true), &top);
+    ASSERT_EQ(get_if(&top, child.id, true), &child);
+    ASSERT_EQ(&get(top, child.id, true), &child);
+
+    // A widget is removed from the registry when it is destroyed.
+    auto grandchild = std::make_unique<counting_widget>(&child);
+    hilet grandchild_id = grandchild->id;
+    ASSERT_EQ(get_if(&top, grandchild_id, true), grandchild.get());
+    grandchild = nullptr;
+    ASSERT_EQ(get_if(&top, grandchild_id, true), nullptr);
+    ASSERT_THROW(get(top, grandchild_id, true), not_found_error);
+
+    // The id is reused by the next widget.
+    grandchild = std::make_unique<counting_widget>(&child);
+    ASSERT_EQ(grandchild->id, grandchild_id);
+    ASSERT_EQ(get_if(&top, grandchild_id, true), grandchild.get());
+}
+
+TEST(widget, lookup_in_tree)
+{
+    auto top = container_widget{};
+    auto other = container_widget{};
+    auto grandchild = counting_widget{top.child.get()};
+
+    // Only widgets in the tree below the start are found.
+    ASSERT_EQ(get_if(&top, grandchild.id, true), &grandchild);
+    ASSERT_EQ(get_if(&other, grandchild.id, true), nullptr);
+    ASSERT_EQ(get_if(top.child.get(), grandchild.id, true), &grandchild);
+    ASSERT_EQ(get_if(other.child.get(), grandchild.id, true), nullptr);
+    ASSERT_EQ(get_if(&grandchild, top.child->id, true), nullptr);
+
+    ASSERT_TRUE(is_descendant(grandchild, top, true));
+    ASSERT_TRUE(is_descendant(grandchild, *top.child, true));
+    ASSERT_TRUE(is_descendant(grandchild, grandchild, true));
+    ASSERT_FALSE(is_descendant(*top.child, grandchild, true));
+    ASSERT_FALSE(is_descendant(grandchild, other, true));
+}
+
+TEST(widget, lookup_invisible)
+{
+    auto top = container_widget{};
+    auto& child = *top.child;
+    auto grandchild = counting_widget{&child};
+    ASSERT_EQ(get_if(&top, grandchild.id, false), &grandchild);
+
+    // A widget below an invisible parent is only found when including invisible widgets.
+    child.mode = widget_mode::invisible;
+    ASSERT_EQ(get_if(&top, grandchild.id, false), nullptr);
+    ASSERT_EQ(get_if(&top, child.id, false), nullptr);
+    ASSERT_EQ(get_if(&top, grandchild.id, true), &grandchild);
+    ASSERT_EQ(get_if(&child, grandchild.id, false), &grandchild);
+
+    // The top level widget itself may be invisible.
+    top.mode = widget_mode::invisible;
+    child.mode = widget_mode::enabled;
+    ASSERT_EQ(get_if(&top, grandchild.id, false), &grandchild);
+
+    grandchild.mode = widget_mode::invisible;
+    ASSERT_EQ(get_if(&top, grandchild.id, false), nullptr);
+    ASSERT_EQ(get_if(&child, grandchild.id, false), nullptr);
+    ASSERT_EQ(get_if(&grandchild, grandchild.id, false), &grandchild);
+}
+
+TEST(widget, lookup_scroll_bar)
+{
+    auto top = container_widget{};
+    auto content = observer<float>{100.0f};
+    auto aperture = observer<float>{50.0f};
+    auto offset = observer<float>{0.0f};
+    auto scroll_bar = scroll_bar_widget<axis::vertical>{top.child.get(), content, aperture, offset};
+    ASSERT_TRUE(scroll_bar.scrollable());
+    ASSERT_EQ(get_if(&top, scroll_bar.id, false), &scroll_bar);
+
+    // A scroll bar without anything to scroll is still a visible widget.
+    aperture = 200.0f;
+    ASSERT_FALSE(scroll_bar.scrollable());
+    ASSERT_EQ(get_if(&top, scroll_bar.id, false), &scroll_bar);
+}
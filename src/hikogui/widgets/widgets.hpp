@@ -8,6 +8,8 @@
 #include "grid_widget.hpp" // export
 #include "icon_widget.hpp" // export
 #include "label_widget.hpp" // export
+#include "list_delegate.hpp" // export
+#include "list_widget.hpp" // export
 #include "menu_button_widget.hpp" // export
 #include "momentary_button_widget.hpp" // export
 #include "overlay_widget.hpp" // export
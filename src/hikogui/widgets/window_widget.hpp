@@ -48,7 +48,7 @@ public:
         _toolbar->emplace<window_controls_macos_widget>();
 
 #else
-#error "Not implemented"
+        // There are no native windows on this platform, only a gui_window_headless.
 #endif
 
         _content = std::make_unique<grid_widget>(this);
@@ -99,8 +99,8 @@ public:
         hi_assert_not_null(_toolbar);
 
         _layout = {};
-        _content_constraints = _content->update_constraints();
-        _toolbar_constraints = _toolbar->update_constraints();
+        _content_constraints = _content->update_constraints_retained();
+        _toolbar_constraints = _toolbar->update_constraints_retained();
 
         auto r = box_constraints{};
         r.minimum.width() = std::max(
@@ -170,16 +170,16 @@ public:
                 point2{context.width() - _content_constraints.margins.right(), toolbar_rectangle.bottom() - between_margin}};
             _content_shape = box_shape{_content_constraints, content_rectangle, theme().baseline_adjustment()};
         }
-        _toolbar->set_layout(context.transform(_toolbar_shape));
-        _content->set_layout(context.transform(_content_shape));
+        _toolbar->set_layout_retained(context.transform(_toolbar_shape));
+        _content->set_layout_retained(context.transform(_content_shape));
     }
     void draw(draw_context const& context) noexcept override
     {
         if (*mode > widget_mode::invisible) {
             context.draw_box(_layout, _layout.rectangle(), background_color(), background_color());
 
-            _toolbar->draw(context);
-            _content->draw(context);
+            _toolbar->draw_retained(context);
+            _content->draw_retained(context);
         }
     }
     [[nodiscard]] hitbox hitbox_test(point2 position) const noexcept override
@@ -261,6 +261,8 @@ public:
     }
     bool process_event(gui_event const& event) const noexcept override
     {
+        discard_retained(event);
+
         if (_window) {
             return _window->process_event(event);
         } else {
@@ -268,20 +270,20 @@ public:
             return true;
         }
     }
-    void set_window(gui_window *window) noexcept override
+    void set_window(gui_window_base *window) noexcept override
     {
         _window = window;
         if (_window) {
             _window->set_title(*title);
         }
     }
-    [[nodiscard]] gui_window *window() const noexcept override
+    [[nodiscard]] gui_window_base *window() const noexcept override
     {
         return _window;
     }
     /// @endprivatesection
 private:
-    gui_window *_window = nullptr;
+    gui_window_base *_window = nullptr;
 
     std::unique_ptr<grid_widget> _content;
     box_constraints _content_constraints;
@@ -250,13 +250,13 @@ public:
 
         for (auto& cell : _grid) {
             if (cell.value == grid_cell_type::button) {
-                cell.set_constraints(_button_widget->update_constraints());
+                _grid.set_constraints(cell, _button_widget->update_constraints_retained());
 
             } else if (cell.value == grid_cell_type::label) {
-                hilet on_label_constraints = _on_label_widget->update_constraints();
-                hilet off_label_constraints = _off_label_widget->update_constraints();
-                hilet other_label_constraints = _other_label_widget->update_constraints();
-                cell.set_constraints(max(on_label_constraints, off_label_constraints, other_label_constraints));
+                hilet on_label_constraints = _on_label_widget->update_constraints_retained();
+                hilet off_label_constraints = _off_label_widget->update_constraints_retained();
+                hilet other_label_constraints = _other_label_widget->update_constraints_retained();
+                _grid.set_constraints(cell, max(on_label_constraints, off_label_constraints, other_label_constraints));
 
             } else {
                 hi_no_default();
@@ -274,12 +274,12 @@ public:
 
         for (hilet& cell : _grid) {
             if (cell.value == grid_cell_type::button) {
-                _button_widget->set_layout(context.transform(cell.shape, transform_command::level));
+                _button_widget->set_layout_retained(context.transform(cell.shape, transform_command::level));
 
             } else if (cell.value == grid_cell_type::label) {
-                _on_label_widget->set_layout(context.transform(cell.shape));
-                _off_label_widget->set_layout(context.transform(cell.shape));
-                _other_label_widget->set_layout(context.transform(cell.shape));
+                _on_label_widget->set_layout_retained(context.transform(cell.shape));
+                _off_label_widget->set_layout_retained(context.transform(cell.shape));
+                _other_label_widget->set_layout_retained(context.transform(cell.shape));
 
             } else {
                 hi_no_default();
@@ -292,12 +292,12 @@ public:
         if (*mode > widget_mode::invisible and overlaps(context, layout())) {
             for (hilet& cell : _grid) {
                 if (cell.value == grid_cell_type::button) {
-                    _button_widget->draw(context);
+                    _button_widget->draw_retained(context);
 
                 } else if (cell.value == grid_cell_type::label) {
-                    _on_label_widget->draw(context);
-                    _off_label_widget->draw(context);
-                    _other_label_widget->draw(context);
+                    _on_label_widget->draw_retained(context);
+                    _off_label_widget->draw_retained(context);
+                    _other_label_widget->draw_retained(context);
 
                 } else {
                     hi_no_default();